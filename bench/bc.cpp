@@ -0,0 +1,171 @@
+// BC benchmark: throughput of image::BC in megapixels per second
+// usage: bc_bench [-n iterations] [-s size] [-t threads] [-e fast|normal|high] [dds files...]
+// without files, random blocks of size x size image are decoded for each format
+// (random blocks cover all modes and endpoint orders, BC7 also reserved mode in 1 of 256 blocks)
+// -e encodes instead (default 1 iteration) and reports RMSE and PSNR of each texture:
+// synthetic size x size RGBA image to each format, or decoded dds files again to their own format
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <random>
+
+#include "../src/image/BC.hpp"
+#include "../src/image/DDS.hpp"
+
+template<typename F>
+double measure_msec(uint32_t iteration_count, F&& f) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < iteration_count; ++i) {
+        f();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - begin).count() / iteration_count;
+}
+
+const char* format_name(image::Format format) {
+    switch(format) {
+        case image::Format::BC1: return "BC1";
+        case image::Format::BC2: return "BC2";
+        case image::Format::BC3: return "BC3";
+        case image::Format::BC4U: return "BC4U";
+        case image::Format::BC4S: return "BC4S";
+        case image::Format::BC5U: return "BC5U";
+        case image::Format::BC5S: return "BC5S";
+        case image::Format::BC7: return "BC7";
+        default: return "?";
+    }
+}
+
+void run(const std::string& name, std::span<const uint8_t> blocks, uint32_t width, uint32_t height, image::Format format, uint32_t iteration_count, concurrency::ThreadPool& pool) {
+    auto info = image::BC::decoded_info(width, height, format);
+    std::vector<uint8_t> dst(info.size());
+
+    auto single_msec = measure_msec(iteration_count, [&]{
+        image::BC::decode(blocks, width, height, format, dst, info.row_pitch);
+    });
+    auto pool_msec = measure_msec(iteration_count, [&]{
+        image::BC::decode(blocks, width, height, format, dst, info.row_pitch, &pool);
+    });
+
+    auto megapixels = static_cast<double>(width) * height / 1e6;
+    std::cout << std::format("{:<32} {:>6} {:>12.2f} {:>14.1f} {:>14.1f}", name, format_name(format), megapixels, megapixels / (single_msec / 1000.0), megapixels / (pool_msec / 1000.0)) << std::endl;
+}
+
+void run_encode(const std::string& name, std::span<const uint8_t> pixels, uint32_t width, uint32_t height, image::Format source_format, image::Format format, const image::bc::EncodeOptions& options, uint32_t iteration_count, concurrency::ThreadPool& pool) {
+    image::bc::EncodeResult result{};
+    auto single_msec = measure_msec(iteration_count, [&]{
+        result = image::BC::encode(pixels, width, height, source_format, format, options);
+    });
+    auto pool_msec = measure_msec(iteration_count, [&]{
+        result = image::BC::encode(pixels, width, height, source_format, format, options, &pool);
+    });
+
+    auto megapixels = static_cast<double>(width) * height / 1e6;
+    std::cout << std::format("{:<32} {:>6} {:>12.2f} {:>14.2f} {:>14.2f} {:>8.3f} {:>8.2f}", name, format_name(format), megapixels, megapixels / (single_msec / 1000.0), megapixels / (pool_msec / 1000.0), result.metrics.rmse, result.metrics.psnr) << std::endl;
+}
+
+// smooth gradients with noise, edges and varying alpha
+std::vector<uint8_t> synthetic_image(uint32_t size) {
+    std::mt19937 rng(1);
+    std::vector<uint8_t> pixels(size_t(size) * size * 4);
+    for(uint32_t y = 0; y < size; ++y) {
+        for(uint32_t x = 0; x < size; ++x) {
+            auto pixel = pixels.data() + (size_t(y) * size + x) * 4;
+            auto edge = ((x / 37) + (y / 23)) % 3 == 0 ? 64 : 0;
+            pixel[0] = static_cast<uint8_t>(std::min<uint32_t>(x * 255 / size + edge + rng() % 8, 255));
+            pixel[1] = static_cast<uint8_t>(std::min<uint32_t>(y * 255 / size + rng() % 8, 255));
+            pixel[2] = static_cast<uint8_t>(std::min<uint32_t>((x + y) * 127 / size + edge, 255));
+            pixel[3] = static_cast<uint8_t>(std::min<uint32_t>((x ^ y) % 256 + rng() % 4, 255));
+        }
+    }
+    return pixels;
+}
+
+int main(int argc, char** argv) {
+    uint32_t iteration_count = 0;
+    std::optional<image::bc::Quality> quality{};
+    uint32_t size = 2048;
+    uint32_t thread_count = 0;
+    std::vector<std::filesystem::path> paths{};
+
+    for(int i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iteration_count = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            size = std::max(4, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            thread_count = std::max(0, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            ++i;
+            quality = std::strcmp(argv[i], "fast") == 0 ? image::bc::Quality::fast : std::strcmp(argv[i], "high") == 0 ? image::bc::Quality::high : image::bc::Quality::normal;
+        }
+        else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if(iteration_count == 0) {
+        iteration_count = quality ? 1 : 10;
+    }
+
+    concurrency::ThreadPool pool(thread_count);
+    if(quality) {
+        image::bc::EncodeOptions options{};
+        options.quality = *quality;
+        std::cout << std::format("{:<32} {:>6} {:>12} {:>14} {:>14} {:>8} {:>8}", "image", "format", "size [MP]", "1 thread [MP/s]", std::format("{} threads [MP/s]", pool.thread_count()), "RMSE", "PSNR") << std::endl;
+
+        if(paths.empty()) {
+            auto pixels = synthetic_image(size);
+            for(auto format : {image::Format::BC1, image::Format::BC2, image::Format::BC3, image::Format::BC4U, image::Format::BC4S, image::Format::BC5U, image::Format::BC5S, image::Format::BC7}) {
+                run_encode(std::format("synthetic {}x{}", size, size), pixels, size, size, image::Format::RGBA8, format, options, iteration_count, pool);
+            }
+            return EXIT_SUCCESS;
+        }
+
+        for(const auto& path : paths) {
+            try {
+                auto dds = image::DDS::load(path);
+                auto info = image::BC::decoded_info(dds.width(), dds.height(), dds.format());
+                std::vector<uint8_t> pixels(info.size());
+                image::BC::decode(dds.data(), dds.width(), dds.height(), dds.format(), pixels, info.row_pitch, &pool);
+                run_encode(path.filename().string(), pixels, dds.width(), dds.height(), info.format, dds.format(), options, iteration_count, pool);
+            }
+            catch(std::exception& e) {
+                std::cerr << std::format("{}: {}", path.string(), e.what()) << std::endl;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << std::format("{:<32} {:>6} {:>12} {:>14} {:>14}", "image", "format", "size [MP]", "1 thread [MP/s]", std::format("{} threads [MP/s]", pool.thread_count())) << std::endl;
+
+    if(paths.empty()) {
+        std::mt19937 rng(1);
+        for(auto format : {image::Format::BC1, image::Format::BC2, image::Format::BC3, image::Format::BC4U, image::Format::BC4S, image::Format::BC5U, image::Format::BC5S, image::Format::BC7}) {
+            std::vector<uint8_t> blocks(image::row_pitch(format, size) * image::row_count(format, size));
+            for(auto& byte : blocks) {
+                byte = static_cast<uint8_t>(rng());
+            }
+            run(std::format("random {}x{}", size, size), blocks, size, size, format, iteration_count, pool);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    for(const auto& path : paths) {
+        try {
+            auto dds = image::DDS::load(path);
+            run(path.filename().string(), dds.data(), dds.width(), dds.height(), dds.format(), iteration_count, pool);
+        }
+        catch(std::exception& e) {
+            std::cerr << std::format("{}: {}", path.string(), e.what()) << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,647 @@
+// image codec benchmark: native loaders (PNG, JPG, BMP, PPM, DDS + BC, HDR) vs stb_image
+// usage: codec_bench [-n iterations] [-s divisor] [-c corpus_dir] [-j result.json] [--no-cold] [files...]
+// without files, synthetic corpus is generated to corpus_dir (default codec_corpus, existing files are reused):
+// small icons, 4K photo (JPEG and PNG), palette PNG, highly compressible atlas, BMP, PPM, BC7 DDS and RLE HDR
+// (-s divides corpus dimensions for quick runs)
+// each file is decoded by each loader in warm pass (file in page cache) and cold pass (pages dropped by posix_fadvise before
+// every iteration, Linux only), reports decode MB/s of decoded bytes, megapixels/s, peak RSS increase and allocations per file
+// (MB/s counts output of each loader, e.g. native JPG decodes to RGBA8 and stb to RGB8, megapixels/s compares them directly;
+// peak RSS includes touched pages of memory-mapped input)
+// -j writes all results as JSON for tracking regressions
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+#include "../src/image/PNG.hpp"
+#include "../src/image/JPG.hpp"
+#include "../src/image/BMP.hpp"
+#include "../src/image/PPM.hpp"
+#include "../src/image/DDS.hpp"
+#include "../src/image/BC.hpp"
+#include "../src/image/HDR.hpp"
+#include "../src/image/png/Checksum.hpp"
+#include "../src/image/png/Deflate.hpp"
+#include "../src/image/stb_image_write.h"
+
+// allocations of native loaders (operator new) and stb_image (STBI_MALLOC) are counted while counting is enabled
+namespace {
+
+std::atomic<bool> is_counting{false};
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<uint64_t> allocated_bytes{0};
+
+void count_allocation(size_t size) noexcept {
+    if(is_counting.load(std::memory_order_relaxed)) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+void* counted_malloc(size_t size) noexcept {
+    count_allocation(size);
+    return std::malloc(size);
+}
+
+void* counted_realloc(void* pointer, size_t size) noexcept {
+    count_allocation(size);
+    return std::realloc(pointer, size);
+}
+
+void* allocate(size_t size) {
+    count_allocation(size);
+    if(auto pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void* allocate_aligned(size_t size, std::align_val_t alignment) {
+    count_allocation(size);
+    auto align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    if(auto pointer = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+// own stb_image instance (src/image/stb_image.cpp is not linked) with counted allocations, PNM and HDR are enabled for comparison
+#define STBI_NO_PSD
+#define STBI_NO_TGA
+#define STBI_NO_GIF
+#define STBI_NO_PIC
+#define STBI_MALLOC(size) counted_malloc(size)
+#define STBI_REALLOC(pointer, size) counted_realloc(pointer, size)
+#define STBI_FREE(pointer) std::free(pointer)
+#define STB_IMAGE_IMPLEMENTATION
+#include "../src/image/stb_image.h"
+
+namespace {
+
+template<typename F>
+double measure_msec(uint32_t iteration_count, F&& f) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < iteration_count; ++i) {
+        f();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - begin).count() / iteration_count;
+}
+
+// --- memory
+
+// value of "VmRSS:" or "VmHWM:" line of /proc/self/status in KiB (-1 if not available)
+int64_t read_status_kb(const char* key) {
+    std::ifstream status("/proc/self/status");
+    std::string line{};
+    while(std::getline(status, line)) {
+        if(line.starts_with(key)) {
+            return std::atoll(line.c_str() + std::strlen(key));
+        }
+    }
+    return -1;
+}
+
+// resets peak RSS (VmHWM) to current RSS (Linux 4.0+)
+// freed heap is returned first, otherwise loader reusing pages of previous one would show no increase
+bool reset_peak_rss() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return static_cast<bool>(clear_refs);
+}
+
+// drops cached pages of file, so next read goes to storage
+bool drop_page_cache(const std::filesystem::path& path) {
+#if defined(__linux__)
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    ::fdatasync(fd);
+    auto result = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+    return result == 0;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+// --- loaders
+
+struct Decoded {
+    uint32_t width;
+    uint32_t height;
+    size_t size;
+};
+
+std::string extension_of(const std::filesystem::path& path) {
+    auto extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+// native loader of file type (decoded size is bytes of decoder output format)
+Decoded load_native(const std::filesystem::path& path) {
+    auto extension = extension_of(path);
+    if(extension == ".png") {
+        auto png = image::PNG::load(path);
+        return Decoded{png.width(), png.height(), png.data().size()};
+    }
+    if(extension == ".jpg" || extension == ".jpeg") {
+        auto jpg = image::JPG::load(path);
+        return Decoded{jpg.width(), jpg.height(), jpg.data().size()};
+    }
+    if(extension == ".bmp") {
+        auto bmp = image::BMP::load(path);
+        return Decoded{bmp.width(), bmp.height(), bmp.data().size()};
+    }
+    if(extension == ".ppm") {
+        auto ppm = image::PPM::load(path);
+        return Decoded{ppm.width(), ppm.height(), ppm.data().size()};
+    }
+    if(extension == ".hdr") {
+        // float RGBA as stbi_loadf
+        auto hdr = image::HDR::load(path, image::Format::RGBA32F);
+        return Decoded{hdr.width(), hdr.height(), hdr.data().size()};
+    }
+    if(extension == ".dds") {
+        // mapping and layout only, then top level blocks decoded to pixels
+        auto dds = image::DDS::load(path);
+        const auto& level = dds.subresource(0, 0);
+        if(!image::is_block_compressed(dds.format())) {
+            return Decoded{level.width, level.height, level.size};
+        }
+        auto pixels = image::BC::decode(dds.data(0, 0), level.width, level.height, dds.format());
+        return Decoded{level.width, level.height, pixels.size()};
+    }
+    throw std::runtime_error(std::format("unsupported file type: {}", extension));
+}
+
+bool is_supported_by_stb(const std::filesystem::path& path) {
+    auto extension = extension_of(path);
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" || extension == ".ppm" || extension == ".hdr";
+}
+
+// channels as stored, floats for HDR
+Decoded load_stb(const std::filesystem::path& path) {
+    int32_t width{}, height{}, component_count{};
+    if(extension_of(path) == ".hdr") {
+        auto data = stbi_loadf(path.string().c_str(), &width, &height, &component_count, 4);
+        if(!data) {
+            throw std::runtime_error(stbi_failure_reason());
+        }
+        stbi_image_free(data);
+        return Decoded{static_cast<uint32_t>(width), static_cast<uint32_t>(height), size_t(width) * height * 16};
+    }
+    auto is_16bit = stbi_is_16_bit(path.string().c_str());
+    auto data = is_16bit ? static_cast<void*>(stbi_load_16(path.string().c_str(), &width, &height, &component_count, 0)) : static_cast<void*>(stbi_load(path.string().c_str(), &width, &height, &component_count, 0));
+    if(!data) {
+        throw std::runtime_error(stbi_failure_reason());
+    }
+    stbi_image_free(data);
+    return Decoded{static_cast<uint32_t>(width), static_cast<uint32_t>(height), size_t(width) * height * component_count * (is_16bit ? 2 : 1)};
+}
+
+// --- corpus
+
+// smooth gradients, soft shapes and sensor-like noise (compresses like a photo, not like flat art)
+std::vector<uint8_t> make_photo(uint32_t width, uint32_t height, uint32_t channel_count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 4.0f);
+    std::vector<uint8_t> pixels(size_t(width) * height * channel_count);
+    for(uint32_t y = 0; y < height; ++y) {
+        for(uint32_t x = 0; x < width; ++x) {
+            auto u = static_cast<float>(x) / width, v = static_cast<float>(y) / height;
+            float base[3] = {
+                128.0f + 90.0f * std::sin(6.0f * u + 2.0f * v) * std::cos(3.0f * v),
+                110.0f + 80.0f * std::sin(9.0f * v - 4.0f * u + 1.0f),
+                100.0f + 70.0f * std::cos(12.0f * u * v + 5.0f * u),
+            };
+            auto* pixel = pixels.data() + (size_t(y) * width + x) * channel_count;
+            for(uint32_t c = 0; c < channel_count; ++c) {
+                pixel[c] = c == 3 ? 255 : static_cast<uint8_t>(std::clamp(base[c] + noise(rng), 0.0f, 255.0f));
+            }
+        }
+    }
+    return pixels;
+}
+
+// flat rectangles of few colors (typical UI or sprite atlas, deflates very well)
+std::vector<uint8_t> make_atlas(uint32_t width, uint32_t height, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> pixels(size_t(width) * height * 4, 0);
+    for(uint32_t i = 0; i < 200; ++i) {
+        auto x0 = static_cast<uint32_t>(rng() % width), y0 = static_cast<uint32_t>(rng() % height);
+        auto x1 = std::min(width, x0 + 16 + static_cast<uint32_t>(rng() % (width / 8))), y1 = std::min(height, y0 + 16 + static_cast<uint32_t>(rng() % (height / 8)));
+        uint8_t color[4] = {static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), 255};
+        for(auto y = y0; y < y1; ++y) {
+            for(auto x = x0; x < x1; ++x) {
+                std::memcpy(pixels.data() + (size_t(y) * width + x) * 4, color, 4);
+            }
+        }
+    }
+    return pixels;
+}
+
+void write_file(const std::filesystem::path& path, std::span<const uint8_t> bytes) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if(!file) {
+        throw std::runtime_error(std::format("failed to write file: {}", path.string()));
+    }
+}
+
+void append_chunk(std::vector<uint8_t>& out, const char* type, std::span<const uint8_t> payload) {
+    auto append_u32 = [&](uint32_t value) {
+        for(auto shift : {24, 16, 8, 0}) {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    };
+    append_u32(static_cast<uint32_t>(payload.size()));
+    auto begin = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), payload.begin(), payload.end());
+    append_u32(image::png::crc32(0, out.data() + begin, out.size() - begin));
+}
+
+// 8 bits indexed PNG (PNG encoder writes truecolor only)
+void write_palette_png(const std::filesystem::path& path, uint32_t width, uint32_t height) {
+    std::vector<uint8_t> palette(256 * 3);
+    for(uint32_t i = 0; i < 256; ++i) {
+        palette[i * 3 + 0] = static_cast<uint8_t>(i);
+        palette[i * 3 + 1] = static_cast<uint8_t>(255 - i);
+        palette[i * 3 + 2] = static_cast<uint8_t>((i * 7) & 0xff);
+    }
+    // ordered dithered gradient, filter type 0 for each row
+    std::vector<uint8_t> raw(size_t(width + 1) * height);
+    for(uint32_t y = 0; y < height; ++y) {
+        raw[size_t(y) * (width + 1)] = 0;
+        for(uint32_t x = 0; x < width; ++x) {
+            auto value = (x * 256 / width + y * 64 / height + ((x ^ y) & 3)) & 0xff;
+            raw[size_t(y) * (width + 1) + 1 + x] = static_cast<uint8_t>(value);
+        }
+    }
+    std::vector<uint8_t> zlib{0x78, 0x9c};
+    auto deflated = image::png::Deflate::compress(raw, 0, raw.size(), 6, true);
+    zlib.insert(zlib.end(), deflated.begin(), deflated.end());
+    auto adler = image::png::adler32(1, raw.data(), raw.size());
+    for(auto shift : {24, 16, 8, 0}) {
+        zlib.push_back(static_cast<uint8_t>(adler >> shift));
+    }
+
+    std::vector<uint8_t> out{0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a};
+    uint8_t ihdr[13] = {
+        static_cast<uint8_t>(width >> 24), static_cast<uint8_t>(width >> 16), static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+        static_cast<uint8_t>(height >> 24), static_cast<uint8_t>(height >> 16), static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+        8, 3, 0, 0, 0,
+    };
+    append_chunk(out, "IHDR", ihdr);
+    append_chunk(out, "PLTE", palette);
+    append_chunk(out, "IDAT", zlib);
+    append_chunk(out, "IEND", {});
+    write_file(path, out);
+}
+
+void write_ppm(const std::filesystem::path& path, std::span<const uint8_t> rgb, uint32_t width, uint32_t height) {
+    auto header = std::format("P6\n{} {}\n255\n", width, height);
+    std::vector<uint8_t> out(header.begin(), header.end());
+    out.insert(out.end(), rgb.begin(), rgb.end());
+    write_file(path, out);
+}
+
+// adaptive RLE scanlines (runs of 3+ equal bytes, literals otherwise) of sky-like gradient with a bright sun
+void write_hdr(const std::filesystem::path& path, uint32_t width, uint32_t height) {
+    auto header = std::format("#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y {} +X {}\n", height, width);
+    std::vector<uint8_t> out(header.begin(), header.end());
+    std::vector<uint8_t> rgbe(size_t(width) * 4);
+    for(uint32_t y = 0; y < height; ++y) {
+        for(uint32_t x = 0; x < width; ++x) {
+            auto u = static_cast<float>(x) / width, v = static_cast<float>(y) / height;
+            auto sun = 2000.0f * std::exp(-((u - 0.3f) * (u - 0.3f) + (v - 0.2f) * (v - 0.2f)) * 2000.0f);
+            float rgb[3] = {0.3f + 0.5f * v + sun, 0.5f + 0.4f * v + sun, 1.0f - 0.3f * v + sun};
+            auto largest = std::max({rgb[0], rgb[1], rgb[2]});
+            int32_t exponent{};
+            auto mantissa = std::frexp(largest, &exponent);
+            auto scale = mantissa * 256.0f / largest;
+            auto* pixel = rgbe.data() + size_t(x) * 4;
+            for(uint32_t c = 0; c < 3; ++c) {
+                pixel[c] = static_cast<uint8_t>(std::min(rgb[c] * scale, 255.0f));
+            }
+            pixel[3] = static_cast<uint8_t>(exponent + 128);
+        }
+        out.insert(out.end(), {2, 2, static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width & 0xff)});
+        for(uint32_t c = 0; c < 4; ++c) {
+            for(uint32_t x = 0; x < width;) {
+                uint32_t run = 1;
+                while(x + run < width && run < 127 && rgbe[size_t(x + run) * 4 + c] == rgbe[size_t(x) * 4 + c]) {
+                    ++run;
+                }
+                if(run >= 3) {
+                    out.insert(out.end(), {static_cast<uint8_t>(128 + run), rgbe[size_t(x) * 4 + c]});
+                    x += run;
+                    continue;
+                }
+                // literals until next run of 3 (or 128 bytes)
+                auto first = x;
+                while(x < width && x - first < 128 && !(x + 2 < width && rgbe[size_t(x) * 4 + c] == rgbe[size_t(x + 1) * 4 + c] && rgbe[size_t(x) * 4 + c] == rgbe[size_t(x + 2) * 4 + c])) {
+                    ++x;
+                }
+                if(x == first) {
+                    ++x;
+                }
+                out.push_back(static_cast<uint8_t>(x - first));
+                for(auto i = first; i < x; ++i) {
+                    out.push_back(rgbe[size_t(i) * 4 + c]);
+                }
+            }
+        }
+    }
+    write_file(path, out);
+}
+
+std::vector<std::filesystem::path> generate_corpus(const std::filesystem::path& directory, uint32_t divisor) {
+    std::filesystem::create_directories(directory);
+    std::vector<std::filesystem::path> paths{};
+    auto add = [&](const char* name, auto&& write) {
+        auto path = directory / name;
+        if(!std::filesystem::exists(path)) {
+            std::cout << std::format("generating {}", path.string()) << std::endl;
+            write(path);
+        }
+        paths.push_back(path);
+    };
+    auto scaled = [&](uint32_t size) { return std::max(8u, size / divisor); };
+
+    for(auto size : {16u, 32u, 64u}) {
+        auto name = std::format("icon_{}.png", size);
+        add(name.c_str(), [&](const std::filesystem::path& path) {
+            auto pixels = make_photo(size, size, 4, size);
+            image::PNG::save(path, pixels, size, size, image::Format::RGBA8);
+        });
+    }
+
+    auto photo_width = scaled(3840), photo_height = scaled(2160);
+    std::vector<uint8_t> photo{};
+    auto get_photo = [&]() -> const std::vector<uint8_t>& {
+        if(photo.empty()) {
+            photo = make_photo(photo_width, photo_height, 3, 1);
+        }
+        return photo;
+    };
+    add("photo_4k.jpg", [&](const std::filesystem::path& path) {
+        stbi_write_jpg(path.string().c_str(), static_cast<int32_t>(photo_width), static_cast<int32_t>(photo_height), 3, get_photo().data(), 90);
+    });
+    add("photo_4k.png", [&](const std::filesystem::path& path) {
+        image::PNG::save(path, get_photo(), photo_width, photo_height, image::Format::RGB8);
+    });
+    add("palette_1k.png", [&](const std::filesystem::path& path) {
+        write_palette_png(path, scaled(1024), scaled(1024));
+    });
+    add("atlas_4k.png", [&](const std::filesystem::path& path) {
+        auto size = scaled(4096);
+        image::PNG::save(path, make_atlas(size, size, 2), size, size, image::Format::RGBA8);
+    });
+
+    auto size = scaled(2048);
+    auto square = make_photo(size, size, 3, 3);
+    add("photo_2k.bmp", [&](const std::filesystem::path& path) {
+        // 32 bits per pixel (BMP reader supports no other)
+        auto pixels = make_photo(size, size, 4, 3);
+        stbi_write_bmp(path.string().c_str(), static_cast<int32_t>(size), static_cast<int32_t>(size), 4, pixels.data());
+    });
+    add("photo_2k.ppm", [&](const std::filesystem::path& path) {
+        write_ppm(path, square, size, size);
+    });
+    add("photo_2k_bc7.dds", [&](const std::filesystem::path& path) {
+        concurrency::ThreadPool pool;
+        image::bc::EncodeOptions options{};
+        options.quality = image::bc::Quality::fast;
+        image::BC::save(path, square, size, size, image::Format::RGB8, image::Format::BC7, options, &pool);
+    });
+    add("sky_2k.hdr", [&](const std::filesystem::path& path) {
+        write_hdr(path, scaled(2048), scaled(1024));
+    });
+
+    return paths;
+}
+
+// --- measurement
+
+struct Result {
+    std::string file;
+    std::string loader;
+    std::string pass;
+    uint64_t file_size;
+    uint32_t width;
+    uint32_t height;
+    uint64_t decoded_size;
+    uint32_t iteration_count;
+    double mean_msec;
+    double min_msec;
+    double mb_per_sec;
+    double megapixels_per_sec;
+    // increase of peak RSS over RSS before decoding (-1: not available)
+    int64_t peak_rss_kb;
+    uint64_t allocation_count;
+    uint64_t allocated_bytes;
+    std::string error;
+};
+
+// one counted run (allocations, peak RSS), then timed iterations (page cache is dropped before each one in cold pass)
+Result run(const std::filesystem::path& path, const std::string& loader_name, Decoded(*loader)(const std::filesystem::path&), bool is_cold, uint32_t iteration_count) {
+    Result result{path.filename().string(), loader_name, is_cold ? "cold" : "warm", 0, 0, 0, 0, iteration_count, 0.0, 0.0, 0.0, 0.0, -1, 0, 0, {}};
+    try {
+        result.file_size = std::filesystem::file_size(path);
+        bool is_peak_reset = reset_peak_rss();
+        auto rss_before = read_status_kb("VmRSS:");
+        allocation_count = 0;
+        allocated_bytes = 0;
+        is_counting = true;
+        auto decoded = loader(path);
+        is_counting = false;
+        auto peak = std::max(read_status_kb("VmHWM:"), read_status_kb("VmRSS:"));
+        if(is_peak_reset && rss_before >= 0 && peak >= 0) {
+            result.peak_rss_kb = std::max<int64_t>(0, peak - rss_before);
+        }
+        result.allocation_count = allocation_count;
+        result.allocated_bytes = allocated_bytes;
+        result.width = decoded.width;
+        result.height = decoded.height;
+        result.decoded_size = decoded.size;
+
+        double total_msec = 0.0, min_msec = std::numeric_limits<double>::max();
+        for(uint32_t i = 0; i < iteration_count; ++i) {
+            if(is_cold) {
+                drop_page_cache(path);
+            }
+            auto msec = measure_msec(1, [&]{ loader(path); });
+            total_msec += msec;
+            min_msec = std::min(min_msec, msec);
+        }
+        result.mean_msec = total_msec / iteration_count;
+        result.min_msec = min_msec;
+        result.mb_per_sec = static_cast<double>(decoded.size) / (1024.0 * 1024.0) / (result.mean_msec / 1000.0);
+        result.megapixels_per_sec = static_cast<double>(decoded.width) * decoded.height / 1e6 / (result.mean_msec / 1000.0);
+    }
+    catch(std::exception& e) {
+        is_counting = false;
+        result.error = e.what();
+    }
+    return result;
+}
+
+std::string json_string(std::string_view value) {
+    std::string escaped{"\""};
+    for(auto c : value) {
+        if(c == '"' || c == '\\') {
+            escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+        else if(static_cast<unsigned char>(c) < 0x20) {
+            escaped += std::format("\\u{:04x}", static_cast<uint32_t>(c));
+        }
+        else {
+            escaped.push_back(c);
+        }
+    }
+    escaped.push_back('"');
+    return escaped;
+}
+
+void write_json(const std::filesystem::path& path, std::span<const Result> results, uint32_t iteration_count, bool is_cold_supported) {
+    std::ofstream out(path);
+    auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    out << std::format("{{\n  \"benchmark\": \"codec\",\n  \"timestamp\": {},\n  \"iterations\": {},\n  \"cold_cache\": {},\n  \"results\": [\n", timestamp, iteration_count, is_cold_supported ? "\"posix_fadvise\"" : "null");
+    for(size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << std::format(
+            "    {{\"file\": {}, \"loader\": {}, \"pass\": {}, \"file_size\": {}, \"width\": {}, \"height\": {}, \"decoded_size\": {}, "
+            "\"mean_msec\": {:.4f}, \"min_msec\": {:.4f}, \"mb_per_sec\": {:.3f}, \"megapixels_per_sec\": {:.3f}, "
+            "\"peak_rss_kb\": {}, \"allocations\": {}, \"allocated_bytes\": {}, \"error\": {}}}{}\n",
+            json_string(r.file), json_string(r.loader), json_string(r.pass), r.file_size, r.width, r.height, r.decoded_size,
+            r.mean_msec, r.min_msec, r.mb_per_sec, r.megapixels_per_sec,
+            r.peak_rss_kb, r.allocation_count, r.allocated_bytes, r.error.empty() ? "null" : json_string(r.error), i + 1 < results.size() ? "," : "");
+    }
+    out << "  ]\n}\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    uint32_t iteration_count = 5;
+    uint32_t divisor = 1;
+    bool runs_cold = true;
+    std::filesystem::path corpus_directory = "codec_corpus";
+    std::filesystem::path json_path{};
+    std::vector<std::filesystem::path> paths{};
+
+    for(int i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iteration_count = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            divisor = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            corpus_directory = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--no-cold") == 0) {
+            runs_cold = false;
+        }
+        else if(argv[i][0] == '-') {
+            std::cerr << "usage: codec_bench [-n iterations] [-s divisor] [-c corpus_dir] [-j result.json] [--no-cold] [files...]" << std::endl;
+            return EXIT_FAILURE;
+        }
+        else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if(paths.empty()) {
+        try {
+            paths = generate_corpus(corpus_directory, divisor);
+        }
+        catch(std::exception& e) {
+            std::cerr << std::format("failed to generate corpus: {}", e.what()) << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+#if defined(__GLIBC__)
+    // heap only grows while loader runs (freed memory stays resident until malloc_trim before next run), so peak is not missed
+    mallopt(M_MMAP_THRESHOLD, 1 << 30);
+    mallopt(M_TRIM_THRESHOLD, INT32_MAX);
+#endif
+
+    bool is_cold_supported = runs_cold;
+#if !defined(__linux__)
+    is_cold_supported = false;
+#endif
+
+    std::vector<Result> results{};
+    std::cout << std::format("{:<20} {:<7} {:<5} {:>10} {:>10} {:>10} {:>10} {:>12} {:>10}", "file", "loader", "pass", "size [MB]", "MB/s", "MP/s", "msec", "peak [KiB]", "allocs") << std::endl;
+    for(const auto& path : paths) {
+        std::vector<std::pair<const char*, Decoded(*)(const std::filesystem::path&)>> loaders{{"native", load_native}};
+        if(is_supported_by_stb(path)) {
+            loaders.emplace_back("stb", load_stb);
+        }
+        for(bool is_cold : {false, true}) {
+            if(is_cold && !is_cold_supported) {
+                continue;
+            }
+            for(auto [name, loader] : loaders) {
+                auto result = run(path, name, loader, is_cold, iteration_count);
+                if(!result.error.empty()) {
+                    std::cout << std::format("{:<20} {:<7} {:<5} error: {}", result.file, result.loader, result.pass, result.error) << std::endl;
+                }
+                else {
+                    std::cout << std::format("{:<20} {:<7} {:<5} {:>10.2f} {:>10.1f} {:>10.1f} {:>10.3f} {:>12} {:>10}",
+                        result.file, result.loader, result.pass, static_cast<double>(result.decoded_size) / (1024.0 * 1024.0),
+                        result.mb_per_sec, result.megapixels_per_sec, result.mean_msec, result.peak_rss_kb, result.allocation_count) << std::endl;
+                }
+                results.push_back(std::move(result));
+            }
+        }
+    }
+
+    if(!json_path.empty()) {
+        write_json(json_path, results, iteration_count, is_cold_supported);
+        std::cout << std::format("results written to {}", json_path.string()) << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+// OBJ load benchmark: mesh::Obj::load on one thread vs thread pool
+// usage: obj_bench [-n iterations] [-t threads] [-m generated_megabytes] [files...]
+// without files, grid mesh of about generated_megabytes (default 64) is written to obj_bench.obj
+// (positions, texture coordinates, normals, quads with absolute and relative indices, one very long comment line)
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "../src/mesh/Obj.hpp"
+
+template<typename F>
+double measure_msec(uint32_t iteration_count, F&& f) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < iteration_count; ++i) {
+        f();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - begin).count() / iteration_count;
+}
+
+// grid of size x size vertices, every other row of quads uses relative indices
+void write_grid(const std::filesystem::path& path, uint32_t size) {
+    std::ofstream file(path, std::ios::binary);
+    file << "# obj_bench grid " << size << " x " << size << "\n";
+    file << "#" << std::string(1 << 20, '-') << "\n";
+    file << "o grid\n";
+    std::string line{};
+    for(uint32_t y = 0; y < size; ++y) {
+        for(uint32_t x = 0; x < size; ++x) {
+            auto u = static_cast<float>(x) / (size - 1), v = static_cast<float>(y) / (size - 1);
+            auto h = 0.1f * std::sin(12.0f * u) * std::cos(9.0f * v);
+            line = std::format("v {:.6f} {:.6f} {:.6f}\nvt {:.6f} {:.6f}\nvn {:.6f} {:.6f} {:.6f}\n", u, h, v, u, v, 0.0f, 1.0f, 0.0f);
+            file.write(line.data(), static_cast<std::streamsize>(line.size()));
+        }
+    }
+    file << "s off\n";
+    auto vertex_count = int64_t(size) * size;
+    for(uint32_t y = 0; y + 1 < size; ++y) {
+        for(uint32_t x = 0; x + 1 < size; ++x) {
+            int64_t corners[4] = {int64_t(y) * size + x + 1, int64_t(y) * size + x + 2, int64_t(y + 1) * size + x + 2, int64_t(y + 1) * size + x + 1};
+            if(y % 2 == 1) {
+                // relative to end of vertex list
+                for(auto& corner : corners) {
+                    corner -= vertex_count + 1;
+                }
+            }
+            line = std::format("f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2} {3}/{3}/{3}\n", corners[0], corners[1], corners[2], corners[3]);
+            file.write(line.data(), static_cast<std::streamsize>(line.size()));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t iteration_count = 3;
+    uint32_t thread_count = 0;
+    uint32_t megabytes = 64;
+    std::vector<std::filesystem::path> paths{};
+
+    for(int i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iteration_count = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            thread_count = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if(std::strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            megabytes = std::max(1, std::atoi(argv[++i]));
+        }
+        else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if(paths.empty()) {
+        // about 130 bytes of attributes and 45 bytes of face per vertex
+        auto size = static_cast<uint32_t>(std::sqrt(megabytes * 1024.0 * 1024.0 / 175.0));
+        paths.emplace_back("obj_bench.obj");
+        std::cout << std::format("generating {} ({} x {} grid)", paths.back().string(), size, size) << std::endl;
+        write_grid(paths.back(), std::max(size, 2u));
+    }
+
+    concurrency::ThreadPool pool(thread_count);
+    std::cout << std::format("{:<40} {:>10} {:>12} {:>16} {:>16} {:>8}", "file", "size [MB]", "triangles", "1 thread [MB/s]", std::format("{} threads [MB/s]", pool.thread_count()), "ratio") << std::endl;
+    for(const auto& path : paths) {
+        try {
+            auto megabyte_count = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+            // warm page cache, results must match
+            auto reference = mesh::Obj::load(path);
+            auto parallel = mesh::Obj::load(path, &pool);
+            if(reference.indices() != parallel.indices() || reference.vertices().size() != parallel.vertices().size()) {
+                std::cerr << std::format("{}: results of single thread and pool differ", path.string()) << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            auto single_msec = measure_msec(iteration_count, [&]{ mesh::Obj::load(path); });
+            auto pool_msec = measure_msec(iteration_count, [&]{ mesh::Obj::load(path, &pool); });
+            auto single_speed = megabyte_count / (single_msec / 1000.0);
+            auto pool_speed = megabyte_count / (pool_msec / 1000.0);
+            std::cout << std::format("{:<40} {:>10.2f} {:>12} {:>16.1f} {:>16.1f} {:>8.2f}", path.filename().string(), megabyte_count, reference.indices().size() / 3, single_speed, pool_speed, pool_speed / single_speed) << std::endl;
+        }
+        catch(std::exception& e) {
+            std::cerr << std::format("{}: {}", path.string(), e.what()) << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+// PNG decode benchmark: image::PNG vs stb_image
+// usage: png_bench [-n iterations] files...
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "../src/image/PNG.hpp"
+#include "../src/image/stb_image.h"
+
+template<typename F>
+double measure_msec(uint32_t iteration_count, F&& f) {
+    auto begin = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < iteration_count; ++i) {
+        f();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - begin).count() / iteration_count;
+}
+
+int main(int argc, char** argv) {
+    uint32_t iteration_count = 10;
+    std::vector<std::filesystem::path> paths{};
+
+    for(int i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iteration_count = std::max(1, std::atoi(argv[++i]));
+        }
+        else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    if(paths.empty()) {
+        std::cerr << "usage: png_bench [-n iterations] files..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << std::format("{:<40} {:>12} {:>12} {:>12} {:>8}", "file", "size [MB]", "png [MB/s]", "stb [MB/s]", "ratio") << std::endl;
+
+    for(const auto& path : paths) {
+        size_t decoded_size{};
+        double png_msec{}, stb_msec{};
+        try {
+            png_msec = measure_msec(iteration_count, [&]{
+                auto png = image::PNG::load(path);
+                decoded_size = png.data().size();
+            });
+        }
+        catch(std::exception& e) {
+            std::cerr << std::format("{}: {}", path.string(), e.what()) << std::endl;
+            continue;
+        }
+
+        stb_msec = measure_msec(iteration_count, [&]{
+            int32_t width{}, height{}, component_count{};
+            auto data = stbi_load(path.string().c_str(), &width, &height, &component_count, 0);
+            stbi_image_free(data);
+        });
+
+        auto size_mb = static_cast<double>(decoded_size) / (1024.0 * 1024.0);
+        auto png_mbps = size_mb / (png_msec / 1000.0);
+        auto stb_mbps = size_mb / (stb_msec / 1000.0);
+        std::cout << std::format("{:<40} {:>12.3f} {:>12.1f} {:>12.1f} {:>8.2f}", path.filename().string(), size_mb, png_mbps, stb_mbps, png_mbps / stb_mbps) << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
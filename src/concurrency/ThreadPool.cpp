@@ -0,0 +1,119 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace concurrency {
+
+namespace {
+
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int32_t current_index = -1;
+
+}
+
+ThreadPool::ThreadPool(uint32_t thread_count) : queued_count_(0), next_queue_(0), stop_(false) {
+    if(thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    queues_.reserve(thread_count);
+    for(uint32_t i = 0; i < thread_count; ++i) {
+        queues_.emplace_back(std::make_unique<Queue>());
+    }
+
+    workers_.reserve(thread_count);
+    for(uint32_t i = 0; i < thread_count; ++i) {
+        workers_.emplace_back([this, i]{ run_(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+
+    for(auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::post(std::function<void()> task) {
+    // worker of this pool pushes to own queue (task is likely to use data in its cache)
+    uint32_t index{};
+    if(current_pool == this) {
+        index = static_cast<uint32_t>(current_index);
+    }
+    else {
+        index = next_queue_.fetch_add(1, std::memory_order_relaxed) % thread_count();
+    }
+
+    {
+        // count is updated under sleep mutex so that sleeping worker never misses it,
+        // and before task is published so that pop or steal never decrements it below 0
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        queued_count_.fetch_add(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.emplace_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::pop_(uint32_t index, std::function<void()>& task) {
+    auto& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued_count_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ThreadPool::steal_(uint32_t index, std::function<void()>& task) {
+    for(uint32_t i = 1; i < thread_count(); ++i) {
+        auto& queue = *queues_[(index + i) % thread_count()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.tasks.empty()) {
+            continue;
+        }
+
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        queued_count_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+void ThreadPool::run_(uint32_t index) {
+    current_pool = this;
+    current_index = static_cast<int32_t>(index);
+
+    while(true) {
+        std::function<void()> task{};
+        if(pop_(index, task) || steal_(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this]{ return stop_ || queued_count_.load(std::memory_order_acquire) > 0; });
+        // remaining tasks are run before exit
+        if(stop_ && queued_count_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+int32_t ThreadPool::worker_index() noexcept {
+    return current_index;
+}
+
+}
\ No newline at end of file
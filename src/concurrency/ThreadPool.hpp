@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace concurrency {
+
+// work-stealing thread pool
+// each worker has own deque: it pops newest task from back, idle workers steal oldest task from front of others
+// tasks submitted from outside the pool are distributed round robin
+class ThreadPool {
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    // queued (not yet started) tasks
+    std::atomic<size_t> queued_count_;
+    std::atomic<uint32_t> next_queue_;
+    bool stop_;
+
+    bool pop_(uint32_t index, std::function<void()>& task);
+    bool steal_(uint32_t index, std::function<void()>& task);
+    void run_(uint32_t index);
+
+public:
+    // thread_count = 0 -> number of hardware threads
+    explicit ThreadPool(uint32_t thread_count = 0);
+    // runs all queued tasks, then joins workers
+    ~ThreadPool() noexcept;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t thread_count() const noexcept { return static_cast<uint32_t>(queues_.size()); }
+
+    // fire and forget (task must not throw)
+    void post(std::function<void()> task);
+
+    // result (or exception) is returned through future
+    template<typename F>
+    auto submit(F&& function) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        // std::function needs copyable callable
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+        auto future = task->get_future();
+        post([task]{ (*task)(); });
+        return future;
+    }
+
+    // index of worker running current thread (-1 if current thread is not a worker of any pool)
+    static int32_t worker_index() noexcept;
+};
+
+// runs task(0) ... task(count - 1) on pool (or current thread without pool) and waits all of them
+// first exception is rethrown, do not call from task on the same pool
+template<typename F>
+void parallel_for(ThreadPool* pool, uint32_t count, F&& task) {
+    if(!pool || count <= 1) {
+        for(uint32_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+    std::vector<std::future<void>> futures{};
+    futures.reserve(count);
+    for(uint32_t i = 0; i < count; ++i) {
+        futures.push_back(pool->submit([&task, i]{ task(i); }));
+    }
+    // wait all before rethrowing (tasks refer to caller stack)
+    std::exception_ptr error{};
+    for(auto& future : futures) {
+        try {
+            future.get();
+        }
+        catch(...) {
+            if(!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if(error) {
+        std::rethrow_exception(error);
+    }
+}
+
+}
\ No newline at end of file
@@ -1,31 +1,30 @@
 #include "TrueType.hpp"
 
+#include "../io/MappedFile.hpp"
+
 namespace font {
 
 TrueType TrueType::load(const std::filesystem::path& path) {
     TrueType tt{};
 
-    std::ifstream ifs(path, std::ios::in | std::ios::binary);
-
-    if(ifs.fail()) {
-        throw std::runtime_error(std::format("[font::TrueType::load] ERROR: failed to read file: {}", path.string().c_str()));
-    }
+    io::MappedFile file(path);
+    io::ByteReader reader(file.bytes());
 
     uint32_t scaler_type{};
     uint16_t table_count{};
     uint16_t search_range{};
     uint16_t entry_selector{};
     uint16_t range_shift{};
-    read_be_(ifs, scaler_type);
-    read_be_(ifs, table_count);
-    read_be_(ifs, search_range);
-    read_be_(ifs, entry_selector);
-    read_be_(ifs, range_shift);
+    reader.read_be(scaler_type);
+    reader.read_be(table_count);
+    reader.read_be(search_range);
+    reader.read_be(entry_selector);
+    reader.read_be(range_shift);
 
     std::unordered_map<std::string, TableDirectory_> tables{};
 
     for(uint32_t i = 0; i < table_count; ++i) {
-        auto [tag, td] = read_table_directory_(ifs);
+        auto [tag, td] = read_table_directory_(reader);
         tables[tag] = td;
     }
 
@@ -48,36 +47,36 @@ TrueType TrueType::load(const std::filesystem::path& path) {
     // OS/2
     // prep
 
-    ifs.seekg(tables["head"].offset, std::ios::beg);
-    auto head = true_type::read_head(ifs);
+    reader.seek(tables["head"].offset);
+    auto head = true_type::read_head(reader);
     tt.head_ = head;
 
-    ifs.seekg(tables["maxp"].offset, std::ios::beg);
-    auto maxp = true_type::read_maxp(ifs);
+    reader.seek(tables["maxp"].offset);
+    auto maxp = true_type::read_maxp(reader);
     tt.maxp_ = maxp;
 
-    ifs.seekg(tables["loca"].offset, std::ios::beg);
+    reader.seek(tables["loca"].offset);
     true_type::Loca loca{};
     if(head.index_to_loc_format == 0) {
-        loca = std::move(true_type::read_loca_short(ifs, maxp.num_glyphs));
+        loca = std::move(true_type::read_loca_short(reader, maxp.num_glyphs));
     }
     else {
-        loca = std::move(true_type::read_loca_long(ifs, maxp.num_glyphs));
+        loca = std::move(true_type::read_loca_long(reader, maxp.num_glyphs));
     }
 
-    ifs.seekg(tables["cmap"].offset, std::ios::beg);
-    auto cmap = true_type::read_cmap(ifs);
+    reader.seek(tables["cmap"].offset);
+    auto cmap = true_type::read_cmap(reader);
 
-    ifs.seekg(tables["cmap"].offset + cmap.subtables[2].offset, std::ios::beg);
+    reader.seek(tables["cmap"].offset + cmap.subtables[2].offset);
     uint16_t format{};
-    read_be_(ifs, format);
-    auto cmap12 = true_type::cmap::read_format12(ifs);
+    reader.read_be(format);
+    auto cmap12 = true_type::cmap::read_format12(reader);
     tt.char_map_ = cmap12;
 
     std::vector<true_type::Glyf> glyphs(maxp.num_glyphs);
     for(size_t i = 0; i < glyphs.size(); ++i) {
-        ifs.seekg(tables["glyf"].offset + loca.offsets[i], std::ios::beg);
-        glyphs[i] = std::move(true_type::read_glyf(ifs));
+        reader.seek(tables["glyf"].offset + loca.offsets[i]);
+        glyphs[i] = std::move(true_type::read_glyf(reader));
     }
     tt.glyphs_ = glyphs;
 
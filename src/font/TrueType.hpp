@@ -17,70 +17,19 @@ class TrueType {
     using F2Dot14_ = int16_t;
     using LongDateTime_ = int64_t;
 
-
-    template<typename T>
-    static void read_be_(std::ifstream& ifs, T& dst) {
-        if constexpr (sizeof(T) == 1) {
-            uint8_t bytes{};
-            ifs.read(reinterpret_cast<char*>(&bytes), sizeof(T));
-            dst = std::bit_cast<T, uint8_t>(bytes);
-        }
-        else if constexpr(sizeof(T) == 2) {
-            uint16_t bytes{};
-            ifs.read(reinterpret_cast<char*>(&bytes), sizeof(T));
-
-            bytes = (((bytes >> 000) & 0xff) << 010) |
-                    (((bytes >> 010) & 0xff) << 000);
-
-            dst = std::bit_cast<T, uint16_t>(bytes);
-        }
-        else if constexpr(sizeof(T) == 4) {
-            uint32_t bytes{};
-            ifs.read(reinterpret_cast<char*>(&bytes), sizeof(T));
-
-            bytes = (((bytes >> 000) & 0xff) << 030) |
-                    (((bytes >> 010) & 0xff) << 020) |
-                    (((bytes >> 020) & 0xff) << 010) |
-                    (((bytes >> 030) & 0xff) << 000);
-
-            dst = std::bit_cast<T, uint32_t>(bytes);
-        }
-        else if constexpr(sizeof(T) == 8) {
-            uint64_t bytes{};
-            ifs.read(reinterpret_cast<char*>(&bytes), sizeof(T));
-
-            bytes = (((bytes >> 000) & 0xff) << 070) |
-                    (((bytes >> 010) & 0xff) << 060) |
-                    (((bytes >> 020) & 0xff) << 050) |
-                    (((bytes >> 030) & 0xff) << 040) |
-                    (((bytes >> 040) & 0xff) << 030) |
-                    (((bytes >> 050) & 0xff) << 020) |
-                    (((bytes >> 060) & 0xff) << 010) |
-                    (((bytes >> 070) & 0xff) << 000);
-
-            dst = std::bit_cast<T, uint64_t>(bytes);
-        }
-        else {
-            static_assert([]{ return false; }, "[font::TrueType::read_be_] ERROR: unexpeced byte size");
-        }
-    }
-
     struct TableDirectory_ {
         uint32_t check_sum;
         uint32_t offset;
         uint32_t length;
     };
 
-    static std::pair<std::string, TableDirectory_> read_table_directory_(std::ifstream& ifs) {
+    static std::pair<std::string, TableDirectory_> read_table_directory_(io::ByteReader& reader) {
         std::string tag(4, '\0');
         TableDirectory_ td{};
-        read_be_(ifs, tag[0]);
-        read_be_(ifs, tag[1]);
-        read_be_(ifs, tag[2]);
-        read_be_(ifs, tag[3]);
-        read_be_(ifs, td.check_sum);
-        read_be_(ifs, td.offset);
-        read_be_(ifs, td.length);
+        reader.copy_bytes(tag.data(), tag.size());
+        reader.read_be(td.check_sum);
+        reader.read_be(td.offset);
+        reader.read_be(td.length);
 
         return {tag, td};
     }
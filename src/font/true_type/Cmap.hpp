@@ -15,15 +15,15 @@ struct Cmap {
     std::vector<cmap::Subtable> subtables;
 };
 
-inline Cmap read_cmap(std::ifstream& ifs) {
+inline Cmap read_cmap(io::ByteReader& reader) {
     Cmap cm{};
 
-    read_be(ifs, cm.version);
+    reader.read_be(cm.version);
     uint16_t subtable_count{};
-    read_be(ifs, subtable_count);
+    reader.read_be(subtable_count);
     cm.subtables.resize(subtable_count);
     for(size_t i = 0; i < cm.subtables.size(); ++i) {
-        cm.subtables[i] = std::move(cmap::read_subtable(ifs));
+        cm.subtables[i] = std::move(cmap::read_subtable(reader));
     }
 
     return cm;
@@ -16,26 +16,22 @@ struct Glyf {
     std::vector<int16_t> y_coordinates;
 };
 
-inline Glyf read_glyf(std::ifstream& ifs) {
+inline Glyf read_glyf(io::ByteReader& reader) {
     Glyf glyf{};
 
-    read_be(ifs, glyf.num_contours);
-    read_be(ifs, glyf.x_min);
-    read_be(ifs, glyf.y_min);
-    read_be(ifs, glyf.x_max);
-    read_be(ifs, glyf.y_max);
+    reader.read_be(glyf.num_contours);
+    reader.read_be(glyf.x_min);
+    reader.read_be(glyf.y_min);
+    reader.read_be(glyf.x_max);
+    reader.read_be(glyf.y_max);
 
     glyf.end_pts_of_contours.resize(glyf.num_contours);
-    for(size_t i = 0; i < glyf.end_pts_of_contours.size(); ++i) {
-        read_be(ifs, glyf.end_pts_of_contours[i]);
-    }
+    reader.read_be(std::span(glyf.end_pts_of_contours));
 
     uint16_t instruction_length{};
-    read_be(ifs, instruction_length);
+    reader.read_be(instruction_length);
     glyf.instructions.resize(instruction_length);
-    for(size_t i = 0; i < glyf.instructions.size(); ++i) {
-        read_be(ifs, glyf.instructions[i]);
-    }
+    reader.copy_bytes(glyf.instructions.data(), glyf.instructions.size());
 
     glyf.flags.resize(glyf.end_pts_of_contours.back() + 1);
     glyf.x_coordinates.resize(glyf.end_pts_of_contours.back() + 1);
@@ -43,11 +39,11 @@ inline Glyf read_glyf(std::ifstream& ifs) {
 
     for(size_t i = 0; i < glyf.flags.size(); ++i) {
         uint8_t flag{};
-        read_be(ifs, flag);
+        reader.read_be(flag);
         glyf.flags[i] = flag;
         if(flag & 0x08) {
             uint8_t count{};
-            read_be(ifs, count);
+            reader.read_be(count);
             for(uint8_t c = 0; c < count; ++c) {
                 glyf.flags[++i] = flag;
             }
@@ -57,7 +53,7 @@ inline Glyf read_glyf(std::ifstream& ifs) {
     for(size_t i = 0; i < glyf.x_coordinates.size(); ++i) {
         if(glyf.flags[i] & 0x02) {
             uint8_t x{};
-            read_be(ifs, x);
+            reader.read_be(x);
             if(glyf.flags[i] & 0x10) { 
                 if(i == 0) {
                     glyf.x_coordinates[i] = static_cast<int16_t>(x);
@@ -86,7 +82,7 @@ inline Glyf read_glyf(std::ifstream& ifs) {
             }
             else {
                 int16_t x{};
-                read_be(ifs, x);
+                reader.read_be(x);
                 if(i == 0) {
                     glyf.x_coordinates[i] = x;
                 }
@@ -100,7 +96,7 @@ inline Glyf read_glyf(std::ifstream& ifs) {
     for(size_t i = 0; i < glyf.y_coordinates.size(); ++i) {
         if(glyf.flags[i] & 0x04) {
             uint8_t y{};
-            read_be(ifs, y);
+            reader.read_be(y);
             if(glyf.flags[i] & 0x20) { 
                 if(i == 0) {
                     glyf.y_coordinates[i] = static_cast<int16_t>(y);
@@ -129,7 +125,7 @@ inline Glyf read_glyf(std::ifstream& ifs) {
             }
             else {
                 int16_t y{};
-                read_be(ifs, y);
+                reader.read_be(y);
                 if(i == 0) {
                     glyf.y_coordinates[i] = y;
                 }
@@ -23,25 +23,25 @@ struct Head {
     int16_t glyph_data_format;
 };
 
-inline Head read_head(std::ifstream& ifs) {
+inline Head read_head(io::ByteReader& reader) {
     Head head{};
-    read_be(ifs, head.version);
-    read_be(ifs, head.font_revision);
-    read_be(ifs, head.check_sum_adjustment);
-    read_be(ifs, head.magic_number);
-    read_be(ifs, head.flags);
-    read_be(ifs, head.units_per_em);
-    read_be(ifs, head.created);
-    read_be(ifs, head.modified);
-    read_be(ifs, head.x_min);
-    read_be(ifs, head.y_min);
-    read_be(ifs, head.x_max);
-    read_be(ifs, head.y_max);
-    read_be(ifs, head.mac_style);
-    read_be(ifs, head.lowest_rect_ppem);
-    read_be(ifs, head.font_direction_hint);
-    read_be(ifs, head.index_to_loc_format);
-    read_be(ifs, head.glyph_data_format);
+    reader.read_be(head.version);
+    reader.read_be(head.font_revision);
+    reader.read_be(head.check_sum_adjustment);
+    reader.read_be(head.magic_number);
+    reader.read_be(head.flags);
+    reader.read_be(head.units_per_em);
+    reader.read_be(head.created);
+    reader.read_be(head.modified);
+    reader.read_be(head.x_min);
+    reader.read_be(head.y_min);
+    reader.read_be(head.x_max);
+    reader.read_be(head.y_max);
+    reader.read_be(head.mac_style);
+    reader.read_be(head.lowest_rect_ppem);
+    reader.read_be(head.font_direction_hint);
+    reader.read_be(head.index_to_loc_format);
+    reader.read_be(head.glyph_data_format);
 
     return head;
 }
@@ -10,28 +10,22 @@ struct Loca {
     std::vector<uint32_t> offsets;
 };
 
-inline Loca read_loca_short(std::ifstream& ifs, uint16_t num_glyphs) {
+inline Loca read_loca_short(io::ByteReader& reader, uint16_t num_glyphs) {
     Loca loca{};
     loca.offsets.resize(num_glyphs);
 
     for(size_t i = 0; i < loca.offsets.size(); ++i) {
-        uint16_t offset{};
-        read_be(ifs, offset);
-        loca.offsets[i] = offset;
+        loca.offsets[i] = reader.read_be<uint16_t>();
     }
 
     return loca;
 }
 
-inline Loca read_loca_long(std::ifstream& ifs, uint16_t num_glyphs) {
+inline Loca read_loca_long(io::ByteReader& reader, uint16_t num_glyphs) {
     Loca loca{};
     loca.offsets.resize(num_glyphs);
 
-    for(size_t i = 0; i < loca.offsets.size(); ++i) {
-        uint32_t offset{};
-        read_be(ifs, offset);
-        loca.offsets[i] = offset;
-    }
+    reader.read_be(std::span(loca.offsets));
 
     return loca;
 }
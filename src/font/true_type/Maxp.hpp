@@ -24,24 +24,24 @@ struct Maxp {
     uint16_t max_component_depth;
 };
 
-inline Maxp read_maxp(std::ifstream& ifs) {
+inline Maxp read_maxp(io::ByteReader& reader) {
     Maxp maxp{};
 
-    read_be(ifs, maxp.version);
-    read_be(ifs, maxp.num_glyphs);
-    read_be(ifs, maxp.max_points);
-    read_be(ifs, maxp.max_contours);
-    read_be(ifs, maxp.max_component_points);
-    read_be(ifs, maxp.max_component_contours);
-    read_be(ifs, maxp.max_zones);
-    read_be(ifs, maxp.max_twilight_points);
-    read_be(ifs, maxp.max_storages);
-    read_be(ifs, maxp.max_function_defs);
-    read_be(ifs, maxp.max_instruction_defs);
-    read_be(ifs, maxp.max_stack_elements);
-    read_be(ifs, maxp.max_size_of_instructions);
-    read_be(ifs, maxp.max_component_elements);
-    read_be(ifs, maxp.max_component_depth);
+    reader.read_be(maxp.version);
+    reader.read_be(maxp.num_glyphs);
+    reader.read_be(maxp.max_points);
+    reader.read_be(maxp.max_contours);
+    reader.read_be(maxp.max_component_points);
+    reader.read_be(maxp.max_component_contours);
+    reader.read_be(maxp.max_zones);
+    reader.read_be(maxp.max_twilight_points);
+    reader.read_be(maxp.max_storages);
+    reader.read_be(maxp.max_function_defs);
+    reader.read_be(maxp.max_instruction_defs);
+    reader.read_be(maxp.max_stack_elements);
+    reader.read_be(maxp.max_size_of_instructions);
+    reader.read_be(maxp.max_component_elements);
+    reader.read_be(maxp.max_component_depth);
 
     return maxp;
 }
@@ -26,18 +26,18 @@ struct Format12 {
     }
 };
 
-inline Format12 read_format12(std::ifstream& ifs) {
+inline Format12 read_format12(io::ByteReader& reader) {
     Format12 format{};
 
     format.format = 12;
-    read_be(ifs, format.reserved);
-    read_be(ifs, format.length);
-    read_be(ifs, format.language);
+    reader.read_be(format.reserved);
+    reader.read_be(format.length);
+    reader.read_be(format.language);
     uint32_t group_count{};
-    read_be(ifs, group_count);
+    reader.read_be(group_count);
     format.groups.resize(group_count);
     for(size_t i = 0; i < format.groups.size(); ++i) {
-        format.groups[i] = std::move(read_smg(ifs));
+        format.groups[i] = std::move(read_smg(reader));
     }
 
     return format;
@@ -14,12 +14,12 @@ struct SequentialMapGroup {
     uint32_t start_glyph_id;
 };
 
-inline SequentialMapGroup read_smg(std::ifstream& ifs) {
+inline SequentialMapGroup read_smg(io::ByteReader& reader) {
     SequentialMapGroup smg{};
 
-    read_be(ifs, smg.start_char_code);
-    read_be(ifs, smg.end_char_code);
-    read_be(ifs, smg.start_glyph_id);
+    reader.read_be(smg.start_char_code);
+    reader.read_be(smg.end_char_code);
+    reader.read_be(smg.start_glyph_id);
 
     return smg;
 }
@@ -14,12 +14,12 @@ struct Subtable {
     uint32_t offset;
 };
 
-inline Subtable read_subtable(std::ifstream& ifs) {
+inline Subtable read_subtable(io::ByteReader& reader) {
     Subtable subtable{};
 
-    read_be(ifs, subtable.platform_id);
-    read_be(ifs, subtable.platform_specific_id);
-    read_be(ifs, subtable.offset);
+    reader.read_be(subtable.platform_id);
+    reader.read_be(subtable.platform_specific_id);
+    reader.read_be(subtable.offset);
 
     return subtable;
 }
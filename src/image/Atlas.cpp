@@ -0,0 +1,195 @@
+#include "Atlas.hpp"
+#include "Mip.hpp"
+
+#include <cstring>
+
+namespace image {
+
+Atlas::Atlas(Format format, const atlas::Options& options) :
+    format_(format), options_(options), alignment_(1), packer_(options.width, options.height), data_{}, entries_{}, free_ids_{}, dirty_{}
+{
+    if(is_block_compressed(format)) {
+        throw std::runtime_error(std::format("[image::Atlas] ERROR: block compressed format is not supported (format = {}).", static_cast<uint32_t>(format)));
+    }
+    if(options.width == 0 || options.height == 0 || options.mip_count == 0 || options.mip_count > Mip::full_count(options.width, options.height)) {
+        throw std::runtime_error(std::format("[image::Atlas] ERROR: invalid options (size = {} x {}, mip count = {}).", options.width, options.height, options.mip_count));
+    }
+    alignment_ = 1u << (options.mip_count - 1);
+    data_.resize(row_pitch() * options.height);
+}
+
+void Atlas::mark_dirty_(const atlas::Rect& rect) noexcept {
+    if(!dirty_) {
+        dirty_ = rect;
+        return;
+    }
+    auto right = std::max(dirty_->x + dirty_->width, rect.x + rect.width);
+    auto bottom = std::max(dirty_->y + dirty_->height, rect.y + rect.height);
+    dirty_->x = std::min(dirty_->x, rect.x);
+    dirty_->y = std::min(dirty_->y, rect.y);
+    dirty_->width = right - dirty_->x;
+    dirty_->height = bottom - dirty_->y;
+}
+
+void Atlas::write_slot_(const atlas::Entry& entry, const uint8_t* src, size_t src_pitch) noexcept {
+    auto size = pixel_size(format_);
+    auto pitch = row_pitch();
+    const auto& rect = entry.rect;
+    const auto& slot = entry.slot;
+    auto left = rect.x - slot.x;
+    auto right = slot.x + slot.width - rect.x - rect.width;
+
+    for(uint32_t y = 0; y < slot.height; ++y) {
+        // rows above and below texture repeat its first and last row
+        auto src_y = std::clamp(static_cast<int64_t>(slot.y + y) - rect.y, int64_t(0), static_cast<int64_t>(rect.height) - 1);
+        const auto* src_row = src + src_y * src_pitch;
+        auto* dst_row = data_.data() + (slot.y + y) * pitch + size_t(slot.x) * size;
+
+        for(uint32_t x = 0; x < left; ++x) {
+            std::memcpy(dst_row + x * size, src_row, size);
+        }
+        std::memcpy(dst_row + size_t(left) * size, src_row, size_t(rect.width) * size);
+        const auto* last = src_row + size_t(rect.width - 1) * size;
+        for(uint32_t x = 0; x < right; ++x) {
+            std::memcpy(dst_row + size_t(left + rect.width + x) * size, last, size);
+        }
+    }
+    mark_dirty_(slot);
+}
+
+std::optional<uint32_t> Atlas::insert(std::span<const uint8_t> data, uint32_t width, uint32_t height, size_t row_pitch) {
+    auto info = ImageInfo::make(width, height, format_);
+    row_pitch = row_pitch == 0 ? info.row_pitch : row_pitch;
+    if(width == 0 || height == 0 || row_pitch < info.row_pitch || data.size() < info.size(row_pitch)) {
+        throw std::runtime_error(std::format("[image::Atlas] ERROR: invalid texture (size = {}, pitch = {}, texture = {} x {}).", data.size(), row_pitch, width, height));
+    }
+
+    auto align = [&](uint32_t value) { return (value + 2 * options_.padding + alignment_ - 1) / alignment_ * alignment_; };
+    auto slot = packer_.insert(align(width), align(height));
+    if(!slot) {
+        return std::nullopt;
+    }
+
+    // texture is centered in slot, so alignment remainder is shared by both gutters
+    atlas::Entry entry{{}, *slot, true};
+    entry.rect = atlas::Rect{slot->x + (slot->width - width) / 2, slot->y + (slot->height - height) / 2, width, height};
+
+    uint32_t id{};
+    if(free_ids_.empty()) {
+        id = static_cast<uint32_t>(entries_.size());
+        entries_.push_back(entry);
+    }
+    else {
+        id = free_ids_.back();
+        free_ids_.pop_back();
+        entries_[id] = entry;
+    }
+    write_slot_(entry, data.data(), row_pitch);
+
+    return id;
+}
+
+void Atlas::remove(uint32_t id) {
+    if(!contains(id)) {
+        throw std::runtime_error(std::format("[image::Atlas] ERROR: texture is not in atlas (id = {}).", id));
+    }
+    entries_[id].is_live = false;
+    packer_.release(entries_[id].slot);
+    free_ids_.push_back(id);
+}
+
+std::optional<std::vector<atlas::Move>> Atlas::defragment() {
+    std::vector<uint32_t> ids{};
+    for(uint32_t id = 0; id < entries_.size(); ++id) {
+        if(entries_[id].is_live) {
+            ids.push_back(id);
+        }
+    }
+    std::ranges::sort(ids, [&](uint32_t lhs, uint32_t rhs) {
+        const auto& a = entries_[lhs].slot;
+        const auto& b = entries_[rhs].slot;
+        return std::max(a.width, a.height) != std::max(b.width, b.height) ? std::max(a.width, a.height) > std::max(b.width, b.height) : a.area() > b.area();
+    });
+
+    atlas::MaxRects packer(options_.width, options_.height);
+    std::vector<atlas::Rect> slots(ids.size());
+    for(size_t i = 0; i < ids.size(); ++i) {
+        const auto& slot = entries_[ids[i]].slot;
+        auto placed = packer.insert(slot.width, slot.height);
+        if(!placed) {
+            return std::nullopt;
+        }
+        slots[i] = *placed;
+    }
+
+    // slots keep their pixels (gutters included), so they are copied to new buffer as blocks
+    std::vector<uint8_t> data(data_.size());
+    std::vector<atlas::Move> moves{};
+    auto size = pixel_size(format_);
+    auto pitch = row_pitch();
+    for(size_t i = 0; i < ids.size(); ++i) {
+        auto& entry = entries_[ids[i]];
+        const auto& to = slots[i];
+        for(uint32_t y = 0; y < to.height; ++y) {
+            std::memcpy(data.data() + (to.y + y) * pitch + size_t(to.x) * size, data_.data() + (entry.slot.y + y) * pitch + size_t(entry.slot.x) * size, size_t(to.width) * size);
+        }
+        if(to.x != entry.slot.x || to.y != entry.slot.y) {
+            atlas::Rect rect{to.x + entry.rect.x - entry.slot.x, to.y + entry.rect.y - entry.slot.y, entry.rect.width, entry.rect.height};
+            moves.push_back(atlas::Move{ids[i], entry.rect, rect});
+            entry.rect = rect;
+            entry.slot = to;
+        }
+    }
+    data_ = std::move(data);
+    packer_ = std::move(packer);
+    mark_dirty_(atlas::Rect{0, 0, options_.width, options_.height});
+
+    return moves;
+}
+
+const atlas::Entry& Atlas::entry(uint32_t id) const {
+    if(!contains(id)) {
+        throw std::runtime_error(std::format("[image::Atlas] ERROR: texture is not in atlas (id = {}).", id));
+    }
+    return entries_[id];
+}
+
+atlas::UVTransform Atlas::uv_transform(uint32_t id) const {
+    const auto& rect = entry(id).rect;
+    auto width = static_cast<float>(options_.width);
+    auto height = static_cast<float>(options_.height);
+    return atlas::UVTransform{rect.width / width, rect.height / height, rect.x / width, rect.y / height};
+}
+
+mip::Chain Atlas::generate_mips(mip::Options options, concurrency::ThreadPool* pool) const {
+    options.mip_count = options.mip_count == 0 ? options_.mip_count : options.mip_count;
+    options.row_pitch = 0;
+    // atlas does not tile, each texture has its own edges
+    options.wrap = false;
+    return Mip::generate(data_, options_.width, options_.height, format_, options, pool);
+}
+
+Atlas::Packed Atlas::build(std::span<const atlas::Source> sources, Format format, const atlas::Options& options) {
+    std::vector<uint32_t> order(sources.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order, [&](uint32_t lhs, uint32_t rhs) {
+        const auto& a = sources[lhs];
+        const auto& b = sources[rhs];
+        return std::max(a.width, a.height) != std::max(b.width, b.height) ? std::max(a.width, a.height) > std::max(b.width, b.height) : uint64_t(a.width) * a.height > uint64_t(b.width) * b.height;
+    });
+
+    Packed packed{Atlas(format, options), std::vector<uint32_t>(sources.size()), std::vector<atlas::UVTransform>(sources.size())};
+    for(auto index : order) {
+        const auto& source = sources[index];
+        auto id = packed.atlas.insert(source.data, source.width, source.height, source.row_pitch);
+        if(!id) {
+            throw std::runtime_error(std::format("[image::Atlas] ERROR: textures do not fit in atlas (texture = {}, size = {} x {}, atlas = {} x {}).", index, source.width, source.height, options.width, options.height));
+        }
+        packed.ids[index] = *id;
+        packed.uv_transforms[index] = packed.atlas.uv_transform(*id);
+    }
+
+    return packed;
+}
+
+}
\ No newline at end of file
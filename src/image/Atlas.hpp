@@ -0,0 +1,109 @@
+#pragma once
+
+#include <optional>
+#include <utility>
+
+#include "common.hpp"
+#include "atlas/Packer.hpp"
+#include "atlas/Remap.hpp"
+#include "mip/Generator.hpp"
+#include "../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+namespace atlas {
+
+struct Options {
+    uint32_t width = 2048;
+    uint32_t height = 2048;
+    // pixels of edge replicated around each texture (keeps bilinear and wider mip filters from sampling neighbours)
+    uint32_t padding = 2;
+    // mip levels the atlas is going to have, slots are aligned to 2^(mip_count - 1) pixels,
+    // so no texture shares a texel with another one down to the last level
+    uint32_t mip_count = 1;
+};
+
+struct Entry {
+    // texture pixels
+    Rect rect;
+    // rect with gutter and alignment (space taken in atlas)
+    Rect slot;
+    bool is_live;
+};
+
+struct Move {
+    uint32_t id;
+    Rect from;
+    Rect to;
+};
+
+struct Source {
+    std::span<const uint8_t> data;
+    uint32_t width;
+    uint32_t height;
+    // 0: tightly packed
+    size_t row_pitch = 0;
+};
+
+}
+
+// texture atlas of one uncompressed format, packed by MaxRects
+// textures are inserted and removed at runtime by id, defragment() repacks live textures when free space is fragmented
+// changed area is accumulated to dirty rect for partial upload
+class Atlas {
+    Format format_;
+    atlas::Options options_;
+    uint32_t alignment_;
+    atlas::MaxRects packer_;
+    std::vector<uint8_t> data_;
+    std::vector<atlas::Entry> entries_;
+    std::vector<uint32_t> free_ids_;
+    std::optional<atlas::Rect> dirty_;
+
+    void mark_dirty_(const atlas::Rect& rect) noexcept;
+    // writes texture to rect and replicates its edges over the rest of slot
+    void write_slot_(const atlas::Entry& entry, const uint8_t* src, size_t src_pitch) noexcept;
+
+public:
+    Atlas(Format format, const atlas::Options& options = {});
+
+    // returns id, or nullopt if texture does not fit (try defragment() or another atlas)
+    std::optional<uint32_t> insert(std::span<const uint8_t> data, uint32_t width, uint32_t height, size_t row_pitch = 0);
+    // frees slot of texture (pixels stay until slot is reused), id may be returned by later insert()
+    void remove(uint32_t id);
+    // repacks live textures from largest to smallest into new layout and moves their pixels
+    // returns moved textures (their uv transforms changed, empty if none moved),
+    // or nullopt if repacked layout would not fit all of them (atlas is left unchanged)
+    std::optional<std::vector<atlas::Move>> defragment();
+
+    bool contains(uint32_t id) const noexcept { return id < entries_.size() && entries_[id].is_live; }
+    const atlas::Entry& entry(uint32_t id) const;
+    atlas::UVTransform uv_transform(uint32_t id) const;
+
+    // area changed since last call (nullopt if nothing changed)
+    std::optional<atlas::Rect> take_dirty() noexcept { return std::exchange(dirty_, std::nullopt); }
+
+    // mip chain of whole atlas (mip_count of options is used unless options.mip_count is set)
+    mip::Chain generate_mips(mip::Options options = {}, concurrency::ThreadPool* pool = nullptr) const;
+
+    auto width() const noexcept { return options_.width; }
+    auto height() const noexcept { return options_.height; }
+    auto format() const noexcept { return format_; }
+    const auto& options() const noexcept { return options_; }
+    size_t row_pitch() const noexcept { return image::row_pitch(format_, options_.width); }
+    float occupancy() const noexcept { return packer_.occupancy(); }
+    std::span<const uint8_t> data() const noexcept { return data_; }
+
+    struct Packed;
+    // packs all sources (largest first, for better fit) to a single atlas, throws if they do not fit
+    // ids and uv transforms of result are in order of sources
+    static Packed build(std::span<const atlas::Source> sources, Format format, const atlas::Options& options = {});
+};
+
+struct Atlas::Packed {
+    Atlas atlas;
+    std::vector<uint32_t> ids;
+    std::vector<atlas::UVTransform> uv_transforms;
+};
+
+}
\ No newline at end of file
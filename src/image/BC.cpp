@@ -0,0 +1,48 @@
+#include "BC.hpp"
+#include "DDS.hpp"
+
+namespace image {
+
+void BC::decode(std::span<const uint8_t> blocks, uint32_t width, uint32_t height, Format format, std::span<uint8_t> dst, size_t row_pitch, concurrency::ThreadPool* pool) {
+    auto decoder = bc::Decoder::select(format);
+    auto info = ImageInfo::make(width, height, decoder.output_format);
+    info.check_destination(dst, row_pitch);
+
+    auto block_rows = image::row_count(format, height);
+    auto required = image::row_pitch(format, width) * block_rows;
+    if(blocks.size() < required) {
+        throw std::runtime_error(std::format("[image::BC] ERROR: blocks are too small (size = {}, required = {}).", blocks.size(), required));
+    }
+    if(width == 0 || height == 0) {
+        return;
+    }
+
+    auto task_count = pool ? std::min(block_rows, pool->thread_count() * 4) : 1;
+    concurrency::parallel_for(pool, task_count, [&](uint32_t task) {
+        auto first = static_cast<uint32_t>(uint64_t(block_rows) * task / task_count);
+        auto last = static_cast<uint32_t>(uint64_t(block_rows) * (task + 1) / task_count);
+        decoder.decode(blocks.data(), width, height, first, last, dst.data(), row_pitch);
+    });
+}
+
+std::vector<uint8_t> BC::decode(std::span<const uint8_t> blocks, uint32_t width, uint32_t height, Format format, concurrency::ThreadPool* pool) {
+    auto info = decoded_info(width, height, format);
+    std::vector<uint8_t> data(info.size());
+    decode(blocks, width, height, format, data, info.row_pitch, pool);
+
+    return data;
+}
+
+bc::EncodeResult BC::encode(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format source_format, Format format, const bc::EncodeOptions& options, concurrency::ThreadPool* pool) {
+    return bc::Encoder::encode(data, width, height, source_format, format, options, pool);
+}
+
+bc::Metrics BC::save(const std::filesystem::path& path, std::span<const uint8_t> data, uint32_t width, uint32_t height, Format source_format, Format format, const bc::EncodeOptions& options, concurrency::ThreadPool* pool) {
+    auto result = encode(data, width, height, source_format, format, options, pool);
+    auto layout = dds::Layout::make(format, width, height, 1, 1, 1, false, result.blocks.size());
+    DDS::save(path, layout, result.blocks, options.is_srgb);
+
+    return result.metrics;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common.hpp"
+#include "bc/Decoder.hpp"
+#include "bc/Encoder.hpp"
+#include "../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+// CPU decode of block compressed images (thumbnails, validation of baked textures, fallback for unsupported GPU formats)
+// BC1, BC2, BC3 and BC7 are decoded to RGBA8, BC4 to R8 and BC5 to RG8 (signed variants as two's complement SNORM)
+// and CPU encode of 8 bits images to the same formats (see bc::Encoder)
+// BC6H is not supported
+class BC {
+public:
+    // format written by decode()
+    static Format decoded_format(Format format) { return bc::Decoder::output_format_of(format); }
+    static ImageInfo decoded_info(uint32_t width, uint32_t height, Format format) { return ImageInfo::make(width, height, decoded_format(format)); }
+
+    // blocks: tightly packed rows of blocks (e.g. DDS::data())
+    // rows of blocks are split to tasks on pool if given
+    static void decode(std::span<const uint8_t> blocks, uint32_t width, uint32_t height, Format format, std::span<uint8_t> dst, size_t row_pitch, concurrency::ThreadPool* pool = nullptr);
+    static std::vector<uint8_t> decode(std::span<const uint8_t> blocks, uint32_t width, uint32_t height, Format format, concurrency::ThreadPool* pool = nullptr);
+
+    // data: source_format pixels (R8, RG8, RGB8, RGBA8 or BGRA8), rows of blocks are split to tasks on pool if given
+    static bc::EncodeResult encode(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format source_format, Format format, const bc::EncodeOptions& options = {}, concurrency::ThreadPool* pool = nullptr);
+    // encodes and writes DDS (one mip level), returns metrics of encoded blocks
+    static bc::Metrics save(const std::filesystem::path& path, std::span<const uint8_t> data, uint32_t width, uint32_t height, Format source_format, Format format, const bc::EncodeOptions& options = {}, concurrency::ThreadPool* pool = nullptr);
+};
+
+}
\ No newline at end of file
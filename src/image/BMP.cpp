@@ -1,33 +1,39 @@
 #include "BMP.hpp"
+#include "Convert.hpp"
 
 namespace image {
 
-BMP BMP::load(const std::filesystem::path& path) {
-    std::ifstream ifs(path, std::ios::in | std::ios::binary);
-    if(ifs.fail()) {
-        throw std::runtime_error(std::format("[image::BMP::load] ERROR: failed to open file: {}", path.string()));
+BMP::Reader::Reader(const std::filesystem::path& path, Format format) : file_(path) {
+    if(is_block_compressed(format)) {
+        throw std::runtime_error(std::format("[image::BMP::Reader] ERROR: unsupported output format: {}", static_cast<uint32_t>(format)));
     }
 
-    auto file_header = bmp::read_file_header(ifs);
-    std::cerr << std::format("type = {}, size = {}, offset = {}", file_header.type, file_header.size, file_header.offset) << std::endl;
+    io::ByteReader reader(file_.bytes());
 
-    auto info_header = bmp::read_info_header(ifs);
-    std::cerr << std::format("size = {}, width = {}, height = {}, bit count = {}, comp = {}, palette = {}", info_header.size, info_header.width, info_header.height, info_header.bit_count, info_header.compression, info_header.palette_count) << std::endl;
+    auto file_header = bmp::read_file_header(reader);
+    auto info_header = bmp::read_info_header(reader);
 
-    ifs.seekg(file_header.offset, std::ios::beg);
-    uint32_t pixel{};
-
-    std::vector<uint8_t> image_data(info_header.width * std::abs(info_header.height) * 4);
-    for(size_t i = 0; i < image_data.size(); i += 4) {
-        uint32_t pixel{};
-        ifs.read(reinterpret_cast<char*>(&pixel), sizeof(uint32_t));
-        image_data[i + 0] = static_cast<uint8_t>((pixel & 0x00ff0000) >> 16);
-        image_data[i + 1] = static_cast<uint8_t>((pixel & 0x0000ff00) >> 8);
-        image_data[i + 2] = static_cast<uint8_t>(pixel & 0x000000ff);
-        image_data[i + 3] = static_cast<uint8_t>((pixel & 0xff000000) >> 24);
+    if(info_header.bit_count != 32) {
+        throw std::runtime_error(std::format("[image::BMP::Reader] ERROR: unsupported bit count: {}", info_header.bit_count));
     }
 
-    return BMP(std::move(image_data), info_header.width, std::abs(info_header.height), 4);
+    info_ = ImageInfo::make(static_cast<uint32_t>(std::abs(info_header.width)), static_cast<uint32_t>(std::abs(info_header.height)), format);
+    reader.seek(file_header.offset);
+    pixels_ = reader.read_bytes(ImageInfo::make(info_.width, info_.height, Format::BGRA8).size());
+}
+
+void BMP::Reader::decode(std::span<uint8_t> dst, size_t row_pitch) const {
+    info_.check_destination(dst, row_pitch);
+
+    convert(Format::BGRA8, info_.format, pixels_, image::row_pitch(Format::BGRA8, info_.width), dst, row_pitch, info_.width, info_.height);
+}
+
+BMP BMP::load(const std::filesystem::path& path, Format format) {
+    Reader reader(path, format);
+    std::vector<uint8_t> image_data(reader.info().size());
+    reader.decode(image_data, reader.info().row_pitch);
+
+    return BMP(std::move(image_data), reader.info().width, reader.info().height, reader.info().format);
 }
 
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "common.hpp"
 #include "bmp/FileHeader.hpp"
 #include "bmp/InfoHeader.hpp"
+#include "../io/MappedFile.hpp"
 
 namespace image {
 
@@ -10,20 +11,37 @@ class BMP {
     uint32_t width_;
     uint32_t height_;
     uint32_t component_count_;
+    Format format_;
     std::vector<uint8_t> data_;
 
-    BMP(std::vector<uint8_t>&& data, uint32_t width, uint32_t height, uint32_t component_count) noexcept :
-        width_(width), height_(height), component_count_(component_count), data_(data) {}
+    BMP(std::vector<uint8_t>&& data, uint32_t width, uint32_t height, Format format) noexcept :
+        width_(width), height_(height), component_count_(image::component_count(format)), format_(format), data_(std::move(data)) {}
 
 public:
+    // two-phase decode into caller memory (see PNG::Reader)
+    // 32 bits BGRA pixels are converted to output format (RGBA8 by default, see convert())
+    class Reader {
+        io::MappedFile file_;
+        std::span<const uint8_t> pixels_;
+        ImageInfo info_;
+
+    public:
+        explicit Reader(const std::filesystem::path& path, Format format = Format::RGBA8);
+
+        const auto& info() const noexcept { return info_; }
+        void decode(std::span<uint8_t> dst, size_t row_pitch) const;
+    };
+
     BMP() noexcept = default;
     
-    static BMP load(const std::filesystem::path& path);
+    static BMP load(const std::filesystem::path& path, Format format = Format::RGBA8);
 
-    const auto& data() const noexcept { return data_; }
+    const auto& data() const & noexcept { return data_; }
+    auto data() && noexcept { return std::move(data_); }
     auto width() const noexcept { return width_; }
     auto height() const noexcept { return height_; }
     auto component_count() const noexcept { return component_count_; }
+    auto format() const noexcept { return format_; }
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include "BatchLoader.hpp"
+
+#include "../io/MappedFile.hpp"
+
+#include "PNG.hpp"
+#include "JPG.hpp"
+#include "BMP.hpp"
+#include "PPM.hpp"
+#include "DDS.hpp"
+#include "HDR.hpp"
+#include "Convert.hpp"
+#include "Resize.hpp"
+#include "stb_image.h"
+
+namespace image {
+
+FileType detect_file_type(std::span<const uint8_t> head) noexcept {
+    auto starts_with = [&](std::initializer_list<uint8_t> magic) {
+        return head.size() >= magic.size() && std::equal(magic.begin(), magic.end(), head.begin());
+    };
+
+    if(starts_with({0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a})) {
+        return FileType::PNG;
+    }
+    if(starts_with({0xff, 0xd8, 0xff})) {
+        return FileType::JPG;
+    }
+    if(starts_with({'B', 'M'})) {
+        return FileType::BMP;
+    }
+    // binary RGB only
+    if(starts_with({'P', '6'})) {
+        return FileType::PPM;
+    }
+    if(starts_with({'D', 'D', 'S', ' '})) {
+        return FileType::DDS;
+    }
+    if(hdr::is_hdr(head)) {
+        return FileType::HDR;
+    }
+
+    return FileType::UNKNOWN;
+}
+
+namespace {
+
+// decoded size from header without decoding pixels
+size_t estimate_size_(FileType type, std::span<const uint8_t> bytes) {
+    if(type == FileType::DDS) {
+        if(bytes.size() < 20) {
+            return 0;
+        }
+        uint32_t height{}, width{};
+        std::memcpy(&height, bytes.data() + 12, sizeof(uint32_t));
+        std::memcpy(&width, bytes.data() + 16, sizeof(uint32_t));
+        // upper bound (block compressed data is smaller)
+        return size_t(width) * height * 4;
+    }
+    if(type == FileType::HDR) {
+        auto header = hdr::read_header(bytes);
+        return size_t(header.width) * header.height * pixel_size(Format::RGBA16F);
+    }
+
+    int32_t width{}, height{}, component_count{};
+    if(!stbi_info_from_memory(bytes.data(), static_cast<int32_t>(bytes.size()), &width, &height, &component_count)) {
+        return 0;
+    }
+    // BMP, PPM and stb fallback are at most RGBA8, PNG keeps 16 bits samples
+    if(type == FileType::PNG) {
+        auto sample_size = stbi_is_16_bit_from_memory(bytes.data(), static_cast<int32_t>(bytes.size())) ? 2 : 1;
+        return size_t(width) * height * component_count * sample_size;
+    }
+    return size_t(width) * height * 4;
+}
+
+// formats without native decoder (progressive or CMYK JPEG) go through stb_image
+// (gray stays R8 or RG8 and color is RGBA8 as native decoders produce)
+void load_stb_(LoadedImage& image, std::span<const uint8_t> bytes) {
+    int32_t width{}, height{}, component_count{};
+    auto pixels = stbi_load_from_memory(bytes.data(), static_cast<int32_t>(bytes.size()), &width, &height, &component_count, 0);
+    if(!pixels) {
+        throw std::runtime_error(std::format("[image::BatchLoader] ERROR: failed to decode file: {} ({})", image.path.string(), stbi_failure_reason()));
+    }
+
+    constexpr Format FORMATS[] = {Format::R8, Format::RG8, Format::RGB8, Format::RGBA8};
+    auto source_format = FORMATS[component_count - 1];
+    image.width = static_cast<uint32_t>(width);
+    image.height = static_cast<uint32_t>(height);
+    image.format = component_count <= 2 ? source_format : Format::RGBA8;
+    auto pixel_count = size_t(width) * height;
+    image.data.resize(pixel_count * pixel_size(image.format));
+    convert(source_format, image.format, std::span<const uint8_t>(pixels, pixel_count * component_count), image.data);
+    stbi_image_free(pixels);
+}
+
+// decodes file of given type into image (path is set by caller) and applies size budget on current thread
+void decode_file_(LoadedImage& image, FileType type, const LoadOptions& options) {
+    switch(type) {
+        case FileType::PNG: {
+            auto png = PNG::load(image.path);
+            image.width = png.width();
+            image.height = png.height();
+            image.format = png.format();
+            image.data = std::move(png).data();
+            break;
+        }
+        case FileType::JPG: {
+            io::MappedFile file(image.path);
+            if(!JPG::is_supported(file.bytes())) {
+                load_stb_(image, file.bytes());
+                break;
+            }
+            auto jpg = JPG::load(std::move(file));
+            image.width = jpg.width();
+            image.height = jpg.height();
+            image.format = jpg.format();
+            image.data = std::move(jpg).data();
+            break;
+        }
+        case FileType::BMP: {
+            auto bmp = BMP::load(image.path);
+            image.width = bmp.width();
+            image.height = bmp.height();
+            image.format = bmp.format();
+            image.data = std::move(bmp).data();
+            break;
+        }
+        case FileType::PPM: {
+            // RGBA8 as other color decoders (GPUs rarely sample RGB8)
+            auto ppm = PPM::load(image.path, Format::RGBA8);
+            image.width = ppm.width();
+            image.height = ppm.height();
+            image.format = Format::RGBA8;
+            image.data = std::move(ppm).data();
+            break;
+        }
+        case FileType::HDR: {
+            // linear RGBA16F (half of RGBA32F memory and upload)
+            auto hdr = HDR::load(image.path, Format::RGBA16F);
+            image.width = hdr.width();
+            image.height = hdr.height();
+            image.format = Format::RGBA16F;
+            image.data = std::move(hdr).data();
+            break;
+        }
+        case FileType::DDS: {
+            // main image only (see DDS::Reader)
+            DDS::Reader reader(image.path);
+            image.width = reader.info().width;
+            image.height = reader.info().height;
+            image.format = reader.info().format;
+            image.data.resize(reader.info().size());
+            reader.decode(image.data, reader.info().row_pitch);
+            break;
+        }
+        default: {
+            io::MappedFile file(image.path);
+            load_stb_(image, file.bytes());
+            break;
+        }
+    }
+
+    if(!is_block_compressed(image.format)) {
+        // decoded rows are tightly packed
+        auto resize_options = options.resize;
+        resize_options.row_pitch = 0;
+        Resize::fit(image.data, image.width, image.height, image.format, options.max_dimension, resize_options);
+    }
+}
+
+}
+
+LoadedImage load_image(const std::filesystem::path& path, const LoadOptions& options) {
+    LoadedImage image{0, path, 0, 0, Format::RGBA8, {}, nullptr};
+    FileType type{};
+    {
+        io::MappedFile file(path);
+        type = detect_file_type(file.bytes());
+    }
+    decode_file_(image, type, options);
+
+    return image;
+}
+
+BatchLoader::BatchLoader(concurrency::ThreadPool& pool, size_t max_in_flight_bytes, const LoadOptions& options) noexcept :
+    pool_(pool), max_in_flight_bytes_(max_in_flight_bytes), options_(options), in_flight_bytes_(0), running_count_(0), remaining_count_(0), submitted_count_(0) {}
+
+BatchLoader::~BatchLoader() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_.clear();
+    parked_.clear();
+    completed_cv_.wait(lock, [this]{ return running_count_ == 0; });
+}
+
+size_t BatchLoader::submit(const std::filesystem::path& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto index = submitted_count_++;
+    pending_.emplace_back(Job{index, path, FileType::UNKNOWN, 0});
+    ++remaining_count_;
+    dispatch_();
+
+    return index;
+}
+
+void BatchLoader::submit(std::span<const std::filesystem::path> paths) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(const auto& path : paths) {
+        pending_.emplace_back(Job{submitted_count_++, path, FileType::UNKNOWN, 0});
+        ++remaining_count_;
+    }
+    dispatch_();
+}
+
+void BatchLoader::dispatch_() {
+    while(running_count_ < pool_.thread_count()) {
+        // probed jobs first (any one that fits in memory budget)
+        auto parked = std::find_if(parked_.begin(), parked_.end(), [this](const Job& job){ return fits_(job.estimated_size); });
+        if(parked != parked_.end()) {
+            auto job = std::move(*parked);
+            parked_.erase(parked);
+            in_flight_bytes_ += job.estimated_size;
+            ++running_count_;
+            pool_.post([this, job = std::move(job)]() mutable { decode_(std::move(job)); });
+        }
+        else if(!pending_.empty()) {
+            auto job = std::move(pending_.front());
+            pending_.pop_front();
+            ++running_count_;
+            pool_.post([this, job = std::move(job)]() mutable { probe_(std::move(job)); });
+        }
+        else {
+            break;
+        }
+    }
+}
+
+void BatchLoader::probe_(Job job) {
+    try {
+        io::MappedFile file(job.path);
+        job.type = detect_file_type(file.bytes());
+        job.estimated_size = estimate_size_(job.type, file.bytes());
+    }
+    catch(...) {
+        // error is reported by decode_()
+        job.estimated_size = 0;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(fits_(job.estimated_size)) {
+        in_flight_bytes_ += job.estimated_size;
+        lock.unlock();
+        decode_(std::move(job));
+    }
+    else {
+        parked_.emplace_back(std::move(job));
+        --running_count_;
+        dispatch_();
+        if(running_count_ == 0) {
+            completed_cv_.notify_all();
+        }
+    }
+}
+
+void BatchLoader::decode_(Job job) {
+    LoadedImage image{job.index, job.path, 0, 0, Format::RGBA8, {}, nullptr};
+
+    try {
+        decode_file_(image, job.type, options_);
+    }
+    catch(...) {
+        image.data = {};
+        image.error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // reservation becomes actual size
+    in_flight_bytes_ = in_flight_bytes_ - job.estimated_size + image.data.size();
+    completed_.emplace_back(std::move(image));
+    --running_count_;
+    dispatch_();
+    completed_cv_.notify_all();
+}
+
+std::optional<LoadedImage> BatchLoader::next() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(remaining_count_ == 0) {
+        return std::nullopt;
+    }
+
+    completed_cv_.wait(lock, [this]{ return !completed_.empty(); });
+    auto image = std::move(completed_.front());
+    completed_.pop_front();
+    --remaining_count_;
+    in_flight_bytes_ -= image.data.size();
+    dispatch_();
+
+    return image;
+}
+
+std::vector<LoadedImage> BatchLoader::load(concurrency::ThreadPool& pool, std::span<const std::filesystem::path> paths, size_t max_in_flight_bytes, const LoadOptions& options) {
+    BatchLoader loader(pool, max_in_flight_bytes, options);
+    loader.submit(paths);
+
+    std::vector<LoadedImage> images(paths.size());
+    loader.for_each([&](LoadedImage&& image) {
+        images[image.index] = std::move(image);
+    });
+
+    return images;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <span>
+
+#include "common.hpp"
+#include "resize/Resizer.hpp"
+#include "../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+enum class FileType {
+    PNG,
+    JPG,
+    BMP,
+    PPM,
+    DDS,
+    HDR,
+    UNKNOWN,
+};
+
+// detect file type from magic number (first bytes of file)
+FileType detect_file_type(std::span<const uint8_t> head) noexcept;
+
+// decoded image of any file type
+struct LoadedImage {
+    // position in order of submission
+    size_t index;
+    std::filesystem::path path;
+    uint32_t width;
+    uint32_t height;
+    Format format;
+    std::vector<uint8_t> data;
+    // set if loading failed (other members except index and path are empty)
+    std::exception_ptr error;
+};
+
+// applied to decoded images, so sizes can be capped per configuration without changing assets
+struct LoadOptions {
+    // 0: no limit, otherwise larger side is scaled down to it (aspect ratio kept, block compressed DDS stays as is)
+    uint32_t max_dimension = 0;
+    // filter, sRGB and wrap of downscaling (row_pitch is ignored)
+    resize::Options resize{};
+};
+
+// loads one image file of any type on current thread (throws on error, index is 0)
+LoadedImage load_image(const std::filesystem::path& path, const LoadOptions& options = {});
+
+// loads many image files concurrently on thread pool
+// results are returned in order of completion, decoded bytes held by loader are capped by max_in_flight_bytes
+// (memory is reserved from header size before decoding, and released when next() returns the image.
+//  image larger than the cap is decoded alone)
+class BatchLoader {
+    struct Job {
+        size_t index;
+        std::filesystem::path path;
+        FileType type;
+        size_t estimated_size;
+    };
+
+    concurrency::ThreadPool& pool_;
+    size_t max_in_flight_bytes_;
+    LoadOptions options_;
+
+    std::mutex mutex_;
+    std::condition_variable completed_cv_;
+    // not probed yet
+    std::deque<Job> pending_;
+    // probed, waiting for memory
+    std::deque<Job> parked_;
+    std::deque<LoadedImage> completed_;
+    size_t in_flight_bytes_;
+    // tasks on pool
+    size_t running_count_;
+    // submitted, but not returned by next() yet
+    size_t remaining_count_;
+    size_t submitted_count_;
+
+    bool fits_(size_t size) const noexcept {
+        return in_flight_bytes_ == 0 || in_flight_bytes_ + size <= max_in_flight_bytes_;
+    }
+
+    // start jobs while pool has idle workers (mutex_ must be locked)
+    void dispatch_();
+    void probe_(Job job);
+    void decode_(Job job);
+
+public:
+    // max_in_flight_bytes: decoded bytes loader may hold at once (before images are downscaled by options)
+    explicit BatchLoader(concurrency::ThreadPool& pool, size_t max_in_flight_bytes = size_t(1) << 30, const LoadOptions& options = {}) noexcept;
+    // waits for running tasks (not started files are dropped)
+    ~BatchLoader() noexcept;
+
+    BatchLoader(const BatchLoader&) = delete;
+    BatchLoader& operator=(const BatchLoader&) = delete;
+
+    // returns index of file
+    size_t submit(const std::filesystem::path& path);
+    void submit(std::span<const std::filesystem::path> paths);
+
+    // blocks until any image is finished
+    // returns std::nullopt if all submitted images are already returned
+    // (do not call from task on the same pool)
+    std::optional<LoadedImage> next();
+
+    // calls callback(LoadedImage&&) on current thread in order of completion until all submitted images are returned
+    template<typename F>
+    void for_each(F&& callback) {
+        while(auto image = next()) {
+            callback(std::move(*image));
+        }
+    }
+
+    // load all files, result is in order of paths
+    static std::vector<LoadedImage> load(concurrency::ThreadPool& pool, std::span<const std::filesystem::path> paths, size_t max_in_flight_bytes = size_t(1) << 30, const LoadOptions& options = {});
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "Convert.hpp"
+
+namespace image {
+
+void convert(Format src_format, Format dst_format, std::span<const uint8_t> src, std::span<uint8_t> dst, const pixel::Options& options) {
+    auto converter = pixel::Converter::select(src_format, dst_format, options);
+    auto count = src.size() / converter.src_pixel_size;
+    if(dst.size() < count * converter.dst_pixel_size) {
+        throw std::runtime_error(std::format("[image::convert] ERROR: destination is too small (size = {}, required = {}).", dst.size(), count * converter.dst_pixel_size));
+    }
+
+    converter.convert(src.data(), dst.data(), count);
+}
+
+void convert(Format src_format, Format dst_format, std::span<const uint8_t> src, size_t src_pitch, std::span<uint8_t> dst, size_t dst_pitch, uint32_t width, uint32_t height, const pixel::Options& options) {
+    auto converter = pixel::Converter::select(src_format, dst_format, options);
+    ImageInfo::make(width, height, dst_format).check_destination(dst, dst_pitch);
+    auto src_info = ImageInfo::make(width, height, src_format);
+    if(src_pitch < src_info.row_pitch || src.size() < src_info.size(src_pitch)) {
+        throw std::runtime_error(std::format("[image::convert] ERROR: source is too small (size = {}, pitch = {}, image = {} x {}).", src.size(), src_pitch, width, height));
+    }
+
+    if(src_pitch == src_info.row_pitch && dst_pitch == row_pitch(dst_format, width)) {
+        converter.convert(src.data(), dst.data(), size_t(width) * height);
+        return;
+    }
+    for(uint32_t y = 0; y < height; ++y) {
+        converter.convert(src.data() + y * src_pitch, dst.data() + y * dst_pitch, width);
+    }
+}
+
+}
\ No newline at end of file
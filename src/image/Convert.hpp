@@ -0,0 +1,14 @@
+#pragma once
+
+#include "common.hpp"
+#include "pixel/Converter.hpp"
+
+namespace image {
+
+// converts pixels of uncompressed format to another uncompressed format (pixel count is src.size() / pixel size)
+// channels are added or dropped as decoders produce them (gray, gray + alpha, RGB, RGBA, see pixel::Converter)
+void convert(Format src_format, Format dst_format, std::span<const uint8_t> src, std::span<uint8_t> dst, const pixel::Options& options = {});
+// image of rows with pitches
+void convert(Format src_format, Format dst_format, std::span<const uint8_t> src, size_t src_pitch, std::span<uint8_t> dst, size_t dst_pitch, uint32_t width, uint32_t height, const pixel::Options& options = {});
+
+}
\ No newline at end of file
@@ -2,63 +2,276 @@
 
 namespace image {
 
-DDS DDS::load(const std::filesystem::path& path) {
-    std::ifstream ifs(path, std::ios::in | std::ios::binary);
-    if(ifs.fail()) {
-        throw std::runtime_error(std::format("[image::DDS::load] ERROR: failed to open file: {}", path.string()));
-    } 
+Format DDS::legacy_format_(const dds::Header& header) {
+    constexpr uint32_t ALPHA_PIXELS = 0x00000001;
+    constexpr uint32_t ALPHA = 0x00000002;
+    constexpr uint32_t RGB = 0x00000040;
+    constexpr uint32_t LUMINANCE = 0x00020000;
 
-    auto header = dds::read_header(ifs);
-    auto mipmap_count = (header.flags & 0x00020000) ? std::max(header.mipmap_count, 1u) : 1;
+    auto masks_are = [&](uint32_t r, uint32_t g, uint32_t b) {
+        return header.r_bit_mask == r && header.g_bit_mask == g && header.b_bit_mask == b;
+    };
+    bool has_alpha = (header.pf_flags & ALPHA_PIXELS) && header.a_bit_mask != 0;
 
-    std::cerr << std::format("width = {}, height = {}, mipmap count = {}, four cc = {:x}", header.width, header.height, mipmap_count, header.four_cc) << std::endl;
+    if(header.pf_flags & RGB) {
+        switch(header.rgb_bit_count) {
+            case 32:
+                // X8B8G8R8 is read as RGBA8 (alpha is undefined)
+                if(masks_are(0x000000ff, 0x0000ff00, 0x00ff0000)) {
+                    return Format::RGBA8;
+                }
+                if(masks_are(0x00ff0000, 0x0000ff00, 0x000000ff)) {
+                    return Format::BGRA8;
+                }
+                if(masks_are(0x0000ffff, 0xffff0000, 0x00000000)) {
+                    return Format::RG16;
+                }
+                break;
+            case 24:
+                if(masks_are(0x000000ff, 0x0000ff00, 0x00ff0000)) {
+                    return Format::RGB8;
+                }
+                break;
+            case 16:
+                if(masks_are(0x000000ff, 0x0000ff00, 0x00000000)) {
+                    return Format::RG8;
+                }
+                break;
+        }
+    }
+    else if(header.pf_flags & LUMINANCE) {
+        if(header.rgb_bit_count == 8) {
+            return Format::R8;
+        }
+        if(header.rgb_bit_count == 16) {
+            // L8A8 or L16
+            return has_alpha ? Format::RG8 : Format::R16;
+        }
+    }
+    else if((header.pf_flags & ALPHA) && header.rgb_bit_count == 8) {
+        return Format::R8;
+    }
 
-    uint32_t block_size = 16;
-    uint32_t block_width = header.width;
-    uint32_t block_height = header.height;
+    throw std::runtime_error(std::format("[image::DDS] ERROR: unsupported pixel format (flags = {:x}, bit count = {}, masks = {:x} {:x} {:x} {:x})",
+        header.pf_flags, header.rgb_bit_count, header.r_bit_mask, header.g_bit_mask, header.b_bit_mask, header.a_bit_mask));
+}
+
+dds::Layout DDS::read_layout_(std::span<const uint8_t> bytes, size_t& payload_offset, bool& is_srgb) {
+    constexpr uint32_t MIPMAP_COUNT = 0x00020000;
+    constexpr uint32_t DEPTH = 0x00800000;
+    constexpr uint32_t FOURCC = 0x00000004;
+    constexpr uint32_t CUBEMAP = 0x00000200;
+    constexpr uint32_t CUBEMAP_FACES = 0x0000fc00;
+    constexpr uint32_t VOLUME = 0x00200000;
+    // D3D11_RESOURCE_DIMENSION_TEXTURE3D, D3D11_RESOURCE_MISC_TEXTURECUBE
+    constexpr uint32_t DX10_TEXTURE3D = 4;
+    constexpr uint32_t DX10_TEXTURECUBE = 0x4;
+
+    io::ByteReader reader(bytes);
 
-    if(header.pf_flags & 0x00000004) {
-        if(header.four_cc == make_four_cc_("DX10")) {
-            std::cerr << "DX10" << std::endl;
-            auto header_dx10 = dds::read_header_dx10(ifs);
+    auto header = dds::read_header(reader);
+    if(header.magic != make_four_cc_("DDS ")) {
+        throw std::runtime_error("[image::DDS] ERROR: not a DDS file.");
+    }
+    auto mip_count = (header.flags & MIPMAP_COUNT) ? std::max(header.mipmap_count, 1u) : 1;
+    auto depth = ((header.flags & DEPTH) && (header.caps2 & VOLUME)) ? std::max(header.depth, 1u) : 1;
+    uint32_t layer_count = 1;
+    bool is_cube = false;
+    is_srgb = false;
+
+    bool has_dx10 = (header.pf_flags & FOURCC) && header.four_cc == make_four_cc_("DX10");
+    Format format{};
+    if(header.pf_flags & FOURCC) {
+        if(has_dx10) {
+            auto header_dx10 = dds::read_header_dx10(reader);
+            format = dds::format_of_dxgi(header_dx10.format);
+            is_srgb = dds::is_srgb_dxgi_format(header_dx10.format);
+            layer_count = std::max(header_dx10.array_size, 1u);
+            if(header_dx10.dimension != DX10_TEXTURE3D) {
+                depth = 1;
+            }
+            if(header_dx10.misc_flag & DX10_TEXTURECUBE) {
+                is_cube = true;
+                layer_count *= 6;
+            }
         }
         else if(header.four_cc == make_four_cc_("DXT1")) {
-            std::cerr << "DXT1" << std::endl;
-            block_size = 8;
-        }
-        else if(header.four_cc == make_four_cc_("DXT2")) {
-            std::cerr << "DXT2" << std::endl;
+            format = Format::BC1;
         }
-        else if(header.four_cc == make_four_cc_("DXT3")) {
-            std::cerr << "DXT3" << std::endl;
-        } 
-        else if(header.four_cc == make_four_cc_("DXT4")) {
-            std::cerr << "DXT4" << std::endl;
+        else if(header.four_cc == make_four_cc_("DXT2") || header.four_cc == make_four_cc_("DXT3")) {
+            format = Format::BC2;
         }
-        else if(header.four_cc == make_four_cc_("DXT5")) {
-            std::cerr << "DXT5" << std::endl;
+        else if(header.four_cc == make_four_cc_("DXT4") || header.four_cc == make_four_cc_("DXT5")) {
+            format = Format::BC3;
         }
-        else if(header.four_cc == make_four_cc_("BC4U")) {
-            std::cerr << "BC4U" << std::endl;
+        else if(header.four_cc == make_four_cc_("BC4U") || header.four_cc == make_four_cc_("ATI1")) {
+            format = Format::BC4U;
         }
         else if(header.four_cc == make_four_cc_("BC4S")) {
-            std::cerr << "BC4S" << std::endl;
+            format = Format::BC4S;
         }
-        else if(header.four_cc == make_four_cc_("BC5U")) {
-            std::cerr << "BC5U" << std::endl;
+        else if(header.four_cc == make_four_cc_("BC5U") || header.four_cc == make_four_cc_("ATI2")) {
+            format = Format::BC5U;
         }
         else if(header.four_cc == make_four_cc_("BC5S")) {
-            std::cerr << "BC4S" << std::endl;
+            format = Format::BC5S;
+        }
+        // D3DFMT_A16B16G16R16
+        else if(header.four_cc == 36) {
+            format = Format::RGBA16;
+        }
+        // D3DFMT_R16F, D3DFMT_G16R16F, D3DFMT_A16B16G16R16F
+        else if(header.four_cc == 111) {
+            format = Format::R16F;
+        }
+        else if(header.four_cc == 112) {
+            format = Format::RG16F;
+        }
+        else if(header.four_cc == 113) {
+            format = Format::RGBA16F;
+        }
+        // D3DFMT_R32F, D3DFMT_G32R32F, D3DFMT_A32B32G32R32F
+        else if(header.four_cc == 114) {
+            format = Format::R32F;
+        }
+        else if(header.four_cc == 115) {
+            format = Format::RG32F;
+        }
+        else if(header.four_cc == 116) {
+            format = Format::RGBA32F;
         }
         else {
-            throw std::runtime_error(std::format("[image::DDS::load] ERROR: unknown FOURCC format: {:x}", header.four_cc));
+            throw std::runtime_error(std::format("[image::DDS::Reader] ERROR: unknown FOURCC format: {:x}", header.four_cc));
         }
     }
+    else {
+        format = legacy_format_(header);
+    }
+
+    // legacy cube map stores only faces which are flagged
+    if(!has_dx10 && (header.caps2 & CUBEMAP)) {
+        layer_count = static_cast<uint32_t>(std::popcount(header.caps2 & CUBEMAP_FACES));
+        is_cube = layer_count == 6;
+        depth = 1;
+    }
 
-    uint32_t main_image_size = std::max(1u, (block_width + 3) / 4) * std::max(1u, (block_height + 3) / 4) * block_size;
-    std::vector<uint8_t> image_data(main_image_size);
+    // payload follows headers
+    payload_offset = reader.position();
+    return dds::Layout::make(format, header.width, header.height, depth, mip_count, layer_count, is_cube, reader.remaining());
+}
+
+DDS::Reader::Reader(const std::filesystem::path& path) : file_(path) {
+    size_t payload_offset{};
+    bool is_srgb{};
+    layout_ = read_layout_(file_.bytes(), payload_offset, is_srgb);
 
-    return DDS(std::move(image_data), block_width, block_height);
+    info_ = ImageInfo::make(layout_.width, layout_.height, layout_.format);
+    const auto& top = layout_.subresource(0, 0);
+    pixels_ = file_.bytes().subspan(payload_offset + top.offset, top.slice_pitch());
+}
+
+void DDS::Reader::decode(std::span<uint8_t> dst, size_t row_pitch) const {
+    info_.check_destination(dst, row_pitch);
+
+    if(row_pitch == info_.row_pitch) {
+        std::memcpy(dst.data(), pixels_.data(), pixels_.size());
+        return;
+    }
+    for(uint32_t y = 0; y < info_.row_count(); ++y) {
+        std::memcpy(dst.data() + y * row_pitch, pixels_.data() + y * info_.row_pitch, info_.row_pitch);
+    }
+}
+
+DDS DDS::load(const std::filesystem::path& path) {
+    DDS dds;
+    dds.file_ = io::MappedFile(path);
+    dds.layout_ = read_layout_(dds.file_.bytes(), dds.payload_offset_, dds.is_srgb_);
+    return dds;
+}
+
+std::vector<uint8_t> DDS::encode(const dds::Layout& layout, std::span<const uint8_t> payload, bool is_srgb) {
+    constexpr uint32_t CAPS = 0x00000001;
+    constexpr uint32_t HEIGHT = 0x00000002;
+    constexpr uint32_t WIDTH = 0x00000004;
+    constexpr uint32_t PITCH = 0x00000008;
+    constexpr uint32_t PIXELFORMAT = 0x00001000;
+    constexpr uint32_t MIPMAP_COUNT = 0x00020000;
+    constexpr uint32_t LINEAR_SIZE = 0x00080000;
+    constexpr uint32_t DEPTH = 0x00800000;
+    constexpr uint32_t FOURCC = 0x00000004;
+    constexpr uint32_t CAPS_COMPLEX = 0x00000008;
+    constexpr uint32_t CAPS_MIPMAP = 0x00400000;
+    constexpr uint32_t CAPS_TEXTURE = 0x00001000;
+    constexpr uint32_t CUBEMAP_ALL_FACES = 0x0000fe00;
+    constexpr uint32_t VOLUME = 0x00200000;
+    // D3D11_RESOURCE_DIMENSION_TEXTURE2D, D3D11_RESOURCE_DIMENSION_TEXTURE3D, D3D11_RESOURCE_MISC_TEXTURECUBE
+    constexpr uint32_t DX10_TEXTURE2D = 3;
+    constexpr uint32_t DX10_TEXTURE3D = 4;
+    constexpr uint32_t DX10_TEXTURECUBE = 0x4;
+
+    if(payload.size() < layout.size) {
+        throw std::runtime_error(std::format("[image::DDS::encode] ERROR: payload is smaller than layout (size = {}, required = {}).", payload.size(), layout.size));
+    }
+    if(layout.is_cube && layout.layer_count % 6 != 0) {
+        throw std::runtime_error(std::format("[image::DDS::encode] ERROR: cube map needs 6 faces per layer (layers = {}).", layout.layer_count));
+    }
+
+    dds::Header header{};
+    header.magic = make_four_cc_("DDS ");
+    header.size = 124;
+    header.flags = CAPS | HEIGHT | WIDTH | PIXELFORMAT;
+    header.height = layout.height;
+    header.width = layout.width;
+    const auto& top = layout.subresource(0, 0);
+    if(is_block_compressed(layout.format)) {
+        header.flags |= LINEAR_SIZE;
+        header.pitch_or_linear_size = static_cast<uint32_t>(top.slice_pitch());
+    }
+    else {
+        header.flags |= PITCH;
+        header.pitch_or_linear_size = static_cast<uint32_t>(top.row_pitch);
+    }
+    header.depth = layout.depth;
+    header.mipmap_count = layout.mip_count;
+    header.flags |= (layout.mip_count > 1 ? MIPMAP_COUNT : 0) | (layout.depth > 1 ? DEPTH : 0);
+    header.pf_size = 32;
+    header.pf_flags = FOURCC;
+    header.four_cc = make_four_cc_("DX10");
+    header.caps = CAPS_TEXTURE;
+    if(layout.mip_count > 1) {
+        header.caps |= CAPS_COMPLEX | CAPS_MIPMAP;
+    }
+    if(layout.layer_count > 1 || layout.depth > 1) {
+        header.caps |= CAPS_COMPLEX;
+    }
+    header.caps2 = (layout.is_cube ? CUBEMAP_ALL_FACES : 0) | (layout.depth > 1 ? VOLUME : 0);
+
+    dds::HeaderDX10 header_dx10{};
+    header_dx10.format = dds::dxgi_format_of(layout.format, is_srgb);
+    header_dx10.dimension = layout.depth > 1 ? DX10_TEXTURE3D : DX10_TEXTURE2D;
+    header_dx10.misc_flag = layout.is_cube ? DX10_TEXTURECUBE : 0;
+    header_dx10.array_size = layout.is_cube ? layout.layer_count / 6 : layout.layer_count;
+
+    std::vector<uint8_t> bytes{};
+    bytes.reserve(148 + layout.size);
+    dds::write_header(bytes, header);
+    dds::write_header_dx10(bytes, header_dx10);
+    bytes.insert(bytes.end(), payload.begin(), payload.begin() + layout.size);
+
+    return bytes;
+}
+
+void DDS::save(const std::filesystem::path& path, const dds::Layout& layout, std::span<const uint8_t> payload, bool is_srgb) {
+    auto bytes = encode(layout, payload, is_srgb);
+
+    std::ofstream file(path, std::ios::binary);
+    if(!file) {
+        throw std::runtime_error(std::format("[image::DDS::save] ERROR: failed to open or create file: {}", path.string()));
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if(!file) {
+        throw std::runtime_error(std::format("[image::DDS::save] ERROR: failed to write file: {}", path.string()));
+    }
 }
 
 }
\ No newline at end of file
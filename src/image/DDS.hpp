@@ -3,32 +3,80 @@
 #include "common.hpp"
 #include "dds/Header.hpp"
 #include "dds/HeaderDX10.hpp"
+#include "dds/Format.hpp"
+#include "dds/Layout.hpp"
+#include "../io/MappedFile.hpp"
 
 namespace image {
 
+// DDS texture (BC1-BC7 or uncompressed, any number of mip levels, array layers, cube faces or depth slices)
+// blocks are not decoded, payload stays in memory-mapped file and is viewed per subresource
 class DDS {
-    uint32_t width_;
-    uint32_t height_;
-    uint32_t component_count_;
-    uint8_t compression_type_;
-    std::vector<uint8_t> data_;
+    io::MappedFile file_;
+    // position of payload in file
+    size_t payload_offset_;
+    dds::Layout layout_;
+    bool is_srgb_;
 
     static uint32_t make_four_cc_(const char* key) {
         return (key[3] << 24) | (key[2] << 16) | (key[1] << 8) | (key[0]);
     }
 
-    DDS(std::vector<uint8_t>&& data, uint32_t width, uint32_t height) noexcept :
-        width_(width), height_(height), data_(data) {}
+    // format of header without FOURCC (bit masks)
+    static Format legacy_format_(const dds::Header& header);
+
+    // parses headers, returns layout and position of payload
+    static dds::Layout read_layout_(std::span<const uint8_t> bytes, size_t& payload_offset, bool& is_srgb);
 
 public:
-    DDS() noexcept = default;
+    // two-phase decode into caller memory (see PNG::Reader)
+    // main image (top mip level of first array layer) is copied as stored (blocks are not decoded)
+    class Reader {
+        io::MappedFile file_;
+        std::span<const uint8_t> pixels_;
+        dds::Layout layout_;
+        ImageInfo info_;
+
+    public:
+        explicit Reader(const std::filesystem::path& path);
+
+        const auto& info() const noexcept { return info_; }
+        const auto& layout() const noexcept { return layout_; }
+        void decode(std::span<uint8_t> dst, size_t row_pitch) const;
+    };
+
+    // DDS file with DX10 header of payload (subresources as described by layout)
+    static std::vector<uint8_t> encode(const dds::Layout& layout, std::span<const uint8_t> payload, bool is_srgb = false);
+    static void save(const std::filesystem::path& path, const dds::Layout& layout, std::span<const uint8_t> payload, bool is_srgb = false);
 
+    DDS() noexcept : payload_offset_(0), layout_{}, is_srgb_(false) {}
+
+    // maps file, nothing is copied
     static DDS load(const std::filesystem::path& path);
 
-    auto width() const noexcept { return width_; }
-    auto height() const noexcept { return height_; }
+    auto width() const noexcept { return layout_.width; }
+    auto height() const noexcept { return layout_.height; }
+    auto depth() const noexcept { return layout_.depth; }
+    auto format() const noexcept { return layout_.format; }
+    auto mip_count() const noexcept { return layout_.mip_count; }
+    auto layer_count() const noexcept { return layout_.layer_count; }
+    auto is_cube() const noexcept { return layout_.is_cube; }
+    // DXGI *_SRGB format (legacy headers have no color space)
+    auto is_srgb() const noexcept { return is_srgb_; }
+    auto block_dimension() const noexcept { return image::block_dimension(layout_.format); }
+    bool is_mapped() const noexcept { return file_.is_mapped(); }
+
+    const auto& layout() const noexcept { return layout_; }
+    const auto& subresources() const noexcept { return layout_.subresources; }
+    const auto& subresource(uint32_t mip, uint32_t layer = 0) const { return layout_.subresource(mip, layer); }
 
-    const auto& data() const noexcept { return data_; }
+    // all subresources as stored (offsets of subresources are relative to this)
+    std::span<const uint8_t> payload() const noexcept { return file_.bytes().subspan(payload_offset_, layout_.size); }
+
+    std::span<const uint8_t> data(uint32_t mip = 0, uint32_t layer = 0) const {
+        const auto& subresource = layout_.subresource(mip, layer);
+        return payload().subspan(subresource.offset, subresource.size);
+    }
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "HDR.hpp"
+#include "Convert.hpp"
+#include "hdr/Rgbe.hpp"
+#include "hdr/Scanline.hpp"
+
+namespace image {
+
+HDR::Reader::Reader(const std::filesystem::path& path, Format format) : file_(path) {
+    if(is_block_compressed(format)) {
+        throw std::runtime_error(std::format("[image::HDR::Reader] ERROR: unsupported output format: {}", static_cast<uint32_t>(format)));
+    }
+
+    header_ = hdr::read_header(file_.bytes());
+    info_ = ImageInfo::make(header_.width, header_.height, format);
+}
+
+void HDR::Reader::decode(std::span<uint8_t> dst, size_t row_pitch) const {
+    info_.check_destination(dst, row_pitch);
+
+    auto width = info_.width;
+    auto kernel = hdr::select_rgbe_kernel(info_.format);
+    std::vector<uint8_t> rgbe(size_t(width) * 4);
+    // other formats are converted from floats of each row
+    std::vector<uint8_t> floats(kernel ? 0 : size_t(width) * 16);
+
+    auto bytes = file_.bytes().subspan(header_.data_offset);
+    for(uint32_t y = 0; y < info_.height; ++y) {
+        bytes = bytes.subspan(hdr::decode_scanline(bytes, rgbe.data(), width));
+        auto* row = dst.data() + (header_.is_bottom_up ? info_.height - 1 - y : y) * row_pitch;
+        if(kernel) {
+            kernel(rgbe.data(), row, width);
+        }
+        else {
+            hdr::select_rgbe_kernel(Format::RGBA32F)(rgbe.data(), floats.data(), width);
+            convert(Format::RGBA32F, info_.format, floats, std::span<uint8_t>(row, info_.row_pitch));
+        }
+    }
+}
+
+HDR HDR::load(const std::filesystem::path& path, Format format) {
+    Reader reader(path, format);
+    std::vector<uint8_t> image_data(reader.info().size());
+    reader.decode(image_data, reader.info().row_pitch);
+
+    return HDR(std::move(image_data), reader.info().width, reader.info().height, format);
+}
+
+}
\ No newline at end of file
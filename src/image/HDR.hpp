@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common.hpp"
+#include "hdr/Header.hpp"
+#include "../io/MappedFile.hpp"
+
+namespace image {
+
+// Radiance RGBE (.hdr) pictures, e.g. environment maps and light probes
+class HDR {
+    uint32_t width_;
+    uint32_t height_;
+    Format format_;
+    std::vector<uint8_t> data_;
+
+    HDR(std::vector<uint8_t>&& data, uint32_t width, uint32_t height, Format format) noexcept :
+        width_(width), height_(height), format_(format), data_(std::move(data)) {}
+
+public:
+    // two-phase decode into caller memory (see PNG::Reader)
+    // scanlines are RLE decoded and converted to linear RGBA16F or RGBA32F (alpha 1) in one pass,
+    // other uncompressed formats are converted from RGBA32F (see convert(), 8 and 16 bits outputs are clamped)
+    class Reader {
+        io::MappedFile file_;
+        hdr::Header header_;
+        ImageInfo info_;
+
+    public:
+        explicit Reader(const std::filesystem::path& path, Format format = Format::RGBA16F);
+
+        const auto& info() const noexcept { return info_; }
+        void decode(std::span<uint8_t> dst, size_t row_pitch) const;
+    };
+
+    HDR() noexcept = default;
+
+    // RGBA16F halves memory and upload size of RGBA32F (range up to 65504 is enough for most environment maps)
+    static HDR load(const std::filesystem::path& path, Format format = Format::RGBA16F);
+
+    const auto& data() const & noexcept { return data_; }
+    auto data() && noexcept { return std::move(data_); }
+    auto width() const noexcept { return width_; }
+    auto height() const noexcept { return height_; }
+    auto format() const noexcept { return format_; }
+};
+
+}
\ No newline at end of file
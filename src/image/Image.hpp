@@ -7,8 +7,12 @@
 
 #include <glm/glm.hpp>
 
+#include "common.hpp"
+#include "PNG.hpp"
+#include "Convert.hpp"
+#include "../io/MappedFile.hpp"
+
 #include "stb_image.h"
-#include "stb_image_write.h"
 
 namespace image {
 
@@ -17,6 +21,49 @@ class Image {
     uint32_t width_, height_;
 
 public:
+    // two-phase decode into caller memory (see PNG::Reader)
+    // any format supported by stb_image is converted to output format (RGBA8 by default, see convert())
+    // (stb_image decodes file channels into its own buffer, so rows are converted once)
+    class Reader {
+        io::MappedFile file_;
+        ImageInfo info_;
+
+    public:
+        explicit Reader(const std::filesystem::path& path, Format format = Format::RGBA8) : file_(path) {
+            if(is_block_compressed(format)) {
+                throw std::runtime_error(std::format("[image::Image::Reader] ERROR: unsupported output format: {}", static_cast<uint32_t>(format)));
+            }
+            int32_t width{}, height{}, component_count{};
+            if(!stbi_info_from_memory(file_.data(), static_cast<int32_t>(file_.size()), &width, &height, &component_count)) {
+                throw std::runtime_error(std::format("[image::Image::Reader] ERROR: failed to read file: {} ({})", path.string(), stbi_failure_reason()));
+            }
+            info_ = ImageInfo::make(static_cast<uint32_t>(width), static_cast<uint32_t>(height), format);
+        }
+
+        const auto& info() const noexcept { return info_; }
+
+        void decode(std::span<uint8_t> dst, size_t row_pitch) const {
+            info_.check_destination(dst, row_pitch);
+
+            int32_t width{}, height{}, component_count{};
+            auto pixels = stbi_load_from_memory(file_.data(), static_cast<int32_t>(file_.size()), &width, &height, &component_count, 0);
+            if(!pixels) {
+                throw std::runtime_error(std::format("[image::Image::Reader] ERROR: failed to decode image ({})", stbi_failure_reason()));
+            }
+            constexpr Format FORMATS[] = {Format::R8, Format::RG8, Format::RGB8, Format::RGBA8};
+            auto format = FORMATS[component_count - 1];
+            auto pitch = image::row_pitch(format, info_.width);
+            try {
+                convert(format, info_.format, std::span<const uint8_t>(pixels, pitch * info_.height), pitch, dst, row_pitch, info_.width, info_.height);
+            }
+            catch(...) {
+                stbi_image_free(pixels);
+                throw;
+            }
+            stbi_image_free(pixels);
+        }
+    };
+
     Image(uint8_t* data, uint32_t width, uint32_t height) noexcept : data_(data), width_(width), height_(height) {}
     ~Image() noexcept {
         stbi_image_free(data_);
@@ -40,8 +87,9 @@ public:
         return Image(data, width, height);
     }
 
+    // RGBA8 (see PNG::save for other formats and options)
     static void save_png(const std::filesystem::path& dst_path, const uint8_t* data, uint32_t width, uint32_t height) {
-        stbi_write_png(dst_path.string().c_str(), static_cast<int32_t>(width), static_cast<int32_t>(height), STBI_rgb_alpha, reinterpret_cast<const void*>(data), 0);
+        PNG::save(dst_path, std::span<const uint8_t>(data, size_t(width) * height * 4), width, height, Format::RGBA8);
     }
 };
 
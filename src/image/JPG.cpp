@@ -2,107 +2,79 @@
 
 namespace image {
 
-JPG JPG::load(const std::filesystem::path& path) {
-    std::ifstream ifs(path, std::ios::in | std::ios::binary);
-    if(ifs.fail()) {
-        throw std::runtime_error(std::format("[image::JPG::load] ERROR: failed to open file: {}", path.string()));
-    }
+JPG::Reader::Reader(const std::filesystem::path& path) : decoder_(path), upsampling_(jpg::Upsampling::Interpolate) {
+    auto format = decoder_.components().size() == 1 ? Format::R8 : Format::RGBA8;
+    info_ = ImageInfo::make(decoder_.width(), decoder_.height(), format);
+}
 
-    std::array<uint8_t, 2> marker{};
-    jpg::read_be(ifs, marker[0]);
-    jpg::read_be(ifs, marker[1]);
+JPG::Reader::Reader(io::MappedFile&& file) : decoder_(std::move(file)), upsampling_(jpg::Upsampling::Interpolate) {
+    auto format = decoder_.components().size() == 1 ? Format::R8 : Format::RGBA8;
+    info_ = ImageInfo::make(decoder_.width(), decoder_.height(), format);
+}
 
-    // SOI
-    if(!(marker[0] == 0xff && marker[1] == 0xd8)) {
-        throw std::runtime_error(std::format("[image::JPG::load] ERROR: invalid format image: {}", path.string()));
+JPG::Reader::Reader(const std::filesystem::path& path, Format format, uint32_t scale, jpg::Upsampling upsampling) : decoder_(path, scale), upsampling_(upsampling) {
+    if(format != Format::R8 && format != Format::RGB8 && format != Format::RGBA8) {
+        throw std::runtime_error(std::format("[image::JPG::Reader] ERROR: unsupported output format: {}", static_cast<uint32_t>(format)));
     }
+    info_ = ImageInfo::make(decoder_.width(), decoder_.height(), format);
+}
 
-    std::vector<jpg::DQT> dqts{};
-    std::vector<jpg::DHT> dhts{};
-    jpg::SOF0 sof0{};
-    jpg::SOS sos{};
-
-    // read segments
-    while(true) {
-        jpg::read_be(ifs, marker[0]);
-        jpg::read_be(ifs, marker[1]);
-        std::cerr << std::format("marker {:02x}{:02x}", marker[0], marker[1]) << std::endl;
-        // DQT
-        if(marker[0] == 0xff && marker[1] == 0xdb) {
-            dqts.emplace_back(std::move(jpg::read_dqt(ifs)));
-        }
-        // SOF0
-        else if(marker[0] == 0xff && marker[1] == 0xc0) {
-            sof0 = std::move(jpg::read_sof0(ifs));
-        }
-        // DHT
-        else if(marker[0] == 0xff && marker[1] == 0xc4) {
-            dhts.emplace_back(std::move(jpg::read_dht(ifs)));
-        }
-        // SOS (last segment)
-        else if(marker[0] == 0xff && marker[1] == 0xda) {
-            sos = std::move(jpg::read_sos(ifs));
-            break;
-        }
-        // other segments
-        else if(marker[0] == 0xff) {
-            uint16_t length{};
-            jpg::read_be(ifs, length);
-            ifs.seekg(length - 2, std::ios::cur);
-        }
-        // invalid
-        else {
-            throw std::runtime_error(std::format("[image::JPG::load] ERROR: invalid segment"));
-        }
-    }
+void JPG::Reader::decode(std::span<uint8_t> dst, size_t row_pitch, concurrency::ThreadPool* pool) {
+    info_.check_destination(dst, row_pitch);
 
-    for(size_t i = 0; i < dhts.size(); ++i) {
-        std::cerr << std::format("DHT segment #{}", i) << std::endl;
-        for(size_t j = 0; j < dhts[i].hts.size(); ++j) {
-            std::cerr << std::format("huffman table #{}", j) << std::endl;
-            for(size_t k = 0; k < dhts[i].hts[j].li.size(); ++k) {
-                std::cerr << std::format("length {}: count = {}", k + 1, dhts[i].hts[j].li[k]) << std::endl;
-            }
-            for(size_t k = 0; k < dhts[i].hts[j].vi_j.size(); ++k) {
-                std::cerr << std::format("value #{}: {:02x}", k, dhts[i].hts[j].vi_j[k]) << std::endl;
-            }
-        }
-    }
+    jpg::PixelWriter writer(decoder_, dst, row_pitch, info_.format, upsampling_);
+    decoder_.decode(writer, pool, writer.needs_context());
+}
 
-    jpg::BitStream ecs{};
-    while(true) {
-        uint8_t code{};
-        ifs.read(reinterpret_cast<char*>(&code), sizeof(uint8_t));
-
-        if(code == 0xff) {
-            uint8_t marker{};
-            ifs.read(reinterpret_cast<char*>(&marker), sizeof(uint8_t));
-
-            // EOI
-            if(marker == 0xd9) {
-                break;
-            }
-            // value
-            else if(marker == 0x00) {
-                ecs.data.push_back(code);
-            }
-            // RST
-            else if(0xd0 <= marker && marker <= 0xd7) {
-                continue;
-            }
-            // invalid
-            else {
-                throw std::runtime_error(std::format("[image::JPG::load] ERROR: invalid code: {:x}{:x}", code, marker));
-            }
-        }
-        else {
-            ecs.data.push_back(code);
-        }
+JPG::Reader::PlanarInfo JPG::Reader::planar_info() const {
+    if(!is_planar_supported()) {
+        throw std::runtime_error("[image::JPG::Reader] ERROR: image can not be decoded to planes (not YCbCr or unsupported sampling).");
+    }
+    if(decoder_.components().size() == 1) {
+        return PlanarInfo{ImageInfo::make(decoder_.width(), decoder_.height(), Format::R8), ImageInfo::make(0, 0, Format::RG8)};
     }
+    const auto& cb = decoder_.components()[1];
+    return PlanarInfo{ImageInfo::make(decoder_.width(), decoder_.height(), Format::R8), ImageInfo::make(cb.output_width, cb.output_height, Format::RG8)};
+}
+
+void JPG::Reader::decode_planar(std::span<uint8_t> luma, size_t luma_pitch, std::span<uint8_t> chroma, size_t chroma_pitch, concurrency::ThreadPool* pool) {
+    auto info = planar_info();
+    info.luma.check_destination(luma, luma_pitch);
+    info.chroma.check_destination(chroma, chroma_pitch);
+
+    decoder_.decode(jpg::PlanarWriter(decoder_, luma, luma_pitch, chroma, chroma_pitch), pool);
+}
+
+JPG JPG::load(const std::filesystem::path& path, concurrency::ThreadPool* pool) {
+    Reader reader(path);
+    std::vector<uint8_t> data(reader.info().size());
+    reader.decode(data, reader.info().row_pitch, pool);
+
+    return JPG(std::move(data), reader.info().width, reader.info().height, reader.info().format);
+}
+
+JPG JPG::load(io::MappedFile&& file, concurrency::ThreadPool* pool) {
+    Reader reader(std::move(file));
+    std::vector<uint8_t> data(reader.info().size());
+    reader.decode(data, reader.info().row_pitch, pool);
+
+    return JPG(std::move(data), reader.info().width, reader.info().height, reader.info().format);
+}
+
+JPG JPG::load(const std::filesystem::path& path, Format format, concurrency::ThreadPool* pool) {
+    Reader reader(path, format);
+    std::vector<uint8_t> data(reader.info().size());
+    reader.decode(data, reader.info().row_pitch, pool);
+
+    return JPG(std::move(data), reader.info().width, reader.info().height, reader.info().format);
+}
 
-    std::cerr << std::format("{}", ecs.size()) << std::endl;
+JPG JPG::load_scaled(const std::filesystem::path& path, Format format, uint32_t scale, concurrency::ThreadPool* pool) {
+    Reader reader(path, format, scale);
+    std::vector<uint8_t> data(reader.info().size());
+    reader.decode(data, reader.info().row_pitch, pool);
 
-    return {};
+    return JPG(std::move(data), reader.info().width, reader.info().height, reader.info().format);
 }
 
 }
\ No newline at end of file
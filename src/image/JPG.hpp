@@ -1,17 +1,75 @@
 #pragma once
 
 #include "common.hpp"
-#include "jpg/utils.hpp"
-#include "jpg/DHT.hpp"
-#include "jpg/DQT.hpp"
-#include "jpg/SOF0.hpp"
-#include "jpg/SOS.hpp"
+#include "jpg/Decoder.hpp"
+#include "jpg/Color.hpp"
 
 namespace image {
 
 class JPG {
+    uint32_t width_;
+    uint32_t height_;
+    uint32_t component_count_;
+    Format format_;
+    std::vector<uint8_t> data_;
+
+    JPG(std::vector<uint8_t>&& data, uint32_t width, uint32_t height, Format format) noexcept :
+        width_(width), height_(height), component_count_(image::component_count(format)), format_(format), data_(std::move(data)) {}
+
 public:
-    static JPG load(const std::filesystem::path& path);
+    // two-phase decode into caller memory (see PNG::Reader)
+    // constructor reads headers up to first scan, decode() decodes all scans and converts to output format
+    class Reader {
+        jpg::Decoder decoder_;
+        ImageInfo info_;
+        jpg::Upsampling upsampling_;
+
+    public:
+        // Y plane (R8) and interleaved CbCr plane (RG8, empty for gray scale image) at chroma resolution of file
+        // (NV12 layout for 4:2:0, NV16 for 4:2:2, NV24 for 4:4:4) for conversion on GPU
+        struct PlanarInfo {
+            ImageInfo luma;
+            ImageInfo chroma;
+        };
+
+        // gray scale -> R8, color -> RGBA8
+        explicit Reader(const std::filesystem::path& path);
+        explicit Reader(io::MappedFile&& file);
+        // R8 (first component), RGB8 or RGBA8
+        // scale 2, 4 or 8 decodes ceil(width / scale) x ceil(height / scale) image by reduced IDCTs (thumbnails, low mips)
+        // chroma is interpolated unless replication is asked for (faster, streams restart intervals decoded on pool)
+        Reader(const std::filesystem::path& path, Format format, uint32_t scale = 1, jpg::Upsampling upsampling = jpg::Upsampling::Interpolate);
+
+        const auto& info() const noexcept { return info_; }
+        // can be called once, restart intervals are decoded on pool if given (see jpg::Decoder::decode)
+        void decode(std::span<uint8_t> dst, size_t row_pitch, concurrency::ThreadPool* pool = nullptr);
+
+        // YCbCr image with full resolution Y and same sampling of Cb and Cr (or gray scale image)
+        bool is_planar_supported() const noexcept { return jpg::PlanarWriter::is_supported(decoder_); }
+        PlanarInfo planar_info() const;
+        // decodes to planes without color conversion (instead of decode())
+        void decode_planar(std::span<uint8_t> luma, size_t luma_pitch, std::span<uint8_t> chroma, size_t chroma_pitch, concurrency::ThreadPool* pool = nullptr);
+    };
+
+    JPG() noexcept = default;
+
+    // baseline (sequential Huffman coded 8 bits) gray scale, YCbCr or RGB image
+    // other files (progressive, CMYK, ...) must be loaded by stb_image
+    static bool is_supported(std::span<const uint8_t> bytes) noexcept { return jpg::is_supported(bytes); }
+
+    static JPG load(const std::filesystem::path& path, concurrency::ThreadPool* pool = nullptr);
+    // file already mapped by caller (no second mapping after is_supported())
+    static JPG load(io::MappedFile&& file, concurrency::ThreadPool* pool = nullptr);
+    static JPG load(const std::filesystem::path& path, Format format, concurrency::ThreadPool* pool = nullptr);
+    // reduced size (see Reader)
+    static JPG load_scaled(const std::filesystem::path& path, Format format, uint32_t scale, concurrency::ThreadPool* pool = nullptr);
+
+    const auto& data() const & noexcept { return data_; }
+    auto data() && noexcept { return std::move(data_); }
+    auto width() const noexcept { return width_; }
+    auto height() const noexcept { return height_; }
+    auto component_count() const noexcept { return component_count_; }
+    auto format() const noexcept { return format_; }
 };
 
 }
\ No newline at end of file
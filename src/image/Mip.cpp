@@ -0,0 +1,15 @@
+#include "Mip.hpp"
+#include "DDS.hpp"
+
+namespace image {
+
+mip::Chain Mip::generate(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, const mip::Options& options, concurrency::ThreadPool* pool) {
+    return mip::Generator(format, options.is_srgb).generate(data, width, height, options, pool);
+}
+
+void Mip::save(const std::filesystem::path& path, std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, const mip::Options& options, concurrency::ThreadPool* pool) {
+    auto chain = generate(data, width, height, format, options, pool);
+    DDS::save(path, chain.layout, chain.data, options.is_srgb && !is_float(format));
+}
+
+}
\ No newline at end of file
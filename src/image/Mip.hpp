@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common.hpp"
+#include "mip/Generator.hpp"
+#include "../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+// CPU mip chain generation (box, triangle, Kaiser, Lanczos3 or Mitchell filter, sRGB-correct, alpha coverage preserving, see mip::Generator)
+// result is tightly packed in DDS order, so it can be saved as is or encoded per level (BC::encode)
+class Mip {
+public:
+    // number of levels of full chain (down to 1 x 1)
+    static uint32_t full_count(uint32_t width, uint32_t height) noexcept { return static_cast<uint32_t>(std::bit_width(std::max(width, height))); }
+
+    // data: format pixels (R8, RG8, RGB8, RGBA8, BGRA8 or R32F, RG32F, RGB32F, RGBA32F), rows of each level are split to tasks on pool if given
+    static mip::Chain generate(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, const mip::Options& options = {}, concurrency::ThreadPool* pool = nullptr);
+    // generates and writes DDS (*_SRGB format if options.is_srgb)
+    static void save(const std::filesystem::path& path, std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, const mip::Options& options = {}, concurrency::ThreadPool* pool = nullptr);
+};
+
+}
\ No newline at end of file
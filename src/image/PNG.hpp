@@ -1,13 +1,8 @@
 #pragma once
 
 #include "common.hpp"
-#include "png/IHDR.hpp"
-#include "png/IDAT.hpp"
-#include "png/Deflate.hpp"
-#include "png/LZSS.hpp"
-#include "png/FixedHuffman.hpp"
-#include "png/CustomHuffman.hpp"
-#include "png/Image.hpp"
+#include "png/Decoder.hpp"
+#include "png/Encoder.hpp"
 
 namespace image {
 
@@ -15,36 +10,49 @@ class PNG {
     uint32_t width_;
     uint32_t height_;
     uint32_t component_count_;
+    Format format_;
     std::vector<uint8_t> data_;
 
-    static uint8_t paeth_predictor_(uint8_t a, uint8_t b, uint8_t c) {
-        auto p = a + b - c;
-        auto pa = std::abs(p - a);
-        auto pb = std::abs(p - b);
-        auto pc = std::abs(p - c);
-        if(pa <= pb && pa <= pc) {
-            return a;
-        }
-        else if(pb <= pc) {
-            return b;
-        }
-        else {
-            return c;
-        }
-    }
-
-    PNG(std::vector<uint8_t>&& data, uint32_t width, uint32_t height, uint32_t component_count) noexcept :
-        width_(width) , height_(height), component_count_(component_count), data_(data) {}
+    PNG(std::vector<uint8_t>&& data, uint32_t width, uint32_t height, Format format) noexcept :
+        width_(width), height_(height), component_count_(image::component_count(format)), format_(format), data_(std::move(data)) {}
 
 public:
+    // two-phase decode into caller memory (e.g. persistently mapped staging buffer)
+    // constructor reads header only, decode() writes pixels to destination with caller chosen row pitch
+    class Reader {
+        png::Decoder decoder_;
+        png::Expand expand_;
+        ImageInfo info_;
+
+    public:
+        // natural format (see png::Decoder::natural_format())
+        explicit Reader(const std::filesystem::path& path);
+        Reader(const std::filesystem::path& path, Format format);
+
+        const auto& info() const noexcept { return info_; }
+        // can be called once
+        void decode(std::span<uint8_t> dst, size_t row_pitch);
+    };
+
     PNG() noexcept = default;
     
+    // decode to format which keeps all information of file (see png::Decoder::natural_format())
     static PNG load(const std::filesystem::path& path);
+    // decode directly to format (R8, RG8, RGB8, RGBA8, R16, RG16, RGB16 or RGBA16)
+    // gray scale is replicated to RGB, missing alpha is opaque, 16 bits samples are native endian
+    static PNG load(const std::filesystem::path& path, Format format);
+
+    // encode R8, RG8, RGB8, RGBA8 or 16 bits variants (native endian) to PNG file image
+    // segments are compressed on pool if given (see png::Encoder)
+    static std::vector<uint8_t> encode(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, const png::EncodeOptions& options = {}, concurrency::ThreadPool* pool = nullptr);
+    static void save(const std::filesystem::path& path, std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, const png::EncodeOptions& options = {}, concurrency::ThreadPool* pool = nullptr);
 
-    const auto& data() const noexcept { return data_; }
+    const auto& data() const & noexcept { return data_; }
+    auto data() && noexcept { return std::move(data_); }
     auto width() const noexcept { return width_; }
     auto height() const noexcept { return height_; }
     auto component_count() const noexcept { return component_count_; }
+    auto format() const noexcept { return format_; }
 };
 
 }
\ No newline at end of file
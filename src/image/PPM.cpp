@@ -1,35 +1,67 @@
 #include "PPM.hpp"
+#include "Convert.hpp"
+
+#include <cctype>
+#include <charconv>
+
+#include "../io/ByteReader.hpp"
 
 namespace image {
 
-PPM PPM::load(const std::filesystem::path& path) {
-    std::ifstream ifs(path, std::ios::in | std::ios::binary);
-    if(ifs.fail()) {
-        throw std::runtime_error(std::format("[image::PPM::load] ERROR: failed to open file: {}", path.string()));
-    } 
-
-    std::string type(2, '\0');
-    uint32_t width{};
-    uint32_t height{};
-    uint32_t max_value{};
-
-    ifs >> type >> width >> height >> max_value;
-    std::cerr << std::format("type = {}, width = {}, height = {}, max value = {}", type, width, height, max_value) << std::endl;
-
-    while(true) {
-        uint8_t dummy{};
-        ifs.read(reinterpret_cast<char*>(&dummy), sizeof(uint8_t));
-        if(dummy == '\n') {
-            break;
-        }
-    }
-    
-    std::vector<uint8_t> image_data(width * height * 3);
-    for(size_t i = 0; i < image_data.size(); ++i) {
-        ifs.read(reinterpret_cast<char*>(&image_data[i]), sizeof(uint8_t));
+PPM::Reader::Reader(const std::filesystem::path& path, Format format) : file_(path) {
+    if(is_block_compressed(format)) {
+        throw std::runtime_error(std::format("[image::PPM::Reader] ERROR: unsupported output format: {}", static_cast<uint32_t>(format)));
     }
 
-    return PPM(std::move(image_data), width, height, 3);
+    io::ByteReader reader(file_.bytes());
+
+    // header is whitespace separated text ('#' starts comment until end of line)
+    auto read_token = [&reader]() {
+        while(!reader.at_end() && (std::isspace(reader.peek()) || reader.peek() == '#')) {
+            if(reader.read_le<uint8_t>() == '#') {
+                while(!reader.at_end() && reader.read_le<uint8_t>() != '\n') {}
+            }
+        }
+        std::string token{};
+        while(!reader.at_end() && !std::isspace(reader.peek())) {
+            token.push_back(static_cast<char>(reader.read_le<uint8_t>()));
+        }
+        return token;
+    };
+    auto read_value = [&](const char* name) {
+        auto token = read_token();
+        uint32_t value{};
+        auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if(token.empty() || ec != std::errc{} || end != token.data() + token.size()) {
+            throw std::runtime_error(std::format("[image::PPM::Reader] ERROR: invalid {}: {}", name, token));
+        }
+        return value;
+    };
+
+    // type (P6) and max value (255) are only skipped
+    read_token();
+    auto width = read_value("width");
+    auto height = read_value("height");
+    read_value("max value");
+
+    while(reader.read_le<uint8_t>() != '\n') {}
+
+    info_ = ImageInfo::make(width, height, format);
+    pixels_ = reader.read_bytes(ImageInfo::make(width, height, Format::RGB8).size());
+}
+
+void PPM::Reader::decode(std::span<uint8_t> dst, size_t row_pitch) const {
+    info_.check_destination(dst, row_pitch);
+
+    convert(Format::RGB8, info_.format, pixels_, image::row_pitch(Format::RGB8, info_.width), dst, row_pitch, info_.width, info_.height);
+}
+
+PPM PPM::load(const std::filesystem::path& path, Format format) {
+    Reader reader(path, format);
+    std::vector<uint8_t> image_data(reader.info().size());
+    reader.decode(image_data, reader.info().row_pitch);
+
+    return PPM(std::move(image_data), reader.info().width, reader.info().height, image::component_count(format));
 }
 
 }
\ No newline at end of file
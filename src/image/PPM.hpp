@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.hpp"
+#include "../io/MappedFile.hpp"
 
 namespace image {
 
@@ -14,11 +15,26 @@ class PPM {
         width_(width), height_(height), component_count_(component_count), data_(data) {}
 
 public:
+    // two-phase decode into caller memory (see PNG::Reader)
+    // binary (P6) 8 bits samples are converted from RGB8 to output format (e.g. RGBA8 for GPU upload, see convert())
+    class Reader {
+        io::MappedFile file_;
+        std::span<const uint8_t> pixels_;
+        ImageInfo info_;
+
+    public:
+        explicit Reader(const std::filesystem::path& path, Format format = Format::RGB8);
+
+        const auto& info() const noexcept { return info_; }
+        void decode(std::span<uint8_t> dst, size_t row_pitch) const;
+    };
+
     PPM() noexcept = default;
 
-    static PPM load(const std::filesystem::path& path);
+    static PPM load(const std::filesystem::path& path, Format format = Format::RGB8);
 
-    const auto& data() const noexcept { return data_; }
+    const auto& data() const & noexcept { return data_; }
+    auto data() && noexcept { return std::move(data_); }
     auto width() const noexcept { return width_; }
     auto height() const noexcept { return height_; }
     auto component_count() const noexcept { return component_count_; }
@@ -0,0 +1,30 @@
+#include "Resize.hpp"
+
+namespace image {
+
+std::vector<uint8_t> Resize::resize(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, uint32_t dst_width, uint32_t dst_height, const resize::Options& options, concurrency::ThreadPool* pool) {
+    auto info = ImageInfo::make(dst_width, dst_height, format);
+    std::vector<uint8_t> result(info.size());
+    resize(data, width, height, format, result, info.row_pitch, dst_width, dst_height, options, pool);
+    return result;
+}
+
+void Resize::resize(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, std::span<uint8_t> dst, size_t dst_pitch, uint32_t dst_width, uint32_t dst_height, const resize::Options& options, concurrency::ThreadPool* pool) {
+    if(is_block_compressed(format)) {
+        throw std::runtime_error(std::format("[image::Resize] ERROR: block compressed format is not supported (format = {}).", static_cast<uint32_t>(format)));
+    }
+    resize::Resizer(format, options.is_srgb).resize(data, width, height, dst, dst_pitch, dst_width, dst_height, options, pool);
+}
+
+bool Resize::fit(std::vector<uint8_t>& data, uint32_t& width, uint32_t& height, Format format, uint32_t max_dimension, const resize::Options& options, concurrency::ThreadPool* pool) {
+    auto [fitted_width, fitted_height] = resize::fit(width, height, max_dimension);
+    if(fitted_width == width && fitted_height == height) {
+        return false;
+    }
+    data = resize(data, width, height, format, fitted_width, fitted_height, options, pool);
+    width = fitted_width;
+    height = fitted_height;
+    return true;
+}
+
+}
\ No newline at end of file
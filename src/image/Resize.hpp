@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common.hpp"
+#include "resize/Resizer.hpp"
+#include "../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+// CPU image resizing (box, bilinear, Lanczos3, Mitchell or Kaiser filter, sRGB-correct, see resize::Resizer)
+// used to cap texture sizes at load time (see LoadOptions::max_dimension) instead of uploading and scaling on GPU
+class Resize {
+public:
+    // data: pixels of any uncompressed format, result is tightly packed, rows are split to bands on pool if given
+    static std::vector<uint8_t> resize(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, uint32_t dst_width, uint32_t dst_height, const resize::Options& options = {}, concurrency::ThreadPool* pool = nullptr);
+    // into caller memory
+    static void resize(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, std::span<uint8_t> dst, size_t dst_pitch, uint32_t dst_width, uint32_t dst_height, const resize::Options& options = {}, concurrency::ThreadPool* pool = nullptr);
+
+    // scales larger side down to max_dimension (aspect ratio kept), returns false and leaves data as is if it already fits
+    static bool fit(std::vector<uint8_t>& data, uint32_t& width, uint32_t& height, Format format, uint32_t max_dimension, const resize::Options& options = {}, concurrency::ThreadPool* pool = nullptr);
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "TEX.hpp"
+#include "BatchLoader.hpp"
+#include "png/Deflate.hpp"
+#include "png/Inflate.hpp"
+
+namespace image {
+
+namespace {
+
+// raw deflate stream of chunk to size bytes at dst
+void inflate_chunk_(std::span<const uint8_t> src, uint8_t* dst, size_t size) {
+    constexpr size_t REQUEST_SIZE = 65536;
+    png::Inflate inflate(png::BitReader(src.data(), src.size()), REQUEST_SIZE);
+    for(size_t position = 0; position < size;) {
+        auto count = std::min(REQUEST_SIZE, size - position);
+        if(!inflate.fill(count) || inflate.reader.overrun()) {
+            throw std::runtime_error(std::format("[image::TEX] ERROR: compressed chunk is truncated (size = {}, inflated = {}, expected = {}).", src.size(), position, size));
+        }
+        std::memcpy(dst + position, inflate.window.read_data(), count);
+        inflate.window.consume(count);
+        position += count;
+    }
+}
+
+}
+
+std::vector<uint8_t> TEX::encode(const dds::Layout& layout, std::span<const uint8_t> payload, bool is_srgb, uint32_t compression_level, concurrency::ThreadPool* pool, uint32_t max_dimension) {
+    if(payload.size() < layout.size) {
+        throw std::runtime_error(std::format("[image::TEX::encode] ERROR: payload is too small (size = {}, required = {}).", payload.size(), layout.size));
+    }
+
+    tex::Header header{};
+    header.magic = tex::MAGIC;
+    header.version = tex::VERSION;
+    header.dxgi_format = dds::dxgi_format_of(layout.format, is_srgb);
+    header.flags = (layout.is_cube ? tex::FLAG_CUBE : 0) | (is_srgb ? tex::FLAG_SRGB : 0);
+    header.width = layout.width;
+    header.height = layout.height;
+    header.depth = layout.depth;
+    header.mip_count = layout.mip_count;
+    header.layer_count = layout.layer_count;
+    header.max_dimension = max_dimension;
+    header.payload_size = layout.size;
+
+    // chunks are compressed independently (no shared window), so they can be inflated in any order
+    std::vector<std::vector<uint8_t>> chunks{};
+    if(compression_level > 0) {
+        header.chunk_size = CHUNK_SIZE;
+        header.chunk_count = static_cast<uint32_t>((layout.size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        chunks.resize(header.chunk_count);
+        concurrency::parallel_for(pool, header.chunk_count, [&](uint32_t chunk) {
+            auto source = payload.subspan(size_t(chunk) * CHUNK_SIZE, std::min<size_t>(CHUNK_SIZE, layout.size - size_t(chunk) * CHUNK_SIZE));
+            chunks[chunk] = png::Deflate::compress(source, 0, source.size(), compression_level, true);
+        });
+    }
+
+    auto table_size = layout.subresources.size() * 16 + size_t(header.chunk_count) * 8;
+    header.payload_offset = (tex::HEADER_SIZE + table_size + tex::PAYLOAD_ALIGNMENT - 1) / tex::PAYLOAD_ALIGNMENT * tex::PAYLOAD_ALIGNMENT;
+
+    std::vector<uint8_t> bytes{};
+    bytes.reserve(header.payload_offset + layout.size);
+    tex::write_header(bytes, header);
+    auto append_u64 = [&](uint64_t value) {
+        uint8_t field[8];
+        io::store_le(field, value);
+        bytes.insert(bytes.end(), field, field + 8);
+    };
+    for(const auto& subresource : layout.subresources) {
+        append_u64(subresource.offset);
+        append_u64(subresource.size);
+    }
+    uint64_t chunk_end = 0;
+    for(const auto& chunk : chunks) {
+        chunk_end += chunk.size();
+        append_u64(chunk_end);
+    }
+    bytes.resize(header.payload_offset);
+
+    if(chunks.empty()) {
+        bytes.insert(bytes.end(), payload.begin(), payload.begin() + layout.size);
+    }
+    for(const auto& chunk : chunks) {
+        bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+    }
+
+    return bytes;
+}
+
+void TEX::save(const std::filesystem::path& path, const dds::Layout& layout, std::span<const uint8_t> payload, bool is_srgb, uint32_t compression_level, concurrency::ThreadPool* pool, uint32_t max_dimension) {
+    auto bytes = encode(layout, payload, is_srgb, compression_level, pool, max_dimension);
+
+    std::ofstream file(path, std::ios::binary);
+    if(!file) {
+        throw std::runtime_error(std::format("[image::TEX::save] ERROR: failed to open or create file: {}", path.string()));
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if(!file) {
+        throw std::runtime_error(std::format("[image::TEX::save] ERROR: failed to write file: {}", path.string()));
+    }
+}
+
+void TEX::bake(const std::filesystem::path& source, const std::filesystem::path& path, const tex::BakeOptions& options, concurrency::ThreadPool* pool) {
+    auto image = load_image(source);
+    auto baked = tex::bake(image.data, image.width, image.height, image.format, options, pool);
+    save(path, baked.layout, baked.payload, baked.is_srgb, options.compression_level, pool, options.max_dimension);
+}
+
+TEX TEX::load(const std::filesystem::path& path, concurrency::ThreadPool* pool) {
+    TEX tex;
+    tex.file_ = io::MappedFile(path);
+    auto bytes = tex.file_.bytes();
+
+    io::ByteReader reader(bytes);
+    auto header = tex::read_header(reader);
+    if(header.magic != tex::MAGIC || header.version != tex::VERSION) {
+        throw std::runtime_error(std::format("[image::TEX] ERROR: not a baked texture of version {}: {}", tex::VERSION, path.string()));
+    }
+    tex.is_srgb_ = header.flags & tex::FLAG_SRGB;
+    tex.max_dimension_ = header.max_dimension;
+    tex.layout_ = dds::Layout::make(dds::format_of_dxgi(header.dxgi_format), header.width, header.height, header.depth, header.mip_count, header.layer_count, header.flags & tex::FLAG_CUBE, header.payload_size);
+    if(tex.layout_.size != header.payload_size) {
+        throw std::runtime_error(std::format("[image::TEX] ERROR: payload size does not match layout (size = {}, layout = {}).", header.payload_size, tex.layout_.size));
+    }
+    // table is written from the same layout, mismatch means corrupted file or different layout rules
+    for(const auto& subresource : tex.layout_.subresources) {
+        auto offset = reader.read_le<uint64_t>();
+        auto size = reader.read_le<uint64_t>();
+        if(offset != subresource.offset || size != subresource.size) {
+            throw std::runtime_error(std::format("[image::TEX] ERROR: subresource table does not match layout (mip = {}, layer = {}).", subresource.mip_level, subresource.array_layer));
+        }
+    }
+    if(header.payload_offset > bytes.size()) {
+        throw std::runtime_error(std::format("[image::TEX] ERROR: payload offset is out of file (offset = {}, size = {}).", header.payload_offset, bytes.size()));
+    }
+    auto stored = bytes.subspan(header.payload_offset);
+
+    if(header.chunk_size == 0) {
+        if(stored.size() < header.payload_size) {
+            throw std::runtime_error(std::format("[image::TEX] ERROR: payload is truncated (size = {}, required = {}).", stored.size(), header.payload_size));
+        }
+        tex.payload_ = stored.first(header.payload_size);
+        return tex;
+    }
+
+    if(header.chunk_count != (header.payload_size + header.chunk_size - 1) / header.chunk_size) {
+        throw std::runtime_error(std::format("[image::TEX] ERROR: invalid chunk count: {} (payload = {}, chunk = {})", header.chunk_count, header.payload_size, header.chunk_size));
+    }
+    std::vector<uint64_t> chunk_ends(header.chunk_count);
+    for(auto& end : chunk_ends) {
+        reader.read_le(end);
+    }
+    for(uint32_t chunk = 0; chunk < header.chunk_count; ++chunk) {
+        auto begin = chunk == 0 ? 0 : chunk_ends[chunk - 1];
+        if(chunk_ends[chunk] < begin || chunk_ends[chunk] > stored.size()) {
+            throw std::runtime_error(std::format("[image::TEX] ERROR: chunk {} is out of file.", chunk));
+        }
+    }
+
+    tex.inflated_.resize(header.payload_size);
+    concurrency::parallel_for(pool, header.chunk_count, [&](uint32_t chunk) {
+        auto begin = chunk == 0 ? 0 : chunk_ends[chunk - 1];
+        auto offset = size_t(chunk) * header.chunk_size;
+        inflate_chunk_(stored.subspan(begin, chunk_ends[chunk] - begin), tex.inflated_.data() + offset, std::min<size_t>(header.chunk_size, header.payload_size - offset));
+    });
+    tex.payload_ = tex.inflated_;
+
+    return tex;
+}
+
+TEX TEX::load_or_bake(const std::filesystem::path& source, const std::filesystem::path& cache, const tex::BakeOptions& options, concurrency::ThreadPool* pool) {
+    std::error_code error{};
+    auto cache_time = std::filesystem::last_write_time(cache, error);
+    if(!error && cache_time >= std::filesystem::last_write_time(source)) {
+        try {
+            auto tex = load(cache, pool);
+            bool has_mips = tex.mip_count() == Mip::full_count(tex.width(), tex.height());
+            bool is_srgb = options.is_srgb && !is_float(options.format);
+            // cache baked under another budget (smaller, larger or none) is baked again
+            bool is_same_budget = tex.max_dimension() == options.max_dimension;
+            if(tex.format() == options.format && tex.is_srgb() == is_srgb && (has_mips || !options.generate_mips) && is_same_budget) {
+                return tex;
+            }
+        }
+        catch(std::exception&) {
+            // stale or broken cache is baked again
+        }
+    }
+
+    bake(source, cache, options, pool);
+    return load(cache, pool);
+}
+
+}
\ No newline at end of file
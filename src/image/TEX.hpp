@@ -0,0 +1,70 @@
+#pragma once
+
+#include "common.hpp"
+#include "dds/Format.hpp"
+#include "dds/Layout.hpp"
+#include "tex/Header.hpp"
+#include "tex/Bake.hpp"
+#include "../io/MappedFile.hpp"
+#include "../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+// baked texture: final GPU format with all mips and subresource table, optionally deflate compressed (see tex::Header)
+// stored payload is used straight from memory-mapped file, so loading costs header checks and page faults only
+// compressed payload is split to independent chunks, which are inflated in parallel
+class TEX {
+    io::MappedFile file_;
+    // inflated payload (empty if payload is stored as is)
+    std::vector<uint8_t> inflated_;
+    std::span<const uint8_t> payload_;
+    dds::Layout layout_;
+    bool is_srgb_;
+    uint32_t max_dimension_;
+
+public:
+    // uncompressed bytes per deflate chunk
+    static constexpr uint32_t CHUNK_SIZE = 1 << 18;
+
+    TEX() noexcept : payload_{}, layout_{}, is_srgb_(false), max_dimension_(0) {}
+
+    // file of payload (subresources as described by layout), compression_level 1-9 deflates chunks on pool
+    // max_dimension: size budget payload was baked with (recorded for load_or_bake())
+    static std::vector<uint8_t> encode(const dds::Layout& layout, std::span<const uint8_t> payload, bool is_srgb = false, uint32_t compression_level = 0, concurrency::ThreadPool* pool = nullptr, uint32_t max_dimension = 0);
+    static void save(const std::filesystem::path& path, const dds::Layout& layout, std::span<const uint8_t> payload, bool is_srgb = false, uint32_t compression_level = 0, concurrency::ThreadPool* pool = nullptr, uint32_t max_dimension = 0);
+
+    // loads source image (any type load_image() reads), bakes it and saves
+    static void bake(const std::filesystem::path& source, const std::filesystem::path& path, const tex::BakeOptions& options = {}, concurrency::ThreadPool* pool = nullptr);
+
+    // maps file (compressed chunks are inflated on pool)
+    static TEX load(const std::filesystem::path& path, concurrency::ThreadPool* pool = nullptr);
+    // loads cache if it is not older than source and was baked to the same format under the same options.max_dimension,
+    // otherwise bakes source to cache first
+    static TEX load_or_bake(const std::filesystem::path& source, const std::filesystem::path& cache, const tex::BakeOptions& options = {}, concurrency::ThreadPool* pool = nullptr);
+
+    auto width() const noexcept { return layout_.width; }
+    auto height() const noexcept { return layout_.height; }
+    auto depth() const noexcept { return layout_.depth; }
+    auto format() const noexcept { return layout_.format; }
+    auto mip_count() const noexcept { return layout_.mip_count; }
+    auto layer_count() const noexcept { return layout_.layer_count; }
+    auto is_cube() const noexcept { return layout_.is_cube; }
+    auto is_srgb() const noexcept { return is_srgb_; }
+    // size budget of baking (0: none)
+    auto max_dimension() const noexcept { return max_dimension_; }
+    bool is_mapped() const noexcept { return file_.is_mapped() && inflated_.empty(); }
+
+    const auto& layout() const noexcept { return layout_; }
+    const auto& subresources() const noexcept { return layout_.subresources; }
+    const auto& subresource(uint32_t mip, uint32_t layer = 0) const { return layout_.subresource(mip, layer); }
+
+    // all subresources (offsets of subresources are relative to this)
+    std::span<const uint8_t> payload() const noexcept { return payload_; }
+
+    std::span<const uint8_t> data(uint32_t mip = 0, uint32_t layer = 0) const {
+        const auto& subresource = layout_.subresource(mip, layer);
+        return payload_.subspan(subresource.offset, subresource.size);
+    }
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <optional>
+
+#include "../common.hpp"
+
+namespace image {
+
+namespace atlas {
+
+struct Rect {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+
+    uint64_t area() const noexcept { return uint64_t(width) * height; }
+    bool contains(const Rect& rhs) const noexcept {
+        return rhs.x >= x && rhs.y >= y && rhs.x + rhs.width <= x + width && rhs.y + rhs.height <= y + height;
+    }
+    bool intersects(const Rect& rhs) const noexcept {
+        return rhs.x < x + width && x < rhs.x + rhs.width && rhs.y < y + height && y < rhs.y + rhs.height;
+    }
+    bool operator==(const Rect&) const noexcept = default;
+};
+
+// MaxRects bin packer (best short side fit, no rotation)
+// free space is kept as list of maximal free rectangles (they overlap each other),
+// placing rectangle splits every free rectangle it intersects into up to 4 remaining parts,
+// releasing one rebuilds free list by splitting whole bin by the rest (keeps it maximal, costs used * free per release)
+// if all sizes and bin size are multiples of alignment, all positions are multiples of it too
+class MaxRects {
+    uint32_t width_;
+    uint32_t height_;
+    std::vector<Rect> free_;
+    std::vector<Rect> used_;
+    uint64_t used_area_;
+
+    // removes free rectangles contained by other ones
+    void prune_() {
+        for(size_t i = 0; i < free_.size(); ++i) {
+            for(size_t j = i + 1; j < free_.size();) {
+                if(free_[i].contains(free_[j])) {
+                    free_[j] = free_.back();
+                    free_.pop_back();
+                }
+                else if(free_[j].contains(free_[i])) {
+                    free_[i] = free_[j];
+                    free_[j] = free_.back();
+                    free_.pop_back();
+                    j = i + 1;
+                }
+                else {
+                    ++j;
+                }
+            }
+        }
+    }
+
+    // splits every free rectangle intersecting placed one into up to 4 remaining parts
+    void split_(const Rect& placed) {
+        std::vector<Rect> parts{};
+        for(size_t i = 0; i < free_.size();) {
+            auto rect = free_[i];
+            if(!rect.intersects(placed)) {
+                ++i;
+                continue;
+            }
+            free_[i] = free_.back();
+            free_.pop_back();
+            if(placed.x > rect.x) {
+                parts.push_back(Rect{rect.x, rect.y, placed.x - rect.x, rect.height});
+            }
+            if(placed.x + placed.width < rect.x + rect.width) {
+                parts.push_back(Rect{placed.x + placed.width, rect.y, rect.x + rect.width - placed.x - placed.width, rect.height});
+            }
+            if(placed.y > rect.y) {
+                parts.push_back(Rect{rect.x, rect.y, rect.width, placed.y - rect.y});
+            }
+            if(placed.y + placed.height < rect.y + rect.height) {
+                parts.push_back(Rect{rect.x, placed.y + placed.height, rect.width, rect.y + rect.height - placed.y - placed.height});
+            }
+        }
+        free_.insert(free_.end(), parts.begin(), parts.end());
+        prune_();
+    }
+
+public:
+    MaxRects(uint32_t width, uint32_t height) : width_(width), height_(height), free_{Rect{0, 0, width, height}}, used_{}, used_area_(0) {}
+
+    auto width() const noexcept { return width_; }
+    auto height() const noexcept { return height_; }
+    const auto& free_rects() const noexcept { return free_; }
+    // used area / bin area
+    float occupancy() const noexcept { return static_cast<float>(double(used_area_) / (double(width_) * height_)); }
+
+    std::optional<Rect> insert(uint32_t width, uint32_t height) {
+        if(width == 0 || height == 0) {
+            return std::nullopt;
+        }
+
+        // best short side fit: smallest leftover on shorter side, then on longer side
+        const Rect* best = nullptr;
+        uint32_t best_short = UINT32_MAX, best_long = UINT32_MAX;
+        for(const auto& rect : free_) {
+            if(rect.width < width || rect.height < height) {
+                continue;
+            }
+            auto leftover_x = rect.width - width;
+            auto leftover_y = rect.height - height;
+            auto short_side = std::min(leftover_x, leftover_y);
+            auto long_side = std::max(leftover_x, leftover_y);
+            if(short_side < best_short || (short_side == best_short && long_side < best_long)) {
+                best = &rect;
+                best_short = short_side;
+                best_long = long_side;
+            }
+        }
+        if(!best) {
+            return std::nullopt;
+        }
+
+        Rect placed{best->x, best->y, width, height};
+        split_(placed);
+        used_.push_back(placed);
+        used_area_ += placed.area();
+
+        return placed;
+    }
+
+    // rect must be one returned by insert() and not released yet
+    // free list is rebuilt from remaining used rectangles, so released space joins every free rectangle around it
+    void release(const Rect& rect) {
+        auto used = std::ranges::find(used_, rect);
+        if(used == used_.end()) {
+            return;
+        }
+        *used = used_.back();
+        used_.pop_back();
+        used_area_ -= rect.area();
+
+        free_.assign(1, Rect{0, 0, width_, height_});
+        for(const auto& placed : used_) {
+            split_(placed);
+        }
+    }
+};
+
+}
+
+}
\ No newline at end of file
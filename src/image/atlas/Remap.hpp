@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../common.hpp"
+
+namespace image {
+
+namespace atlas {
+
+// maps texture coordinates of source texture to its rectangle in atlas (uv * scale + offset)
+// coordinates must stay in [0, 1], repeating (tiling) textures can not be atlased
+struct UVTransform {
+    float scale_u;
+    float scale_v;
+    float offset_u;
+    float offset_v;
+
+    void apply(float& u, float& v) const noexcept {
+        u = u * scale_u + offset_u;
+        v = v * scale_v + offset_v;
+    }
+};
+
+// rewrites uv member of vertices (e.g. &mesh::VertexAttribute::tex_coord, &mesh::pmx::Vertex::uv)
+template<typename Vertex, typename UV>
+void remap_uvs(std::span<Vertex> vertices, UV Vertex::* uv, const UVTransform& transform) noexcept {
+    for(auto& vertex : vertices) {
+        transform.apply((vertex.*uv).x, (vertex.*uv).y);
+    }
+}
+
+// rewrites vertices referenced by indices only (e.g. index range of pmx material), each vertex once
+// is_remapped is shared between calls (size of vertices), so vertex used by several ranges is not transformed twice
+template<typename Vertex, typename UV, typename Index>
+void remap_uvs(std::span<Vertex> vertices, std::span<const Index> indices, UV Vertex::* uv, const UVTransform& transform, std::vector<bool>& is_remapped) {
+    if(is_remapped.size() < vertices.size()) {
+        is_remapped.resize(vertices.size(), false);
+    }
+    for(auto index : indices) {
+        if(static_cast<size_t>(index) >= vertices.size()) {
+            throw std::runtime_error(std::format("[image::atlas] ERROR: index is out of range (index = {}, vertex count = {}).", static_cast<size_t>(index), vertices.size()));
+        }
+        if(is_remapped[index]) {
+            continue;
+        }
+        is_remapped[index] = true;
+        transform.apply((vertices[index].*uv).x, (vertices[index].*uv).y);
+    }
+}
+
+}
+
+}
\ No newline at end of file
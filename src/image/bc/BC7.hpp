@@ -0,0 +1,474 @@
+#pragma once
+
+#include "Channel.hpp"
+
+namespace image {
+
+namespace bc {
+
+// BC7 block to RGBA8 (D3D11 BC7 format, same as BPTC_UNORM)
+// mode and index bits are parsed per block to endpoints of each subset and interpolation weight of each pixel,
+// interpolation (64 - w) * e0 + w * e1 is done for 4 pixels at once by SIMD kernel
+// reserved mode (first byte is 0) is decoded as transparent black
+
+struct BC7Mode {
+    uint8_t subset_count;
+    uint8_t partition_bits;
+    uint8_t rotation_bits;
+    uint8_t index_selection_bits;
+    uint8_t color_bits;
+    uint8_t alpha_bits;
+    // p-bit per endpoint or shared by both endpoints of subset
+    uint8_t endpoint_pbits;
+    uint8_t shared_pbits;
+    uint8_t index_bits;
+    uint8_t secondary_index_bits;
+};
+
+constexpr std::array<BC7Mode, 8> BC7_MODES = {{
+    {3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+    {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+    {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+    {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+    {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+    {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+    {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+    {2, 6, 0, 0, 5, 5, 1, 0, 2, 0},
+}};
+
+// subset of each pixel of 2 subsets partitions (bit i = pixel i)
+constexpr std::array<uint16_t, 64> BC7_PARTITIONS_2 = {
+    0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+    0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+    0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+    0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+    0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+    0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+    0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+    0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+};
+
+// BC7_PARTITIONS_2 expanded to subset of each pixel
+constexpr auto BC7_SUBSETS_2 = [] {
+    std::array<std::array<uint8_t, 16>, 64> subsets{};
+    for(uint32_t p = 0; p < 64; ++p) {
+        for(uint32_t i = 0; i < 16; ++i) {
+            subsets[p][i] = static_cast<uint8_t>((BC7_PARTITIONS_2[p] >> i) & 1);
+        }
+    }
+    return subsets;
+}();
+
+// subset of each pixel of 3 subsets partitions
+constexpr std::array<std::array<uint8_t, 16>, 64> BC7_PARTITIONS_3 = {{
+    {0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2},
+    {0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+    {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2},
+    {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2},
+    {0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1},
+    {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2},
+    {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2},
+    {0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2},
+    {0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2},
+    {0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2},
+    {0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0},
+    {0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2},
+    {0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0},
+    {0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2},
+    {0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1},
+    {0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2},
+    {0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2},
+    {0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0},
+    {0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0},
+    {0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2},
+    {0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0},
+    {0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1},
+    {0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2},
+    {0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1},
+    {0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2},
+    {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2},
+    {0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0},
+    {0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0},
+    {0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0},
+    {0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1},
+    {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1},
+    {0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2},
+    {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1},
+    {0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1},
+    {0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1},
+    {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2},
+    {0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1},
+    {0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2},
+    {0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2},
+    {0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2},
+    {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2},
+    {0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2},
+    {0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1},
+    {0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0},
+}};
+
+// anchor pixel of second subset of 2 subsets partitions (its index has implicit zero MSB, as pixel 0)
+constexpr std::array<uint8_t, 64> BC7_ANCHORS_2 = {
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 2, 8, 2, 2, 8, 8, 15,
+    2, 8, 2, 2, 8, 8, 2, 2,
+    15, 15, 6, 8, 2, 8, 15, 15,
+    2, 8, 2, 2, 2, 15, 15, 6,
+    6, 2, 6, 8, 15, 15, 2, 2,
+    15, 15, 15, 15, 15, 2, 2, 15,
+};
+
+// anchor pixels of second and third subsets of 3 subsets partitions
+constexpr std::array<std::array<uint8_t, 64>, 2> BC7_ANCHORS_3 = {{
+    {
+        3, 3, 15, 15, 8, 3, 15, 15,
+        8, 8, 6, 6, 6, 5, 3, 3,
+        3, 3, 8, 15, 3, 3, 6, 10,
+        5, 8, 8, 6, 8, 5, 15, 15,
+        8, 15, 3, 5, 6, 10, 8, 15,
+        15, 3, 15, 5, 15, 15, 15, 15,
+        3, 15, 5, 5, 5, 8, 5, 10,
+        5, 10, 8, 13, 15, 12, 3, 3,
+    },
+    {
+        15, 8, 8, 3, 15, 15, 3, 8,
+        15, 15, 15, 15, 15, 15, 15, 8,
+        15, 8, 15, 3, 15, 8, 15, 8,
+        3, 15, 6, 10, 15, 15, 10, 8,
+        15, 3, 15, 10, 10, 8, 9, 10,
+        6, 15, 8, 15, 3, 6, 6, 8,
+        15, 3, 15, 15, 15, 15, 15, 15,
+        15, 15, 15, 15, 3, 15, 15, 8,
+    },
+}};
+
+// interpolation weights of 2, 3 and 4 bits indices (out of 64), padded for byte shuffle
+alignas(16) constexpr std::array<std::array<uint8_t, 16>, 3> BC7_WEIGHTS = {{
+    {0, 21, 43, 64},
+    {0, 9, 18, 27, 37, 46, 55, 64},
+    {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64},
+}};
+
+// inserts zero bit at position (< 63), upper bits are moved up
+constexpr uint64_t insert_zero_bit_(uint64_t bits, uint32_t position) noexcept {
+    auto low_mask = (uint64_t(1) << position) - 1;
+    return ((bits & ~low_mask) << 1) | (bits & low_mask);
+}
+
+// fields of 128 bits block (LSB first)
+struct BC7Bits {
+    uint64_t low;
+    uint64_t high;
+
+    explicit BC7Bits(const uint8_t* block) noexcept : low(io::load_le<uint64_t>(block)), high(io::load_le<uint64_t>(block + 8)) {}
+
+    // 64 bits from position (zero filled after the end)
+    uint64_t window(uint32_t position) const noexcept {
+        if(position == 0) {
+            return low;
+        }
+        if(position < 64) {
+            return (low >> position) | (high << (64 - position));
+        }
+        return high >> (position - 64);
+    }
+
+    // count < 32
+    uint32_t field(uint32_t position, uint32_t count) const noexcept {
+        return static_cast<uint32_t>(window(position) & ((uint64_t(1) << count) - 1));
+    }
+};
+
+// block parsed for interpolation
+struct BC7Block {
+    // RGBA8 endpoints of each subset: endpoints[e][subset * 4 + channel]
+    alignas(16) std::array<std::array<uint8_t, 16>, 2> endpoints;
+    alignas(16) std::array<uint8_t, 16> subsets;
+    // indices of 16 pixels as uniform index_bits fields (MSB of anchor indices is inserted)
+    uint64_t color_indices;
+    uint64_t alpha_indices;
+    uint32_t color_index_bits;
+    uint32_t alpha_index_bits;
+    // 0: none, 1..3: alpha is swapped with R, G or B after interpolation
+    uint32_t rotation;
+
+    // p-bit is appended as LSB, then value is expanded to 8 bits by replicating its MSBs
+    template<uint32_t POSITION, uint32_t BITS, bool PBIT>
+    static uint8_t endpoint_value_(const BC7Bits& bits, uint32_t pbit) noexcept {
+        constexpr uint32_t expanded_bits = BITS + PBIT;
+        uint32_t value = bits.field(POSITION, BITS);
+        if constexpr(PBIT) {
+            value = (value << 1) | pbit;
+        }
+        return static_cast<uint8_t>((value << (8 - expanded_bits)) | (value >> (2 * expanded_bits - 8)));
+    }
+
+    // endpoints are stored in order R, G, B, A of all endpoints (subset 0 e0, subset 0 e1, subset 1 e0, ...)
+    template<uint32_t MODE_INDEX, uint32_t E>
+    void parse_endpoint_(const BC7Bits& bits) noexcept {
+        constexpr auto mode = BC7_MODES[MODE_INDEX];
+        constexpr uint32_t endpoint_count = mode.subset_count * 2u;
+        constexpr bool has_pbits = mode.endpoint_pbits || mode.shared_pbits;
+        constexpr uint32_t color_position = MODE_INDEX + 1 + mode.partition_bits + mode.rotation_bits + mode.index_selection_bits;
+        constexpr uint32_t alpha_position = color_position + 3 * endpoint_count * mode.color_bits;
+        constexpr uint32_t pbit_position = alpha_position + endpoint_count * mode.alpha_bits;
+
+        uint32_t pbit = 0;
+        if constexpr(mode.endpoint_pbits) {
+            pbit = bits.field(pbit_position + E, 1);
+        }
+        else if constexpr(mode.shared_pbits) {
+            pbit = bits.field(pbit_position + E / 2, 1);
+        }
+        auto dst = endpoints[E & 1].data() + (E >> 1) * 4;
+        dst[0] = endpoint_value_<color_position + E * mode.color_bits, mode.color_bits, has_pbits>(bits, pbit);
+        dst[1] = endpoint_value_<color_position + (endpoint_count + E) * mode.color_bits, mode.color_bits, has_pbits>(bits, pbit);
+        dst[2] = endpoint_value_<color_position + (2 * endpoint_count + E) * mode.color_bits, mode.color_bits, has_pbits>(bits, pbit);
+        if constexpr(mode.alpha_bits) {
+            dst[3] = endpoint_value_<alpha_position + E * mode.alpha_bits, mode.alpha_bits, has_pbits>(bits, pbit);
+        }
+        else {
+            dst[3] = 255;
+        }
+    }
+
+    // mode parameters are compile time constants, so that position of every field except indices is constant
+    // (fields are extracted independently instead of by sequential reads)
+    template<uint32_t MODE_INDEX>
+    void parse_mode_(const uint8_t* block) noexcept {
+        constexpr auto mode = BC7_MODES[MODE_INDEX];
+        constexpr uint32_t endpoint_count = mode.subset_count * 2u;
+        constexpr uint32_t partition_position = MODE_INDEX + 1;
+        constexpr uint32_t rotation_position = partition_position + mode.partition_bits;
+        constexpr uint32_t color_position = rotation_position + mode.rotation_bits + mode.index_selection_bits;
+        constexpr uint32_t alpha_position = color_position + 3 * endpoint_count * mode.color_bits;
+        constexpr uint32_t pbit_position = alpha_position + endpoint_count * mode.alpha_bits;
+        constexpr uint32_t index_position = pbit_position + mode.endpoint_pbits * endpoint_count + mode.shared_pbits * mode.subset_count;
+        // one bit less for anchor of each subset
+        constexpr uint32_t secondary_position = index_position + 16 * mode.index_bits - mode.subset_count;
+
+        BC7Bits bits(block);
+        uint32_t partition = mode.partition_bits ? bits.field(partition_position, mode.partition_bits) : 0;
+        rotation = mode.rotation_bits ? bits.field(rotation_position, mode.rotation_bits) : 0;
+        uint32_t index_selection = mode.index_selection_bits ? bits.field(rotation_position + mode.rotation_bits, 1) : 0;
+
+        // every endpoint is expanded with constant field positions, slots of missing subsets stay zero
+        for(auto& e : endpoints) {
+            e.fill(0);
+        }
+        [&]<size_t... E>(std::index_sequence<E...>) {
+            (parse_endpoint_<MODE_INDEX, E>(bits), ...);
+        }(std::make_index_sequence<endpoint_count>{});
+
+        // anchor pixels have index with one bit less
+        uint32_t anchor1 = 16, anchor2 = 16;
+        if constexpr(mode.subset_count == 1) {
+            subsets.fill(0);
+        }
+        else if constexpr(mode.subset_count == 2) {
+            anchor1 = BC7_ANCHORS_2[partition];
+            subsets = BC7_SUBSETS_2[partition];
+        }
+        else {
+            anchor1 = BC7_ANCHORS_3[0][partition];
+            anchor2 = BC7_ANCHORS_3[1][partition];
+            subsets = BC7_PARTITIONS_3[partition];
+        }
+
+        // indices of every mode fit in 64 bits window
+        constexpr uint64_t index_mask = mode.index_bits == 4 ? ~uint64_t(0) : (uint64_t(1) << (16 * mode.index_bits)) - 1;
+        auto indices = insert_zero_bit_(bits.window(index_position), mode.index_bits - 1);
+        if constexpr(mode.subset_count > 1) {
+            auto first = std::min(anchor1, anchor2);
+            auto second = std::max(anchor1, anchor2);
+            indices = insert_zero_bit_(indices, first * mode.index_bits + mode.index_bits - 1);
+            if constexpr(mode.subset_count > 2) {
+                indices = insert_zero_bit_(indices, second * mode.index_bits + mode.index_bits - 1);
+            }
+        }
+        color_indices = alpha_indices = indices & index_mask;
+        color_index_bits = alpha_index_bits = mode.index_bits;
+
+        if constexpr(mode.secondary_index_bits) {
+            // modes 4 and 5: separate alpha indices (swapped with color indices by index selection bit)
+            constexpr uint64_t secondary_mask = (uint64_t(1) << (16 * mode.secondary_index_bits)) - 1;
+            alpha_indices = insert_zero_bit_(bits.window(secondary_position), mode.secondary_index_bits - 1) & secondary_mask;
+            alpha_index_bits = mode.secondary_index_bits;
+            if(index_selection) {
+                std::swap(color_indices, alpha_indices);
+                std::swap(color_index_bits, alpha_index_bits);
+            }
+        }
+    }
+
+    // returns false for reserved mode
+    bool parse(const uint8_t* block) noexcept {
+        switch(std::countr_zero(block[0])) {
+            case 0: parse_mode_<0>(block); return true;
+            case 1: parse_mode_<1>(block); return true;
+            case 2: parse_mode_<2>(block); return true;
+            case 3: parse_mode_<3>(block); return true;
+            case 4: parse_mode_<4>(block); return true;
+            case 5: parse_mode_<5>(block); return true;
+            case 6: parse_mode_<6>(block); return true;
+            case 7: parse_mode_<7>(block); return true;
+            default: return false;
+        }
+    }
+};
+
+inline void decode_bc7_block_scalar_(const uint8_t* block, uint8_t* dst, size_t row_pitch) noexcept {
+    BC7Block parsed;
+    if(!parsed.parse(block)) {
+        for(uint32_t y = 0; y < 4; ++y) {
+            std::memset(dst + y * row_pitch, 0, 16);
+        }
+        return;
+    }
+    const auto& color_weights = BC7_WEIGHTS[parsed.color_index_bits - 2];
+    const auto& alpha_weights = BC7_WEIGHTS[parsed.alpha_index_bits - 2];
+    for(uint32_t i = 0; i < 16; ++i) {
+        auto pixel = dst + (i / 4) * row_pitch + (i % 4) * 4;
+        uint32_t subset = parsed.subsets[i];
+        uint32_t color_index = (parsed.color_indices >> (i * parsed.color_index_bits)) & ((1u << parsed.color_index_bits) - 1);
+        uint32_t alpha_index = (parsed.alpha_indices >> (i * parsed.alpha_index_bits)) & ((1u << parsed.alpha_index_bits) - 1);
+        for(uint32_t c = 0; c < 4; ++c) {
+            uint32_t w = c < 3 ? color_weights[color_index] : alpha_weights[alpha_index];
+            uint32_t e0 = parsed.endpoints[0][subset * 4 + c];
+            uint32_t e1 = parsed.endpoints[1][subset * 4 + c];
+            pixel[c] = static_cast<uint8_t>(((64 - w) * e0 + w * e1 + 32) >> 6);
+        }
+        if(parsed.rotation) {
+            std::swap(pixel[3], pixel[parsed.rotation - 1]);
+        }
+    }
+}
+
+inline void decode_bc7_row_scalar(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        decode_bc7_block_scalar_(blocks + i * 16, dst + i * 16, row_pitch);
+    }
+}
+
+#if defined(IMAGE_SIMD_X86)
+
+// byte shuffles for interpolation of row y (4 pixels): pixel value to its 4 channels, and channel rotation
+alignas(16) constexpr auto BC7_SHUFFLES_ = []{
+    std::array<std::array<uint8_t, 16>, 8> shuffles{};
+    for(uint32_t y = 0; y < 4; ++y) {
+        for(uint32_t i = 0; i < 16; ++i) {
+            shuffles[y][i] = static_cast<uint8_t>(y * 4 + i / 4);
+        }
+    }
+    for(uint32_t rotation = 0; rotation < 4; ++rotation) {
+        for(uint32_t i = 0; i < 16; ++i) {
+            auto c = i % 4;
+            if(rotation != 0 && c == 3) {
+                c = rotation - 1;
+            }
+            else if(rotation != 0 && c == rotation - 1) {
+                c = 3;
+            }
+            shuffles[4 + rotation][i] = static_cast<uint8_t>(i / 4 * 4 + c);
+        }
+    }
+    return shuffles;
+}();
+
+// weights of 16 pixels from uniform index fields
+IMAGE_TARGET("ssse3") inline __m128i bc7_weights_ssse3_(uint64_t indices, uint32_t index_bits) noexcept {
+    __m128i nibbles{};
+    if(index_bits == 3) {
+        // same layout as indices of channel block when moved to bytes 2..7
+        auto bytes = _mm_cvtsi64_si128(static_cast<int64_t>(indices << 16));
+        auto shifts = load_constant_(CHANNEL_INDEX_SHIFTS_);
+        auto low = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(bytes, load_constant_(CHANNEL_INDEX_BYTES_[0])), shifts), 13);
+        auto high = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(bytes, load_constant_(CHANNEL_INDEX_BYTES_[1])), shifts), 13);
+        nibbles = _mm_packus_epi16(low, high);
+    }
+    else {
+        if(index_bits == 2) {
+            // 2 bits fields to 4 bits fields
+            indices = (indices | (indices << 16)) & 0x0000ffff0000ffffull;
+            indices = (indices | (indices << 8)) & 0x00ff00ff00ff00ffull;
+            indices = (indices | (indices << 4)) & 0x0f0f0f0f0f0f0f0full;
+            indices = (indices | (indices << 2)) & 0x3333333333333333ull;
+        }
+        auto bytes = _mm_cvtsi64_si128(static_cast<int64_t>(indices));
+        auto mask = _mm_set1_epi8(0x0f);
+        nibbles = _mm_unpacklo_epi8(_mm_and_si128(bytes, mask), _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+    }
+    return _mm_shuffle_epi8(load_constant_(BC7_WEIGHTS[index_bits - 2].data()), nibbles);
+}
+
+IMAGE_TARGET("ssse3") inline void decode_bc7_block_ssse3_(const uint8_t* block, uint8_t* dst, size_t row_pitch) noexcept {
+    BC7Block parsed;
+    if(!parsed.parse(block)) {
+        for(uint32_t y = 0; y < 4; ++y) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + y * row_pitch), _mm_setzero_si128());
+        }
+        return;
+    }
+    auto e0 = _mm_load_si128(reinterpret_cast<const __m128i*>(parsed.endpoints[0].data()));
+    auto e1 = _mm_load_si128(reinterpret_cast<const __m128i*>(parsed.endpoints[1].data()));
+    // subset * 4 per pixel
+    auto subsets = _mm_slli_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(parsed.subsets.data())), 2);
+    auto color_weights = bc7_weights_ssse3_(parsed.color_indices, parsed.color_index_bits);
+    auto alpha_weights = bc7_weights_ssse3_(parsed.alpha_indices, parsed.alpha_index_bits);
+    auto channels = _mm_set1_epi32(0x03020100);
+    auto alpha_mask = _mm_set1_epi32(static_cast<int32_t>(0xff000000));
+    auto rotation = load_constant_(BC7_SHUFFLES_[4 + parsed.rotation].data());
+    auto half = _mm_set1_epi16(32);
+    auto full = _mm_set1_epi8(64);
+
+    for(uint32_t y = 0; y < 4; ++y) {
+        auto expand = load_constant_(BC7_SHUFFLES_[y].data());
+        // endpoints of subset of each pixel
+        auto select = _mm_add_epi8(_mm_shuffle_epi8(subsets, expand), channels);
+        auto a = _mm_shuffle_epi8(e0, select);
+        auto b = _mm_shuffle_epi8(e1, select);
+        auto w = _mm_or_si128(_mm_andnot_si128(alpha_mask, _mm_shuffle_epi8(color_weights, expand)),
+                              _mm_and_si128(alpha_mask, _mm_shuffle_epi8(alpha_weights, expand)));
+        auto iw = _mm_sub_epi8(full, w);
+        // (64 - w) * e0 + w * e1 by one multiply-add of (e0, e1) and (64 - w, w) pairs
+        auto low = _mm_maddubs_epi16(_mm_unpacklo_epi8(a, b), _mm_unpacklo_epi8(iw, w));
+        auto high = _mm_maddubs_epi16(_mm_unpackhi_epi8(a, b), _mm_unpackhi_epi8(iw, w));
+        low = _mm_srli_epi16(_mm_add_epi16(low, half), 6);
+        high = _mm_srli_epi16(_mm_add_epi16(high, half), 6);
+        auto pixels = _mm_shuffle_epi8(_mm_packus_epi16(low, high), rotation);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + y * row_pitch), pixels);
+    }
+}
+
+IMAGE_TARGET("ssse3") inline void decode_bc7_row_ssse3(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        decode_bc7_block_ssse3_(blocks + i * 16, dst + i * 16, row_pitch);
+    }
+}
+
+#endif
+
+}
+
+}
\ No newline at end of file
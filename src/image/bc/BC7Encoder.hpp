@@ -0,0 +1,505 @@
+#pragma once
+
+#include "BC7.hpp"
+#include "Fit.hpp"
+
+namespace image {
+
+namespace bc {
+
+// BC7 block encoder
+// each tried (mode, partition, rotation, index selection) is fitted per subset: range fit along principal axis,
+// quantization with p-bits, nearest palette entry per pixel (exact decoder interpolation), optional least squares refinement
+// partitions are ranked by residual of line fit of their subsets, only best ranked ones are encoded
+
+struct BC7Settings {
+    // bit m: mode m is tried
+    uint32_t mode_mask;
+    // best ranked partitions fully encoded per mode with subsets
+    uint32_t partition_count;
+    // least squares iterations per subset
+    uint32_t refine_count;
+    // all p-bit combinations instead of nearest p-bit of each endpoint
+    bool exhaustive_pbits;
+    // rotations (modes 4 and 5) and index selection (mode 4)
+    bool try_rotations;
+
+    static BC7Settings make(Quality quality, bool has_alpha) noexcept {
+        switch(quality) {
+            case Quality::fast:
+                return BC7Settings{1u << 6, 1, 0, false, false};
+            case Quality::normal:
+                return BC7Settings{has_alpha ? (1u << 5) | (1u << 6) | (1u << 7) : (1u << 1) | (1u << 3) | (1u << 6), 4, 1, false, false};
+            default:
+                return BC7Settings{0xffu, 8, 2, true, true};
+        }
+    }
+};
+
+// endpoints of one subset sharing indices (channels [first, first + count))
+struct BC7Group {
+    uint32_t first;
+    uint32_t count;
+    uint32_t index_bits;
+    // field bits of each channel (without p-bit)
+    std::array<uint8_t, 4> bits;
+    // 0: none, 1: one per endpoint, 2: shared by both endpoints
+    uint32_t pbit_mode;
+};
+
+struct BC7GroupFit {
+    // quantized fields (without p-bit) of e0 and e1
+    std::array<std::array<uint8_t, 4>, 2> fields;
+    std::array<uint8_t, 2> pbits;
+    std::array<uint8_t, 16> indices;
+    uint32_t error;
+};
+
+// field value expanded to 8 bits (p-bit is LSB)
+constexpr uint32_t bc7_expand_(uint32_t field, uint32_t bits, int32_t pbit) noexcept {
+    if(pbit >= 0) {
+        field = (field << 1) | static_cast<uint32_t>(pbit);
+        ++bits;
+    }
+    return (field << (8 - bits)) | (field >> (2 * bits - 8));
+}
+
+// field whose expansion is nearest to each 8 bits value: [field bits - 4][p-bit + 1 (0: no p-bit)][value]
+constexpr auto BC7_QUANTIZE_ = []{
+    std::array<std::array<std::array<uint8_t, 256>, 3>, 5> table{};
+    for(uint32_t bits = 4; bits <= 8; ++bits) {
+        for(int32_t pbit = -1; pbit <= 1; ++pbit) {
+            if(bits == 8 && pbit >= 0) {
+                continue;
+            }
+            auto total_bits = bits + (pbit >= 0);
+            auto max = static_cast<int32_t>((1u << bits) - 1);
+            for(int32_t value = 0; value < 256; ++value) {
+                auto scaled = value * static_cast<int32_t>((1u << total_bits) - 1);
+                auto guess = pbit >= 0 ? (scaled / 255 - pbit) / 2 : scaled / 255;
+                int32_t best = 0, best_error = 256;
+                for(auto field = guess - 1; field <= guess + 2; ++field) {
+                    if(field < 0 || field > max) {
+                        continue;
+                    }
+                    auto error = static_cast<int32_t>(bc7_expand_(static_cast<uint32_t>(field), bits, pbit)) - value;
+                    error = error < 0 ? -error : error;
+                    if(error < best_error) {
+                        best_error = error;
+                        best = field;
+                    }
+                }
+                table[bits - 4][pbit + 1][value] = static_cast<uint8_t>(best);
+            }
+        }
+    }
+    return table;
+}();
+
+// field whose expansion is nearest to value (rounded to integer)
+inline uint32_t bc7_quantize_(float value, uint32_t bits, int32_t pbit) noexcept {
+    return BC7_QUANTIZE_[bits - 4][pbit + 1][static_cast<uint32_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f)];
+}
+
+// indices and error of quantized endpoints (fields and p-bits are set in fit)
+inline void bc7_assign_indices_(const BlockPixels& pixels, uint32_t mask, const BC7Group& group, BC7GroupFit& fit) noexcept {
+    int32_t e[2][4]{};
+    for(uint32_t k = 0; k < 2; ++k) {
+        for(uint32_t c = group.first; c < group.first + group.count; ++c) {
+            e[k][c] = static_cast<int32_t>(bc7_expand_(fit.fields[k][c], group.bits[c], group.pbit_mode ? fit.pbits[k] : -1));
+        }
+    }
+    const auto& weights = BC7_WEIGHTS[group.index_bits - 2];
+    uint32_t palette_size = 1u << group.index_bits;
+    int32_t palette[16][4]{};
+    for(uint32_t k = 0; k < palette_size; ++k) {
+        int32_t w = weights[k];
+        for(uint32_t c = group.first; c < group.first + group.count; ++c) {
+            palette[k][c] = ((64 - w) * e[0][c] + w * e[1][c] + 32) >> 6;
+        }
+    }
+
+    // palette is (nearly) uniform along e0 -> e1: nearest entry is next to projection of pixel
+    float direction[4]{};
+    float length = 0.0f;
+    for(uint32_t c = group.first; c < group.first + group.count; ++c) {
+        direction[c] = float(e[1][c] - e[0][c]);
+        length += direction[c] * direction[c];
+    }
+    float scale = length > 0.0f ? (palette_size - 1) / length : 0.0f;
+
+    fit.error = 0;
+    for(uint32_t i = 0; i < 16; ++i) {
+        if(!(mask & (1u << i))) {
+            continue;
+        }
+        float t = 0.0f;
+        for(uint32_t c = group.first; c < group.first + group.count; ++c) {
+            t += (pixels[i][c] - e[0][c]) * direction[c];
+        }
+        auto nearest = std::clamp(static_cast<int32_t>(t * scale + 0.5f), 0, static_cast<int32_t>(palette_size - 1));
+        uint32_t best_index = 0;
+        auto best_error = std::numeric_limits<uint32_t>::max();
+        for(auto k = std::max(nearest - 1, 0); k <= std::min(nearest + 1, static_cast<int32_t>(palette_size - 1)); ++k) {
+            uint32_t error = 0;
+            for(uint32_t c = group.first; c < group.first + group.count; ++c) {
+                auto d = int32_t(pixels[i][c]) - palette[k][c];
+                error += static_cast<uint32_t>(d * d);
+            }
+            if(error < best_error) {
+                best_error = error;
+                best_index = static_cast<uint32_t>(k);
+            }
+        }
+        fit.indices[i] = static_cast<uint8_t>(best_index);
+        fit.error += best_error;
+    }
+}
+
+// quantizes float endpoints (trying p-bits) and keeps result if it is better than fit
+inline void bc7_evaluate_(const BlockPixels& pixels, uint32_t mask, const BC7Group& group, const Vector4& e0, const Vector4& e1, bool exhaustive_pbits, BC7GroupFit& fit) noexcept {
+    const Vector4* endpoints[2] = {&e0, &e1};
+    auto quantize = [&](BC7GroupFit& candidate) {
+        for(uint32_t k = 0; k < 2; ++k) {
+            for(uint32_t c = group.first; c < group.first + group.count; ++c) {
+                candidate.fields[k][c] = static_cast<uint8_t>(bc7_quantize_((*endpoints[k])[c], group.bits[c], group.pbit_mode ? candidate.pbits[k] : -1));
+            }
+        }
+        bc7_assign_indices_(pixels, mask, group, candidate);
+        if(candidate.error < fit.error) {
+            fit = candidate;
+        }
+    };
+    // quantization error of endpoint k with p-bit
+    auto pbit_error = [&](uint32_t k, int32_t pbit) {
+        float error = 0.0f;
+        for(uint32_t c = group.first; c < group.first + group.count; ++c) {
+            auto value = (*endpoints[k])[c];
+            auto d = float(bc7_expand_(bc7_quantize_(value, group.bits[c], pbit), group.bits[c], pbit)) - value;
+            error += d * d;
+        }
+        return error;
+    };
+
+    BC7GroupFit candidate = fit;
+    if(group.pbit_mode == 0) {
+        candidate.pbits = {0, 0};
+        quantize(candidate);
+    }
+    else if(exhaustive_pbits) {
+        for(uint32_t combination = 0; combination < 4; ++combination) {
+            candidate.pbits = {static_cast<uint8_t>(combination & 1), static_cast<uint8_t>(combination >> 1)};
+            if(group.pbit_mode == 2 && candidate.pbits[0] != candidate.pbits[1]) {
+                continue;
+            }
+            quantize(candidate);
+        }
+    }
+    else if(group.pbit_mode == 1) {
+        for(uint32_t k = 0; k < 2; ++k) {
+            candidate.pbits[k] = pbit_error(k, 1) < pbit_error(k, 0);
+        }
+        quantize(candidate);
+    }
+    else {
+        uint8_t pbit = pbit_error(0, 1) + pbit_error(1, 1) < pbit_error(0, 0) + pbit_error(1, 0);
+        candidate.pbits = {pbit, pbit};
+        quantize(candidate);
+    }
+}
+
+inline BC7GroupFit bc7_fit_group_(const BlockPixels& pixels, uint32_t mask, const BC7Group& group, const BC7Settings& settings) noexcept {
+    BC7GroupFit fit{};
+    fit.error = std::numeric_limits<uint32_t>::max();
+
+    Vector4 e0{}, e1{};
+    if(group.first == 0) {
+        auto line = fit_line_(pixels, mask, group.count);
+        line_endpoints_(pixels, mask, group.count, line, e0, e1);
+    }
+    else {
+        // alpha of modes 4 and 5
+        float low = 255.0f, high = 0.0f;
+        for(uint32_t i = 0; i < 16; ++i) {
+            if(mask & (1u << i)) {
+                low = std::min<float>(low, pixels[i][group.first]);
+                high = std::max<float>(high, pixels[i][group.first]);
+            }
+        }
+        e0[group.first] = low;
+        e1[group.first] = high;
+    }
+    bc7_evaluate_(pixels, mask, group, e0, e1, settings.exhaustive_pbits, fit);
+
+    const auto& weights = BC7_WEIGHTS[group.index_bits - 2];
+    for(uint32_t iteration = 0; iteration < settings.refine_count && fit.error > 0; ++iteration) {
+        float t[16]{};
+        for(uint32_t i = 0; i < 16; ++i) {
+            t[i] = weights[fit.indices[i]] / 64.0f;
+        }
+        if(!least_squares_endpoints_(pixels, mask, t, group.first, group.count, e0, e1)) {
+            break;
+        }
+        auto error = fit.error;
+        bc7_evaluate_(pixels, mask, group, e0, e1, settings.exhaustive_pbits, fit);
+        if(fit.error == error) {
+            break;
+        }
+    }
+    return fit;
+}
+
+// best encoding found so far
+struct BC7Candidate {
+    uint32_t mode;
+    uint32_t partition;
+    uint32_t rotation;
+    uint32_t index_selection;
+    // color (and alpha unless mode 4 or 5) fit of each subset, alpha fit of modes 4 and 5
+    std::array<BC7GroupFit, 3> subsets;
+    BC7GroupFit alpha;
+    uint32_t error;
+};
+
+// subset of each pixel
+inline std::array<uint8_t, 16> bc7_subsets_(uint32_t subset_count, uint32_t partition) noexcept {
+    if(subset_count == 2) {
+        return BC7_SUBSETS_2[partition];
+    }
+    if(subset_count == 3) {
+        return BC7_PARTITIONS_3[partition];
+    }
+    return {};
+}
+
+inline std::array<uint32_t, 3> bc7_subset_masks_(uint32_t subset_count, uint32_t partition) noexcept {
+    std::array<uint32_t, 3> masks{};
+    auto subsets = bc7_subsets_(subset_count, partition);
+    for(uint32_t i = 0; i < 16; ++i) {
+        masks[subsets[i]] |= 1u << i;
+    }
+    return masks;
+}
+
+// pixels: rotated for rotation of candidate
+inline void bc7_encode_mode_(const BlockPixels& pixels, uint32_t mode_index, uint32_t partition, uint32_t rotation, uint32_t index_selection, const BC7Settings& settings, BC7Candidate& best) noexcept {
+    const auto& mode = BC7_MODES[mode_index];
+    bool has_separate_alpha = mode.secondary_index_bits != 0;
+    BC7Candidate candidate{mode_index, partition, rotation, index_selection, {}, {}, 0};
+
+    BC7Group group{};
+    group.first = 0;
+    group.count = (mode.alpha_bits && !has_separate_alpha) ? 4 : 3;
+    group.index_bits = index_selection ? mode.secondary_index_bits : mode.index_bits;
+    group.bits = {mode.color_bits, mode.color_bits, mode.color_bits, mode.alpha_bits};
+    group.pbit_mode = mode.endpoint_pbits ? 1 : mode.shared_pbits ? 2 : 0;
+
+    auto masks = bc7_subset_masks_(mode.subset_count, partition);
+    for(uint32_t s = 0; s < mode.subset_count; ++s) {
+        candidate.subsets[s] = bc7_fit_group_(pixels, masks[s], group, settings);
+        candidate.error += candidate.subsets[s].error;
+        if(candidate.error >= best.error) {
+            return;
+        }
+    }
+
+    if(has_separate_alpha) {
+        BC7Group alpha_group{3, 1, index_selection ? mode.index_bits : mode.secondary_index_bits, {0, 0, 0, mode.alpha_bits}, 0};
+        candidate.alpha = bc7_fit_group_(pixels, 0xffffu, alpha_group, settings);
+        candidate.error += candidate.alpha.error;
+    }
+    else if(!mode.alpha_bits) {
+        // alpha is decoded as 255
+        for(uint32_t i = 0; i < 16; ++i) {
+            auto d = 255 - int32_t(pixels[i][3]);
+            candidate.error += static_cast<uint32_t>(d * d);
+        }
+    }
+
+    if(candidate.error < best.error) {
+        best = candidate;
+    }
+}
+
+// LSB first bit writer of 128 bits block
+struct BC7BitWriter {
+    uint64_t low = 0;
+    uint64_t high = 0;
+    uint32_t position = 0;
+
+    // count <= 32
+    void write(uint64_t value, uint32_t count) noexcept {
+        if(position < 64) {
+            low |= value << position;
+            if(position + count > 64) {
+                high |= value >> (64 - position);
+            }
+        }
+        else {
+            high |= value << (position - 64);
+        }
+        position += count;
+    }
+};
+
+// swaps endpoints of groups whose anchor index has MSB set (the bit is not stored), then packs fields
+inline void bc7_pack_(BC7Candidate& candidate, uint8_t* dst) noexcept {
+    const auto& mode = BC7_MODES[candidate.mode];
+    bool has_separate_alpha = mode.secondary_index_bits != 0;
+    auto color_index_bits = candidate.index_selection ? mode.secondary_index_bits : mode.index_bits;
+    auto alpha_index_bits = candidate.index_selection ? mode.index_bits : mode.secondary_index_bits;
+
+    uint32_t anchors[3] = {0, 16, 16};
+    if(mode.subset_count == 2) {
+        anchors[1] = BC7_ANCHORS_2[candidate.partition];
+    }
+    else if(mode.subset_count == 3) {
+        anchors[1] = BC7_ANCHORS_3[0][candidate.partition];
+        anchors[2] = BC7_ANCHORS_3[1][candidate.partition];
+    }
+    auto subsets = bc7_subsets_(mode.subset_count, candidate.partition);
+    auto flip = [](BC7GroupFit& fit, uint32_t index_bits, const std::array<uint8_t, 16>& subsets, uint32_t subset) {
+        std::swap(fit.fields[0], fit.fields[1]);
+        std::swap(fit.pbits[0], fit.pbits[1]);
+        auto max = static_cast<uint8_t>((1u << index_bits) - 1);
+        for(uint32_t i = 0; i < 16; ++i) {
+            if(subsets[i] == subset) {
+                fit.indices[i] = max - fit.indices[i];
+            }
+        }
+    };
+    for(uint32_t s = 0; s < mode.subset_count; ++s) {
+        auto& fit = candidate.subsets[s];
+        if(fit.indices[anchors[s]] >> (color_index_bits - 1)) {
+            flip(fit, color_index_bits, subsets, s);
+        }
+    }
+    if(has_separate_alpha && (candidate.alpha.indices[0] >> (alpha_index_bits - 1))) {
+        flip(candidate.alpha, alpha_index_bits, subsets, 0);
+    }
+
+    BC7BitWriter writer;
+    writer.write(uint64_t(1) << candidate.mode, candidate.mode + 1);
+    writer.write(candidate.partition, mode.partition_bits);
+    writer.write(candidate.rotation, mode.rotation_bits);
+    writer.write(candidate.index_selection, mode.index_selection_bits);
+    // endpoint e = subset * 2 + k
+    for(uint32_t c = 0; c < 3; ++c) {
+        for(uint32_t e = 0; e < mode.subset_count * 2u; ++e) {
+            writer.write(candidate.subsets[e / 2].fields[e % 2][c], mode.color_bits);
+        }
+    }
+    for(uint32_t e = 0; e < mode.subset_count * 2u && mode.alpha_bits; ++e) {
+        const auto& fit = has_separate_alpha ? candidate.alpha : candidate.subsets[e / 2];
+        writer.write(fit.fields[e % 2][3], mode.alpha_bits);
+    }
+    for(uint32_t e = 0; e < mode.subset_count * 2u && mode.endpoint_pbits; ++e) {
+        writer.write(candidate.subsets[e / 2].pbits[e % 2], 1);
+    }
+    for(uint32_t s = 0; s < mode.subset_count && mode.shared_pbits; ++s) {
+        writer.write(candidate.subsets[s].pbits[0], 1);
+    }
+
+    auto write_indices = [&](const auto& indices, uint32_t index_bits) {
+        for(uint32_t i = 0; i < 16; ++i) {
+            bool is_anchor = i == anchors[0] || i == anchors[1] || i == anchors[2];
+            writer.write(indices(i), index_bits - is_anchor);
+        }
+    };
+    // primary indices are color unless index selection is set
+    auto color = [&](uint32_t i) { return candidate.subsets[subsets[i]].indices[i]; };
+    auto alpha = [&](uint32_t i) { return candidate.alpha.indices[i]; };
+    if(candidate.index_selection) {
+        write_indices(alpha, alpha_index_bits);
+        write_indices(color, color_index_bits);
+    }
+    else {
+        write_indices(color, color_index_bits);
+        if(has_separate_alpha) {
+            write_indices(alpha, alpha_index_bits);
+        }
+    }
+
+    io::store_le(dst, writer.low);
+    io::store_le(dst + 8, writer.high);
+}
+
+inline void encode_bc7_block(const BlockPixels& pixels, Quality quality, uint8_t* dst) noexcept {
+    bool has_alpha = false;
+    for(const auto& pixel : pixels) {
+        has_alpha |= pixel[3] != 255;
+    }
+    auto settings = BC7Settings::make(quality, has_alpha);
+
+    BC7Candidate best{};
+    best.error = std::numeric_limits<uint32_t>::max();
+
+    // residual estimates are shared by modes with same subset count and channels ([subset count - 2][has alpha channel])
+    std::array<std::array<std::array<float, 64>, 2>, 2> residuals{};
+    std::array<std::array<bool, 2>, 2> has_residuals{};
+    std::array<Moments, 16> pixel_moments{};
+    Moments total_moments{};
+    bool has_moments = false;
+
+    for(uint32_t mode_index = 0; mode_index < 8 && best.error > 0; ++mode_index) {
+        if(!(settings.mode_mask & (1u << mode_index))) {
+            continue;
+        }
+        const auto& mode = BC7_MODES[mode_index];
+
+        if(mode.subset_count == 1) {
+            bool has_rotations = settings.try_rotations && mode.rotation_bits;
+            for(uint32_t rotation = 0; rotation < (has_rotations ? 4u : 1u); ++rotation) {
+                auto rotated = pixels;
+                if(rotation) {
+                    for(auto& pixel : rotated) {
+                        std::swap(pixel[3], pixel[rotation - 1]);
+                    }
+                }
+                for(uint32_t index_selection = 0; index_selection <= uint32_t(has_rotations && mode.index_selection_bits); ++index_selection) {
+                    bc7_encode_mode_(rotated, mode_index, 0, rotation, index_selection, settings, best);
+                }
+            }
+            continue;
+        }
+
+        uint32_t partition_count = 1u << mode.partition_bits;
+        uint32_t channel_count = mode.alpha_bits ? 4 : 3;
+        auto& residual = residuals[mode.subset_count - 2][channel_count - 3];
+        if(!has_residuals[mode.subset_count - 2][channel_count - 3]) {
+            has_residuals[mode.subset_count - 2][channel_count - 3] = true;
+            if(!has_moments) {
+                has_moments = true;
+                for(uint32_t i = 0; i < 16; ++i) {
+                    pixel_moments[i] = Moments::of(pixels[i]);
+                    total_moments += pixel_moments[i];
+                }
+            }
+            for(uint32_t partition = 0; partition < 64; ++partition) {
+                auto masks = bc7_subset_masks_(mode.subset_count, partition);
+                // subset 0 is the rest of block
+                auto rest = total_moments;
+                residual[partition] = 0.0f;
+                for(uint32_t s = 1; s < mode.subset_count; ++s) {
+                    auto moments = subset_moments_(pixel_moments, masks[s]);
+                    residual[partition] += moments.residual(channel_count);
+                    rest = rest - moments;
+                }
+                residual[partition] += rest.residual(channel_count);
+            }
+        }
+        std::array<uint8_t, 64> order{};
+        std::iota(order.begin(), order.begin() + partition_count, uint8_t(0));
+        auto selected = std::min(settings.partition_count, partition_count);
+        std::partial_sort(order.begin(), order.begin() + selected, order.begin() + partition_count, [&](uint8_t a, uint8_t b) { return residual[a] < residual[b]; });
+        for(uint32_t k = 0; k < selected; ++k) {
+            bc7_encode_mode_(pixels, mode_index, order[k], 0, 0, settings, best);
+        }
+    }
+
+    bc7_pack_(best, dst);
+}
+
+}
+
+}
\ No newline at end of file
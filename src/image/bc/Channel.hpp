@@ -0,0 +1,215 @@
+#pragma once
+
+#include "utils.hpp"
+
+namespace image {
+
+namespace bc {
+
+// single channel block (BC4, channels of BC5, alpha of BC3)
+// 2 endpoints and 16 3 bits indices into 8 values: a0 > a1 -> 6 interpolated values, otherwise 4 interpolated values, 0 and max
+// interpolation is rounded to nearest
+// SIGNED: endpoints and output are two's complement SNORM, -128 is read as -127
+// (computed as unsigned with offset 127, so that both variants share kernels)
+
+template<bool SIGNED>
+inline void channel_endpoints_(const uint8_t* block, int32_t& a0, int32_t& a1, int32_t& high) noexcept {
+    if constexpr(SIGNED) {
+        a0 = std::max<int32_t>(static_cast<int8_t>(block[0]), -127) + 127;
+        a1 = std::max<int32_t>(static_cast<int8_t>(block[1]), -127) + 127;
+        high = 254;
+    }
+    else {
+        a0 = block[0];
+        a1 = block[1];
+        high = 255;
+    }
+}
+
+// 8 values of (offset) endpoints
+inline std::array<int32_t, 8> channel_palette_(int32_t a0, int32_t a1, int32_t high) noexcept {
+    std::array<int32_t, 8> palette{a0, a1};
+    if(a0 > a1) {
+        for(int32_t i = 1; i <= 6; ++i) {
+            palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+        }
+    }
+    else {
+        for(int32_t i = 1; i <= 4; ++i) {
+            palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = high;
+    }
+    return palette;
+}
+
+template<bool SIGNED>
+inline void channel_values_scalar_(const uint8_t* block, uint8_t* values) noexcept {
+    int32_t a0{}, a1{}, high{};
+    channel_endpoints_<SIGNED>(block, a0, a1, high);
+    auto palette = channel_palette_(a0, a1, high);
+
+    uint64_t bits = 0;
+    for(uint32_t k = 0; k < 6; ++k) {
+        bits |= uint64_t(block[2 + k]) << (8 * k);
+    }
+    for(uint32_t i = 0; i < 16; ++i) {
+        auto value = palette[(bits >> (3 * i)) & 7];
+        values[i] = static_cast<uint8_t>(SIGNED ? value - 127 : value);
+    }
+}
+
+template<bool SIGNED>
+inline void decode_bc4_row_scalar(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        uint8_t values[16];
+        channel_values_scalar_<SIGNED>(blocks + i * 8, values);
+        for(uint32_t y = 0; y < 4; ++y) {
+            std::memcpy(dst + y * row_pitch + i * 4, values + y * 4, 4);
+        }
+    }
+}
+
+template<bool SIGNED>
+inline void decode_bc5_row_scalar(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        uint8_t red[16], green[16];
+        channel_values_scalar_<SIGNED>(blocks + i * 16, red);
+        channel_values_scalar_<SIGNED>(blocks + i * 16 + 8, green);
+        for(uint32_t y = 0; y < 4; ++y) {
+            auto row = dst + y * row_pitch + i * 8;
+            for(uint32_t x = 0; x < 4; ++x) {
+                row[x * 2] = red[y * 4 + x];
+                row[x * 2 + 1] = green[y * 4 + x];
+            }
+        }
+    }
+}
+
+#if defined(IMAGE_SIMD_X86)
+
+// palette in 16 bits lanes: (w0 * a0 + w1 * a1 + bias) * reciprocal >> 16 | max lane
+// [0]: a0 <= a1 (/ 5), [1]: a0 > a1 (/ 7)
+alignas(16) constexpr int16_t CHANNEL_PALETTE_[2][5][8] = {
+    {
+        {5, 0, 4, 3, 2, 1, 0, 0},
+        {0, 5, 1, 2, 3, 4, 0, 0},
+        {2, 2, 2, 2, 2, 2, 2, 2},
+        {13108, 13108, 13108, 13108, 13108, 13108, 13108, 13108},
+        {0, 0, 0, 0, 0, 0, 0, -1},
+    },
+    {
+        {7, 0, 6, 5, 4, 3, 2, 1},
+        {0, 7, 1, 2, 3, 4, 5, 6},
+        {3, 3, 3, 3, 3, 3, 3, 3},
+        {9363, 9363, 9363, 9363, 9363, 9363, 9363, 9363},
+        {0, 0, 0, 0, 0, 0, 0, 0},
+    },
+};
+
+// 3 bits index i is at bit 3 * i of bytes 2..7: bytes containing it are gathered to 16 bits lane,
+// and multiplied to move it to top 3 bits
+alignas(16) constexpr uint8_t CHANNEL_INDEX_BYTES_[2][16] = {
+    {2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5},
+    {5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, 0x80, 7, 0x80},
+};
+alignas(16) constexpr int16_t CHANNEL_INDEX_SHIFTS_[8] = {1 << 13, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8};
+
+template<typename T>
+IMAGE_TARGET("sse2") inline __m128i load_constant_(const T* p) noexcept {
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// 16 values of block in pixel order
+template<bool SIGNED>
+IMAGE_TARGET("ssse3") inline __m128i channel_values_ssse3_(const uint8_t* block) noexcept {
+    int32_t a0{}, a1{}, high{};
+    channel_endpoints_<SIGNED>(block, a0, a1, high);
+
+    const auto& constants = CHANNEL_PALETTE_[a0 > a1];
+    auto palette = _mm_add_epi16(_mm_mullo_epi16(_mm_set1_epi16(static_cast<int16_t>(a0)), load_constant_(constants[0])),
+                                 _mm_mullo_epi16(_mm_set1_epi16(static_cast<int16_t>(a1)), load_constant_(constants[1])));
+    palette = _mm_mulhi_epu16(_mm_add_epi16(palette, load_constant_(constants[2])), load_constant_(constants[3]));
+    palette = _mm_or_si128(palette, _mm_and_si128(load_constant_(constants[4]), _mm_set1_epi16(static_cast<int16_t>(high))));
+    palette = _mm_packus_epi16(palette, palette);
+
+    auto bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+    auto shifts = load_constant_(CHANNEL_INDEX_SHIFTS_);
+    auto low = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(bytes, load_constant_(CHANNEL_INDEX_BYTES_[0])), shifts), 13);
+    auto high_indices = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(bytes, load_constant_(CHANNEL_INDEX_BYTES_[1])), shifts), 13);
+
+    auto values = _mm_shuffle_epi8(palette, _mm_packus_epi16(low, high_indices));
+    if constexpr(SIGNED) {
+        values = _mm_sub_epi8(values, _mm_set1_epi8(127));
+    }
+    return values;
+}
+
+// 4 blocks are transposed so that each row is one 16 bytes store
+template<bool SIGNED>
+IMAGE_TARGET("ssse3") inline void decode_bc4_row_ssse3(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    uint32_t i = 0;
+    for(; i + 4 <= block_count; i += 4) {
+        auto v0 = channel_values_ssse3_<SIGNED>(blocks + i * 8);
+        auto v1 = channel_values_ssse3_<SIGNED>(blocks + i * 8 + 8);
+        auto v2 = channel_values_ssse3_<SIGNED>(blocks + i * 8 + 16);
+        auto v3 = channel_values_ssse3_<SIGNED>(blocks + i * 8 + 24);
+        auto t0 = _mm_unpacklo_epi32(v0, v1);
+        auto t1 = _mm_unpackhi_epi32(v0, v1);
+        auto t2 = _mm_unpacklo_epi32(v2, v3);
+        auto t3 = _mm_unpackhi_epi32(v2, v3);
+        auto row = dst + i * 4;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row), _mm_unpacklo_epi64(t0, t2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + row_pitch), _mm_unpackhi_epi64(t0, t2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + row_pitch * 2), _mm_unpacklo_epi64(t1, t3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + row_pitch * 3), _mm_unpackhi_epi64(t1, t3));
+    }
+    for(; i < block_count; ++i) {
+        alignas(16) uint8_t values[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(values), channel_values_ssse3_<SIGNED>(blocks + i * 8));
+        for(uint32_t y = 0; y < 4; ++y) {
+            std::memcpy(dst + y * row_pitch + i * 4, values + y * 4, 4);
+        }
+    }
+}
+
+template<bool SIGNED>
+IMAGE_TARGET("ssse3") inline void decode_bc5_row_ssse3(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    uint32_t i = 0;
+    // 2 blocks -> 16 bytes per row
+    for(; i + 2 <= block_count; i += 2) {
+        auto block = blocks + i * 16;
+        auto red0 = channel_values_ssse3_<SIGNED>(block);
+        auto green0 = channel_values_ssse3_<SIGNED>(block + 8);
+        auto red1 = channel_values_ssse3_<SIGNED>(block + 16);
+        auto green1 = channel_values_ssse3_<SIGNED>(block + 24);
+        // rows 0, 1 and rows 2, 3 of each block
+        auto rg0_low = _mm_unpacklo_epi8(red0, green0);
+        auto rg0_high = _mm_unpackhi_epi8(red0, green0);
+        auto rg1_low = _mm_unpacklo_epi8(red1, green1);
+        auto rg1_high = _mm_unpackhi_epi8(red1, green1);
+        auto row = dst + i * 8;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row), _mm_unpacklo_epi64(rg0_low, rg1_low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + row_pitch), _mm_unpackhi_epi64(rg0_low, rg1_low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + row_pitch * 2), _mm_unpacklo_epi64(rg0_high, rg1_high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + row_pitch * 3), _mm_unpackhi_epi64(rg0_high, rg1_high));
+    }
+    for(; i < block_count; ++i) {
+        auto block = blocks + i * 16;
+        auto red = channel_values_ssse3_<SIGNED>(block);
+        auto green = channel_values_ssse3_<SIGNED>(block + 8);
+        alignas(16) uint8_t rg[32];
+        _mm_store_si128(reinterpret_cast<__m128i*>(rg), _mm_unpacklo_epi8(red, green));
+        _mm_store_si128(reinterpret_cast<__m128i*>(rg + 16), _mm_unpackhi_epi8(red, green));
+        for(uint32_t y = 0; y < 4; ++y) {
+            std::memcpy(dst + y * row_pitch + i * 8, rg + y * 8, 8);
+        }
+    }
+}
+
+#endif
+
+}
+
+}
\ No newline at end of file
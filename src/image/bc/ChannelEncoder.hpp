@@ -0,0 +1,179 @@
+#pragma once
+
+#include "Channel.hpp"
+#include "Fit.hpp"
+
+namespace image {
+
+namespace bc {
+
+// single channel block encoder (BC4, channels of BC5, alpha of BC3)
+// values are in offset domain of decoder (0 .. 255 unsigned, 0 .. 254 for SNORM with -128 clamped to -127)
+// both palette modes are evaluated with exact decoder palette, so reported error is exact
+
+struct ChannelFit {
+    int32_t a0;
+    int32_t a1;
+    uint64_t indices;
+    uint32_t error;
+};
+
+// nearest palette value of each pixel
+inline ChannelFit evaluate_channel_(const int32_t* values, int32_t a0, int32_t a1, int32_t high) noexcept {
+    ChannelFit fit{a0, a1, 0, 0};
+    auto palette = channel_palette_(a0, a1, high);
+    for(uint32_t i = 0; i < 16; ++i) {
+        uint32_t best_index = 0;
+        auto best_error = std::numeric_limits<int32_t>::max();
+        for(uint32_t k = 0; k < 8; ++k) {
+            auto d = values[i] - palette[k];
+            if(d * d < best_error) {
+                best_error = d * d;
+                best_index = k;
+            }
+        }
+        fit.indices |= uint64_t(best_index) << (3 * i);
+        fit.error += static_cast<uint32_t>(best_error);
+    }
+    return fit;
+}
+
+// endpoints by least squares for indices of fit (a0 > a1: 6 interpolated values, otherwise 4 and fixed 0 and max)
+inline ChannelFit refine_channel_(const int32_t* values, const ChannelFit& fit, int32_t high) noexcept {
+    bool is_eight = fit.a0 > fit.a1;
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax = 0.0f, bx = 0.0f;
+    for(uint32_t i = 0; i < 16; ++i) {
+        auto index = static_cast<uint32_t>((fit.indices >> (3 * i)) & 7);
+        float t{};
+        if(index <= 1) {
+            t = static_cast<float>(index);
+        }
+        else if(is_eight) {
+            t = (index - 1) / 7.0f;
+        }
+        else if(index <= 5) {
+            t = (index - 1) / 5.0f;
+        }
+        else {
+            continue;
+        }
+        auto a = 1.0f - t;
+        aa += a * a;
+        ab += a * t;
+        bb += t * t;
+        ax += a * values[i];
+        bx += t * values[i];
+    }
+    auto determinant = aa * bb - ab * ab;
+    if(std::abs(determinant) < 1e-6f) {
+        return fit;
+    }
+    auto a0 = std::clamp(static_cast<int32_t>(std::lround((ax * bb - bx * ab) / determinant)), 0, high);
+    auto a1 = std::clamp(static_cast<int32_t>(std::lround((bx * aa - ax * ab) / determinant)), 0, high);
+    // keep palette mode
+    if(is_eight != (a0 > a1)) {
+        std::swap(a0, a1);
+        if(is_eight != (a0 > a1)) {
+            return fit;
+        }
+    }
+    auto refined = evaluate_channel_(values, a0, a1, high);
+    return refined.error < fit.error ? refined : fit;
+}
+
+// tries endpoints around fit while error decreases
+inline ChannelFit search_channel_(const int32_t* values, ChannelFit fit, int32_t high) noexcept {
+    bool is_eight = fit.a0 > fit.a1;
+    for(bool improved = true; improved && fit.error > 0;) {
+        improved = false;
+        for(int32_t d0 = -2; d0 <= 2; ++d0) {
+            for(int32_t d1 = -2; d1 <= 2; ++d1) {
+                auto a0 = fit.a0 + d0;
+                auto a1 = fit.a1 + d1;
+                if((d0 == 0 && d1 == 0) || a0 < 0 || a1 < 0 || a0 > high || a1 > high || is_eight != (a0 > a1)) {
+                    continue;
+                }
+                auto candidate = evaluate_channel_(values, a0, a1, high);
+                if(candidate.error < fit.error) {
+                    fit = candidate;
+                    improved = true;
+                }
+            }
+        }
+    }
+    return fit;
+}
+
+inline ChannelFit fit_channel_(const int32_t* values, int32_t high, Quality quality) noexcept {
+    int32_t low_value = high, high_value = 0;
+    // range without extremes which 6 values mode has for free
+    int32_t inner_low = high, inner_high = 0;
+    for(uint32_t i = 0; i < 16; ++i) {
+        low_value = std::min(low_value, values[i]);
+        high_value = std::max(high_value, values[i]);
+        if(values[i] != 0 && values[i] != high) {
+            inner_low = std::min(inner_low, values[i]);
+            inner_high = std::max(inner_high, values[i]);
+        }
+    }
+
+    auto best = evaluate_channel_(values, high_value, low_value, high);
+    if(best.error == 0 || quality == Quality::fast) {
+        return best;
+    }
+    best = refine_channel_(values, best, high);
+
+    if(inner_low <= inner_high && (low_value == 0 || high_value == high)) {
+        auto six = refine_channel_(values, evaluate_channel_(values, inner_low, inner_high, high), high);
+        if(quality == Quality::high) {
+            six = search_channel_(values, six, high);
+        }
+        if(six.error < best.error) {
+            best = six;
+        }
+    }
+    if(quality == Quality::high) {
+        best = search_channel_(values, best, high);
+    }
+    return best;
+}
+
+// values: 16 bytes as stored in source (two's complement for SIGNED)
+template<bool SIGNED>
+inline void encode_channel_block_(const uint8_t* values, Quality quality, uint8_t* dst) noexcept {
+    int32_t offset_values[16];
+    for(uint32_t i = 0; i < 16; ++i) {
+        offset_values[i] = SIGNED ? std::max<int32_t>(static_cast<int8_t>(values[i]), -127) + 127 : values[i];
+    }
+    auto fit = fit_channel_(offset_values, SIGNED ? 254 : 255, quality);
+
+    dst[0] = static_cast<uint8_t>(SIGNED ? fit.a0 - 127 : fit.a0);
+    dst[1] = static_cast<uint8_t>(SIGNED ? fit.a1 - 127 : fit.a1);
+    for(uint32_t k = 0; k < 6; ++k) {
+        dst[2 + k] = static_cast<uint8_t>(fit.indices >> (8 * k));
+    }
+}
+
+template<bool SIGNED>
+inline void encode_bc4_block(const BlockPixels& pixels, Quality quality, uint8_t* dst) noexcept {
+    uint8_t values[16];
+    for(uint32_t i = 0; i < 16; ++i) {
+        values[i] = pixels[i][0];
+    }
+    encode_channel_block_<SIGNED>(values, quality, dst);
+}
+
+template<bool SIGNED>
+inline void encode_bc5_block(const BlockPixels& pixels, Quality quality, uint8_t* dst) noexcept {
+    uint8_t red[16], green[16];
+    for(uint32_t i = 0; i < 16; ++i) {
+        red[i] = pixels[i][0];
+        green[i] = pixels[i][1];
+    }
+    encode_channel_block_<SIGNED>(red, quality, dst);
+    encode_channel_block_<SIGNED>(green, quality, dst + 8);
+}
+
+}
+
+}
\ No newline at end of file
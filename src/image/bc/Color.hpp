@@ -0,0 +1,291 @@
+#pragma once
+
+#include "Channel.hpp"
+
+namespace image {
+
+namespace bc {
+
+// color block (BC1, color of BC2 and BC3) to RGBA8
+// 2 RGB565 endpoints and 16 2 bits indices into 4 colors: c0, c1, (2 c0 + c1) / 3, (c0 + 2 c1) / 3
+// BC1 with c0 <= c1 uses three colors: c0, c1, (c0 + c1) / 2 and transparent black
+// endpoints are expanded by bit replication, interpolation is rounded to nearest
+
+inline void color_palette_scalar_(const uint8_t* block, bool is_bc1, uint8_t* palette) noexcept {
+    auto c0 = io::load_le<uint16_t>(block);
+    auto c1 = io::load_le<uint16_t>(block + 2);
+    auto expand = [](uint32_t c, uint8_t* color) {
+        uint32_t r = c >> 11;
+        uint32_t g = (c >> 5) & 0x3f;
+        uint32_t b = c & 0x1f;
+        color[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+        color[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+        color[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+        color[3] = 255;
+    };
+    expand(c0, palette);
+    expand(c1, palette + 4);
+
+    if(is_bc1 && c0 <= c1) {
+        for(uint32_t k = 0; k < 3; ++k) {
+            palette[8 + k] = static_cast<uint8_t>((palette[k] + palette[4 + k] + 1) / 2);
+            palette[12 + k] = 0;
+        }
+        palette[11] = 255;
+        palette[15] = 0;
+    }
+    else {
+        for(uint32_t k = 0; k < 3; ++k) {
+            palette[8 + k] = static_cast<uint8_t>((2 * palette[k] + palette[4 + k] + 1) / 3);
+            palette[12 + k] = static_cast<uint8_t>((palette[k] + 2 * palette[4 + k] + 1) / 3);
+        }
+        palette[11] = 255;
+        palette[15] = 255;
+    }
+}
+
+inline void decode_color_block_scalar_(const uint8_t* block, bool is_bc1, uint8_t* dst, size_t row_pitch) noexcept {
+    uint8_t palette[16];
+    color_palette_scalar_(block, is_bc1, palette);
+    for(uint32_t y = 0; y < 4; ++y) {
+        uint32_t bits = block[4 + y];
+        for(uint32_t x = 0; x < 4; ++x) {
+            std::memcpy(dst + y * row_pitch + x * 4, palette + ((bits >> (2 * x)) & 3) * 4, 4);
+        }
+    }
+}
+
+inline void decode_bc1_row_scalar(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        decode_color_block_scalar_(blocks + i * 8, true, dst + i * 16, row_pitch);
+    }
+}
+
+// explicit 4 bits alpha
+inline void decode_bc2_row_scalar(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        auto block = blocks + i * 16;
+        decode_color_block_scalar_(block + 8, false, dst + i * 16, row_pitch);
+        for(uint32_t p = 0; p < 16; ++p) {
+            auto alpha = (block[p / 2] >> ((p & 1) * 4)) & 0x0f;
+            dst[(p / 4) * row_pitch + i * 16 + (p % 4) * 4 + 3] = static_cast<uint8_t>(alpha * 17);
+        }
+    }
+}
+
+// alpha is channel block
+inline void decode_bc3_row_scalar(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        auto block = blocks + i * 16;
+        decode_color_block_scalar_(block + 8, false, dst + i * 16, row_pitch);
+        uint8_t alpha[16];
+        channel_values_scalar_<false>(block, alpha);
+        for(uint32_t p = 0; p < 16; ++p) {
+            dst[(p / 4) * row_pitch + i * 16 + (p % 4) * 4 + 3] = alpha[p];
+        }
+    }
+}
+
+#if defined(IMAGE_SIMD_X86)
+
+// byte shuffle which maps one row of 4 indices (byte of color block) to 4 RGBA8 palette entries
+alignas(16) constexpr auto COLOR_SHUFFLES_ = []{
+    std::array<std::array<uint8_t, 16>, 256> shuffles{};
+    for(uint32_t bits = 0; bits < 256; ++bits) {
+        for(uint32_t x = 0; x < 4; ++x) {
+            for(uint32_t k = 0; k < 4; ++k) {
+                shuffles[bits][x * 4 + k] = static_cast<uint8_t>(((bits >> (2 * x)) & 3) * 4 + k);
+            }
+        }
+    }
+    return shuffles;
+}();
+
+// moves 4 alpha values of row y (bytes 4 y .. 4 y + 3) to alpha bytes of 4 RGBA8 pixels
+alignas(16) constexpr auto ALPHA_SHUFFLES_ = []{
+    std::array<std::array<uint8_t, 16>, 4> shuffles{};
+    for(uint32_t y = 0; y < 4; ++y) {
+        for(uint32_t i = 0; i < 16; ++i) {
+            shuffles[y][i] = (i % 4 == 3) ? static_cast<uint8_t>(y * 4 + i / 4) : 0x80;
+        }
+    }
+    return shuffles;
+}();
+
+alignas(16) constexpr int16_t COLOR_EXPAND_[3][8] = {
+    // fields of c0 and c1
+    {-2048, 0x07e0, 0x001f, 0, -2048, 0x07e0, 0x001f, 0},
+    // blue to top bits
+    {1, 1, 2048, 0, 1, 1, 2048, 0},
+    // (x << 3 | x >> 2) and (x << 2 | x >> 4) of field at top bits
+    {264, 8320, 264, 0, 264, 8320, 264, 0},
+};
+
+// 4 colors in RGBA8, same as color_palette_scalar_
+// three color mode is selected by mask (all bits set or zero)
+IMAGE_TARGET("ssse3") inline __m128i color_palette_ssse3_(const uint8_t* block, __m128i three_color) noexcept {
+    auto c0 = static_cast<int16_t>(io::load_le<uint16_t>(block));
+    auto c1 = static_cast<int16_t>(io::load_le<uint16_t>(block + 2));
+    auto colors = _mm_setr_epi16(c0, c0, c0, 0, c1, c1, c1, 0);
+    colors = _mm_and_si128(colors, load_constant_(COLOR_EXPAND_[0]));
+    colors = _mm_mulhi_epu16(_mm_mullo_epi16(colors, load_constant_(COLOR_EXPAND_[1])), load_constant_(COLOR_EXPAND_[2]));
+    colors = _mm_or_si128(colors, _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255));
+
+    // [c0, c1] and [c1, c0]
+    auto swapped = _mm_shuffle_epi32(colors, _MM_SHUFFLE(1, 0, 3, 2));
+    // (2 x + y + 1) / 3 (exact for x, y <= 255)
+    auto sum = _mm_add_epi16(_mm_add_epi16(colors, colors), _mm_add_epi16(swapped, _mm_set1_epi16(1)));
+    auto four = _mm_mulhi_epu16(sum, _mm_set1_epi16(21846));
+    auto three = _mm_and_si128(_mm_avg_epu16(colors, swapped), _mm_setr_epi32(-1, -1, 0, 0));
+    auto mixed = _mm_or_si128(_mm_and_si128(three_color, three), _mm_andnot_si128(three_color, four));
+
+    return _mm_packus_epi16(colors, mixed);
+}
+
+IMAGE_TARGET("ssse3") inline __m128i three_color_mask_ssse3_(const uint8_t* block) noexcept {
+    auto c0 = io::load_le<uint16_t>(block);
+    auto c1 = io::load_le<uint16_t>(block + 2);
+    return _mm_set1_epi32(-static_cast<int32_t>(c0 <= c1));
+}
+
+IMAGE_TARGET("ssse3") inline __m128i color_row_ssse3_(__m128i palette, const uint8_t* block, uint32_t y) noexcept {
+    return _mm_shuffle_epi8(palette, load_constant_(COLOR_SHUFFLES_[block[4 + y]].data()));
+}
+
+// 4 bits alpha of 16 pixels expanded to 8 bits (x * 17)
+IMAGE_TARGET("ssse3") inline __m128i explicit_alpha_ssse3_(const uint8_t* block) noexcept {
+    auto bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+    auto mask = _mm_set1_epi8(0x0f);
+    auto low = _mm_and_si128(bytes, mask);
+    auto high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+    auto alpha = _mm_unpacklo_epi8(low, high);
+    return _mm_or_si128(alpha, _mm_slli_epi16(alpha, 4));
+}
+
+// replaces alpha of color rows by alpha values of pixels in pixel order
+IMAGE_TARGET("ssse3") inline void store_color_alpha_block_ssse3_(__m128i palette, const uint8_t* color_block, __m128i alpha, uint8_t* dst, size_t row_pitch) noexcept {
+    auto rgb_mask = _mm_set1_epi32(0x00ffffff);
+    for(uint32_t y = 0; y < 4; ++y) {
+        auto rgb = _mm_and_si128(color_row_ssse3_(palette, color_block, y), rgb_mask);
+        auto a = _mm_shuffle_epi8(alpha, load_constant_(ALPHA_SHUFFLES_[y].data()));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + y * row_pitch), _mm_or_si128(rgb, a));
+    }
+}
+
+IMAGE_TARGET("ssse3") inline void decode_bc1_row_ssse3(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        auto block = blocks + i * 8;
+        auto palette = color_palette_ssse3_(block, three_color_mask_ssse3_(block));
+        for(uint32_t y = 0; y < 4; ++y) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + y * row_pitch + i * 16), color_row_ssse3_(palette, block, y));
+        }
+    }
+}
+
+IMAGE_TARGET("ssse3") inline void decode_bc2_row_ssse3(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        auto block = blocks + i * 16;
+        auto palette = color_palette_ssse3_(block + 8, _mm_setzero_si128());
+        store_color_alpha_block_ssse3_(palette, block + 8, explicit_alpha_ssse3_(block), dst + i * 16, row_pitch);
+    }
+}
+
+IMAGE_TARGET("ssse3") inline void decode_bc3_row_ssse3(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    for(uint32_t i = 0; i < block_count; ++i) {
+        auto block = blocks + i * 16;
+        auto palette = color_palette_ssse3_(block + 8, _mm_setzero_si128());
+        store_color_alpha_block_ssse3_(palette, block + 8, channel_values_ssse3_<false>(block), dst + i * 16, row_pitch);
+    }
+}
+
+// AVX2: 2 adjacent blocks per 256 bits register (one palette per 128 bits lane), so each row of both is one 32 bytes store
+
+IMAGE_TARGET("avx2") inline __m256i combine_avx2_(__m128i low, __m128i high) noexcept {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+}
+
+IMAGE_TARGET("avx2") inline __m256i color_palettes_avx2_(const uint8_t* block0, const uint8_t* block1, bool is_bc1) noexcept {
+    auto c0 = static_cast<int16_t>(io::load_le<uint16_t>(block0));
+    auto c1 = static_cast<int16_t>(io::load_le<uint16_t>(block0 + 2));
+    auto d0 = static_cast<int16_t>(io::load_le<uint16_t>(block1));
+    auto d1 = static_cast<int16_t>(io::load_le<uint16_t>(block1 + 2));
+    auto colors = _mm256_setr_epi16(c0, c0, c0, 0, c1, c1, c1, 0, d0, d0, d0, 0, d1, d1, d1, 0);
+    colors = _mm256_and_si256(colors, _mm256_broadcastsi128_si256(load_constant_(COLOR_EXPAND_[0])));
+    colors = _mm256_mullo_epi16(colors, _mm256_broadcastsi128_si256(load_constant_(COLOR_EXPAND_[1])));
+    colors = _mm256_mulhi_epu16(colors, _mm256_broadcastsi128_si256(load_constant_(COLOR_EXPAND_[2])));
+    colors = _mm256_or_si256(colors, _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255));
+
+    auto swapped = _mm256_shuffle_epi32(colors, _MM_SHUFFLE(1, 0, 3, 2));
+    auto sum = _mm256_add_epi16(_mm256_add_epi16(colors, colors), _mm256_add_epi16(swapped, _mm256_set1_epi16(1)));
+    auto mixed = _mm256_mulhi_epu16(sum, _mm256_set1_epi16(21846));
+    if(is_bc1) {
+        auto three = _mm256_and_si256(_mm256_avg_epu16(colors, swapped), _mm256_setr_epi32(-1, -1, 0, 0, -1, -1, 0, 0));
+        auto t0 = -static_cast<int64_t>(uint16_t(c0) <= uint16_t(c1));
+        auto t1 = -static_cast<int64_t>(uint16_t(d0) <= uint16_t(d1));
+        auto three_color = _mm256_setr_epi64x(t0, t0, t1, t1);
+        mixed = _mm256_blendv_epi8(mixed, three, three_color);
+    }
+
+    return _mm256_packus_epi16(colors, mixed);
+}
+
+IMAGE_TARGET("avx2") inline __m256i color_rows_avx2_(__m256i palettes, const uint8_t* block0, const uint8_t* block1, uint32_t y) noexcept {
+    auto shuffle = combine_avx2_(load_constant_(COLOR_SHUFFLES_[block0[4 + y]].data()), load_constant_(COLOR_SHUFFLES_[block1[4 + y]].data()));
+    return _mm256_shuffle_epi8(palettes, shuffle);
+}
+
+IMAGE_TARGET("avx2") inline void decode_bc1_row_avx2(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    uint32_t i = 0;
+    for(; i + 2 <= block_count; i += 2) {
+        auto block0 = blocks + i * 8;
+        auto block1 = block0 + 8;
+        auto palettes = color_palettes_avx2_(block0, block1, true);
+        for(uint32_t y = 0; y < 4; ++y) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + y * row_pitch + i * 16), color_rows_avx2_(palettes, block0, block1, y));
+        }
+    }
+    decode_bc1_row_ssse3(blocks + i * 8, block_count - i, dst + i * 16, row_pitch);
+}
+
+template<bool EXPLICIT_ALPHA>
+IMAGE_TARGET("avx2") inline void decode_alpha_color_row_avx2_(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    uint32_t i = 0;
+    auto rgb_mask = _mm256_set1_epi32(0x00ffffff);
+    for(; i + 2 <= block_count; i += 2) {
+        auto block0 = blocks + i * 16;
+        auto block1 = block0 + 16;
+        auto palettes = color_palettes_avx2_(block0 + 8, block1 + 8, false);
+        __m256i alpha{};
+        if constexpr(EXPLICIT_ALPHA) {
+            alpha = combine_avx2_(explicit_alpha_ssse3_(block0), explicit_alpha_ssse3_(block1));
+        }
+        else {
+            alpha = combine_avx2_(channel_values_ssse3_<false>(block0), channel_values_ssse3_<false>(block1));
+        }
+        for(uint32_t y = 0; y < 4; ++y) {
+            auto rgb = _mm256_and_si256(color_rows_avx2_(palettes, block0 + 8, block1 + 8, y), rgb_mask);
+            auto a = _mm256_shuffle_epi8(alpha, _mm256_broadcastsi128_si256(load_constant_(ALPHA_SHUFFLES_[y].data())));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + y * row_pitch + i * 16), _mm256_or_si256(rgb, a));
+        }
+    }
+    if constexpr(EXPLICIT_ALPHA) {
+        decode_bc2_row_ssse3(blocks + i * 16, block_count - i, dst + i * 16, row_pitch);
+    }
+    else {
+        decode_bc3_row_ssse3(blocks + i * 16, block_count - i, dst + i * 16, row_pitch);
+    }
+}
+
+IMAGE_TARGET("avx2") inline void decode_bc2_row_avx2(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    decode_alpha_color_row_avx2_<true>(blocks, block_count, dst, row_pitch);
+}
+
+IMAGE_TARGET("avx2") inline void decode_bc3_row_avx2(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch) {
+    decode_alpha_color_row_avx2_<false>(blocks, block_count, dst, row_pitch);
+}
+
+#endif
+
+}
+
+}
\ No newline at end of file
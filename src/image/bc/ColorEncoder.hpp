@@ -0,0 +1,269 @@
+#pragma once
+
+#include "Color.hpp"
+#include "ChannelEncoder.hpp"
+
+namespace image {
+
+namespace bc {
+
+// color block encoder (BC1, color of BC2 and BC3)
+// opaque: mask of pixels whose color matters, other pixels are transparent (BC1 only, encoded as index 3 of 3 colors mode)
+// candidates are evaluated with exact decoder palette (color_palette_scalar_), error is squared RGB distance
+
+struct ColorFit {
+    uint16_t c0;
+    uint16_t c1;
+    uint32_t indices;
+    uint32_t error;
+};
+
+inline uint16_t quantize_565_(const Vector4& color) noexcept {
+    auto quantize = [](float value, float max) {
+        return static_cast<uint32_t>(std::clamp(std::lround(value * max / 255.0f), 0l, static_cast<long>(max)));
+    };
+    return static_cast<uint16_t>((quantize(color[0], 31.0f) << 11) | (quantize(color[1], 63.0f) << 5) | quantize(color[2], 31.0f));
+}
+
+// endpoints are ordered for palette mode: c0 > c1 for 4 colors, c0 <= c1 for 3 colors
+// (BC2 and BC3 always decode 4 colors)
+inline ColorFit evaluate_color_(const BlockPixels& pixels, uint32_t opaque, uint16_t a, uint16_t b, bool three_color, bool is_bc1) noexcept {
+    ColorFit fit{std::max(a, b), std::min(a, b), 0, 0};
+    if(three_color) {
+        std::swap(fit.c0, fit.c1);
+    }
+    uint8_t block[4];
+    io::store_le(block, fit.c0);
+    io::store_le(block + 2, fit.c1);
+    uint8_t palette[16];
+    color_palette_scalar_(block, is_bc1, palette);
+    // index 3 of 3 colors mode is transparent
+    uint32_t color_count = (is_bc1 && fit.c0 <= fit.c1) ? 3 : 4;
+
+    for(uint32_t i = 0; i < 16; ++i) {
+        if(!(opaque & (1u << i))) {
+            fit.indices |= 3u << (2 * i);
+            continue;
+        }
+        uint32_t best_index = 0;
+        auto best_error = std::numeric_limits<uint32_t>::max();
+        for(uint32_t k = 0; k < color_count; ++k) {
+            uint32_t error = 0;
+            for(uint32_t c = 0; c < 3; ++c) {
+                auto d = int32_t(pixels[i][c]) - palette[k * 4 + c];
+                error += static_cast<uint32_t>(d * d);
+            }
+            if(error < best_error) {
+                best_error = error;
+                best_index = k;
+            }
+        }
+        fit.indices |= best_index << (2 * i);
+        fit.error += best_error;
+    }
+    return fit;
+}
+
+// weight of c1 for each index
+inline float color_weight_(uint32_t index, bool three_color) noexcept {
+    constexpr float FOUR[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+    constexpr float THREE[4] = {0.0f, 1.0f, 0.5f, 0.0f};
+    return three_color ? THREE[index] : FOUR[index];
+}
+
+// endpoints by least squares for indices of fit
+inline ColorFit refine_color_(const BlockPixels& pixels, uint32_t opaque, const ColorFit& fit, bool three_color, bool is_bc1) noexcept {
+    float weights[16]{};
+    for(uint32_t i = 0; i < 16; ++i) {
+        weights[i] = color_weight_((fit.indices >> (2 * i)) & 3, three_color);
+    }
+    Vector4 e0{}, e1{};
+    if(!least_squares_endpoints_(pixels, opaque, weights, 0, 3, e0, e1)) {
+        return fit;
+    }
+    auto refined = evaluate_color_(pixels, opaque, quantize_565_(e0), quantize_565_(e1), three_color, is_bc1);
+    return refined.error < fit.error ? refined : fit;
+}
+
+// range fit along principal axis
+inline ColorFit range_fit_color_(const BlockPixels& pixels, uint32_t opaque, const Line& line, bool three_color, bool is_bc1) noexcept {
+    Vector4 e0{}, e1{};
+    line_endpoints_(pixels, opaque, 3, line, e0, e1);
+    return evaluate_color_(pixels, opaque, quantize_565_(e0), quantize_565_(e1), three_color, is_bc1);
+}
+
+// cluster fit: pixels are ordered by projection to principal axis and every split of the order into
+// clusters of consecutive pixels (one per palette entry) is solved by least squares
+inline ColorFit cluster_fit_color_(const BlockPixels& pixels, uint32_t opaque, const Line& line, bool three_color, bool is_bc1) noexcept {
+    uint32_t order[16];
+    float projections[16];
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < 16; ++i) {
+        if(opaque & (1u << i)) {
+            float t = 0.0f;
+            for(uint32_t c = 0; c < 3; ++c) {
+                t += (pixels[i][c] - line.mean[c]) * line.axis[c];
+            }
+            projections[i] = t;
+            order[count++] = i;
+        }
+    }
+    std::sort(order, order + count, [&](uint32_t a, uint32_t b) { return projections[a] < projections[b]; });
+
+    // prefix sums of ordered pixels
+    float sums[17][3]{};
+    for(uint32_t k = 0; k < count; ++k) {
+        for(uint32_t c = 0; c < 3; ++c) {
+            sums[k + 1][c] = sums[k][c] + pixels[order[k]][c];
+        }
+    }
+
+    float best_error = std::numeric_limits<float>::max();
+    float best_a[3]{}, best_b[3]{};
+    // clusters [0, i), [i, j), [j, k), [k, count) have weights of b: 0, 1/3, 2/3, 1 (0, 1/2, 1 with [j, k) empty for 3 colors)
+    auto solve = [&](uint32_t i, uint32_t j, uint32_t k, float t1, float t2) {
+        float n0 = float(i), n1 = float(j - i), n2 = float(k - j), n3 = float(count - k);
+        float aa = n0 + n1 * (1 - t1) * (1 - t1) + n2 * (1 - t2) * (1 - t2);
+        float bb = n1 * t1 * t1 + n2 * t2 * t2 + n3;
+        float ab = n1 * (1 - t1) * t1 + n2 * (1 - t2) * t2;
+        auto determinant = aa * bb - ab * ab;
+        if(determinant < 1e-6f) {
+            return;
+        }
+        auto inverse = 1.0f / determinant;
+        float error = 0.0f;
+        float a[3], b[3];
+        for(uint32_t c = 0; c < 3; ++c) {
+            auto x1 = sums[j][c] - sums[i][c];
+            auto x2 = sums[k][c] - sums[j][c];
+            auto ax = sums[i][c] + x1 * (1 - t1) + x2 * (1 - t2);
+            auto bx = x1 * t1 + x2 * t2 + sums[count][c] - sums[k][c];
+            // snapped to 565 grid, so that clusters are compared with representable endpoints
+            auto to_grid = c == 1 ? 63.0f / 255.0f : 31.0f / 255.0f;
+            a[c] = float(int32_t(std::clamp((ax * bb - bx * ab) * inverse, 0.0f, 255.0f) * to_grid + 0.5f)) / to_grid;
+            b[c] = float(int32_t(std::clamp((bx * aa - ax * ab) * inverse, 0.0f, 255.0f) * to_grid + 0.5f)) / to_grid;
+            // squared error without constant sum of x^2
+            error += a[c] * a[c] * aa + b[c] * b[c] * bb + 2.0f * a[c] * b[c] * ab - 2.0f * a[c] * ax - 2.0f * b[c] * bx;
+        }
+        if(error < best_error) {
+            best_error = error;
+            std::copy(a, a + 3, best_a);
+            std::copy(b, b + 3, best_b);
+        }
+    };
+    for(uint32_t i = 0; i <= count; ++i) {
+        for(uint32_t j = i; j <= count; ++j) {
+            if(three_color) {
+                solve(i, j, j, 0.5f, 0.5f);
+                continue;
+            }
+            for(uint32_t k = j; k <= count; ++k) {
+                solve(i, j, k, 1.0f / 3.0f, 2.0f / 3.0f);
+            }
+        }
+    }
+    if(best_error == std::numeric_limits<float>::max()) {
+        return range_fit_color_(pixels, opaque, line, three_color, is_bc1);
+    }
+    return evaluate_color_(pixels, opaque, quantize_565_({best_a[0], best_a[1], best_a[2], 0.0f}), quantize_565_({best_b[0], best_b[1], best_b[2], 0.0f}), three_color, is_bc1);
+}
+
+// moves single 565 components by 1 while error decreases
+inline ColorFit search_color_(const BlockPixels& pixels, uint32_t opaque, ColorFit fit, bool three_color, bool is_bc1) noexcept {
+    constexpr uint16_t FIELDS[3][2] = {{11, 31}, {5, 63}, {0, 31}};
+    for(bool improved = true; improved && fit.error > 0;) {
+        improved = false;
+        for(uint32_t e = 0; e < 2; ++e) {
+            for(const auto& [shift, max] : FIELDS) {
+                for(int32_t d : {-1, 1}) {
+                    uint16_t endpoints[2] = {fit.c0, fit.c1};
+                    auto value = int32_t((endpoints[e] >> shift) & max) + d;
+                    if(value < 0 || value > max) {
+                        continue;
+                    }
+                    endpoints[e] = static_cast<uint16_t>((endpoints[e] & ~(max << shift)) | (value << shift));
+                    auto candidate = evaluate_color_(pixels, opaque, endpoints[0], endpoints[1], three_color, is_bc1);
+                    if(candidate.error < fit.error) {
+                        fit = candidate;
+                        improved = true;
+                    }
+                }
+            }
+        }
+    }
+    return fit;
+}
+
+inline ColorFit fit_color_(const BlockPixels& pixels, uint32_t opaque, bool three_color, bool is_bc1, const Line& line, Quality quality) noexcept {
+    auto fit = range_fit_color_(pixels, opaque, line, three_color, is_bc1);
+    if(quality == Quality::fast || fit.error == 0) {
+        return fit;
+    }
+    if(quality == Quality::high) {
+        auto cluster = cluster_fit_color_(pixels, opaque, line, three_color, is_bc1);
+        if(cluster.error < fit.error) {
+            fit = cluster;
+        }
+    }
+    for(uint32_t iteration = 0; iteration < 2; ++iteration) {
+        fit = refine_color_(pixels, opaque, fit, three_color, is_bc1);
+    }
+    if(quality == Quality::high) {
+        fit = search_color_(pixels, opaque, fit, three_color, is_bc1);
+    }
+    return fit;
+}
+
+// is_bc1: 3 colors mode may be used (transparent pixels force it), otherwise palette has always 4 colors
+inline void encode_color_block_(const BlockPixels& pixels, uint32_t opaque, bool is_bc1, Quality quality, uint8_t* dst) noexcept {
+    ColorFit fit{0, 0, 0xffffffffu, 0};
+    if(opaque != 0) {
+        auto line = fit_line_(pixels, opaque, 3);
+        bool has_transparent = opaque != 0xffffu;
+        fit = fit_color_(pixels, opaque, has_transparent, is_bc1, line, quality);
+        // 3 colors mode of opaque block (midpoint may be closer than thirds)
+        if(is_bc1 && !has_transparent && quality != Quality::fast && fit.error > 0) {
+            auto three = fit_color_(pixels, opaque, true, is_bc1, line, quality);
+            if(three.error < fit.error) {
+                fit = three;
+            }
+        }
+    }
+    io::store_le(dst, fit.c0);
+    io::store_le(dst + 2, fit.c1);
+    io::store_le(dst + 4, fit.indices);
+}
+
+// pixels with alpha below threshold are transparent (0: all pixels are opaque)
+inline void encode_bc1_block(const BlockPixels& pixels, Quality quality, uint8_t alpha_threshold, uint8_t* dst) noexcept {
+    uint32_t opaque = 0;
+    for(uint32_t i = 0; i < 16; ++i) {
+        if(pixels[i][3] >= alpha_threshold) {
+            opaque |= 1u << i;
+        }
+    }
+    encode_color_block_(pixels, opaque, true, quality, dst);
+}
+
+// explicit 4 bits alpha (rounded to nearest multiple of 17)
+inline void encode_bc2_block(const BlockPixels& pixels, Quality quality, uint8_t* dst) noexcept {
+    for(uint32_t k = 0; k < 8; ++k) {
+        auto low = (pixels[k * 2][3] + 8) / 17;
+        auto high = (pixels[k * 2 + 1][3] + 8) / 17;
+        dst[k] = static_cast<uint8_t>(low | (high << 4));
+    }
+    encode_color_block_(pixels, 0xffffu, false, quality, dst + 8);
+}
+
+inline void encode_bc3_block(const BlockPixels& pixels, Quality quality, uint8_t* dst) noexcept {
+    uint8_t alpha[16];
+    for(uint32_t i = 0; i < 16; ++i) {
+        alpha[i] = pixels[i][3];
+    }
+    encode_channel_block_<false>(alpha, quality, dst);
+    encode_color_block_(pixels, 0xffffu, false, quality, dst + 8);
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Color.hpp"
+#include "BC7.hpp"
+
+namespace image {
+
+namespace bc {
+
+// decodes block compressed image (tightly packed rows of blocks) to uncompressed format
+// RGBA8 for BC1, BC2, BC3 and BC7, R8 for BC4 and RG8 for BC5 (two's complement for signed variants)
+struct Decoder {
+    DecodeRow row;
+    Format format;
+    Format output_format;
+
+    static Format output_format_of(Format format) {
+        switch(format) {
+            case Format::BC1: case Format::BC2: case Format::BC3: case Format::BC7: return Format::RGBA8;
+            case Format::BC4U: case Format::BC4S: return Format::R8;
+            case Format::BC5U: case Format::BC5S: return Format::RG8;
+            default:
+                throw std::runtime_error(std::format("[image::bc::Decoder] ERROR: unsupported format: {}", static_cast<uint32_t>(format)));
+        }
+    }
+
+    static Decoder select(Format format) {
+        Decoder decoder{nullptr, format, output_format_of(format)};
+
+        switch(format) {
+            case Format::BC1: decoder.row = decode_bc1_row_scalar; break;
+            case Format::BC2: decoder.row = decode_bc2_row_scalar; break;
+            case Format::BC3: decoder.row = decode_bc3_row_scalar; break;
+            case Format::BC4U: decoder.row = decode_bc4_row_scalar<false>; break;
+            case Format::BC4S: decoder.row = decode_bc4_row_scalar<true>; break;
+            case Format::BC5U: decoder.row = decode_bc5_row_scalar<false>; break;
+            case Format::BC5S: decoder.row = decode_bc5_row_scalar<true>; break;
+            case Format::BC7: decoder.row = decode_bc7_row_scalar; break;
+            default: break;
+        }
+
+#if defined(IMAGE_SIMD_X86)
+        const auto& features = simd::features();
+        if(features.ssse3) {
+            switch(format) {
+                case Format::BC1: decoder.row = decode_bc1_row_ssse3; break;
+                case Format::BC2: decoder.row = decode_bc2_row_ssse3; break;
+                case Format::BC3: decoder.row = decode_bc3_row_ssse3; break;
+                case Format::BC4U: decoder.row = decode_bc4_row_ssse3<false>; break;
+                case Format::BC4S: decoder.row = decode_bc4_row_ssse3<true>; break;
+                case Format::BC5U: decoder.row = decode_bc5_row_ssse3<false>; break;
+                case Format::BC5S: decoder.row = decode_bc5_row_ssse3<true>; break;
+                case Format::BC7: decoder.row = decode_bc7_row_ssse3; break;
+                default: break;
+            }
+        }
+        if(features.avx2) {
+            switch(format) {
+                case Format::BC1: decoder.row = decode_bc1_row_avx2; break;
+                case Format::BC2: decoder.row = decode_bc2_row_avx2; break;
+                case Format::BC3: decoder.row = decode_bc3_row_avx2; break;
+                default: break;
+            }
+        }
+#endif
+
+        return decoder;
+    }
+
+    // decodes rows of blocks [first, last) of width x height image
+    // dst points to first pixel of image (not of first row of blocks)
+    void decode(const uint8_t* blocks, uint32_t width, uint32_t height, uint32_t first, uint32_t last, uint8_t* dst, size_t row_pitch) const {
+        auto pixel_size = image::pixel_size(output_format);
+        auto blocks_x = image::row_count(format, width);
+        auto block_pitch = image::row_pitch(format, width);
+        // blocks fully inside of image are written directly
+        auto full_x = width / 4;
+        // partial blocks are decoded to scratch
+        std::vector<uint8_t> scratch{};
+
+        for(uint32_t by = first; by < last; ++by) {
+            auto src = blocks + by * block_pitch;
+            auto rows = std::min(4u, height - by * 4);
+            auto row_dst = dst + size_t(by) * 4 * row_pitch;
+            if(rows == 4) {
+                row(src, full_x, row_dst, row_pitch);
+                if(full_x == blocks_x) {
+                    continue;
+                }
+                // right edge block
+                uint8_t edge[4 * 4 * 4];
+                row(src + full_x * block_size(format), 1, edge, 4 * pixel_size);
+                auto edge_size = (width - full_x * 4) * pixel_size;
+                for(uint32_t y = 0; y < 4; ++y) {
+                    std::memcpy(row_dst + y * row_pitch + full_x * 4 * pixel_size, edge + y * 4 * pixel_size, edge_size);
+                }
+            }
+            else {
+                // bottom edge
+                auto scratch_pitch = size_t(blocks_x) * 4 * pixel_size;
+                scratch.resize(scratch_pitch * 4);
+                row(src, blocks_x, scratch.data(), scratch_pitch);
+                for(uint32_t y = 0; y < rows; ++y) {
+                    std::memcpy(row_dst + y * row_pitch, scratch.data() + y * scratch_pitch, size_t(width) * pixel_size);
+                }
+            }
+        }
+    }
+};
+
+}
+
+}
\ No newline at end of file
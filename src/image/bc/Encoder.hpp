@@ -0,0 +1,167 @@
+#pragma once
+
+#include "ColorEncoder.hpp"
+#include "BC7Encoder.hpp"
+#include "Decoder.hpp"
+#include "../../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+namespace bc {
+
+struct EncodeOptions {
+    Quality quality = Quality::normal;
+    // bytes between source rows (0: tightly packed)
+    size_t row_pitch = 0;
+    // BC1: pixels with alpha below threshold are encoded as transparent black (0: every pixel is opaque)
+    uint8_t alpha_threshold = 128;
+    // DDS is written with *_SRGB format (blocks are encoded in stored space either way)
+    bool is_srgb = false;
+};
+
+// error of decoded blocks against source in channels of decoded format (R: BC4, RG: BC5, RGBA: others)
+// signed formats are compared as two's complement values
+struct Metrics {
+    std::array<double, 4> channel_rmse;
+    double rmse;
+    // dB, infinity if encoding is lossless
+    double psnr;
+};
+
+struct EncodeResult {
+    // tightly packed rows of blocks
+    std::vector<uint8_t> blocks;
+    Metrics metrics;
+};
+
+// block compressor (BC1, BC2, BC3, BC4, BC5 and BC7) of 8 bits source (R8, RG8, RGB8, RGBA8 or BGRA8)
+// missing source channels are read as G = B = 0 and A = 255, BC4 encodes R and BC5 encodes R and G
+// rows of blocks are split to tasks on pool, each task decodes its blocks again to accumulate error for metrics
+// partial blocks at right and bottom edges replicate last column and row (metrics count real pixels only)
+class Encoder {
+    using EncodeBlock = void(*)(const BlockPixels& pixels, const EncodeOptions& options, uint8_t* dst);
+
+    static EncodeBlock select_(Format format) {
+        switch(format) {
+            case Format::BC1: return [](const BlockPixels& pixels, const EncodeOptions& options, uint8_t* dst) { encode_bc1_block(pixels, options.quality, options.alpha_threshold, dst); };
+            case Format::BC2: return [](const BlockPixels& pixels, const EncodeOptions& options, uint8_t* dst) { encode_bc2_block(pixels, options.quality, dst); };
+            case Format::BC3: return [](const BlockPixels& pixels, const EncodeOptions& options, uint8_t* dst) { encode_bc3_block(pixels, options.quality, dst); };
+            case Format::BC4U: return [](const BlockPixels& pixels, const EncodeOptions& options, uint8_t* dst) { encode_bc4_block<false>(pixels, options.quality, dst); };
+            case Format::BC4S: return [](const BlockPixels& pixels, const EncodeOptions& options, uint8_t* dst) { encode_bc4_block<true>(pixels, options.quality, dst); };
+            case Format::BC5U: return [](const BlockPixels& pixels, const EncodeOptions& options, uint8_t* dst) { encode_bc5_block<false>(pixels, options.quality, dst); };
+            case Format::BC5S: return [](const BlockPixels& pixels, const EncodeOptions& options, uint8_t* dst) { encode_bc5_block<true>(pixels, options.quality, dst); };
+            case Format::BC7: return [](const BlockPixels& pixels, const EncodeOptions& options, uint8_t* dst) { encode_bc7_block(pixels, options.quality, dst); };
+            default:
+                throw std::runtime_error(std::format("[image::bc::Encoder] ERROR: unsupported format: {}", static_cast<uint32_t>(format)));
+        }
+    }
+
+    // RGBA8 pixel of source
+    static void load_pixel_(const uint8_t* src, Format format, uint8_t* pixel) noexcept {
+        switch(format) {
+            case Format::R8: pixel[0] = src[0]; pixel[1] = 0; pixel[2] = 0; pixel[3] = 255; break;
+            case Format::RG8: pixel[0] = src[0]; pixel[1] = src[1]; pixel[2] = 0; pixel[3] = 255; break;
+            case Format::RGB8: pixel[0] = src[0]; pixel[1] = src[1]; pixel[2] = src[2]; pixel[3] = 255; break;
+            case Format::BGRA8: pixel[0] = src[2]; pixel[1] = src[1]; pixel[2] = src[0]; pixel[3] = src[3]; break;
+            default: std::memcpy(pixel, src, 4); break;
+        }
+    }
+
+    static BlockPixels load_block_(const uint8_t* data, size_t row_pitch, uint32_t width, uint32_t height, Format format, uint32_t bx, uint32_t by) noexcept {
+        BlockPixels pixels{};
+        auto pixel_size = image::pixel_size(format);
+        for(uint32_t y = 0; y < 4; ++y) {
+            auto row = data + std::min(by * 4 + y, height - 1) * row_pitch;
+            for(uint32_t x = 0; x < 4; ++x) {
+                load_pixel_(row + std::min(bx * 4 + x, width - 1) * pixel_size, format, pixels[y * 4 + x].data());
+            }
+        }
+        return pixels;
+    }
+
+public:
+    // do not call from task on the same pool (waits for row tasks)
+    static EncodeResult encode(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format source_format, Format format, const EncodeOptions& options = {}, concurrency::ThreadPool* pool = nullptr) {
+        if(source_format != Format::R8 && source_format != Format::RG8 && source_format != Format::RGB8 && source_format != Format::RGBA8 && source_format != Format::BGRA8) {
+            throw std::runtime_error(std::format("[image::bc::Encoder] ERROR: unsupported source format: {}", static_cast<uint32_t>(source_format)));
+        }
+        if(width == 0 || height == 0) {
+            throw std::runtime_error(std::format("[image::bc::Encoder] ERROR: invalid image size: {} x {}", width, height));
+        }
+        auto encode_block = select_(format);
+        auto decoder = Decoder::select(format);
+        auto source_info = ImageInfo::make(width, height, source_format);
+        auto row_pitch = options.row_pitch ? options.row_pitch : source_info.row_pitch;
+        if(row_pitch < source_info.row_pitch || data.size() < source_info.size(row_pitch)) {
+            throw std::runtime_error(std::format("[image::bc::Encoder] ERROR: source is too small (size = {}, pitch = {}, image = {} x {}).", data.size(), row_pitch, width, height));
+        }
+
+        auto blocks_x = (width + 3) / 4;
+        auto block_rows = image::row_count(format, height);
+        auto block_pitch = image::row_pitch(format, width);
+        auto block_bytes = block_size(format);
+        bool is_signed = format == Format::BC4S || format == Format::BC5S;
+        auto channel_count = component_count(decoder.output_format);
+
+        EncodeResult result{};
+        result.blocks.resize(block_pitch * block_rows);
+
+        auto task_count = pool ? std::min(block_rows, pool->thread_count() * 4) : 1;
+        // squared error of each channel per task
+        std::vector<std::array<uint64_t, 4>> errors(task_count);
+        concurrency::parallel_for(pool, task_count, [&](uint32_t task) {
+            auto first = static_cast<uint32_t>(uint64_t(block_rows) * task / task_count);
+            auto last = static_cast<uint32_t>(uint64_t(block_rows) * (task + 1) / task_count);
+            auto decoded_pitch = size_t(blocks_x) * 4 * channel_count;
+            std::vector<uint8_t> decoded(decoded_pitch * 4);
+            auto& error = errors[task];
+
+            for(uint32_t by = first; by < last; ++by) {
+                auto dst = result.blocks.data() + by * block_pitch;
+                for(uint32_t bx = 0; bx < blocks_x; ++bx) {
+                    encode_block(load_block_(data.data(), row_pitch, width, height, source_format, bx, by), options, dst + bx * block_bytes);
+                }
+
+                decoder.row(dst, blocks_x, decoded.data(), decoded_pitch);
+                for(uint32_t y = 0; y < std::min(4u, height - by * 4); ++y) {
+                    auto src_row = data.data() + (by * 4 + y) * row_pitch;
+                    auto decoded_row = decoded.data() + y * decoded_pitch;
+                    for(uint32_t x = 0; x < width; ++x) {
+                        uint8_t pixel[4];
+                        load_pixel_(src_row + x * image::pixel_size(source_format), source_format, pixel);
+                        for(uint32_t c = 0; c < channel_count; ++c) {
+                            int32_t a = pixel[c], b = decoded_row[x * channel_count + c];
+                            if(is_signed) {
+                                a = static_cast<int8_t>(a);
+                                b = static_cast<int8_t>(b);
+                            }
+                            error[c] += static_cast<uint64_t>((a - b) * (a - b));
+                        }
+                    }
+                }
+            }
+        });
+
+        std::array<uint64_t, 4> total{};
+        for(const auto& error : errors) {
+            for(uint32_t c = 0; c < 4; ++c) {
+                total[c] += error[c];
+            }
+        }
+        auto pixel_count = static_cast<double>(width) * height;
+        uint64_t sum = 0;
+        for(uint32_t c = 0; c < channel_count; ++c) {
+            result.metrics.channel_rmse[c] = std::sqrt(total[c] / pixel_count);
+            sum += total[c];
+        }
+        auto mse = sum / (pixel_count * channel_count);
+        result.metrics.rmse = std::sqrt(mse);
+        result.metrics.psnr = mse == 0.0 ? std::numeric_limits<double>::infinity() : 10.0 * std::log10(255.0 * 255.0 / mse);
+
+        return result;
+    }
+};
+
+}
+
+}
\ No newline at end of file
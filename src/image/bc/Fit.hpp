@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include "utils.hpp"
+
+namespace image {
+
+namespace bc {
+
+// helpers shared by block encoders
+// pixels of one block are RGBA8 in pixel order (y * 4 + x), subset of pixels is selected by 16 bits mask
+
+using BlockPixels = std::array<std::array<uint8_t, 4>, 16>;
+using Vector4 = std::array<float, 4>;
+
+// line through mean of pixels along principal axis (axis is zero for constant pixels)
+struct Line {
+    Vector4 mean;
+    Vector4 axis;
+};
+
+// principal axis of covariance of channels [0, channel_count) by power iteration
+inline Line fit_line_(const BlockPixels& pixels, uint32_t mask, uint32_t channel_count) noexcept {
+    Line line{};
+    auto count = static_cast<float>(std::popcount(mask));
+    if(count == 0) {
+        return line;
+    }
+    for(uint32_t i = 0; i < 16; ++i) {
+        if(mask & (1u << i)) {
+            for(uint32_t c = 0; c < channel_count; ++c) {
+                line.mean[c] += pixels[i][c];
+            }
+        }
+    }
+    for(uint32_t c = 0; c < channel_count; ++c) {
+        line.mean[c] /= count;
+    }
+
+    float covariance[4][4]{};
+    for(uint32_t i = 0; i < 16; ++i) {
+        if(mask & (1u << i)) {
+            float d[4]{};
+            for(uint32_t c = 0; c < channel_count; ++c) {
+                d[c] = pixels[i][c] - line.mean[c];
+            }
+            for(uint32_t r = 0; r < channel_count; ++r) {
+                for(uint32_t c = r; c < channel_count; ++c) {
+                    covariance[r][c] += d[r] * d[c];
+                }
+            }
+        }
+    }
+    for(uint32_t r = 0; r < channel_count; ++r) {
+        for(uint32_t c = 0; c < r; ++c) {
+            covariance[r][c] = covariance[c][r];
+        }
+    }
+
+    // start from row of largest variance (never orthogonal to principal axis unless covariance is zero)
+    uint32_t largest = 0;
+    for(uint32_t c = 1; c < channel_count; ++c) {
+        if(covariance[c][c] > covariance[largest][largest]) {
+            largest = c;
+        }
+    }
+    Vector4 axis{};
+    for(uint32_t c = 0; c < channel_count; ++c) {
+        axis[c] = covariance[largest][c];
+    }
+    for(uint32_t iteration = 0; iteration < 8; ++iteration) {
+        Vector4 next{};
+        float scale = 0.0f;
+        for(uint32_t r = 0; r < channel_count; ++r) {
+            for(uint32_t c = 0; c < channel_count; ++c) {
+                next[r] += covariance[r][c] * axis[c];
+            }
+            scale = std::max(scale, std::abs(next[r]));
+        }
+        if(scale == 0.0f) {
+            return line;
+        }
+        for(uint32_t c = 0; c < channel_count; ++c) {
+            axis[c] = next[c] / scale;
+        }
+    }
+
+    float length = 0.0f;
+    for(uint32_t c = 0; c < channel_count; ++c) {
+        length += axis[c] * axis[c];
+    }
+    length = std::sqrt(length);
+    for(uint32_t c = 0; c < channel_count; ++c) {
+        line.axis[c] = axis[c] / length;
+    }
+    return line;
+}
+
+// endpoints at smallest and largest projection of pixels to line (range fit)
+inline void line_endpoints_(const BlockPixels& pixels, uint32_t mask, uint32_t channel_count, const Line& line, Vector4& e0, Vector4& e1) noexcept {
+    float low = 0.0f, high = 0.0f;
+    for(uint32_t i = 0; i < 16; ++i) {
+        if(mask & (1u << i)) {
+            float t = 0.0f;
+            for(uint32_t c = 0; c < channel_count; ++c) {
+                t += (pixels[i][c] - line.mean[c]) * line.axis[c];
+            }
+            low = std::min(low, t);
+            high = std::max(high, t);
+        }
+    }
+    for(uint32_t c = 0; c < channel_count; ++c) {
+        e0[c] = std::clamp(line.mean[c] + low * line.axis[c], 0.0f, 255.0f);
+        e1[c] = std::clamp(line.mean[c] + high * line.axis[c], 0.0f, 255.0f);
+    }
+}
+
+// endpoints minimizing squared error of (1 - t) e0 + t e1 for given weight t of each pixel
+// channels [first, first + channel_count), returns false if all weights are equal
+inline bool least_squares_endpoints_(const BlockPixels& pixels, uint32_t mask, const float* weights, uint32_t first, uint32_t channel_count, Vector4& e0, Vector4& e1) noexcept {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    Vector4 ax{}, bx{};
+    for(uint32_t i = 0; i < 16; ++i) {
+        if(mask & (1u << i)) {
+            auto b = weights[i];
+            auto a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for(uint32_t c = first; c < first + channel_count; ++c) {
+                ax[c] += a * pixels[i][c];
+                bx[c] += b * pixels[i][c];
+            }
+        }
+    }
+    auto determinant = aa * bb - ab * ab;
+    if(std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+    for(uint32_t c = first; c < first + channel_count; ++c) {
+        e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+        e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+// count, sums and sums of pairwise products of pixels (upper triangle: rr, rg, rb, ra, gg, gb, ga, bb, ba, aa)
+// moments of subsets add up, so moments of partition subsets are sums of per pixel moments
+struct Moments {
+    std::array<float, 16> values;
+
+    static Moments of(const std::array<uint8_t, 4>& pixel) noexcept {
+        Moments moments{};
+        moments.values[0] = 1.0f;
+        uint32_t k = 5;
+        for(uint32_t r = 0; r < 4; ++r) {
+            moments.values[1 + r] = pixel[r];
+            for(uint32_t c = r; c < 4; ++c) {
+                moments.values[k++] = float(pixel[r]) * pixel[c];
+            }
+        }
+        return moments;
+    }
+
+    Moments& operator+=(const Moments& other) noexcept {
+        for(uint32_t k = 0; k < 16; ++k) {
+            values[k] += other.values[k];
+        }
+        return *this;
+    }
+
+    Moments operator-(const Moments& other) const noexcept {
+        Moments moments = *this;
+        for(uint32_t k = 0; k < 16; ++k) {
+            moments.values[k] -= other.values[k];
+        }
+        return moments;
+    }
+
+    // estimated residual of line fit (sum of squared distances to principal axis) in channels [0, channel_count)
+    // covariance trace minus Frobenius norm (largest eigenvalue of nearly rank 1 covariance)
+    float residual(uint32_t channel_count) const noexcept {
+        constexpr uint32_t PRODUCT[4][4] = {{5, 6, 7, 8}, {6, 9, 10, 11}, {7, 10, 12, 13}, {8, 11, 13, 14}};
+        auto count = values[0];
+        if(count < 2.0f) {
+            return 0.0f;
+        }
+        auto inverse_count = 1.0f / count;
+        float trace = 0.0f, norm = 0.0f;
+        for(uint32_t r = 0; r < channel_count; ++r) {
+            for(uint32_t c = 0; c < channel_count; ++c) {
+                auto covariance = values[PRODUCT[r][c]] - values[1 + r] * values[1 + c] * inverse_count;
+                norm += covariance * covariance;
+                trace += r == c ? covariance : 0.0f;
+            }
+        }
+        return std::max(trace - std::sqrt(norm), 0.0f);
+    }
+};
+
+inline Moments subset_moments_(const std::array<Moments, 16>& pixel_moments, uint32_t mask) noexcept {
+    Moments moments{};
+    for(; mask; mask &= mask - 1) {
+        moments += pixel_moments[std::countr_zero(mask)];
+    }
+    return moments;
+}
+
+}
+
+}
\ No newline at end of file
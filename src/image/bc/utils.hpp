@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstring>
+#include <utility>
+
+#include "../common.hpp"
+#include "../simd.hpp"
+#include "../../io/ByteReader.hpp"
+
+namespace image {
+
+namespace bc {
+
+// decodes one row of 4x4 blocks (4 rows of pixels, block_count * 4 pixels wide)
+using DecodeRow = void(*)(const uint8_t* blocks, uint32_t block_count, uint8_t* dst, size_t row_pitch);
+
+// encoder presets
+// fast: range fit (endpoints at extremes of principal axis), BC7 mode 6 only
+// normal: least squares refinement, BC1 3 color mode, BC7 2 subsets modes with best estimated partitions
+// high: cluster fit and endpoint search, BC7 search over all modes, more partitions, rotations and p-bits
+enum class Quality {
+    fast,
+    normal,
+    high,
+};
+
+}
+
+}
\ No newline at end of file
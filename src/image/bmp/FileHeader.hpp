@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../common.hpp"
+#include "../../io/ByteReader.hpp"
 
 namespace image {
 
@@ -12,14 +13,15 @@ struct FileHeader {
     uint32_t offset;
 };
 
-inline FileHeader read_file_header(std::ifstream& ifs) {
+inline FileHeader read_file_header(io::ByteReader& reader) {
     FileHeader header{};
     header.type.resize(2, '\0');
 
-    ifs.read(reinterpret_cast<char*>(header.type.data()), sizeof(char) * 2);
-    ifs.read(reinterpret_cast<char*>(&header.size), sizeof(uint32_t));
-    ifs.seekg(2 * 2, std::ios::cur);
-    ifs.read(reinterpret_cast<char*>(&header.offset), sizeof(uint32_t));
+    reader.copy_bytes(header.type.data(), sizeof(char) * 2);
+    reader.read_le(header.size);
+    // reserved
+    reader.skip(2 * 2);
+    reader.read_le(header.offset);
 
     return header;
 }
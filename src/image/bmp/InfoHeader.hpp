@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../common.hpp"
+#include "../../io/ByteReader.hpp"
 
 namespace image {
 
@@ -20,29 +21,29 @@ struct InfoHeader {
     uint32_t important_palette_index;
 };
 
-inline InfoHeader read_info_header(std::ifstream& ifs) {
+inline InfoHeader read_info_header(io::ByteReader& reader) {
     InfoHeader header{};
 
-    ifs.read(reinterpret_cast<char*>(&header.size), sizeof(uint32_t));
+    reader.read_le(header.size);
     if(header.size == 12) {
-        ifs.read(reinterpret_cast<char*>(&header.width), sizeof(int16_t));
-        ifs.read(reinterpret_cast<char*>(&header.height), sizeof(int16_t));
-        ifs.read(reinterpret_cast<char*>(&header.plane_count), sizeof(uint16_t));
-        ifs.read(reinterpret_cast<char*>(&header.bit_count), sizeof(uint16_t));
+        header.width = reader.read_le<uint16_t>();
+        header.height = reader.read_le<uint16_t>();
+        reader.read_le(header.plane_count);
+        reader.read_le(header.bit_count);
 
         return header;
     }
     else {
-        ifs.read(reinterpret_cast<char*>(&header.width), sizeof(int32_t));
-        ifs.read(reinterpret_cast<char*>(&header.height), sizeof(int32_t));
-        ifs.read(reinterpret_cast<char*>(&header.plane_count), sizeof(uint16_t));
-        ifs.read(reinterpret_cast<char*>(&header.bit_count), sizeof(uint16_t));
-        ifs.read(reinterpret_cast<char*>(&header.compression), sizeof(uint32_t));
-        ifs.read(reinterpret_cast<char*>(&header.image_size), sizeof(uint32_t));
-        ifs.read(reinterpret_cast<char*>(&header.x_pixels), sizeof(uint32_t));
-        ifs.read(reinterpret_cast<char*>(&header.y_pixels), sizeof(uint32_t));
-        ifs.read(reinterpret_cast<char*>(&header.palette_count), sizeof(uint32_t));
-        ifs.read(reinterpret_cast<char*>(&header.important_palette_index), sizeof(uint32_t));
+        reader.read_le(header.width);
+        reader.read_le(header.height);
+        reader.read_le(header.plane_count);
+        reader.read_le(header.bit_count);
+        reader.read_le(header.compression);
+        reader.read_le(header.image_size);
+        reader.read_le(header.x_pixels);
+        reader.read_le(header.y_pixels);
+        reader.read_le(header.palette_count);
+        reader.read_le(header.important_palette_index);
 
         return header;
     }
@@ -3,11 +3,13 @@
 #include <algorithm>
 #include <array>
 #include <bit>
+#include <cstdint>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iostream>
 #include <numeric>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -15,10 +17,25 @@
 
 namespace image {
     enum class Format {
+        R8,
+        RG8,
         RGB8,
         RGBA8,
+        // byte order B, G, R, A (uncompressed DDS)
+        BGRA8,
+        R16,
+        RG16,
         RGB16,
         RGBA16,
+        // 32 bits float channels (linear, HDR)
+        R32F,
+        RG32F,
+        RGB32F,
+        RGBA32F,
+        // 16 bits float channels (IEEE half)
+        R16F,
+        RG16F,
+        RGBA16F,
         BC1,
         BC2,
         BC3,
@@ -30,4 +47,88 @@ namespace image {
         BC6HS,
         BC7,
     };
+
+    // number of channels of uncompressed format (0 for block compressed format)
+    constexpr uint32_t component_count(Format format) noexcept {
+        switch(format) {
+            case Format::R8: case Format::R16: case Format::R32F: case Format::R16F: return 1;
+            case Format::RG8: case Format::RG16: case Format::RG32F: case Format::RG16F: return 2;
+            case Format::RGB8: case Format::RGB16: case Format::RGB32F: return 3;
+            case Format::RGBA8: case Format::BGRA8: case Format::RGBA16: case Format::RGBA32F: case Format::RGBA16F: return 4;
+            default: return 0;
+        }
+    }
+
+    // bytes per pixel of uncompressed format (0 for block compressed format)
+    constexpr uint32_t pixel_size(Format format) noexcept {
+        switch(format) {
+            case Format::R8: case Format::RG8: case Format::RGB8: case Format::RGBA8: case Format::BGRA8: return component_count(format);
+            case Format::R16: case Format::RG16: case Format::RGB16: case Format::RGBA16: return component_count(format) * 2;
+            case Format::R16F: case Format::RG16F: case Format::RGBA16F: return component_count(format) * 2;
+            case Format::R32F: case Format::RG32F: case Format::RGB32F: case Format::RGBA32F: return component_count(format) * 4;
+            default: return 0;
+        }
+    }
+
+    constexpr bool is_block_compressed(Format format) noexcept {
+        return format >= Format::BC1;
+    }
+
+    // 32 or 16 bits float channels (not normalized)
+    constexpr bool is_float(Format format) noexcept {
+        return format >= Format::R32F && format <= Format::RGBA16F;
+    }
+
+    // bytes per 4x4 block of block compressed format (0 for uncompressed format)
+    constexpr uint32_t block_size(Format format) noexcept {
+        switch(format) {
+            case Format::BC1: case Format::BC4U: case Format::BC4S: return 8;
+            case Format::BC2: case Format::BC3: case Format::BC5U: case Format::BC5S: case Format::BC6HU: case Format::BC6HS: case Format::BC7: return 16;
+            default: return 0;
+        }
+    }
+
+    // width and height of one block in texels (1 for uncompressed format)
+    constexpr uint32_t block_dimension(Format format) noexcept {
+        return is_block_compressed(format) ? 4 : 1;
+    }
+
+    // bytes of one tightly packed row (row of 4x4 blocks for block compressed format)
+    constexpr size_t row_pitch(Format format, uint32_t width) noexcept {
+        return is_block_compressed(format) ? size_t(std::max(1u, (width + 3) / 4)) * block_size(format) : size_t(width) * pixel_size(format);
+    }
+
+    // number of rows in memory (rows of 4x4 blocks for block compressed format)
+    constexpr uint32_t row_count(Format format, uint32_t height) noexcept {
+        return is_block_compressed(format) ? std::max(1u, (height + 3) / 4) : height;
+    }
+
+    // result of first phase of two-phase decode (header only)
+    // row_pitch is minimum (tightly packed) pitch, caller may choose larger one
+    struct ImageInfo {
+        uint32_t width;
+        uint32_t height;
+        Format format;
+        size_t row_pitch;
+
+        auto row_count() const noexcept { return image::row_count(format, height); }
+
+        // bytes required for destination with given pitch (last row is not padded)
+        size_t size(size_t pitch) const noexcept { return row_count() == 0 ? 0 : pitch * (row_count() - 1) + row_pitch; }
+        size_t size() const noexcept { return size(row_pitch); }
+
+        static ImageInfo make(uint32_t width, uint32_t height, Format format) noexcept {
+            return ImageInfo{width, height, format, image::row_pitch(format, width)};
+        }
+
+        // second phase destination must hold all rows
+        void check_destination(std::span<uint8_t> dst, size_t pitch) const {
+            if(pitch < row_pitch) {
+                throw std::runtime_error(std::format("[image::ImageInfo] ERROR: row pitch is too small (pitch = {}, required = {}).", pitch, row_pitch));
+            }
+            if(dst.size() < size(pitch)) {
+                throw std::runtime_error(std::format("[image::ImageInfo] ERROR: destination is too small (size = {}, required = {}).", dst.size(), size(pitch)));
+            }
+        }
+    };
 }
\ No newline at end of file
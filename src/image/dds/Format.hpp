@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../common.hpp"
+
+namespace image {
+
+namespace dds {
+
+// DXGI_FORMAT in DX10 header
+inline Format format_of_dxgi(uint32_t dxgi_format) {
+    switch(dxgi_format) {
+        // R8G8B8A8_*
+        case 27: case 28: case 29: return Format::RGBA8;
+        // B8G8R8A8_*, B8G8R8X8_* (alpha is undefined)
+        case 87: case 88: case 90: case 91: case 92: case 93: return Format::BGRA8;
+        // R16G16B16A16_*
+        case 9: case 11: return Format::RGBA16;
+        // R32G32B32A32_FLOAT, R32G32B32_FLOAT, R32G32_FLOAT, R32_FLOAT
+        case 2: return Format::RGBA32F;
+        case 6: return Format::RGB32F;
+        case 16: return Format::RG32F;
+        case 41: return Format::R32F;
+        // R16G16B16A16_FLOAT, R16G16_FLOAT, R16_FLOAT
+        case 10: return Format::RGBA16F;
+        case 34: return Format::RG16F;
+        case 54: return Format::R16F;
+        case 33: case 35: return Format::RG16;
+        case 48: case 49: return Format::RG8;
+        case 53: case 56: return Format::R16;
+        case 60: case 61: return Format::R8;
+        case 70: case 71: case 72: return Format::BC1;
+        case 73: case 74: case 75: return Format::BC2;
+        case 76: case 77: case 78: return Format::BC3;
+        case 79: case 80: return Format::BC4U;
+        case 81: return Format::BC4S;
+        case 82: case 83: return Format::BC5U;
+        case 84: return Format::BC5S;
+        case 94: case 95: return Format::BC6HU;
+        case 96: return Format::BC6HS;
+        case 97: case 98: case 99: return Format::BC7;
+        default:
+            throw std::runtime_error(std::format("[image::dds] ERROR: unsupported DXGI format: {}", dxgi_format));
+    }
+}
+
+inline bool is_srgb_dxgi_format(uint32_t dxgi_format) noexcept {
+    switch(dxgi_format) {
+        case 29: case 72: case 75: case 78: case 91: case 93: case 99: return true;
+        default: return false;
+    }
+}
+
+// DXGI_FORMAT written to DX10 header
+inline uint32_t dxgi_format_of(Format format, bool is_srgb) {
+    switch(format) {
+        case Format::RGBA8: return is_srgb ? 29 : 28;
+        case Format::BGRA8: return is_srgb ? 91 : 87;
+        case Format::RGBA16: return 11;
+        case Format::RG16: return 35;
+        case Format::RG8: return 49;
+        case Format::R16: return 56;
+        case Format::R8: return 61;
+        case Format::RGBA32F: return 2;
+        case Format::RGB32F: return 6;
+        case Format::RG32F: return 16;
+        case Format::R32F: return 41;
+        case Format::RGBA16F: return 10;
+        case Format::RG16F: return 34;
+        case Format::R16F: return 54;
+        case Format::BC1: return is_srgb ? 72 : 71;
+        case Format::BC2: return is_srgb ? 75 : 74;
+        case Format::BC3: return is_srgb ? 78 : 77;
+        case Format::BC4U: return 80;
+        case Format::BC4S: return 81;
+        case Format::BC5U: return 83;
+        case Format::BC5S: return 84;
+        case Format::BC6HU: return 95;
+        case Format::BC6HS: return 96;
+        case Format::BC7: return is_srgb ? 99 : 98;
+        default:
+            throw std::runtime_error(std::format("[image::dds] ERROR: format has no DXGI format: {}", static_cast<uint32_t>(format)));
+    }
+}
+
+}
+
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../common.hpp"
+#include "../../io/ByteReader.hpp"
 
 namespace image {
 
@@ -27,35 +28,49 @@ struct Header {
     uint32_t caps2;
 };
 
-inline Header read_header(std::ifstream& ifs) {
+inline Header read_header(io::ByteReader& reader) {
     Header header{};
 
-    ifs.read(reinterpret_cast<char*>(&header.magic), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.size), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.flags), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.height), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.width), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.pitch_or_linear_size), sizeof(uint32_t));
-
-    ifs.read(reinterpret_cast<char*>(&header.depth), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.mipmap_count), sizeof(uint32_t));
-    ifs.seekg(sizeof(uint32_t) * 11, std::ios::cur);
-    ifs.read(reinterpret_cast<char*>(&header.pf_size), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.pf_flags), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.four_cc), sizeof(uint32_t));
-
-    ifs.read(reinterpret_cast<char*>(&header.rgb_bit_count), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.r_bit_mask), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.g_bit_mask), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.b_bit_mask), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.a_bit_mask), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.caps), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.caps2), sizeof(uint32_t));
-    ifs.seekg(sizeof(uint32_t) * 3, std::ios::cur);
+    reader.read_le(header.magic);
+    reader.read_le(header.size);
+    reader.read_le(header.flags);
+    reader.read_le(header.height);
+    reader.read_le(header.width);
+    reader.read_le(header.pitch_or_linear_size);
+
+    reader.read_le(header.depth);
+    reader.read_le(header.mipmap_count);
+    reader.skip(sizeof(uint32_t) * 11);
+    reader.read_le(header.pf_size);
+    reader.read_le(header.pf_flags);
+    reader.read_le(header.four_cc);
+
+    reader.read_le(header.rgb_bit_count);
+    reader.read_le(header.r_bit_mask);
+    reader.read_le(header.g_bit_mask);
+    reader.read_le(header.b_bit_mask);
+    reader.read_le(header.a_bit_mask);
+    reader.read_le(header.caps);
+    reader.read_le(header.caps2);
+    reader.skip(sizeof(uint32_t) * 3);
 
     return header;
 }
 
+inline void write_header(std::vector<uint8_t>& out, const Header& header) {
+    const uint32_t fields[] = {
+        header.magic, header.size, header.flags, header.height, header.width, header.pitch_or_linear_size, header.depth, header.mipmap_count,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        header.pf_size, header.pf_flags, header.four_cc, header.rgb_bit_count, header.r_bit_mask, header.g_bit_mask, header.b_bit_mask, header.a_bit_mask,
+        header.caps, header.caps2, 0, 0, 0,
+    };
+    for(auto field : fields) {
+        uint8_t bytes[4];
+        io::store_le(bytes, field);
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+}
+
 }
 
 }
\ No newline at end of file
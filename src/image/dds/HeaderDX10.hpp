@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../common.hpp"
+#include "../../io/ByteReader.hpp"
 
 namespace image {
 
@@ -14,18 +15,26 @@ struct HeaderDX10 {
     uint32_t misc_flag2;
 };
 
-inline HeaderDX10 read_header_dx10(std::ifstream& ifs) {
+inline HeaderDX10 read_header_dx10(io::ByteReader& reader) {
     HeaderDX10 header{};
 
-    ifs.read(reinterpret_cast<char*>(&header.format), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.dimension), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.misc_flag), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.array_size), sizeof(uint32_t));
-    ifs.read(reinterpret_cast<char*>(&header.misc_flag2), sizeof(uint32_t));
+    reader.read_le(header.format);
+    reader.read_le(header.dimension);
+    reader.read_le(header.misc_flag);
+    reader.read_le(header.array_size);
+    reader.read_le(header.misc_flag2);
 
     return header;
 }
 
+inline void write_header_dx10(std::vector<uint8_t>& out, const HeaderDX10& header) {
+    for(auto field : {header.format, header.dimension, header.misc_flag, header.array_size, header.misc_flag2}) {
+        uint8_t bytes[4];
+        io::store_le(bytes, field);
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+}
+
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../common.hpp"
+
+namespace image {
+
+namespace dds {
+
+// one mip level of one array layer (cube face) in payload
+// rows are tightly packed, so VkBufferImageCopy needs only bufferOffset = payload offset in buffer + offset
+// (bufferRowLength = bufferImageHeight = 0)
+struct Subresource {
+    uint32_t mip_level;
+    uint32_t array_layer;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    // from beginning of payload
+    size_t offset;
+    // bytes of one row (row of 4x4 blocks for block compressed format)
+    size_t row_pitch;
+    // rows of one depth slice (rows of blocks for block compressed format)
+    uint32_t row_count;
+    // all depth slices
+    size_t size;
+
+    size_t slice_pitch() const noexcept { return row_pitch * row_count; }
+};
+
+// shape of texture and location of every subresource in payload
+// DDS stores layers one after another, each layer holds its whole mip chain (largest first), all tightly packed
+struct Layout {
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t mip_count;
+    // 6 per cube (faces +X, -X, +Y, -Y, +Z, -Z)
+    uint32_t layer_count;
+    bool is_cube;
+    Format format;
+    // index is layer * mip_count + mip
+    std::vector<Subresource> subresources;
+    // bytes of payload
+    size_t size;
+
+    // throws if payload would be larger than max_size
+    static Layout make(Format format, uint32_t width, uint32_t height, uint32_t depth, uint32_t mip_count, uint32_t layer_count, bool is_cube, size_t max_size) {
+        if(width == 0 || height == 0 || depth == 0 || layer_count == 0) {
+            throw std::runtime_error(std::format("[image::dds::Layout] ERROR: invalid size: {} x {} x {}, {} layers", width, height, depth, layer_count));
+        }
+        auto full_chain = static_cast<uint32_t>(std::bit_width(std::max({width, height, depth})));
+        if(mip_count == 0 || mip_count > full_chain) {
+            throw std::runtime_error(std::format("[image::dds::Layout] ERROR: invalid mip count: {} (size = {} x {} x {})", mip_count, width, height, depth));
+        }
+
+        Layout layout{width, height, depth, mip_count, layer_count, is_cube, format, {}, 0};
+        layout.subresources.reserve(size_t(mip_count) * layer_count);
+        for(uint32_t layer = 0; layer < layer_count; ++layer) {
+            for(uint32_t mip = 0; mip < mip_count; ++mip) {
+                Subresource subresource{};
+                subresource.mip_level = mip;
+                subresource.array_layer = layer;
+                subresource.width = std::max(1u, width >> mip);
+                subresource.height = std::max(1u, height >> mip);
+                subresource.depth = std::max(1u, depth >> mip);
+                subresource.offset = layout.size;
+                subresource.row_pitch = image::row_pitch(format, subresource.width);
+                subresource.row_count = image::row_count(format, subresource.height);
+                subresource.size = subresource.slice_pitch() * subresource.depth;
+                // checked per subresource so that sum cannot overflow
+                if(subresource.size > max_size - layout.size) {
+                    throw std::runtime_error(std::format("[image::dds::Layout] ERROR: payload is truncated (mip = {}, layer = {}, available = {}).", mip, layer, max_size));
+                }
+                layout.size += subresource.size;
+                layout.subresources.push_back(subresource);
+            }
+        }
+
+        return layout;
+    }
+
+    const Subresource& subresource(uint32_t mip, uint32_t layer) const {
+        if(mip >= mip_count || layer >= layer_count) {
+            throw std::runtime_error(std::format("[image::dds::Layout] ERROR: subresource out of range (mip = {}, layer = {}).", mip, layer));
+        }
+        return subresources[size_t(layer) * mip_count + mip];
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <charconv>
+
+#include "../common.hpp"
+
+namespace image {
+
+namespace hdr {
+
+// Radiance picture header (text lines until empty line, then resolution line)
+//   #?RADIANCE
+//   FORMAT=32-bit_rle_rgbe
+//   (other variables, e.g. EXPOSURE, are ignored: pixels are returned as stored)
+//
+//   -Y height +X width
+struct Header {
+    uint32_t width;
+    uint32_t height;
+    // +Y: first scanline is bottom row of image
+    bool is_bottom_up;
+    // first byte of scanlines
+    size_t data_offset;
+};
+
+inline bool is_hdr(std::span<const uint8_t> head) noexcept {
+    auto starts_with = [&](std::string_view magic) {
+        return head.size() >= magic.size() && std::equal(magic.begin(), magic.end(), head.begin());
+    };
+    return starts_with("#?RADIANCE\n") || starts_with("#?RGBE\n");
+}
+
+inline Header read_header(std::span<const uint8_t> bytes) {
+    if(!is_hdr(bytes)) {
+        throw std::runtime_error("[image::hdr] ERROR: not a Radiance picture (#?RADIANCE or #?RGBE expected).");
+    }
+
+    size_t position = 0;
+    auto read_line = [&]() {
+        auto first = position;
+        while(position < bytes.size() && bytes[position] != '\n') {
+            ++position;
+        }
+        if(position == bytes.size()) {
+            throw std::runtime_error("[image::hdr] ERROR: unexpected end of header.");
+        }
+        return std::string_view(reinterpret_cast<const char*>(bytes.data()) + first, position++ - first);
+    };
+
+    read_line();
+    for(auto line = read_line(); !line.empty(); line = read_line()) {
+        if(line.starts_with("FORMAT=") && line != "FORMAT=32-bit_rle_rgbe") {
+            throw std::runtime_error(std::format("[image::hdr] ERROR: unsupported pixel format: {}", line.substr(7)));
+        }
+    }
+
+    // "-Y height +X width" (or "+Y" for bottom-up), rotated and mirrored orientations are not supported
+    auto line = read_line();
+    auto read_size = [&](std::string_view& rest) {
+        uint32_t value{};
+        auto [end, ec] = std::from_chars(rest.data(), rest.data() + rest.size(), value);
+        if(ec != std::errc{} || value == 0) {
+            throw std::runtime_error(std::format("[image::hdr] ERROR: invalid resolution: {}", line));
+        }
+        rest.remove_prefix(end - rest.data());
+        return value;
+    };
+    Header header{};
+    auto rest = line;
+    if(rest.starts_with("-Y ") || rest.starts_with("+Y ")) {
+        header.is_bottom_up = rest[0] == '+';
+        rest.remove_prefix(3);
+        header.height = read_size(rest);
+        if(rest.starts_with(" +X ")) {
+            rest.remove_prefix(4);
+            header.width = read_size(rest);
+        }
+    }
+    if(header.width == 0 || !rest.empty()) {
+        throw std::runtime_error(std::format("[image::hdr] ERROR: unsupported resolution line: {}", line));
+    }
+    header.data_offset = position;
+
+    return header;
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstring>
+
+#include "../pixel/Half.hpp"
+#include "../pixel/Kernels.hpp"
+
+namespace image {
+
+namespace hdr {
+
+// RGBE (shared exponent) -> linear RGBA float or half (alpha 1), count pixels
+// value = mantissa * 2^(exponent - 136) as stb_image decodes it, exponent 0 is black
+// scale 2^(exponent - 128) is built from float bits, so exponent 1 (results below smallest normal float) is flushed to zero
+
+inline float rgbe_scale_(uint8_t exponent) noexcept {
+    return std::bit_cast<float>(uint32_t(exponent > 1 ? exponent - 1 : 0) << 23);
+}
+
+inline void rgbe_to_rgba32f_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        const auto* pixel = src + i * 4;
+        auto scale = rgbe_scale_(pixel[3]);
+        float rgba[4] = {pixel[0] * (1.0f / 256.0f) * scale, pixel[1] * (1.0f / 256.0f) * scale, pixel[2] * (1.0f / 256.0f) * scale, 1.0f};
+        std::memcpy(dst + i * 16, rgba, 16);
+    }
+}
+
+inline void rgbe_to_rgba16f_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        const auto* pixel = src + i * 4;
+        auto scale = rgbe_scale_(pixel[3]);
+        uint16_t rgba[4] = {
+            pixel::float_to_half(pixel[0] * (1.0f / 256.0f) * scale), pixel::float_to_half(pixel[1] * (1.0f / 256.0f) * scale),
+            pixel::float_to_half(pixel[2] * (1.0f / 256.0f) * scale), 0x3c00,
+        };
+        std::memcpy(dst + i * 8, rgba, 8);
+    }
+}
+
+#if defined(IMAGE_SIMD_X86)
+// one pixel of 32 bits lanes (r, g, b, e) to RGBA floats
+IMAGE_TARGET("sse2") inline __m128 rgbe_pixel_sse2_(__m128i rgbe) noexcept {
+    auto exponent = _mm_shuffle_epi32(rgbe, _MM_SHUFFLE(3, 3, 3, 3));
+    auto field = _mm_and_si128(_mm_sub_epi32(exponent, _mm_set1_epi32(1)), _mm_cmpgt_epi32(exponent, _mm_setzero_si128()));
+    auto scale = _mm_castsi128_ps(_mm_slli_epi32(field, 23));
+    auto rgb = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(rgbe), _mm_set1_ps(1.0f / 256.0f)), scale);
+    const auto rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    return _mm_or_ps(_mm_and_ps(rgb, rgb_mask), _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f));
+}
+
+// 4 pixels (16 bytes) to 4 RGBA float vectors
+IMAGE_TARGET("sse2") inline void rgbe_pixels_sse2_(const uint8_t* src, __m128* rgba) noexcept {
+    const auto zero = _mm_setzero_si128();
+    auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    auto low = _mm_unpacklo_epi8(bytes, zero);
+    auto high = _mm_unpackhi_epi8(bytes, zero);
+    rgba[0] = rgbe_pixel_sse2_(_mm_unpacklo_epi16(low, zero));
+    rgba[1] = rgbe_pixel_sse2_(_mm_unpackhi_epi16(low, zero));
+    rgba[2] = rgbe_pixel_sse2_(_mm_unpacklo_epi16(high, zero));
+    rgba[3] = rgbe_pixel_sse2_(_mm_unpackhi_epi16(high, zero));
+}
+
+IMAGE_TARGET("sse2") inline void rgbe_to_rgba32f_sse2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 rgba[4];
+        rgbe_pixels_sse2_(src + i * 4, rgba);
+        for(uint32_t k = 0; k < 4; ++k) {
+            _mm_storeu_ps(reinterpret_cast<float*>(dst + (i + k) * 16), rgba[k]);
+        }
+    }
+    rgbe_to_rgba32f_scalar(src + i * 4, dst + i * 16, count - i);
+}
+
+// floats are converted in registers, so half output needs no float buffer
+IMAGE_TARGET("avx,f16c") inline void rgbe_to_rgba16f_f16c(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 rgba[4];
+        rgbe_pixels_sse2_(src + i * 4, rgba);
+        auto low = _mm256_cvtps_ph(_mm256_insertf128_ps(_mm256_castps128_ps256(rgba[0]), rgba[1], 1), _MM_FROUND_TO_NEAREST_INT);
+        auto high = _mm256_cvtps_ph(_mm256_insertf128_ps(_mm256_castps128_ps256(rgba[2]), rgba[3], 1), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 8), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 8 + 16), high);
+    }
+    rgbe_to_rgba16f_scalar(src + i * 4, dst + i * 8, count - i);
+}
+#endif
+
+// RGBA32F or RGBA16F output, nullptr for other formats
+inline pixel::Kernel select_rgbe_kernel(Format format) noexcept {
+    if(format == Format::RGBA32F) {
+#if defined(IMAGE_SIMD_X86)
+        if(simd::features().sse2) {
+            return rgbe_to_rgba32f_sse2;
+        }
+#endif
+        return rgbe_to_rgba32f_scalar;
+    }
+    if(format == Format::RGBA16F) {
+#if defined(IMAGE_SIMD_X86)
+        if(simd::features().f16c) {
+            return rgbe_to_rgba16f_f16c;
+        }
+#endif
+        return rgbe_to_rgba16f_scalar;
+    }
+    return nullptr;
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../common.hpp"
+
+namespace image {
+
+namespace hdr {
+
+// decodes one scanline of width RGBE pixels to dst (4 bytes per pixel), returns bytes consumed from src
+// adaptive RLE (2, 2, width >> 8, width & 0xff, then each of 4 channels as runs and literals) is used for widths in [8, 0x7fff],
+// flat pixels may contain old RLE (1, 1, 1, n: previous pixel repeated n << shift times, shift grows by 8 for consecutive runs)
+inline size_t decode_scanline(std::span<const uint8_t> src, uint8_t* dst, uint32_t width) {
+    auto truncated = []() {
+        return std::runtime_error("[image::hdr] ERROR: scanline is truncated.");
+    };
+    if(src.size() < 4) {
+        throw truncated();
+    }
+
+    bool is_adaptive = width >= 8 && width <= 0x7fff && src[0] == 2 && src[1] == 2 && !(src[2] & 0x80);
+    if(!is_adaptive) {
+        size_t position = 0;
+        uint32_t shift = 0;
+        for(uint32_t x = 0; x < width;) {
+            if(src.size() - position < 4) {
+                throw truncated();
+            }
+            const auto* pixel = src.data() + position;
+            position += 4;
+            if(pixel[0] == 1 && pixel[1] == 1 && pixel[2] == 1) {
+                auto count = size_t(pixel[3]) << shift;
+                if(x == 0 || count > width - x) {
+                    throw std::runtime_error("[image::hdr] ERROR: invalid run of pixels.");
+                }
+                for(size_t i = 0; i < count; ++i, ++x) {
+                    std::memcpy(dst + size_t(x) * 4, dst + size_t(x - 1) * 4, 4);
+                }
+                shift += 8;
+                continue;
+            }
+            std::memcpy(dst + size_t(x) * 4, pixel, 4);
+            ++x;
+            shift = 0;
+        }
+        return position;
+    }
+
+    if(((uint32_t(src[2]) << 8) | src[3]) != width) {
+        throw std::runtime_error(std::format("[image::hdr] ERROR: scanline width does not match image (scanline = {}, image = {}).", (uint32_t(src[2]) << 8) | src[3], width));
+    }
+    size_t position = 4;
+    for(uint32_t c = 0; c < 4; ++c) {
+        for(uint32_t x = 0; x < width;) {
+            if(position >= src.size()) {
+                throw truncated();
+            }
+            uint32_t count = src[position++];
+            // > 128: run of count - 128 copies of next byte, otherwise count literal bytes
+            bool is_run = count > 128;
+            count = is_run ? count - 128 : count;
+            if(count == 0 || count > width - x) {
+                throw std::runtime_error("[image::hdr] ERROR: invalid run length.");
+            }
+            if(src.size() - position < (is_run ? 1 : count)) {
+                throw truncated();
+            }
+            for(uint32_t i = 0; i < count; ++i, ++x) {
+                dst[size_t(x) * 4 + c] = src[is_run ? position : position + i];
+            }
+            position += is_run ? 1 : count;
+        }
+    }
+    return position;
+}
+
+}
+
+}
\ No newline at end of file
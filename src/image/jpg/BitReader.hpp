@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstring>
+
+#include "utils.hpp"
+
+namespace image {
+
+namespace jpg {
+
+// MSB-first bit reader for entropy-coded segment
+// stuffed zero bytes (0xff 0x00) are removed while refilling, reading stops at marker
+// (zero bits are fed after marker or end of data, check overrun() to detect truncation)
+struct BitReader {
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    uint64_t buffer;
+    uint32_t bit_count;
+    // marker found at position
+    bool has_marker;
+    // zero bytes fed after marker or end of data
+    uint32_t padding_count;
+
+    BitReader(const uint8_t* d, size_t s) noexcept : data(d), size(s), position(0), buffer(0), bit_count(0), has_marker(false), padding_count(0) {}
+
+    // after refill, accumulator has at least 57 bits
+    void refill() noexcept {
+        // no 0xff in next 8 bytes -> whole bytes are copied at once
+        if(!has_marker && bit_count <= 56 && position + 8 <= size) {
+            uint64_t word{};
+            std::memcpy(&word, data + position, sizeof(uint64_t));
+            auto inverted = ~word;
+            if(((inverted - 0x0101010101010101ull) & ~inverted & 0x8080808080808080ull) == 0) {
+                if constexpr(std::endian::native == std::endian::little) {
+                    word = io::byteswap(word);
+                }
+                auto count = (64 - bit_count) >> 3;
+                auto shift = 64 - count * 8;
+                buffer |= (shift == 0 ? word : word >> shift << shift) >> bit_count;
+                bit_count += count * 8;
+                position += count;
+                return;
+            }
+        }
+        while(bit_count <= 56) {
+            uint64_t byte = 0;
+            if(!has_marker && position < size) {
+                byte = data[position];
+                if(byte == 0xff) {
+                    // 0xff 0x00 is data byte 0xff, anything else is marker
+                    if(position + 1 < size && data[position + 1] == 0x00) {
+                        position += 2;
+                    }
+                    else {
+                        has_marker = true;
+                        byte = 0;
+                        ++padding_count;
+                    }
+                }
+                else {
+                    ++position;
+                }
+            }
+            else {
+                ++padding_count;
+            }
+            buffer |= byte << (56 - bit_count);
+            bit_count += 8;
+        }
+    }
+
+    // count <= 16
+    uint32_t peek(uint32_t count) noexcept {
+        if(bit_count < count) {
+            refill();
+        }
+        return static_cast<uint32_t>(buffer >> (64 - count));
+    }
+
+    void consume(uint32_t count) noexcept {
+        buffer <<= count;
+        bit_count -= count;
+    }
+
+    // count <= 16
+    uint32_t read_bits(uint32_t count) noexcept {
+        if(count == 0) {
+            return 0;
+        }
+        auto value = peek(count);
+        consume(count);
+        return value;
+    }
+
+    // more bits were consumed than data had (8 padding bytes are always buffered ahead)
+    bool overrun() const noexcept {
+        return padding_count * 8 > bit_count;
+    }
+
+    // skip to byte after next restart marker RSTn and clear accumulator
+    // (returns false if other marker or end of data comes first)
+    bool restart() noexcept {
+        buffer = 0;
+        bit_count = 0;
+        padding_count = 0;
+        has_marker = false;
+        while(position + 1 < size) {
+            if(data[position] == 0xff) {
+                auto marker = data[position + 1];
+                if((marker & 0xf8) == 0xd0) {
+                    position += 2;
+                    return true;
+                }
+                if(marker != 0x00 && marker != 0xff) {
+                    return false;
+                }
+            }
+            ++position;
+        }
+        return false;
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,577 @@
+#pragma once
+
+#include "utils.hpp"
+#include "Decoder.hpp"
+#include "../simd.hpp"
+
+namespace image {
+
+namespace jpg {
+
+// YCbCr -> RGB (JFIF, 16 bits fixed point as libjpeg)
+constexpr int32_t YCC_SHIFT = 16;
+constexpr int32_t YCC_HALF = 1 << (YCC_SHIFT - 1);
+constexpr int32_t YCC_CR_R = 91881;
+constexpr int32_t YCC_CB_G = -22554;
+constexpr int32_t YCC_CR_G = -46802;
+constexpr int32_t YCC_CB_B = 116130;
+
+inline void ycbcr_to_rgb(uint8_t y, uint8_t cb, uint8_t cr, uint8_t* rgb) noexcept {
+    int32_t b = cb - 128;
+    int32_t r = cr - 128;
+    rgb[0] = static_cast<uint8_t>(std::clamp(y + ((YCC_CR_R * r + YCC_HALF) >> YCC_SHIFT), 0, 255));
+    rgb[1] = static_cast<uint8_t>(std::clamp(y + ((YCC_CB_G * b + YCC_CR_G * r + YCC_HALF) >> YCC_SHIFT), 0, 255));
+    rgb[2] = static_cast<uint8_t>(std::clamp(y + ((YCC_CB_B * b + YCC_HALF) >> YCC_SHIFT), 0, 255));
+}
+
+#if defined(IMAGE_SIMD_X86)
+
+// SIMD kernels compute same values as ycbcr_to_rgb: constants out of 16 bits range are split into multiple of 1 << YCC_SHIFT
+// (added as shifted Cb/Cr) and remainder, so that each channel is one multiply-add of (Cb, Cr) pair
+constexpr int32_t ycc_pair_(int32_t cb_coefficient, int32_t cr_coefficient) noexcept {
+    return static_cast<int32_t>((uint32_t(uint16_t(cr_coefficient)) << 16) | uint16_t(cb_coefficient));
+}
+
+constexpr int32_t YCC_PAIR_R = ycc_pair_(0, YCC_CR_R - (1 << YCC_SHIFT));
+constexpr int32_t YCC_PAIR_G = ycc_pair_(YCC_CB_G, YCC_CR_G + (1 << YCC_SHIFT));
+constexpr int32_t YCC_PAIR_B = ycc_pair_(YCC_CB_B - (2 << YCC_SHIFT), 0);
+
+IMAGE_TARGET("sse2") inline __m128i ycc_term_sse2_(__m128i pairs_low, __m128i pairs_high, int32_t coefficients) noexcept {
+    auto c = _mm_set1_epi32(coefficients);
+    auto half = _mm_set1_epi32(YCC_HALF);
+    auto low = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(pairs_low, c), half), YCC_SHIFT);
+    auto high = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(pairs_high, c), half), YCC_SHIFT);
+    return _mm_packs_epi32(low, high);
+}
+
+// 8 pixels of 16 bits samples -> RGBA of pixels 0-3 (low) and 4-7 (high)
+IMAGE_TARGET("sse2") inline void ycbcr_to_rgba8_sse2_(__m128i y, __m128i cb, __m128i cr, __m128i& low, __m128i& high) noexcept {
+    auto bias = _mm_set1_epi16(128);
+    cb = _mm_sub_epi16(cb, bias);
+    cr = _mm_sub_epi16(cr, bias);
+    auto pairs_low = _mm_unpacklo_epi16(cb, cr);
+    auto pairs_high = _mm_unpackhi_epi16(cb, cr);
+
+    auto r = _mm_add_epi16(_mm_add_epi16(y, cr), ycc_term_sse2_(pairs_low, pairs_high, YCC_PAIR_R));
+    auto g = _mm_add_epi16(_mm_sub_epi16(y, cr), ycc_term_sse2_(pairs_low, pairs_high, YCC_PAIR_G));
+    auto b = _mm_add_epi16(_mm_add_epi16(y, _mm_add_epi16(cb, cb)), ycc_term_sse2_(pairs_low, pairs_high, YCC_PAIR_B));
+
+    // saturation clamps to 0 ... 255
+    auto rb = _mm_packus_epi16(r, b);
+    auto ga = _mm_packus_epi16(g, _mm_set1_epi16(255));
+    auto rg = _mm_unpacklo_epi8(rb, ga);
+    auto ba = _mm_unpackhi_epi8(rb, ga);
+    low = _mm_unpacklo_epi16(rg, ba);
+    high = _mm_unpackhi_epi16(rg, ba);
+}
+
+// chroma loaders of conversion kernels return 8 (load8) or 16 (load16) samples of pixels x ... as 16 bits
+
+// returns number of pixels converted (from x while x + 8 <= end)
+template<typename CHROMA>
+IMAGE_TARGET("sse2") uint32_t ycbcr_to_rgba_sse2_(const uint8_t* y, const CHROMA& chroma, uint8_t* dst, uint32_t x, uint32_t end) noexcept {
+    for(; x + 8 <= end; x += 8) {
+        auto luma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), _mm_setzero_si128());
+        __m128i cb, cr, low, high;
+        chroma.load8(x, cb, cr);
+        ycbcr_to_rgba8_sse2_(luma, cb, cr, low, high);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4 + 16), high);
+    }
+    return x;
+}
+
+// RGBA -> RGB by shuffle (24 bytes per 8 pixels)
+template<typename CHROMA>
+IMAGE_TARGET("ssse3") uint32_t ycbcr_to_rgb_ssse3_(const uint8_t* y, const CHROMA& chroma, uint8_t* dst, uint32_t x, uint32_t end) noexcept {
+    auto drop_alpha = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    for(; x + 8 <= end; x += 8) {
+        auto luma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), _mm_setzero_si128());
+        __m128i cb, cr, low, high;
+        chroma.load8(x, cb, cr);
+        ycbcr_to_rgba8_sse2_(luma, cb, cr, low, high);
+        low = _mm_shuffle_epi8(low, drop_alpha);
+        high = _mm_shuffle_epi8(high, drop_alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 3), _mm_or_si128(low, _mm_slli_si128(high, 12)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 3 + 16), _mm_srli_si128(high, 4));
+    }
+    return x;
+}
+
+IMAGE_TARGET("avx2") inline __m256i ycc_term_avx2_(__m256i pairs_low, __m256i pairs_high, int32_t coefficients) noexcept {
+    auto c = _mm256_set1_epi32(coefficients);
+    auto half = _mm256_set1_epi32(YCC_HALF);
+    auto low = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(pairs_low, c), half), YCC_SHIFT);
+    auto high = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(pairs_high, c), half), YCC_SHIFT);
+    return _mm256_packs_epi32(low, high);
+}
+
+// 16 pixels per iteration (all steps stay in 128 bits lanes, halves are put together by final permute)
+template<typename CHROMA>
+IMAGE_TARGET("avx2") uint32_t ycbcr_to_rgba_avx2_(const uint8_t* y, const CHROMA& chroma, uint8_t* dst, uint32_t x, uint32_t end) noexcept {
+    auto bias = _mm256_set1_epi16(128);
+    auto alpha = _mm256_set1_epi16(255);
+    for(; x + 16 <= end; x += 16) {
+        auto luma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x)));
+        __m256i blue, red;
+        chroma.load16(x, blue, red);
+        blue = _mm256_sub_epi16(blue, bias);
+        red = _mm256_sub_epi16(red, bias);
+        auto pairs_low = _mm256_unpacklo_epi16(blue, red);
+        auto pairs_high = _mm256_unpackhi_epi16(blue, red);
+
+        auto r = _mm256_add_epi16(_mm256_add_epi16(luma, red), ycc_term_avx2_(pairs_low, pairs_high, YCC_PAIR_R));
+        auto g = _mm256_add_epi16(_mm256_sub_epi16(luma, red), ycc_term_avx2_(pairs_low, pairs_high, YCC_PAIR_G));
+        auto b = _mm256_add_epi16(_mm256_add_epi16(luma, _mm256_add_epi16(blue, blue)), ycc_term_avx2_(pairs_low, pairs_high, YCC_PAIR_B));
+
+        // lane 0: pixels 0-3 | 4-7, lane 1: 8-11 | 12-15
+        auto rb = _mm256_packus_epi16(r, b);
+        auto ga = _mm256_packus_epi16(g, alpha);
+        auto rg = _mm256_unpacklo_epi8(rb, ga);
+        auto ba = _mm256_unpackhi_epi8(rb, ga);
+        auto low = _mm256_unpacklo_epi16(rg, ba);
+        auto high = _mm256_unpackhi_epi16(rg, ba);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4 + 32), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    return x;
+}
+
+#endif
+
+// nearest chroma sample of pixel (horizontal FACTOR 1 or 2)
+template<uint32_t FACTOR>
+struct ReplicatedChroma {
+    const uint8_t* cb;
+    const uint8_t* cr;
+
+    // SIMD loads start at simd_begin() and end at simd_end() at most (pixels out of it are converted one by one)
+    uint32_t simd_begin() const noexcept { return 0; }
+    uint32_t simd_end(uint32_t width) const noexcept { return width; }
+
+    void sample(uint32_t x, uint8_t& blue, uint8_t& red) const noexcept {
+        blue = cb[x / FACTOR];
+        red = cr[x / FACTOR];
+    }
+
+#if defined(IMAGE_SIMD_X86)
+    // FACTOR 2: 4 samples each used twice
+    IMAGE_TARGET("sse2") static __m128i load8_(const uint8_t* c) noexcept {
+        auto zero = _mm_setzero_si128();
+        if constexpr(FACTOR == 1) {
+            return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(c)), zero);
+        }
+        else {
+            int32_t samples{};
+            std::memcpy(&samples, c, sizeof(int32_t));
+            auto v = _mm_cvtsi32_si128(samples);
+            return _mm_unpacklo_epi8(_mm_unpacklo_epi8(v, v), zero);
+        }
+    }
+
+    IMAGE_TARGET("avx2") static __m256i load16_(const uint8_t* c) noexcept {
+        if constexpr(FACTOR == 1) {
+            return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(c)));
+        }
+        else {
+            auto v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(c));
+            return _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v, v));
+        }
+    }
+
+    IMAGE_TARGET("sse2") void load8(uint32_t x, __m128i& blue, __m128i& red) const noexcept {
+        blue = load8_(cb + x / FACTOR);
+        red = load8_(cr + x / FACTOR);
+    }
+
+    IMAGE_TARGET("avx2") void load16(uint32_t x, __m256i& blue, __m256i& red) const noexcept {
+        blue = load16_(cb + x / FACTOR);
+        red = load16_(cr + x / FACTOR);
+    }
+#endif
+};
+
+// chroma interpolated as libjpeg and stb_image "fancy" upsampling: 3:1 triangle filter between nearest samples,
+// horizontally for H_FACTOR 2 and vertically for V_FACTOR 2 (near: chroma row nearest to pixel row, far: next nearest one)
+// edge samples are repeated, sums are rounded as by stb_image (libjpeg alternates rounding bias between pixels)
+template<uint32_t H_FACTOR, uint32_t V_FACTOR>
+struct InterpolatedChroma {
+    const uint8_t* cb;
+    const uint8_t* cr;
+    const uint8_t* cb_far;
+    const uint8_t* cr_far;
+    // samples in row
+    uint32_t count;
+
+    // vertically interpolated sample times 4
+    static int32_t column_(const uint8_t* near, const uint8_t* far, uint32_t i) noexcept {
+        return V_FACTOR == 2 ? 3 * near[i] + far[i] : 4 * near[i];
+    }
+
+    uint8_t interpolate_(const uint8_t* near, const uint8_t* far, uint32_t x) const noexcept {
+        auto i = x / H_FACTOR;
+        if constexpr(H_FACTOR == 1) {
+            return static_cast<uint8_t>((column_(near, far, i) + 2) >> 2);
+        }
+        else {
+            // even pixel is on left of sample center, odd one on right
+            auto j = x % 2 == 0 ? (i > 0 ? i - 1 : 0) : std::min(i + 1, count - 1);
+            return static_cast<uint8_t>((3 * column_(near, far, i) + column_(near, far, j) + 8) >> 4);
+        }
+    }
+
+    // horizontal filter loads samples x / 2 - 1 ... x / 2 + 6
+    uint32_t simd_begin() const noexcept { return H_FACTOR == 2 ? 2 : 0; }
+    uint32_t simd_end(uint32_t width) const noexcept { return H_FACTOR == 2 ? std::min(width, 2 * std::max(count, 3u) - 6) : std::min(width, count); }
+
+    void sample(uint32_t x, uint8_t& blue, uint8_t& red) const noexcept {
+        blue = interpolate_(cb, cb_far, x);
+        red = interpolate_(cr, cr_far, x);
+    }
+
+#if defined(IMAGE_SIMD_X86)
+    // 8 columns of samples i ... i + 7
+    IMAGE_TARGET("sse2") static __m128i columns8_(const uint8_t* near, const uint8_t* far, uint32_t i) noexcept {
+        auto zero = _mm_setzero_si128();
+        auto n = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(near + i)), zero);
+        if constexpr(V_FACTOR == 2) {
+            auto f = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(far + i)), zero);
+            return _mm_add_epi16(_mm_add_epi16(n, n), _mm_add_epi16(n, f));
+        }
+        else {
+            return _mm_slli_epi16(n, 2);
+        }
+    }
+
+    IMAGE_TARGET("sse2") static __m128i interpolate8_(const uint8_t* near, const uint8_t* far, uint32_t x) noexcept {
+        if constexpr(H_FACTOR == 1) {
+            return _mm_srli_epi16(_mm_add_epi16(columns8_(near, far, x), _mm_set1_epi16(2)), 2);
+        }
+        else {
+            // columns of samples i - 1 ... i + 6 for pixels of samples i ... i + 3
+            auto previous = columns8_(near, far, x / 2 - 1);
+            auto current = _mm_srli_si128(previous, 2);
+            auto next = _mm_srli_si128(previous, 4);
+            auto weighted = _mm_add_epi16(_mm_add_epi16(current, _mm_add_epi16(current, current)), _mm_set1_epi16(8));
+            auto even = _mm_srli_epi16(_mm_add_epi16(weighted, previous), 4);
+            auto odd = _mm_srli_epi16(_mm_add_epi16(weighted, next), 4);
+            return _mm_unpacklo_epi16(even, odd);
+        }
+    }
+
+    IMAGE_TARGET("sse2") void load8(uint32_t x, __m128i& blue, __m128i& red) const noexcept {
+        blue = interpolate8_(cb, cb_far, x);
+        red = interpolate8_(cr, cr_far, x);
+    }
+
+    IMAGE_TARGET("avx2") void load16(uint32_t x, __m256i& blue, __m256i& red) const noexcept {
+        blue = _mm256_inserti128_si256(_mm256_castsi128_si256(interpolate8_(cb, cb_far, x)), interpolate8_(cb, cb_far, x + 8), 1);
+        red = _mm256_inserti128_si256(_mm256_castsi128_si256(interpolate8_(cr, cr_far, x)), interpolate8_(cr, cr_far, x + 8), 1);
+    }
+#endif
+};
+
+template<uint32_t CHANNELS, typename CHROMA>
+void ycbcr_to_rgb_row_(const uint8_t* y, const CHROMA& chroma, uint8_t* dst, uint32_t width) noexcept {
+    auto convert = [&](uint32_t x) {
+        uint8_t cb{}, cr{};
+        chroma.sample(x, cb, cr);
+        ycbcr_to_rgb(y[x], cb, cr, dst + x * CHANNELS);
+        if constexpr(CHANNELS == 4) {
+            dst[x * CHANNELS + 3] = 0xff;
+        }
+    };
+
+    uint32_t x = 0;
+#if defined(IMAGE_SIMD_X86)
+    for(auto begin = std::min(chroma.simd_begin(), width); x < begin; ++x) {
+        convert(x);
+    }
+    auto end = chroma.simd_end(width);
+    const auto& features = simd::features();
+    if constexpr(CHANNELS == 4) {
+        if(features.avx2) {
+            x = ycbcr_to_rgba_avx2_(y, chroma, dst, x, end);
+        }
+        else if(features.sse2) {
+            x = ycbcr_to_rgba_sse2_(y, chroma, dst, x, end);
+        }
+    }
+    else {
+        if(features.ssse3) {
+            x = ycbcr_to_rgb_ssse3_(y, chroma, dst, x, end);
+        }
+    }
+#endif
+    for(; x < width; ++x) {
+        convert(x);
+    }
+}
+
+// one row of pixels from full resolution Y and Cb/Cr horizontally subsampled by FACTOR (1 or 2), replicated
+// upsampling is done while loading chroma, so subsampled rows are never expanded in memory
+template<uint32_t CHANNELS, uint32_t FACTOR>
+void ycbcr_to_rgb_row(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* dst, uint32_t width) noexcept {
+    ycbcr_to_rgb_row_<CHANNELS>(y, ReplicatedChroma<FACTOR>{cb, cr}, dst, width);
+}
+
+// one row of whole image width from Cb/Cr subsampled by H_FACTOR and V_FACTOR (1 or 2) and interpolated (see InterpolatedChroma)
+template<uint32_t CHANNELS, uint32_t H_FACTOR, uint32_t V_FACTOR>
+void ycbcr_to_rgb_row_interpolated(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, const uint8_t* cb_far, const uint8_t* cr_far, uint8_t* dst, uint32_t width) noexcept {
+    ycbcr_to_rgb_row_<CHANNELS>(y, InterpolatedChroma<H_FACTOR, V_FACTOR>{cb, cr, cb_far, cr_far, (width + H_FACTOR - 1) / H_FACTOR}, dst, width);
+}
+
+// horizontal replication of subsampled row (factor = h_max / h)
+inline void upsample_row_(const uint8_t* src, uint8_t* dst, uint32_t width, uint32_t h, uint32_t h_max) noexcept {
+    if(h_max % h == 0) {
+        auto factor = h_max / h;
+        for(uint32_t x = 0; x < width; x += factor) {
+            auto value = src[x / factor];
+            for(uint32_t i = 0; i < factor && x + i < width; ++i) {
+                dst[x + i] = value;
+            }
+        }
+        return;
+    }
+    for(uint32_t x = 0; x < width; ++x) {
+        dst[x] = src[size_t(x) * h / h_max];
+    }
+}
+
+template<uint32_t CHANNELS>
+void interleave_row_(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* dst, uint32_t width) noexcept {
+    for(uint32_t x = 0; x < width; ++x, dst += CHANNELS) {
+        dst[0] = r[x];
+        dst[1] = g[x];
+        dst[2] = b[x];
+        if constexpr(CHANNELS == 4) {
+            dst[3] = 0xff;
+        }
+    }
+}
+
+// chroma upsampling of PixelWriter
+enum class Upsampling {
+    // 4:2:0, 4:2:2 and 4:4:0 are interpolated (as libjpeg and stb_image, see InterpolatedChroma), others replicated
+    Interpolate,
+    // nearest sample, no context rows are needed (blocky chroma edges)
+    Replicate,
+};
+
+// band sink writing pixels as R8 (first component), RGB8 or RGBA8
+// 4:4:4, 4:2:2, 4:2:0 and 4:4:0 chroma is upsampled by conversion kernel, other samplings are replicated
+// (Cb/Cr rows are selected per output row and replicated horizontally into temporary rows first)
+// interpolation needs bands with context (decoder.decode(writer, pool, writer.needs_context()))
+class PixelWriter {
+    std::span<uint8_t> dst_;
+    size_t row_pitch_;
+    Format format_;
+    uint32_t component_count_;
+    bool is_ycbcr_;
+    // decoded samples per MCU of each component and MCU size in pixels
+    std::array<uint32_t, 3> h_;
+    std::array<uint32_t, 3> v_;
+    uint32_t h_max_;
+    uint32_t v_max_;
+    // horizontal chroma factor handled by kernel (0: replicated into temporary rows)
+    uint32_t chroma_factor_;
+    // vertical chroma factor of interpolation (0: replicated)
+    uint32_t chroma_v_factor_;
+    uint32_t chroma_height_;
+
+    template<uint32_t H_FACTOR, uint32_t V_FACTOR>
+    void interpolate_row_(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, const uint8_t* cb_far, const uint8_t* cr_far, uint8_t* out, uint32_t width) const noexcept {
+        if(format_ == Format::RGBA8) {
+            ycbcr_to_rgb_row_interpolated<4, H_FACTOR, V_FACTOR>(y, cb, cr, cb_far, cr_far, out, width);
+        }
+        else {
+            ycbcr_to_rgb_row_interpolated<3, H_FACTOR, V_FACTOR>(y, cb, cr, cb_far, cr_far, out, width);
+        }
+    }
+
+    // band is whole MCU row with chroma rows around it (band.y is on MCU boundary)
+    void write_interpolated_(const Band& band, uint32_t r, uint8_t* out) const noexcept {
+        auto y = band.y + r;
+        auto first = static_cast<ptrdiff_t>(band.y / chroma_v_factor_);
+        auto near = y / chroma_v_factor_;
+        // even pixel row is above center of its chroma row, odd one below
+        auto far = chroma_v_factor_ == 1 ? near : y % 2 == 0 ? (near > 0 ? near - 1 : 0) : std::min(near + 1, chroma_height_ - 1);
+        auto row = [&](size_t c, uint32_t i) { return band.samples[c] + (static_cast<ptrdiff_t>(i) - first) * static_cast<ptrdiff_t>(band.strides[c]); };
+
+        auto luma = band.samples[0] + size_t(r) * band.strides[0];
+        if(chroma_factor_ == 2 && chroma_v_factor_ == 2) {
+            interpolate_row_<2, 2>(luma, row(1, near), row(2, near), row(1, far), row(2, far), out, band.width);
+        }
+        else if(chroma_factor_ == 2) {
+            interpolate_row_<2, 1>(luma, row(1, near), row(2, near), row(1, far), row(2, far), out, band.width);
+        }
+        else {
+            interpolate_row_<1, 2>(luma, row(1, near), row(2, near), row(1, far), row(2, far), out, band.width);
+        }
+    }
+
+public:
+    PixelWriter(const Decoder& decoder, std::span<uint8_t> dst, size_t row_pitch, Format format, Upsampling upsampling = Upsampling::Interpolate) :
+        dst_(dst), row_pitch_(row_pitch), format_(format), component_count_(static_cast<uint32_t>(decoder.components().size())),
+        is_ycbcr_(decoder.is_ycbcr()), h_{}, v_{}, h_max_(decoder.h_max() * decoder.block_size()), v_max_(decoder.v_max() * decoder.block_size()), chroma_factor_(0),
+        chroma_v_factor_(0), chroma_height_(0)
+    {
+        if(format != Format::R8 && format != Format::RGB8 && format != Format::RGBA8) {
+            throw std::runtime_error(std::format("[image::jpg::PixelWriter] ERROR: unsupported output format: {}", static_cast<uint32_t>(format)));
+        }
+        for(size_t i = 0; i < component_count_; ++i) {
+            const auto& component = decoder.components()[i];
+            h_[i] = component.h * component.block_size;
+            v_[i] = component.v * component.block_size;
+        }
+        if(component_count_ == 3 && is_ycbcr_ && h_[0] == h_max_ && h_[1] == h_[2] && h_max_ % h_[1] == 0 && h_max_ / h_[1] <= 2) {
+            chroma_factor_ = h_max_ / h_[1];
+        }
+        if(upsampling == Upsampling::Interpolate && format != Format::R8 && chroma_factor_ != 0 && v_[0] == v_max_ && v_[1] == v_[2] && v_max_ % v_[1] == 0
+            && v_max_ / v_[1] <= 2 && (chroma_factor_ == 2 || v_max_ / v_[1] == 2))
+        {
+            chroma_v_factor_ = v_max_ / v_[1];
+            chroma_height_ = decoder.components()[1].output_height;
+        }
+    }
+
+    // bands must have context (see Band)
+    bool needs_context() const noexcept { return chroma_v_factor_ != 0; }
+
+    void operator()(const Band& band) const {
+        auto channels = component_count(format_);
+        auto color_count = format_ == Format::R8 ? 1 : component_count_;
+        auto is_rgba = format_ == Format::RGBA8;
+
+        // rows of components not handled by kernel at full resolution
+        std::vector<uint8_t> upsampled{};
+        if(chroma_factor_ == 0 && (h_max_ != h_[0] || (color_count == 3 && (h_max_ != h_[1] || h_max_ != h_[2])))) {
+            upsampled.resize(size_t(band.width) * color_count);
+        }
+
+        std::array<const uint8_t*, 3> rows{};
+        for(uint32_t r = 0; r < band.height; ++r) {
+            auto out = dst_.data() + size_t(band.y + r) * row_pitch_ + size_t(band.x) * channels;
+            if(chroma_v_factor_ != 0) {
+                write_interpolated_(band, r, out);
+                continue;
+            }
+
+            for(size_t c = 0; c < color_count; ++c) {
+                rows[c] = band.samples[c] + size_t(r) * v_[c] / v_max_ * band.strides[c];
+                if(chroma_factor_ == 0 && h_[c] != h_max_) {
+                    upsample_row_(rows[c], upsampled.data() + c * band.width, band.width, h_[c], h_max_);
+                    rows[c] = upsampled.data() + c * band.width;
+                }
+            }
+
+            if(format_ == Format::R8) {
+                std::memcpy(out, rows[0], band.width);
+            }
+            else if(color_count == 1) {
+                if(is_rgba) {
+                    interleave_row_<4>(rows[0], rows[0], rows[0], out, band.width);
+                }
+                else {
+                    interleave_row_<3>(rows[0], rows[0], rows[0], out, band.width);
+                }
+            }
+            else if(!is_ycbcr_) {
+                if(is_rgba) {
+                    interleave_row_<4>(rows[0], rows[1], rows[2], out, band.width);
+                }
+                else {
+                    interleave_row_<3>(rows[0], rows[1], rows[2], out, band.width);
+                }
+            }
+            else if(chroma_factor_ == 2) {
+                if(is_rgba) {
+                    ycbcr_to_rgb_row<4, 2>(rows[0], rows[1], rows[2], out, band.width);
+                }
+                else {
+                    ycbcr_to_rgb_row<3, 2>(rows[0], rows[1], rows[2], out, band.width);
+                }
+            }
+            else {
+                if(is_rgba) {
+                    ycbcr_to_rgb_row<4, 1>(rows[0], rows[1], rows[2], out, band.width);
+                }
+                else {
+                    ycbcr_to_rgb_row<3, 1>(rows[0], rows[1], rows[2], out, band.width);
+                }
+            }
+        }
+    }
+};
+
+// band sink writing Y plane and interleaved CbCr plane at decoded chroma resolution
+// (NV12 layout for 4:2:0, NV16 for 4:2:2, NV24 for 4:4:4), conversion to RGB is left to GPU
+class PlanarWriter {
+    std::span<uint8_t> luma_;
+    size_t luma_pitch_;
+    std::span<uint8_t> chroma_;
+    size_t chroma_pitch_;
+    bool has_chroma_;
+    // decoded chroma samples per MCU and MCU size in pixels
+    uint32_t h_;
+    uint32_t v_;
+    uint32_t h_max_;
+    uint32_t v_max_;
+    uint32_t chroma_width_;
+    uint32_t chroma_height_;
+
+public:
+    // gray scale image has no chroma plane
+    static bool is_supported(const Decoder& decoder) noexcept {
+        const auto& components = decoder.components();
+        if(components.size() == 1) {
+            return true;
+        }
+        return decoder.is_ycbcr() && components[0].h == decoder.h_max() && components[0].v == decoder.v_max()
+            && components[1].h == components[2].h && components[1].v == components[2].v;
+    }
+
+    PlanarWriter(const Decoder& decoder, std::span<uint8_t> luma, size_t luma_pitch, std::span<uint8_t> chroma, size_t chroma_pitch) :
+        luma_(luma), luma_pitch_(luma_pitch), chroma_(chroma), chroma_pitch_(chroma_pitch), has_chroma_(decoder.components().size() == 3),
+        h_(0), v_(0), h_max_(decoder.h_max() * decoder.block_size()), v_max_(decoder.v_max() * decoder.block_size()), chroma_width_(0), chroma_height_(0)
+    {
+        if(!is_supported(decoder)) {
+            throw std::runtime_error("[image::jpg::PlanarWriter] ERROR: planar output needs YCbCr image with full resolution Y and same Cb/Cr sampling.");
+        }
+        if(has_chroma_) {
+            const auto& cb = decoder.components()[1];
+            h_ = cb.h * cb.block_size;
+            v_ = cb.v * cb.block_size;
+            chroma_width_ = cb.output_width;
+            chroma_height_ = cb.output_height;
+        }
+    }
+
+    void operator()(const Band& band) const {
+        for(uint32_t r = 0; r < band.height; ++r) {
+            std::memcpy(luma_.data() + size_t(band.y + r) * luma_pitch_ + band.x, band.samples[0] + r * band.strides[0], band.width);
+        }
+        if(!has_chroma_) {
+            return;
+        }
+
+        // band starts on MCU boundary, so its first chroma sample is exact
+        auto x = band.x * h_ / h_max_;
+        auto y = band.y * v_ / v_max_;
+        auto width = std::min(chroma_width_, ((band.x + band.width) * h_ + h_max_ - 1) / h_max_) - x;
+        auto height = std::min(chroma_height_, ((band.y + band.height) * v_ + v_max_ - 1) / v_max_) - y;
+        for(uint32_t r = 0; r < height; ++r) {
+            auto cb = band.samples[1] + r * band.strides[1];
+            auto cr = band.samples[2] + r * band.strides[2];
+            auto out = chroma_.data() + size_t(y + r) * chroma_pitch_ + size_t(x) * 2;
+            for(uint32_t i = 0; i < width; ++i) {
+                out[i * 2] = cb[i];
+                out[i * 2 + 1] = cr[i];
+            }
+        }
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -20,26 +20,22 @@ struct DHT {
     std::vector<HT> hts;
 };
 
-inline DHT read_dht(std::ifstream& ifs) {
+inline DHT read_dht(io::ByteReader& reader) {
     DHT dht{};
 
-    read_be(ifs, dht.lh);
+    reader.read_be(dht.lh);
     
     auto table_size = dht.lh - 2;
     while(table_size > 0) {
         DHT::HT ht{};
 
-        read_be(ifs, ht.tc_th);
+        reader.read_be(ht.tc_th);
         table_size -= 1;
-        for(size_t i = 0; i < ht.li.size(); ++i) {
-            read_be(ifs, ht.li[i]);
-        }
+        reader.read_be(std::span(ht.li));
         table_size -= 16;
         
         ht.vi_j.resize(std::accumulate(ht.li.begin(), ht.li.end(), 0));
-        for(size_t i = 0; i < ht.vi_j.size(); ++i) {
-            read_be(ifs, ht.vi_j[i]);
-        }
+        reader.read_be(std::span(ht.vi_j));
         table_size -= sizeof(uint8_t) * static_cast<int>(ht.vi_j.size());
 
         dht.hts.emplace_back(std::move(ht));
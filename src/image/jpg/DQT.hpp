@@ -24,28 +24,24 @@ struct DQT {
 
 };
 
-inline DQT read_dqt(std::ifstream& ifs) {
+inline DQT read_dqt(io::ByteReader& reader) {
     DQT dqt{};
 
-    read_be(ifs, dqt.lq);
+    reader.read_be(dqt.lq);
 
     auto table_size = dqt.lq - 2;
     while(table_size > 0) {
         DQT::QT qt{};
-        read_be(ifs, qt.pq_tq);
+        reader.read_be(qt.pq_tq);
         table_size -= 1;
         // 8bit table
         if(qt.pq() == 0) {
-            for(size_t i = 0; i < qt.qk.u8.size(); ++i) {
-                read_be(ifs, qt.qk.u8[i]);
-            }
+            reader.read_be(std::span(qt.qk.u8));
             table_size -= 64;
         }
         // 16bit table
         else {
-            for(size_t i = 0; i < qt.qk.u16.size(); ++i) {
-                read_be(ifs, qt.qk.u16[i]);
-            }
+            reader.read_be(std::span(qt.qk.u16));
             table_size -= 128;
         }
 
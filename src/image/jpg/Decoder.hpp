@@ -0,0 +1,686 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <span>
+
+#include "../../io/MappedFile.hpp"
+#include "../../concurrency/ThreadPool.hpp"
+
+#include "utils.hpp"
+#include "DHT.hpp"
+#include "DQT.hpp"
+#include "SOF0.hpp"
+#include "SOS.hpp"
+#include "BitReader.hpp"
+#include "Huffman.hpp"
+#include "IDCT.hpp"
+
+namespace image {
+
+namespace jpg {
+
+// frame component with its decoded samples
+struct Component {
+    uint8_t id;
+    // sampling factors
+    uint32_t h;
+    uint32_t v;
+    uint32_t quantization_index;
+    // coded samples covered by image (ceil(X * h / h_max) x ceil(Y * v / v_max))
+    uint32_t width;
+    uint32_t height;
+    // decoded samples per block side (8 unless scaled) and decoded samples covered by image
+    uint32_t block_size;
+    uint32_t output_width;
+    uint32_t output_height;
+    // plane is padded to whole MCUs
+    size_t stride;
+    std::vector<uint8_t> plane;
+};
+
+// decoded samples of pixel rectangle (one MCU row or part of it)
+// bands decoded with context are whole MCU rows, and sample rows right above and below band (where component has them)
+// are readable too, so that sink can interpolate across band edges
+struct Band {
+    // pixels [x, x + width) x [y, y + height) (x and y are on MCU boundary)
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    // for each frame component, sample corresponding to pixel (x, y) and row stride
+    std::array<const uint8_t*, 3> samples;
+    std::array<size_t, 3> strides;
+};
+
+// receives bands of decoded image (bands are disjoint, called from pool threads in any order when decoded in parallel)
+using BandSink = std::function<void(const Band&)>;
+
+// baseline sequential JPEG decoder (SOF0/SOF1, 8 bits, Huffman coding, 1 or 3 components)
+// Huffman decoding and dequantization (in zigzag order) of one MCU row, then IDCT of each block row of the MCU row
+// image coded in one scan (usual interleaved file) is passed to sink MCU row by MCU row while it is in cache,
+// multi-scan image is decoded into per-component planes first
+// scaled decoding (1/2, 1/4, 1/8) uses reduced IDCTs: full resolution component blocks become 4 x 4, 2 x 2 or 1 x 1 samples,
+// subsampled components keep larger blocks as long as it saves upsampling (as libjpeg)
+class Decoder {
+    struct ScanComponent {
+        Component* component;
+        const HuffmanTable* dc_table;
+        const HuffmanTable* ac_table;
+        const std::array<uint16_t, 64>* quantization;
+        // blocks per MCU (1 x 1 in non-interleaved scan)
+        uint32_t h;
+        uint32_t v;
+        // first block in MCU row buffer
+        size_t block_offset;
+        int32_t dc_prediction;
+    };
+
+    io::MappedFile file_;
+    io::ByteReader reader_;
+
+    uint32_t width_;
+    uint32_t height_;
+    // 1, 2, 4 or 8
+    uint32_t scale_;
+    // decoded samples per block side of full resolution component
+    uint32_t block_size_;
+    uint32_t output_width_;
+    uint32_t output_height_;
+    std::vector<Component> components_;
+    uint32_t h_max_;
+    uint32_t v_max_;
+    uint32_t mcus_x_;
+    uint32_t mcus_y_;
+    // 3 components are YCbCr unless Adobe marker or component ids say RGB
+    bool is_ycbcr_;
+
+    // zigzag order
+    std::array<std::array<uint16_t, 64>, 4> quantization_tables_;
+    std::array<bool, 4> has_quantization_table_;
+    std::array<HuffmanTable, 4> dc_tables_;
+    std::array<HuffmanTable, 4> ac_tables_;
+    std::array<bool, 4> has_dc_table_;
+    std::array<bool, 4> has_ac_table_;
+    // MCUs per restart interval (0: no restart markers)
+    uint32_t restart_interval_;
+
+    // current scan (header is read, entropy-coded segment starts at reader_ position)
+    SOS sos_;
+    bool has_scan_;
+    bool is_decoded_;
+
+    static bool is_sof_(uint8_t marker) noexcept {
+        return marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc;
+    }
+
+    void read_frame_(uint8_t marker) {
+        if(marker != 0xc0 && marker != 0xc1) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: unsupported frame type: SOF{} (only baseline and extended sequential Huffman are supported).", marker - 0xc0));
+        }
+        if(!components_.empty()) {
+            throw std::runtime_error("[image::jpg::Decoder] ERROR: multiple frames.");
+        }
+
+        auto sof = read_sof0(reader_);
+        if(sof.p != 8) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: unsupported sample precision: {}", sof.p));
+        }
+        if(sof.x == 0 || sof.y == 0) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: invalid image size: {} x {}", sof.x, sof.y));
+        }
+        if(sof.components.size() != 1 && sof.components.size() != 3) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: unsupported component count: {}", sof.components.size()));
+        }
+
+        width_ = sof.x;
+        height_ = sof.y;
+        h_max_ = 1;
+        v_max_ = 1;
+        for(const auto& c : sof.components) {
+            if(c.hi() < 1 || c.hi() > 4 || c.vi() < 1 || c.vi() > 4 || c.tqi > 3) {
+                throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: invalid component parameters (id = {})", c.ci));
+            }
+            h_max_ = std::max<uint32_t>(h_max_, c.hi());
+            v_max_ = std::max<uint32_t>(v_max_, c.vi());
+        }
+        mcus_x_ = (width_ + 8 * h_max_ - 1) / (8 * h_max_);
+        mcus_y_ = (height_ + 8 * v_max_ - 1) / (8 * v_max_);
+        output_width_ = (width_ + scale_ - 1) / scale_;
+        output_height_ = (height_ + scale_ - 1) / scale_;
+
+        for(const auto& c : sof.components) {
+            Component component{};
+            component.id = c.ci;
+            component.h = c.hi();
+            component.v = c.vi();
+            component.quantization_index = c.tqi;
+            component.width = (width_ * component.h + h_max_ - 1) / h_max_;
+            component.height = (height_ * component.v + v_max_ - 1) / v_max_;
+            // larger block as long as it divides MCU of full resolution component
+            component.block_size = block_size_;
+            while(component.block_size < 8 && (h_max_ * block_size_) % (component.h * component.block_size * 2) == 0 && (v_max_ * block_size_) % (component.v * component.block_size * 2) == 0) {
+                component.block_size *= 2;
+            }
+            component.output_width = static_cast<uint32_t>((uint64_t(output_width_) * component.h * component.block_size + h_max_ * block_size_ - 1) / (h_max_ * block_size_));
+            component.output_height = static_cast<uint32_t>((uint64_t(output_height_) * component.v * component.block_size + v_max_ * block_size_ - 1) / (v_max_ * block_size_));
+            component.stride = size_t(mcus_x_) * component.h * component.block_size;
+            components_.emplace_back(std::move(component));
+        }
+        if(components_.size() == 3 && components_[0].id == 'R' && components_[1].id == 'G' && components_[2].id == 'B') {
+            is_ycbcr_ = false;
+        }
+    }
+
+    void read_quantization_tables_() {
+        auto dqt = read_dqt(reader_);
+        for(const auto& qt : dqt.qts) {
+            if(qt.tq() > 3) {
+                throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: invalid quantization table index: {}", qt.tq()));
+            }
+            for(size_t k = 0; k < 64; ++k) {
+                quantization_tables_[qt.tq()][k] = qt.pq() == 0 ? qt.qk.u8[k] : qt.qk.u16[k];
+            }
+            has_quantization_table_[qt.tq()] = true;
+        }
+    }
+
+    void read_huffman_tables_() {
+        auto dht = read_dht(reader_);
+        for(const auto& ht : dht.hts) {
+            if(ht.tc() > 1 || ht.th() > 3) {
+                throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: invalid Huffman table: class = {}, index = {}", ht.tc(), ht.th()));
+            }
+            if(ht.tc() == 0) {
+                dc_tables_[ht.th()] = HuffmanTable::from_dht(ht);
+                has_dc_table_[ht.th()] = true;
+            }
+            else {
+                ac_tables_[ht.th()] = HuffmanTable::from_dht(ht);
+                has_ac_table_[ht.th()] = true;
+            }
+        }
+    }
+
+    // APP14 "Adobe": transform flag 0 means components are not YCbCr
+    void read_adobe_(uint16_t length) {
+        if(length < 2) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: invalid segment length: marker = ee, length = {}", length));
+        }
+        io::ByteReader segment(reader_.read_bytes(length - 2));
+        if(segment.size() >= 12) {
+            auto id = segment.read_bytes(5);
+            if(std::equal(id.begin(), id.end(), "Adobe")) {
+                segment.skip(6);
+                is_ycbcr_ = segment.read_be<uint8_t>() != 0;
+            }
+        }
+    }
+
+    // read segments until SOS (header of it is read) or EOI (returns false)
+    bool read_segments_() {
+        while(true) {
+            // fill bytes 0xff may precede marker
+            if(reader_.read_be<uint8_t>() != 0xff) {
+                throw std::runtime_error("[image::jpg::Decoder] ERROR: invalid segment.");
+            }
+            uint8_t marker = 0xff;
+            while(marker == 0xff) {
+                marker = reader_.read_be<uint8_t>();
+            }
+
+            if(marker == 0xd9) {
+                return false;
+            }
+            if(marker == 0xda) {
+                if(components_.empty()) {
+                    throw std::runtime_error("[image::jpg::Decoder] ERROR: SOS before frame header.");
+                }
+                sos_ = read_sos(reader_);
+                return true;
+            }
+            if(marker == 0xdb) {
+                read_quantization_tables_();
+            }
+            else if(marker == 0xc4) {
+                read_huffman_tables_();
+            }
+            else if(marker == 0xdd) {
+                // DRI
+                reader_.read_be<uint16_t>();
+                restart_interval_ = reader_.read_be<uint16_t>();
+            }
+            else if(is_sof_(marker)) {
+                read_frame_(marker);
+            }
+            else if(marker == 0xee) {
+                read_adobe_(reader_.read_be<uint16_t>());
+            }
+            else if((marker >= 0xd0 && marker <= 0xd7) || marker == 0x01) {
+                // stray RSTn / TEM without payload
+            }
+            else {
+                auto length = reader_.read_be<uint16_t>();
+                if(length < 2) {
+                    throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: invalid segment length: marker = {:02x}, length = {}", marker, length));
+                }
+                reader_.skip(length - 2);
+            }
+        }
+    }
+
+    // DC_ONLY: AC coefficients are decoded (to advance) but not stored (1 x 1 scaled block)
+    template<bool DC_ONLY>
+    void decode_block_(BitReader& bits, ScanComponent& scan_component, int16_t* block) const {
+        const auto& quantization = *scan_component.quantization;
+
+        auto size = scan_component.dc_table->decode(bits);
+        if(size > 11) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: invalid DC difference size: {}", size));
+        }
+        scan_component.dc_prediction += receive_extend(bits, size);
+        block[0] = static_cast<int16_t>(scan_component.dc_prediction * quantization[0]);
+
+        // dequantize in zigzag order and put each coefficient to natural position
+        const auto& ac_table = *scan_component.ac_table;
+        for(uint32_t k = 1; k < 64;) {
+            if(auto fast = ac_table.fast_ac[bits.peek(HuffmanTable::FAST_BITS)]; fast != 0) {
+                k += (fast >> 4) & 0x0f;
+                bits.consume(fast & 0x0f);
+                if(k > 63) {
+                    throw std::runtime_error("[image::jpg::Decoder] ERROR: too many AC coefficients.");
+                }
+                if constexpr(!DC_ONLY) {
+                    block[natural_order[k]] = static_cast<int16_t>((fast >> 8) * quantization[k]);
+                }
+                ++k;
+                continue;
+            }
+
+            auto rs = ac_table.decode(bits);
+            auto run = rs >> 4;
+            auto ac_size = rs & 0x0f;
+            if(ac_size == 0) {
+                // EOB
+                if(run != 15) {
+                    break;
+                }
+                // ZRL
+                k += 16;
+                continue;
+            }
+            k += run;
+            if(k > 63) {
+                throw std::runtime_error("[image::jpg::Decoder] ERROR: too many AC coefficients.");
+            }
+            auto value = receive_extend(bits, ac_size);
+            if constexpr(!DC_ONLY) {
+                block[natural_order[k]] = static_cast<int16_t>(value * quantization[k]);
+            }
+            ++k;
+        }
+    }
+
+    size_t component_index_(const Component& component) const noexcept {
+        return static_cast<size_t>(&component - components_.data());
+    }
+
+    // passes MCU rows of decoded planes to sink
+    void emit_planes_(const BandSink& sink, concurrency::ThreadPool* pool) const {
+        auto task_count = pool ? std::min(mcus_y_, pool->thread_count() * 4) : 1;
+        concurrency::parallel_for(pool, task_count, [&](uint32_t task) {
+            auto first = static_cast<uint32_t>(uint64_t(mcus_y_) * task / task_count);
+            auto last = static_cast<uint32_t>(uint64_t(mcus_y_) * (task + 1) / task_count);
+            for(auto mcu_y = first; mcu_y < last; ++mcu_y) {
+                Band band{};
+                band.x = 0;
+                band.y = mcu_y * v_max_ * block_size_;
+                band.width = output_width_;
+                band.height = std::min(band.y + v_max_ * block_size_, output_height_) - band.y;
+                for(size_t i = 0; i < components_.size(); ++i) {
+                    const auto& component = components_[i];
+                    band.samples[i] = component.plane.data() + size_t(mcu_y) * component.v * component.block_size * component.stride;
+                    band.strides[i] = component.stride;
+                }
+                sink(band);
+            }
+        });
+    }
+
+    // length of entropy-coded segment (up to first marker other than RSTn) and offsets of data after each RSTn in it
+    static size_t scan_segment_(std::span<const uint8_t> bytes, std::vector<size_t>& restart_offsets) {
+        size_t position = 0;
+        while(position < bytes.size()) {
+            auto found = static_cast<const uint8_t*>(std::memchr(bytes.data() + position, 0xff, bytes.size() - position));
+            if(!found || found + 1 == bytes.data() + bytes.size()) {
+                break;
+            }
+            position = static_cast<size_t>(found - bytes.data());
+            auto marker = bytes[position + 1];
+            if(marker == 0x00 || marker == 0xff) {
+                // stuffed byte or fill bytes
+                ++position;
+            }
+            else if((marker & 0xf8) == 0xd0) {
+                position += 2;
+                restart_offsets.push_back(position);
+            }
+            else {
+                return position;
+            }
+        }
+        return bytes.size();
+    }
+
+    // decodes MCUs [mcu_begin, mcu_end) of scan (bits start at MCU mcu_begin, restart markers inside range are skipped)
+    // and transforms blocks into component planes, or into band buffer passed to sink after each (part of) MCU row
+    // ranges of different calls write disjoint blocks, so they can run in parallel
+    // with context (range of whole MCU rows), band buffers have one row above and below and MCU row is passed to sink
+    // after next one is decoded, when first row of next one is copied below band and last row of band above next one
+    void decode_mcus_(BitReader& bits, std::vector<ScanComponent> scan_components, size_t blocks_per_mcu, uint32_t mcus_x, uint32_t mcu_begin, uint32_t mcu_end, const BandSink* sink, bool has_context) {
+        // MCU row buffer: block rows of each component, blocks of one block row are consecutive
+        for(auto& scan_component : scan_components) {
+            scan_component.block_offset *= mcus_x;
+        }
+        std::vector<int16_t> coefficients(blocks_per_mcu * mcus_x * 64);
+
+        // streamed scan has all components (MCU is one block for single component)
+        std::array<std::vector<uint8_t>, 3> band_samples{};
+        std::array<std::vector<uint8_t>, 3> previous_samples{};
+        std::optional<Band> previous{};
+        auto mcu_width = scan_components.size() > 1 ? h_max_ * block_size_ : block_size_;
+        auto mcu_height = scan_components.size() > 1 ? v_max_ * block_size_ : block_size_;
+        auto context_rows = sink && has_context ? 1u : 0u;
+        if(sink) {
+            for(const auto& scan_component : scan_components) {
+                const auto& component = *scan_component.component;
+                auto index = component_index_(component);
+                band_samples[index].resize(component.stride * (scan_component.v * component.block_size + 2 * context_rows));
+                if(has_context) {
+                    previous_samples[index].resize(band_samples[index].size());
+                }
+            }
+        }
+
+        auto mcu_index = mcu_begin;
+        while(mcu_index < mcu_end) {
+            auto mcu_y = mcu_index / mcus_x;
+            auto x_begin = mcu_index % mcus_x;
+            auto x_end = std::min(mcus_x, x_begin + (mcu_end - mcu_index));
+
+            for(auto mcu_x = x_begin; mcu_x < x_end; ++mcu_x, ++mcu_index) {
+                if(restart_interval_ != 0 && mcu_index != mcu_begin && mcu_index % restart_interval_ == 0) {
+                    if(bits.overrun()) {
+                        throw std::runtime_error("[image::jpg::Decoder] ERROR: entropy-coded data is truncated.");
+                    }
+                    if(!bits.restart()) {
+                        throw std::runtime_error("[image::jpg::Decoder] ERROR: restart marker not found.");
+                    }
+                    for(auto& scan_component : scan_components) {
+                        scan_component.dc_prediction = 0;
+                    }
+                }
+
+                for(auto& scan_component : scan_components) {
+                    auto row_blocks = size_t(mcus_x) * scan_component.h;
+                    for(uint32_t v = 0; v < scan_component.v; ++v) {
+                        for(uint32_t h = 0; h < scan_component.h; ++h) {
+                            auto block = scan_component.block_offset + v * row_blocks + mcu_x * scan_component.h + h;
+                            if(scan_component.component->block_size == 1) {
+                                decode_block_<true>(bits, scan_component, coefficients.data() + block * 64);
+                            }
+                            else {
+                                decode_block_<false>(bits, scan_component, coefficients.data() + block * 64);
+                            }
+                        }
+                    }
+                }
+            }
+            if(bits.overrun()) {
+                throw std::runtime_error("[image::jpg::Decoder] ERROR: entropy-coded data is truncated.");
+            }
+
+            // transform decoded part of MCU row and clear it for next one
+            Band band{};
+            for(const auto& scan_component : scan_components) {
+                auto& component = *scan_component.component;
+                auto index = component_index_(component);
+                auto row_blocks = size_t(mcus_x) * scan_component.h;
+                auto block_count = size_t(x_end - x_begin) * scan_component.h;
+                auto size = component.block_size;
+                auto x = size_t(x_begin) * scan_component.h * size;
+                auto rows = sink ? band_samples[index].data() + context_rows * component.stride : component.plane.data() + size_t(mcu_y) * scan_component.v * size * component.stride;
+                for(uint32_t v = 0; v < scan_component.v; ++v) {
+                    auto first = coefficients.data() + (scan_component.block_offset + v * row_blocks + size_t(x_begin) * scan_component.h) * 64;
+                    idct_row(first, block_count, size, rows + v * size * component.stride + x, component.stride);
+                    // DC only blocks have no AC stored
+                    if(size == 1) {
+                        for(size_t i = 0; i < block_count; ++i) {
+                            first[i * 64] = 0;
+                        }
+                    }
+                    else {
+                        std::fill_n(first, block_count * 64, int16_t(0));
+                    }
+                }
+                band.samples[index] = rows + x;
+                band.strides[index] = component.stride;
+            }
+
+            if(sink) {
+                band.x = x_begin * mcu_width;
+                band.y = mcu_y * mcu_height;
+                band.width = std::min(x_end * mcu_width, output_width_) - band.x;
+                band.height = std::min((mcu_y + 1) * mcu_height, output_height_) - band.y;
+                if(!has_context) {
+                    (*sink)(band);
+                }
+                else {
+                    if(previous) {
+                        for(const auto& scan_component : scan_components) {
+                            const auto& component = *scan_component.component;
+                            auto index = component_index_(component);
+                            auto rows = scan_component.v * component.block_size;
+                            auto stride = component.stride;
+                            std::memcpy(previous_samples[index].data() + (rows + 1) * stride, band_samples[index].data() + stride, stride);
+                            std::memcpy(band_samples[index].data(), previous_samples[index].data() + rows * stride, stride);
+                        }
+                        (*sink)(*previous);
+                    }
+                    // swapping vectors keeps their storage, so band stays valid
+                    previous = band;
+                    std::swap(band_samples, previous_samples);
+                }
+            }
+        }
+        if(previous) {
+            (*sink)(*previous);
+        }
+    }
+
+    void decode_scan_(const BandSink* sink, bool has_context, concurrency::ThreadPool* pool) {
+        if(sos_.components.empty() || sos_.components.size() > 4) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: invalid scan component count: {}", sos_.components.size()));
+        }
+
+        std::vector<ScanComponent> scan_components{};
+        size_t blocks_per_mcu = 0;
+        auto is_interleaved = sos_.components.size() > 1;
+        for(const auto& sc : sos_.components) {
+            auto component = std::find_if(components_.begin(), components_.end(), [&](const Component& c){ return c.id == sc.csj; });
+            if(component == components_.end()) {
+                throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: unknown scan component: {}", sc.csj));
+            }
+            if(std::any_of(scan_components.begin(), scan_components.end(), [&](const ScanComponent& c){ return c.component == &*component; })) {
+                throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: duplicate scan component: {}", sc.csj));
+            }
+            if(sc.tdj() > 3 || sc.taj() > 3 || !has_dc_table_[sc.tdj()] || !has_ac_table_[sc.taj()]) {
+                throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: undefined Huffman table (component = {})", sc.csj));
+            }
+            if(!has_quantization_table_[component->quantization_index]) {
+                throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: undefined quantization table (component = {})", sc.csj));
+            }
+
+            ScanComponent scan_component{};
+            scan_component.component = &*component;
+            scan_component.dc_table = &dc_tables_[sc.tdj()];
+            scan_component.ac_table = &ac_tables_[sc.taj()];
+            scan_component.quantization = &quantization_tables_[component->quantization_index];
+            scan_component.h = is_interleaved ? component->h : 1;
+            scan_component.v = is_interleaved ? component->v : 1;
+            scan_component.block_offset = blocks_per_mcu;
+            blocks_per_mcu += scan_component.h * scan_component.v;
+            scan_components.push_back(scan_component);
+        }
+        if(blocks_per_mcu > 10) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: too many blocks in MCU: {}", blocks_per_mcu));
+        }
+
+        // non-interleaved scan: MCU is one block of component
+        auto mcus_x = mcus_x_;
+        auto mcus_y = mcus_y_;
+        if(!is_interleaved) {
+            const auto& component = *scan_components[0].component;
+            mcus_x = (component.width + 7) / 8;
+            mcus_y = (component.height + 7) / 8;
+        }
+
+        auto mcu_count = mcus_x * mcus_y;
+        auto segment = reader_.bytes().subspan(reader_.position());
+        std::vector<size_t> restart_offsets{};
+        auto segment_size = scan_segment_(segment, restart_offsets);
+
+        // restart intervals are independent (DC predictions are reset at each RSTn) -> groups of consecutive intervals are decoded in parallel
+        // (serially if markers are missing, decoding reports it)
+        auto interval_count = restart_interval_ == 0 ? 1 : (mcu_count + restart_interval_ - 1) / restart_interval_;
+        if(pool && pool->thread_count() > 1 && interval_count > 1 && restart_offsets.size() + 1 >= interval_count) {
+            // a few tasks per thread to balance intervals of different size
+            auto task_count = std::min(interval_count, pool->thread_count() * 4);
+            concurrency::parallel_for(pool, task_count, [&](uint32_t task) {
+                auto first = static_cast<uint32_t>(uint64_t(interval_count) * task / task_count);
+                auto last = static_cast<uint32_t>(uint64_t(interval_count) * (task + 1) / task_count);
+                auto offset = first == 0 ? 0 : restart_offsets[first - 1];
+                BitReader bits(segment.data() + offset, segment_size - offset);
+                decode_mcus_(bits, scan_components, blocks_per_mcu, mcus_x, first * restart_interval_, std::min(mcu_count, last * restart_interval_), sink, false);
+            });
+        }
+        else {
+            BitReader bits(segment.data(), segment_size);
+            decode_mcus_(bits, scan_components, blocks_per_mcu, mcus_x, 0, mcu_count, sink, has_context);
+        }
+
+        // continue at marker after scan
+        reader_.seek(reader_.position() + segment_size);
+    }
+
+    // path is for error messages only
+    Decoder(io::MappedFile&& file, const std::filesystem::path& path, uint32_t scale) :
+        file_(std::move(file)), reader_(file_.bytes()), width_(0), height_(0), scale_(scale), block_size_(8 / std::max(scale, 1u)), output_width_(0), output_height_(0), h_max_(1), v_max_(1), mcus_x_(0), mcus_y_(0), is_ycbcr_(true),
+        quantization_tables_{}, has_quantization_table_{}, dc_tables_{}, ac_tables_{}, has_dc_table_{}, has_ac_table_{}, restart_interval_(0),
+        sos_{}, has_scan_(false), is_decoded_(false)
+    {
+        if(scale != 1 && scale != 2 && scale != 4 && scale != 8) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: unsupported scale: 1/{}", scale));
+        }
+        if(reader_.read_be<uint16_t>() != 0xffd8) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: invalid format image: {}", path.string()));
+        }
+        has_scan_ = read_segments_();
+        if(components_.empty() || !has_scan_) {
+            throw std::runtime_error(std::format("[image::jpg::Decoder] ERROR: no image data: {}", path.string()));
+        }
+    }
+
+public:
+    // output is ceil(X / scale) x ceil(Y / scale) for scale 1, 2, 4 or 8
+    explicit Decoder(const std::filesystem::path& path, uint32_t scale = 1) : Decoder(io::MappedFile(path), path, scale) {}
+    // already mapped file (e.g. after checking is_supported())
+    explicit Decoder(io::MappedFile&& file, uint32_t scale = 1) : Decoder(std::move(file), {}, scale) {}
+
+    // decoded (scaled) size
+    auto width() const noexcept { return output_width_; }
+    auto height() const noexcept { return output_height_; }
+    auto scale() const noexcept { return scale_; }
+    // decoded samples per block side of full resolution component (MCU is h_max * block_size x v_max * block_size pixels)
+    auto block_size() const noexcept { return block_size_; }
+    auto h_max() const noexcept { return h_max_; }
+    auto v_max() const noexcept { return v_max_; }
+    bool is_ycbcr() const noexcept { return is_ycbcr_; }
+    const auto& components() const noexcept { return components_; }
+
+    // decodes all scans and passes decoded samples to sink by bands (can be called once)
+    // restart intervals (and conversion of multi-scan image) run on pool if given (do not call from task on the same pool)
+    // has_context: bands are whole MCU rows with rows around them (see Band)
+    void decode(const BandSink& sink, concurrency::ThreadPool* pool = nullptr, bool has_context = false) {
+        if(is_decoded_) {
+            throw std::runtime_error("[image::jpg::Decoder] ERROR: image is already decoded.");
+        }
+        is_decoded_ = true;
+
+        // baseline codes each component in one scan, so first scan with all components is the only one
+        // restart intervals decoded in parallel end inside MCU rows, so bands with context are then cut from planes
+        auto is_parallel = pool && pool->thread_count() > 1 && restart_interval_ != 0;
+        auto is_streamed = sos_.components.size() == components_.size() && !(has_context && is_parallel);
+        if(!is_streamed) {
+            for(auto& component : components_) {
+                component.plane.assign(component.stride * mcus_y_ * component.v * component.block_size, 0);
+            }
+        }
+        while(has_scan_) {
+            decode_scan_(is_streamed ? &sink : nullptr, has_context, pool);
+            has_scan_ = read_segments_();
+            if(has_scan_ && is_streamed) {
+                throw std::runtime_error("[image::jpg::Decoder] ERROR: component is coded in multiple scans.");
+            }
+        }
+        if(!is_streamed) {
+            emit_planes_(sink, pool);
+        }
+    }
+};
+
+// SOF0/SOF1 with 8 bits samples and 1 or 3 components (others are progressive, lossless, arithmetic coded, 12 bits or CMYK)
+inline bool is_supported(std::span<const uint8_t> bytes) noexcept {
+    try {
+        io::ByteReader reader(bytes);
+        if(reader.read_be<uint16_t>() != 0xffd8) {
+            return false;
+        }
+        while(true) {
+            if(reader.read_be<uint8_t>() != 0xff) {
+                return false;
+            }
+            uint8_t marker = 0xff;
+            while(marker == 0xff) {
+                marker = reader.read_be<uint8_t>();
+            }
+            if(marker == 0xd9 || marker == 0xda) {
+                return false;
+            }
+            if((marker >= 0xd0 && marker <= 0xd7) || marker == 0x01) {
+                continue;
+            }
+            auto length = reader.read_be<uint16_t>();
+            if(marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc) {
+                if(marker != 0xc0 && marker != 0xc1) {
+                    return false;
+                }
+                auto precision = reader.read_be<uint8_t>();
+                reader.skip(4);
+                auto component_count = reader.read_be<uint8_t>();
+                return precision == 8 && (component_count == 1 || component_count == 3);
+            }
+            if(length < 2) {
+                return false;
+            }
+            reader.skip(length - 2);
+        }
+    }
+    catch(...) {
+        return false;
+    }
+}
+
+}
+
+}
\ No newline at end of file
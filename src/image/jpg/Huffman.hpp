@@ -0,0 +1,117 @@
+#pragma once
+
+#include "utils.hpp"
+#include "DHT.hpp"
+#include "BitReader.hpp"
+
+namespace image {
+
+namespace jpg {
+
+// Huffman decoding table (ITU T.81 F.2.2.3)
+// codes up to FAST_BITS long are decoded by one lookup of next FAST_BITS bits, longer ones by comparing with max code of each length
+struct HuffmanTable {
+    static constexpr uint32_t FAST_BITS = 9;
+
+    // (code length << 8) | symbol, 0 if code is longer than FAST_BITS
+    std::array<uint16_t, 1 << FAST_BITS> fast;
+    // AC table: (value << 8) | (run << 4) | (code length + size) for code and value bits fitting in FAST_BITS together,
+    // so that small coefficients are decoded by one lookup (0 if not)
+    std::array<int16_t, 1 << FAST_BITS> fast_ac;
+    // largest code of each length (-1 if none)
+    std::array<int32_t, 17> max_code;
+    // index of first symbol of each length in values minus first code of that length
+    std::array<int32_t, 17> value_offset;
+    std::array<uint8_t, 256> values;
+
+    static HuffmanTable from_dht(const DHT::HT& ht) {
+        if(ht.vi_j.size() > 256) {
+            throw std::runtime_error(std::format("[image::jpg::HuffmanTable] ERROR: too many symbols: {}", ht.vi_j.size()));
+        }
+
+        HuffmanTable table{};
+        std::copy(ht.vi_j.begin(), ht.vi_j.end(), table.values.begin());
+
+        // canonical codes (C.2)
+        int32_t code = 0;
+        int32_t index = 0;
+        for(uint32_t length = 1; length <= 16; ++length) {
+            auto count = static_cast<int32_t>(ht.li[length - 1]);
+            table.value_offset[length] = index - code;
+            if(count > 0) {
+                for(int32_t i = 0; i < count; ++i) {
+                    if(length <= FAST_BITS) {
+                        // all lookups starting with this code
+                        auto first = static_cast<uint32_t>(code + i) << (FAST_BITS - length);
+                        auto last = first + (1u << (FAST_BITS - length));
+                        for(auto j = first; j < last; ++j) {
+                            table.fast[j] = static_cast<uint16_t>((length << 8) | table.values[index + i]);
+                        }
+                    }
+                }
+                code += count;
+                index += count;
+                table.max_code[length] = code - 1;
+            }
+            else {
+                table.max_code[length] = -1;
+            }
+            if(code > (1 << length)) {
+                throw std::runtime_error("[image::jpg::HuffmanTable] ERROR: invalid code lengths.");
+            }
+            code <<= 1;
+        }
+
+        for(uint32_t bits = 0; bits < (1u << FAST_BITS); ++bits) {
+            auto entry = table.fast[bits];
+            if(entry == 0) {
+                continue;
+            }
+            uint32_t length = entry >> 8;
+            uint32_t run = (entry >> 4) & 0x0f;
+            uint32_t size = entry & 0x0f;
+            if(size == 0 || length + size > FAST_BITS) {
+                continue;
+            }
+            auto value = static_cast<int32_t>(((bits << length) & ((1u << FAST_BITS) - 1)) >> (FAST_BITS - size));
+            if(value < (1 << (size - 1))) {
+                value -= (1 << size) - 1;
+            }
+            if(value >= -128 && value <= 127) {
+                table.fast_ac[bits] = static_cast<int16_t>(value * 256 + static_cast<int32_t>((run << 4) | (length + size)));
+            }
+        }
+
+        return table;
+    }
+
+    uint32_t decode(BitReader& reader) const {
+        auto bits = reader.peek(16);
+        auto entry = fast[bits >> (16 - FAST_BITS)];
+        if(entry != 0) {
+            reader.consume(entry >> 8);
+            return entry & 0xff;
+        }
+        for(uint32_t length = FAST_BITS + 1; length <= 16; ++length) {
+            auto code = static_cast<int32_t>(bits >> (16 - length));
+            if(code <= max_code[length]) {
+                reader.consume(length);
+                return values[value_offset[length] + code];
+            }
+        }
+        throw std::runtime_error("[image::jpg::HuffmanTable] ERROR: invalid Huffman code.");
+    }
+};
+
+// value of size bits magnitude category (F.2.2.1)
+inline int32_t receive_extend(BitReader& reader, uint32_t size) noexcept {
+    if(size == 0) {
+        return 0;
+    }
+    auto value = static_cast<int32_t>(reader.read_bits(size));
+    return value < (1 << (size - 1)) ? value - (1 << size) + 1 : value;
+}
+
+}
+
+}
\ No newline at end of file
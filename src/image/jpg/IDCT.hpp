@@ -0,0 +1,603 @@
+#pragma once
+
+#include "utils.hpp"
+#include "../simd.hpp"
+
+namespace image {
+
+namespace jpg {
+
+// 8x8 integer inverse DCT (Loeffler-Ligtenberg-Moschytz, same arithmetic as libjpeg's "islow")
+// input is dequantized coefficients in natural order, output is level shifted and clamped samples
+// SIMD kernels compute exactly same values as scalar one: constant sums of odd part are folded so that each
+// output is 2 multiply-adds of coefficient pairs (all folded constants fit in 16 bits)
+
+constexpr int32_t IDCT_CONST_BITS = 13;
+constexpr int32_t IDCT_PASS1_BITS = 2;
+
+constexpr int32_t FIX_0_298631336 = 2446;
+constexpr int32_t FIX_0_390180644 = 3196;
+constexpr int32_t FIX_0_541196100 = 4433;
+constexpr int32_t FIX_0_765366865 = 6270;
+constexpr int32_t FIX_0_899976223 = 7373;
+constexpr int32_t FIX_1_175875602 = 9633;
+constexpr int32_t FIX_1_501321110 = 12299;
+constexpr int32_t FIX_1_847759065 = 15137;
+constexpr int32_t FIX_1_961570560 = 16069;
+constexpr int32_t FIX_2_053119869 = 16819;
+constexpr int32_t FIX_2_562915447 = 20995;
+constexpr int32_t FIX_3_072711026 = 25172;
+
+// reduced size transforms
+constexpr int32_t FIX_0_211164243 = 1730;
+constexpr int32_t FIX_0_509795579 = 4176;
+constexpr int32_t FIX_0_601344887 = 4926;
+constexpr int32_t FIX_0_720959822 = 5906;
+constexpr int32_t FIX_0_850430095 = 6967;
+constexpr int32_t FIX_1_061594337 = 8697;
+constexpr int32_t FIX_1_272758580 = 10426;
+constexpr int32_t FIX_1_451774981 = 11893;
+constexpr int32_t FIX_2_172734803 = 17799;
+constexpr int32_t FIX_3_624509785 = 29692;
+
+inline uint8_t clamp_sample_(int32_t value) noexcept {
+    return static_cast<uint8_t>(std::clamp(value, 0, 255));
+}
+
+// one 1D transform, in[i * step] -> out[i * step] (before descale)
+inline void idct_1d_(const int32_t* in, int32_t* out, size_t step) noexcept {
+    // even part
+    auto z2 = in[2 * step];
+    auto z3 = in[6 * step];
+    auto z1 = (z2 + z3) * FIX_0_541196100;
+    auto tmp2 = z1 - z3 * FIX_1_847759065;
+    auto tmp3 = z1 + z2 * FIX_0_765366865;
+    auto tmp0 = (in[0] + in[4 * step]) * (1 << IDCT_CONST_BITS);
+    auto tmp1 = (in[0] - in[4 * step]) * (1 << IDCT_CONST_BITS);
+    auto tmp10 = tmp0 + tmp3;
+    auto tmp13 = tmp0 - tmp3;
+    auto tmp11 = tmp1 + tmp2;
+    auto tmp12 = tmp1 - tmp2;
+
+    // odd part
+    auto t0 = in[7 * step];
+    auto t1 = in[5 * step];
+    auto t2 = in[3 * step];
+    auto t3 = in[1 * step];
+    auto z5 = (t0 + t1 + t2 + t3) * FIX_1_175875602;
+    auto y1 = -(t0 + t3) * FIX_0_899976223;
+    auto y2 = -(t1 + t2) * FIX_2_562915447;
+    auto y3 = -(t0 + t2) * FIX_1_961570560 + z5;
+    auto y4 = -(t1 + t3) * FIX_0_390180644 + z5;
+    t0 = t0 * FIX_0_298631336 + y1 + y3;
+    t1 = t1 * FIX_2_053119869 + y2 + y4;
+    t2 = t2 * FIX_3_072711026 + y2 + y3;
+    t3 = t3 * FIX_1_501321110 + y1 + y4;
+
+    out[0] = tmp10 + t3;
+    out[7 * step] = tmp10 - t3;
+    out[1 * step] = tmp11 + t2;
+    out[6 * step] = tmp11 - t2;
+    out[2 * step] = tmp12 + t1;
+    out[5 * step] = tmp12 - t1;
+    out[3 * step] = tmp13 + t0;
+    out[4 * step] = tmp13 - t0;
+}
+
+inline void idct_scalar(const int16_t* coefficients, uint8_t* dst, size_t stride) noexcept {
+    std::array<int32_t, 64> in{};
+    std::array<int32_t, 64> workspace{};
+    for(size_t i = 0; i < 64; ++i) {
+        in[i] = coefficients[i];
+    }
+
+    // columns (intermediate results are kept with PASS1_BITS fraction bits, saturated to 16 bits as SIMD kernels)
+    for(size_t x = 0; x < 8; ++x) {
+        std::array<int32_t, 64> column{};
+        idct_1d_(in.data() + x, column.data() + x, 8);
+        for(size_t y = 0; y < 8; ++y) {
+            auto value = (column[y * 8 + x] + (1 << (IDCT_CONST_BITS - IDCT_PASS1_BITS - 1))) >> (IDCT_CONST_BITS - IDCT_PASS1_BITS);
+            workspace[y * 8 + x] = std::clamp(value, -32768, 32767);
+        }
+    }
+
+    // rows (+ 128 level shift)
+    constexpr int32_t shift = IDCT_CONST_BITS + IDCT_PASS1_BITS + 3;
+    for(size_t y = 0; y < 8; ++y) {
+        std::array<int32_t, 8> row{};
+        idct_1d_(workspace.data() + y * 8, row.data(), 1);
+        for(size_t x = 0; x < 8; ++x) {
+            dst[y * stride + x] = clamp_sample_(std::clamp((row[x] + (1 << (shift - 1)) + (128 << shift)) >> shift, -32768, 32767));
+        }
+    }
+}
+
+// scaled decoding transforms (same arithmetic as libjpeg's reduced IDCTs): 4 x 4, 2 x 2 or 1 x 1 samples of block
+// from low frequency coefficients only, so cost is proportional to output size
+
+inline int32_t idct_descale_(int32_t value, int32_t shift) noexcept {
+    return (value + (1 << (shift - 1))) >> shift;
+}
+
+// 4 point transform of in[0], in[2], in[6] (even) and in[1], in[3], in[5], in[7] (odd), results before descale
+template<typename T>
+void idct_4_(const T* in, size_t step, int32_t* out) noexcept {
+    auto tmp0 = int32_t(in[0]) * (1 << (IDCT_CONST_BITS + 1));
+    auto tmp2 = in[2 * step] * FIX_1_847759065 - in[6 * step] * FIX_0_765366865;
+    auto tmp10 = tmp0 + tmp2;
+    auto tmp12 = tmp0 - tmp2;
+
+    int32_t z1 = in[7 * step];
+    int32_t z2 = in[5 * step];
+    int32_t z3 = in[3 * step];
+    int32_t z4 = in[1 * step];
+    auto odd0 = -z1 * FIX_0_211164243 + z2 * FIX_1_451774981 - z3 * FIX_2_172734803 + z4 * FIX_1_061594337;
+    auto odd2 = -z1 * FIX_0_509795579 - z2 * FIX_0_601344887 + z3 * FIX_0_899976223 + z4 * FIX_2_562915447;
+
+    out[0] = tmp10 + odd2;
+    out[1] = tmp12 + odd0;
+    out[2] = tmp12 - odd0;
+    out[3] = tmp10 - odd2;
+}
+
+inline void idct_4x4_scalar(const int16_t* coefficients, uint8_t* dst, size_t stride) noexcept {
+    // columns (column 4 is not used by rows, saturated to 16 bits as SIMD kernel), AC free column is DC scaled by PASS1_BITS (same result as transform)
+    std::array<int32_t, 32> workspace{};
+    for(size_t x = 0; x < 8; ++x) {
+        if(x == 4) {
+            continue;
+        }
+        const auto* in = coefficients + x;
+        if((in[8] | in[16] | in[24] | in[40] | in[48] | in[56]) == 0) {
+            auto dc = std::clamp(in[0] * (1 << IDCT_PASS1_BITS), -32768, 32767);
+            workspace[x] = dc;
+            workspace[8 + x] = dc;
+            workspace[16 + x] = dc;
+            workspace[24 + x] = dc;
+            continue;
+        }
+        int32_t column[4];
+        idct_4_(coefficients + x, 8, column);
+        for(size_t y = 0; y < 4; ++y) {
+            workspace[y * 8 + x] = std::clamp(idct_descale_(column[y], IDCT_CONST_BITS - IDCT_PASS1_BITS + 1), -32768, 32767);
+        }
+    }
+
+    for(size_t y = 0; y < 4; ++y) {
+        const auto* in = workspace.data() + y * 8;
+        if((in[1] | in[2] | in[3] | in[5] | in[6] | in[7]) == 0) {
+            auto sample = clamp_sample_(idct_descale_(in[0], IDCT_PASS1_BITS + 3) + 128);
+            std::fill_n(dst + y * stride, 4, sample);
+            continue;
+        }
+        // + 128 level shift is folded into rounding as in SIMD kernel
+        int32_t row[4];
+        idct_4_(in, 1, row);
+        constexpr int32_t shift = IDCT_CONST_BITS + IDCT_PASS1_BITS + 3 + 1;
+        for(size_t x = 0; x < 4; ++x) {
+            dst[y * stride + x] = clamp_sample_((row[x] + (1 << (shift - 1)) + (128 << shift)) >> shift);
+        }
+    }
+}
+
+// 2 point transform of in[0] (even) and in[1], in[3], in[5], in[7] (odd), results before descale
+template<typename T>
+void idct_2_(const T* in, size_t step, int32_t* out) noexcept {
+    auto tmp10 = int32_t(in[0]) * (1 << (IDCT_CONST_BITS + 2));
+    auto tmp0 = -int32_t(in[7 * step]) * FIX_0_720959822 + in[5 * step] * FIX_0_850430095 - in[3 * step] * FIX_1_272758580 + in[1 * step] * FIX_3_624509785;
+    out[0] = tmp10 + tmp0;
+    out[1] = tmp10 - tmp0;
+}
+
+inline void idct_2x2_scalar(const int16_t* coefficients, uint8_t* dst, size_t stride) noexcept {
+    // columns 0, 1, 3, 5 and 7 (others are not used by rows)
+    std::array<int32_t, 16> workspace{};
+    for(size_t x : {0, 1, 3, 5, 7}) {
+        const auto* in = coefficients + x;
+        if((in[8] | in[24] | in[40] | in[56]) == 0) {
+            workspace[x] = in[0] * (1 << IDCT_PASS1_BITS);
+            workspace[8 + x] = workspace[x];
+            continue;
+        }
+        int32_t column[2];
+        idct_2_(coefficients + x, 8, column);
+        workspace[x] = idct_descale_(column[0], IDCT_CONST_BITS - IDCT_PASS1_BITS + 2);
+        workspace[8 + x] = idct_descale_(column[1], IDCT_CONST_BITS - IDCT_PASS1_BITS + 2);
+    }
+
+    for(size_t y = 0; y < 2; ++y) {
+        int32_t row[2];
+        idct_2_(workspace.data() + y * 8, 1, row);
+        dst[y * stride] = clamp_sample_(idct_descale_(row[0], IDCT_CONST_BITS + IDCT_PASS1_BITS + 3 + 2) + 128);
+        dst[y * stride + 1] = clamp_sample_(idct_descale_(row[1], IDCT_CONST_BITS + IDCT_PASS1_BITS + 3 + 2) + 128);
+    }
+}
+
+// DC only
+inline void idct_1x1(const int16_t* coefficients, uint8_t* dst) noexcept {
+    *dst = clamp_sample_(idct_descale_(coefficients[0], 3) + 128);
+}
+
+#if defined(IMAGE_SIMD_X86)
+
+// 16 bits pair constant for _mm_madd_epi16 (even lanes * a + odd lanes * b)
+inline __m128i idct_pair_sse2_(int32_t a, int32_t b) noexcept {
+    return _mm_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(a) & 0xffff)));
+}
+
+// x * a + y * b for 8 lanes, 32 bits results in lo (lanes 0-3) and hi (lanes 4-7)
+struct IdctWide128_ {
+    __m128i lo;
+    __m128i hi;
+};
+
+IMAGE_TARGET("sse2") inline IdctWide128_ idct_madd_sse2_(__m128i xy_lo, __m128i xy_hi, __m128i ab) noexcept {
+    return {_mm_madd_epi16(xy_lo, ab), _mm_madd_epi16(xy_hi, ab)};
+}
+
+IMAGE_TARGET("sse2") inline IdctWide128_ idct_add_sse2_(IdctWide128_ a, IdctWide128_ b) noexcept {
+    return {_mm_add_epi32(a.lo, b.lo), _mm_add_epi32(a.hi, b.hi)};
+}
+
+IMAGE_TARGET("sse2") inline IdctWide128_ idct_sub_sse2_(IdctWide128_ a, IdctWide128_ b) noexcept {
+    return {_mm_sub_epi32(a.lo, b.lo), _mm_sub_epi32(a.hi, b.hi)};
+}
+
+template<int SHIFT>
+IMAGE_TARGET("sse2") inline __m128i idct_descale_sse2_(IdctWide128_ a, __m128i bias) noexcept {
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(a.lo, bias), SHIFT), _mm_srai_epi32(_mm_add_epi32(a.hi, bias), SHIFT));
+}
+
+// 1D transform of 8 vectors (each lane is independent column), results are descaled to 16 bits
+template<int SHIFT>
+IMAGE_TARGET("sse2") inline void idct_pass_sse2_(__m128i (&v)[8], __m128i bias) noexcept {
+    // even part: (v0, v4) and (v2, v6) pairs
+    auto p04_lo = _mm_unpacklo_epi16(v[0], v[4]);
+    auto p04_hi = _mm_unpackhi_epi16(v[0], v[4]);
+    auto p26_lo = _mm_unpacklo_epi16(v[2], v[6]);
+    auto p26_hi = _mm_unpackhi_epi16(v[2], v[6]);
+    constexpr int32_t one = 1 << IDCT_CONST_BITS;
+    auto tmp0 = idct_madd_sse2_(p04_lo, p04_hi, idct_pair_sse2_(one, one));
+    auto tmp1 = idct_madd_sse2_(p04_lo, p04_hi, idct_pair_sse2_(one, -one));
+    auto tmp2 = idct_madd_sse2_(p26_lo, p26_hi, idct_pair_sse2_(FIX_0_541196100, FIX_0_541196100 - FIX_1_847759065));
+    auto tmp3 = idct_madd_sse2_(p26_lo, p26_hi, idct_pair_sse2_(FIX_0_541196100 + FIX_0_765366865, FIX_0_541196100));
+    auto tmp10 = idct_add_sse2_(tmp0, tmp3);
+    auto tmp13 = idct_sub_sse2_(tmp0, tmp3);
+    auto tmp11 = idct_add_sse2_(tmp1, tmp2);
+    auto tmp12 = idct_sub_sse2_(tmp1, tmp2);
+
+    // odd part: (v7, v3) and (v5, v1) pairs
+    auto p73_lo = _mm_unpacklo_epi16(v[7], v[3]);
+    auto p73_hi = _mm_unpackhi_epi16(v[7], v[3]);
+    auto p51_lo = _mm_unpacklo_epi16(v[5], v[1]);
+    auto p51_hi = _mm_unpackhi_epi16(v[5], v[1]);
+    constexpr int32_t c = FIX_1_175875602;
+    auto t0 = idct_add_sse2_(
+        idct_madd_sse2_(p73_lo, p73_hi, idct_pair_sse2_(FIX_0_298631336 - FIX_0_899976223 - FIX_1_961570560 + c, c - FIX_1_961570560)),
+        idct_madd_sse2_(p51_lo, p51_hi, idct_pair_sse2_(c, c - FIX_0_899976223)));
+    auto t1 = idct_add_sse2_(
+        idct_madd_sse2_(p73_lo, p73_hi, idct_pair_sse2_(c, c - FIX_2_562915447)),
+        idct_madd_sse2_(p51_lo, p51_hi, idct_pair_sse2_(FIX_2_053119869 - FIX_2_562915447 - FIX_0_390180644 + c, c - FIX_0_390180644)));
+    auto t2 = idct_add_sse2_(
+        idct_madd_sse2_(p73_lo, p73_hi, idct_pair_sse2_(c - FIX_1_961570560, FIX_3_072711026 - FIX_2_562915447 - FIX_1_961570560 + c)),
+        idct_madd_sse2_(p51_lo, p51_hi, idct_pair_sse2_(c - FIX_2_562915447, c)));
+    auto t3 = idct_add_sse2_(
+        idct_madd_sse2_(p73_lo, p73_hi, idct_pair_sse2_(c - FIX_0_899976223, c)),
+        idct_madd_sse2_(p51_lo, p51_hi, idct_pair_sse2_(c - FIX_0_390180644, FIX_1_501321110 - FIX_0_899976223 - FIX_0_390180644 + c)));
+
+    v[0] = idct_descale_sse2_<SHIFT>(idct_add_sse2_(tmp10, t3), bias);
+    v[7] = idct_descale_sse2_<SHIFT>(idct_sub_sse2_(tmp10, t3), bias);
+    v[1] = idct_descale_sse2_<SHIFT>(idct_add_sse2_(tmp11, t2), bias);
+    v[6] = idct_descale_sse2_<SHIFT>(idct_sub_sse2_(tmp11, t2), bias);
+    v[2] = idct_descale_sse2_<SHIFT>(idct_add_sse2_(tmp12, t1), bias);
+    v[5] = idct_descale_sse2_<SHIFT>(idct_sub_sse2_(tmp12, t1), bias);
+    v[3] = idct_descale_sse2_<SHIFT>(idct_add_sse2_(tmp13, t0), bias);
+    v[4] = idct_descale_sse2_<SHIFT>(idct_sub_sse2_(tmp13, t0), bias);
+}
+
+// 8x8 16 bits transpose
+IMAGE_TARGET("sse2") inline void idct_transpose_sse2_(__m128i (&v)[8]) noexcept {
+    auto a0 = _mm_unpacklo_epi16(v[0], v[1]);
+    auto a1 = _mm_unpackhi_epi16(v[0], v[1]);
+    auto a2 = _mm_unpacklo_epi16(v[2], v[3]);
+    auto a3 = _mm_unpackhi_epi16(v[2], v[3]);
+    auto a4 = _mm_unpacklo_epi16(v[4], v[5]);
+    auto a5 = _mm_unpackhi_epi16(v[4], v[5]);
+    auto a6 = _mm_unpacklo_epi16(v[6], v[7]);
+    auto a7 = _mm_unpackhi_epi16(v[6], v[7]);
+    auto b0 = _mm_unpacklo_epi32(a0, a2);
+    auto b1 = _mm_unpackhi_epi32(a0, a2);
+    auto b2 = _mm_unpacklo_epi32(a1, a3);
+    auto b3 = _mm_unpackhi_epi32(a1, a3);
+    auto b4 = _mm_unpacklo_epi32(a4, a6);
+    auto b5 = _mm_unpackhi_epi32(a4, a6);
+    auto b6 = _mm_unpacklo_epi32(a5, a7);
+    auto b7 = _mm_unpackhi_epi32(a5, a7);
+    v[0] = _mm_unpacklo_epi64(b0, b4);
+    v[1] = _mm_unpackhi_epi64(b0, b4);
+    v[2] = _mm_unpacklo_epi64(b1, b5);
+    v[3] = _mm_unpackhi_epi64(b1, b5);
+    v[4] = _mm_unpacklo_epi64(b2, b6);
+    v[5] = _mm_unpackhi_epi64(b2, b6);
+    v[6] = _mm_unpacklo_epi64(b3, b7);
+    v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+IMAGE_TARGET("sse2") inline void idct_sse2(const int16_t* coefficients, uint8_t* dst, size_t stride) noexcept {
+    __m128i v[8];
+    for(size_t i = 0; i < 8; ++i) {
+        v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients + i * 8));
+    }
+
+    // columns, then rows of transposed block (+ 128 level shift)
+    constexpr int32_t shift = IDCT_CONST_BITS + IDCT_PASS1_BITS + 3;
+    idct_pass_sse2_<IDCT_CONST_BITS - IDCT_PASS1_BITS>(v, _mm_set1_epi32(1 << (IDCT_CONST_BITS - IDCT_PASS1_BITS - 1)));
+    idct_transpose_sse2_(v);
+    idct_pass_sse2_<shift>(v, _mm_set1_epi32((1 << (shift - 1)) + (128 << shift)));
+    // v[i] is column i of output
+    idct_transpose_sse2_(v);
+
+    for(size_t i = 0; i < 8; i += 2) {
+        auto packed = _mm_packus_epi16(v[i], v[i + 1]);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * stride), packed);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (i + 1) * stride), _mm_unpackhi_epi64(packed, packed));
+    }
+}
+
+// AVX2: same transform for two blocks at once (one block per 128 bits lane, all operations are in-lane)
+IMAGE_TARGET("avx2") inline __m256i idct_pair_avx2_(int32_t a, int32_t b) noexcept {
+    return _mm256_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(a) & 0xffff)));
+}
+
+struct IdctWide256_ {
+    __m256i lo;
+    __m256i hi;
+};
+
+IMAGE_TARGET("avx2") inline IdctWide256_ idct_madd_avx2_(__m256i xy_lo, __m256i xy_hi, __m256i ab) noexcept {
+    return {_mm256_madd_epi16(xy_lo, ab), _mm256_madd_epi16(xy_hi, ab)};
+}
+
+IMAGE_TARGET("avx2") inline IdctWide256_ idct_add_avx2_(IdctWide256_ a, IdctWide256_ b) noexcept {
+    return {_mm256_add_epi32(a.lo, b.lo), _mm256_add_epi32(a.hi, b.hi)};
+}
+
+IMAGE_TARGET("avx2") inline IdctWide256_ idct_sub_avx2_(IdctWide256_ a, IdctWide256_ b) noexcept {
+    return {_mm256_sub_epi32(a.lo, b.lo), _mm256_sub_epi32(a.hi, b.hi)};
+}
+
+template<int SHIFT>
+IMAGE_TARGET("avx2") inline __m256i idct_descale_avx2_(IdctWide256_ a, __m256i bias) noexcept {
+    return _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(a.lo, bias), SHIFT), _mm256_srai_epi32(_mm256_add_epi32(a.hi, bias), SHIFT));
+}
+
+template<int SHIFT>
+IMAGE_TARGET("avx2") inline void idct_pass_avx2_(__m256i (&v)[8], __m256i bias) noexcept {
+    auto p04_lo = _mm256_unpacklo_epi16(v[0], v[4]);
+    auto p04_hi = _mm256_unpackhi_epi16(v[0], v[4]);
+    auto p26_lo = _mm256_unpacklo_epi16(v[2], v[6]);
+    auto p26_hi = _mm256_unpackhi_epi16(v[2], v[6]);
+    constexpr int32_t one = 1 << IDCT_CONST_BITS;
+    auto tmp0 = idct_madd_avx2_(p04_lo, p04_hi, idct_pair_avx2_(one, one));
+    auto tmp1 = idct_madd_avx2_(p04_lo, p04_hi, idct_pair_avx2_(one, -one));
+    auto tmp2 = idct_madd_avx2_(p26_lo, p26_hi, idct_pair_avx2_(FIX_0_541196100, FIX_0_541196100 - FIX_1_847759065));
+    auto tmp3 = idct_madd_avx2_(p26_lo, p26_hi, idct_pair_avx2_(FIX_0_541196100 + FIX_0_765366865, FIX_0_541196100));
+    auto tmp10 = idct_add_avx2_(tmp0, tmp3);
+    auto tmp13 = idct_sub_avx2_(tmp0, tmp3);
+    auto tmp11 = idct_add_avx2_(tmp1, tmp2);
+    auto tmp12 = idct_sub_avx2_(tmp1, tmp2);
+
+    auto p73_lo = _mm256_unpacklo_epi16(v[7], v[3]);
+    auto p73_hi = _mm256_unpackhi_epi16(v[7], v[3]);
+    auto p51_lo = _mm256_unpacklo_epi16(v[5], v[1]);
+    auto p51_hi = _mm256_unpackhi_epi16(v[5], v[1]);
+    constexpr int32_t c = FIX_1_175875602;
+    auto t0 = idct_add_avx2_(
+        idct_madd_avx2_(p73_lo, p73_hi, idct_pair_avx2_(FIX_0_298631336 - FIX_0_899976223 - FIX_1_961570560 + c, c - FIX_1_961570560)),
+        idct_madd_avx2_(p51_lo, p51_hi, idct_pair_avx2_(c, c - FIX_0_899976223)));
+    auto t1 = idct_add_avx2_(
+        idct_madd_avx2_(p73_lo, p73_hi, idct_pair_avx2_(c, c - FIX_2_562915447)),
+        idct_madd_avx2_(p51_lo, p51_hi, idct_pair_avx2_(FIX_2_053119869 - FIX_2_562915447 - FIX_0_390180644 + c, c - FIX_0_390180644)));
+    auto t2 = idct_add_avx2_(
+        idct_madd_avx2_(p73_lo, p73_hi, idct_pair_avx2_(c - FIX_1_961570560, FIX_3_072711026 - FIX_2_562915447 - FIX_1_961570560 + c)),
+        idct_madd_avx2_(p51_lo, p51_hi, idct_pair_avx2_(c - FIX_2_562915447, c)));
+    auto t3 = idct_add_avx2_(
+        idct_madd_avx2_(p73_lo, p73_hi, idct_pair_avx2_(c - FIX_0_899976223, c)),
+        idct_madd_avx2_(p51_lo, p51_hi, idct_pair_avx2_(c - FIX_0_390180644, FIX_1_501321110 - FIX_0_899976223 - FIX_0_390180644 + c)));
+
+    v[0] = idct_descale_avx2_<SHIFT>(idct_add_avx2_(tmp10, t3), bias);
+    v[7] = idct_descale_avx2_<SHIFT>(idct_sub_avx2_(tmp10, t3), bias);
+    v[1] = idct_descale_avx2_<SHIFT>(idct_add_avx2_(tmp11, t2), bias);
+    v[6] = idct_descale_avx2_<SHIFT>(idct_sub_avx2_(tmp11, t2), bias);
+    v[2] = idct_descale_avx2_<SHIFT>(idct_add_avx2_(tmp12, t1), bias);
+    v[5] = idct_descale_avx2_<SHIFT>(idct_sub_avx2_(tmp12, t1), bias);
+    v[3] = idct_descale_avx2_<SHIFT>(idct_add_avx2_(tmp13, t0), bias);
+    v[4] = idct_descale_avx2_<SHIFT>(idct_sub_avx2_(tmp13, t0), bias);
+}
+
+IMAGE_TARGET("avx2") inline void idct_transpose_avx2_(__m256i (&v)[8]) noexcept {
+    auto a0 = _mm256_unpacklo_epi16(v[0], v[1]);
+    auto a1 = _mm256_unpackhi_epi16(v[0], v[1]);
+    auto a2 = _mm256_unpacklo_epi16(v[2], v[3]);
+    auto a3 = _mm256_unpackhi_epi16(v[2], v[3]);
+    auto a4 = _mm256_unpacklo_epi16(v[4], v[5]);
+    auto a5 = _mm256_unpackhi_epi16(v[4], v[5]);
+    auto a6 = _mm256_unpacklo_epi16(v[6], v[7]);
+    auto a7 = _mm256_unpackhi_epi16(v[6], v[7]);
+    auto b0 = _mm256_unpacklo_epi32(a0, a2);
+    auto b1 = _mm256_unpackhi_epi32(a0, a2);
+    auto b2 = _mm256_unpacklo_epi32(a1, a3);
+    auto b3 = _mm256_unpackhi_epi32(a1, a3);
+    auto b4 = _mm256_unpacklo_epi32(a4, a6);
+    auto b5 = _mm256_unpackhi_epi32(a4, a6);
+    auto b6 = _mm256_unpacklo_epi32(a5, a7);
+    auto b7 = _mm256_unpackhi_epi32(a5, a7);
+    v[0] = _mm256_unpacklo_epi64(b0, b4);
+    v[1] = _mm256_unpackhi_epi64(b0, b4);
+    v[2] = _mm256_unpacklo_epi64(b1, b5);
+    v[3] = _mm256_unpackhi_epi64(b1, b5);
+    v[4] = _mm256_unpacklo_epi64(b2, b6);
+    v[5] = _mm256_unpackhi_epi64(b2, b6);
+    v[6] = _mm256_unpacklo_epi64(b3, b7);
+    v[7] = _mm256_unpackhi_epi64(b3, b7);
+}
+
+// two blocks, outputs may be anywhere (e.g. horizontally adjacent blocks: dst1 = dst0 + 8)
+IMAGE_TARGET("avx2") inline void idct2_avx2(const int16_t* coefficients0, const int16_t* coefficients1, uint8_t* dst0, uint8_t* dst1, size_t stride) noexcept {
+    __m256i v[8];
+    for(size_t i = 0; i < 8; ++i) {
+        auto row0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients0 + i * 8));
+        auto row1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients1 + i * 8));
+        v[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(row0), row1, 1);
+    }
+
+    constexpr int32_t shift = IDCT_CONST_BITS + IDCT_PASS1_BITS + 3;
+    idct_pass_avx2_<IDCT_CONST_BITS - IDCT_PASS1_BITS>(v, _mm256_set1_epi32(1 << (IDCT_CONST_BITS - IDCT_PASS1_BITS - 1)));
+    idct_transpose_avx2_(v);
+    idct_pass_avx2_<shift>(v, _mm256_set1_epi32((1 << (shift - 1)) + (128 << shift)));
+    idct_transpose_avx2_(v);
+
+    for(size_t i = 0; i < 8; i += 2) {
+        auto packed = _mm256_packus_epi16(v[i], v[i + 1]);
+        auto packed0 = _mm256_castsi256_si128(packed);
+        auto packed1 = _mm256_extracti128_si256(packed, 1);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst0 + i * stride), packed0);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst0 + (i + 1) * stride), _mm_unpackhi_epi64(packed0, packed0));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst1 + i * stride), packed1);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst1 + (i + 1) * stride), _mm_unpackhi_epi64(packed1, packed1));
+    }
+}
+
+// 4 x 4 transform of 4 point vectors (lanes are independent), 16 bits results after descale
+template<int SHIFT>
+IMAGE_TARGET("sse2") inline void idct4_pass_sse2_(__m128i v0, __m128i v1, __m128i v2, __m128i v3, __m128i v5, __m128i v6, __m128i v7, __m128i bias, __m128i (&out)[4]) noexcept {
+    auto zero = _mm_setzero_si128();
+    // v0 << (CONST_BITS + 1) as 32 bits
+    IdctWide128_ tmp0{_mm_srai_epi32(_mm_unpacklo_epi16(zero, v0), 16 - (IDCT_CONST_BITS + 1)), _mm_srai_epi32(_mm_unpackhi_epi16(zero, v0), 16 - (IDCT_CONST_BITS + 1))};
+    auto tmp2 = idct_madd_sse2_(_mm_unpacklo_epi16(v2, v6), _mm_unpackhi_epi16(v2, v6), idct_pair_sse2_(FIX_1_847759065, -FIX_0_765366865));
+    auto tmp10 = idct_add_sse2_(tmp0, tmp2);
+    auto tmp12 = idct_sub_sse2_(tmp0, tmp2);
+
+    auto p75_lo = _mm_unpacklo_epi16(v7, v5);
+    auto p75_hi = _mm_unpackhi_epi16(v7, v5);
+    auto p31_lo = _mm_unpacklo_epi16(v3, v1);
+    auto p31_hi = _mm_unpackhi_epi16(v3, v1);
+    auto odd0 = idct_add_sse2_(idct_madd_sse2_(p75_lo, p75_hi, idct_pair_sse2_(-FIX_0_211164243, FIX_1_451774981)), idct_madd_sse2_(p31_lo, p31_hi, idct_pair_sse2_(-FIX_2_172734803, FIX_1_061594337)));
+    auto odd2 = idct_add_sse2_(idct_madd_sse2_(p75_lo, p75_hi, idct_pair_sse2_(-FIX_0_509795579, -FIX_0_601344887)), idct_madd_sse2_(p31_lo, p31_hi, idct_pair_sse2_(FIX_0_899976223, FIX_2_562915447)));
+
+    out[0] = idct_descale_sse2_<SHIFT>(idct_add_sse2_(tmp10, odd2), bias);
+    out[1] = idct_descale_sse2_<SHIFT>(idct_add_sse2_(tmp12, odd0), bias);
+    out[2] = idct_descale_sse2_<SHIFT>(idct_sub_sse2_(tmp12, odd0), bias);
+    out[3] = idct_descale_sse2_<SHIFT>(idct_sub_sse2_(tmp10, odd2), bias);
+}
+
+// columns of one block: 4 rows of 8 columns
+IMAGE_TARGET("sse2") inline void idct4_columns_sse2_(const int16_t* coefficients, __m128i (&w)[4]) noexcept {
+    auto row = reinterpret_cast<const __m128i*>(coefficients);
+    constexpr int32_t shift = IDCT_CONST_BITS - IDCT_PASS1_BITS + 1;
+    idct4_pass_sse2_<shift>(_mm_loadu_si128(row), _mm_loadu_si128(row + 1), _mm_loadu_si128(row + 2), _mm_loadu_si128(row + 3),
+        _mm_loadu_si128(row + 5), _mm_loadu_si128(row + 6), _mm_loadu_si128(row + 7), _mm_set1_epi32(1 << (shift - 1)), w);
+}
+
+// 4 x 8 -> pairs of columns ([0 | 1], [2 | 3], [4 | 5], [6 | 7], 4 rows each)
+IMAGE_TARGET("sse2") inline void idct4_transpose_sse2_(__m128i (&w)[4]) noexcept {
+    auto a0 = _mm_unpacklo_epi16(w[0], w[1]);
+    auto a1 = _mm_unpackhi_epi16(w[0], w[1]);
+    auto a2 = _mm_unpacklo_epi16(w[2], w[3]);
+    auto a3 = _mm_unpackhi_epi16(w[2], w[3]);
+    w[0] = _mm_unpacklo_epi32(a0, a2);
+    w[1] = _mm_unpackhi_epi32(a0, a2);
+    w[2] = _mm_unpacklo_epi32(a1, a3);
+    w[3] = _mm_unpackhi_epi32(a1, a3);
+}
+
+// two blocks: columns of each, then rows of both at once (lanes 0-3 rows of block 0, lanes 4-7 rows of block 1)
+IMAGE_TARGET("sse2") inline void idct4x4x2_sse2(const int16_t* coefficients0, const int16_t* coefficients1, uint8_t* dst0, uint8_t* dst1, size_t stride) noexcept {
+    __m128i w0[4];
+    __m128i w1[4];
+    idct4_columns_sse2_(coefficients0, w0);
+    idct4_columns_sse2_(coefficients1, w1);
+    idct4_transpose_sse2_(w0);
+    idct4_transpose_sse2_(w1);
+
+    constexpr int32_t shift = IDCT_CONST_BITS + IDCT_PASS1_BITS + 3 + 1;
+    __m128i out[4];
+    idct4_pass_sse2_<shift>(_mm_unpacklo_epi64(w0[0], w1[0]), _mm_unpackhi_epi64(w0[0], w1[0]), _mm_unpacklo_epi64(w0[1], w1[1]), _mm_unpackhi_epi64(w0[1], w1[1]),
+        _mm_unpackhi_epi64(w0[2], w1[2]), _mm_unpacklo_epi64(w0[3], w1[3]), _mm_unpackhi_epi64(w0[3], w1[3]), _mm_set1_epi32((1 << (shift - 1)) + (128 << shift)), out);
+
+    // out[x] lane i is sample x of row i -> 4 bytes per row
+    auto p01 = _mm_packus_epi16(out[0], out[1]);
+    auto p23 = _mm_packus_epi16(out[2], out[3]);
+    auto q01 = _mm_unpacklo_epi8(p01, _mm_srli_si128(p01, 8));
+    auto q23 = _mm_unpacklo_epi8(p23, _mm_srli_si128(p23, 8));
+    auto rows0 = _mm_unpacklo_epi16(q01, q23);
+    auto rows1 = _mm_unpackhi_epi16(q01, q23);
+    for(size_t y = 0; y < 4; ++y) {
+        auto row0 = _mm_cvtsi128_si32(rows0);
+        auto row1 = _mm_cvtsi128_si32(rows1);
+        std::memcpy(dst0 + y * stride, &row0, 4);
+        std::memcpy(dst1 + y * stride, &row1, 4);
+        rows0 = _mm_srli_si128(rows0, 4);
+        rows1 = _mm_srli_si128(rows1, 4);
+    }
+}
+
+#endif
+
+// horizontal run of blocks (coefficients are consecutive 64 values blocks, block i is written to dst + 8 * i)
+inline void idct_row(const int16_t* coefficients, size_t block_count, uint8_t* dst, size_t stride) noexcept {
+    size_t i = 0;
+#if defined(IMAGE_SIMD_X86)
+    const auto& features = simd::features();
+    if(features.avx2) {
+        for(; i + 2 <= block_count; i += 2) {
+            idct2_avx2(coefficients + i * 64, coefficients + (i + 1) * 64, dst + i * 8, dst + (i + 1) * 8, stride);
+        }
+    }
+    if(features.sse2) {
+        for(; i < block_count; ++i) {
+            idct_sse2(coefficients + i * 64, dst + i * 8, stride);
+        }
+    }
+#endif
+    for(; i < block_count; ++i) {
+        idct_scalar(coefficients + i * 64, dst + i * 8, stride);
+    }
+}
+
+// horizontal run of blocks transformed to size x size samples (8, 4, 2 or 1), block i is written to dst + size * i
+inline void idct_row(const int16_t* coefficients, size_t block_count, uint32_t size, uint8_t* dst, size_t stride) noexcept {
+    switch(size) {
+        case 8:
+            idct_row(coefficients, block_count, dst, stride);
+            break;
+        case 4: {
+            size_t i = 0;
+#if defined(IMAGE_SIMD_X86)
+            if(simd::features().sse2) {
+                for(; i + 2 <= block_count; i += 2) {
+                    idct4x4x2_sse2(coefficients + i * 64, coefficients + (i + 1) * 64, dst + i * 4, dst + (i + 1) * 4, stride);
+                }
+            }
+#endif
+            for(; i < block_count; ++i) {
+                idct_4x4_scalar(coefficients + i * 64, dst + i * 4, stride);
+            }
+            break;
+        }
+        case 2:
+            for(size_t i = 0; i < block_count; ++i) {
+                idct_2x2_scalar(coefficients + i * 64, dst + i * 2, stride);
+            }
+            break;
+        default:
+            for(size_t i = 0; i < block_count; ++i) {
+                idct_1x1(coefficients + i * 64, dst + i);
+            }
+            break;
+    }
+}
+
+}
+
+}
\ No newline at end of file
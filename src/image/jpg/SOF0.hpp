@@ -15,12 +15,12 @@ struct SOF0Component {
     uint8_t vi() const noexcept { return hi_vi & 0x0f; }
 };
 
-inline SOF0Component read_sof0_component(std::ifstream& ifs) {
+inline SOF0Component read_sof0_component(io::ByteReader& reader) {
     SOF0Component component{};
 
-    read_be(ifs, component.ci);
-    read_be(ifs, component.hi_vi);
-    read_be(ifs, component.tqi);
+    reader.read_be(component.ci);
+    reader.read_be(component.hi_vi);
+    reader.read_be(component.tqi);
 
     return component;
 }
@@ -33,19 +33,19 @@ struct SOF0 {
     std::vector<SOF0Component> components;
 };
 
-inline SOF0 read_sof0(std::ifstream& ifs) {
+inline SOF0 read_sof0(io::ByteReader& reader) {
     SOF0 sof0;
 
-    read_be(ifs, sof0.lf);
-    read_be(ifs, sof0.p);
-    read_be(ifs, sof0.y);
-    read_be(ifs, sof0.x);
+    reader.read_be(sof0.lf);
+    reader.read_be(sof0.p);
+    reader.read_be(sof0.y);
+    reader.read_be(sof0.x);
 
     uint8_t nf{};
-    read_be(ifs, nf);
+    reader.read_be(nf);
     sof0.components.resize(nf);
     for(size_t i = 0; i < sof0.components.size(); ++i) {
-        sof0.components[i] = std::move(read_sof0_component(ifs));
+        sof0.components[i] = std::move(read_sof0_component(reader));
     }
 
     return sof0;
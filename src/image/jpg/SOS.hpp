@@ -14,11 +14,11 @@ struct SOSComponent {
     uint8_t taj() const noexcept { return tdj_taj & 0x0f; }
 };
 
-inline SOSComponent read_sos_component(std::ifstream& ifs) {
+inline SOSComponent read_sos_component(io::ByteReader& reader) {
     SOSComponent component{};
 
-    read_be(ifs, component.csj);
-    read_be(ifs, component.tdj_taj);
+    reader.read_be(component.csj);
+    reader.read_be(component.tdj_taj);
 
     return component;
 }
@@ -34,21 +34,21 @@ struct SOS {
     uint8_t al() const noexcept { return ah_al & 0x0f; }
 };
 
-inline SOS read_sos(std::ifstream& ifs) {
+inline SOS read_sos(io::ByteReader& reader) {
     SOS sos{};
 
-    read_be(ifs, sos.ls);
+    reader.read_be(sos.ls);
 
     uint8_t ns{};
-    read_be(ifs, ns);
+    reader.read_be(ns);
     sos.components.resize(ns);
     for(size_t i = 0; i < sos.components.size(); ++i) {
-        sos.components[i] = std::move(read_sos_component(ifs));
+        sos.components[i] = std::move(read_sos_component(reader));
     }
 
-    read_be(ifs, sos.ss);
-    read_be(ifs, sos.se);
-    read_be(ifs, sos.ah_al);
+    reader.read_be(sos.ss);
+    reader.read_be(sos.se);
+    reader.read_be(sos.ah_al);
 
     return sos;
 }
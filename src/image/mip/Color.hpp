@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+#include "../common.hpp"
+
+namespace image {
+
+namespace mip {
+
+// sRGB transfer function through lookup tables (8 bits encoded values <-> linear floats)
+
+inline float srgb_to_linear_exact_(float value) noexcept {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+inline float linear_to_srgb_exact_(float value) noexcept {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// [encoded value] -> linear value
+inline const std::array<float, 256>& srgb_to_linear_table_() noexcept {
+    static const auto table = []{
+        std::array<float, 256> table{};
+        for(uint32_t i = 0; i < 256; ++i) {
+            table[i] = srgb_to_linear_exact_(i / 255.0f);
+        }
+        return table;
+    }();
+    return table;
+}
+
+// linear [2^-13, 1) is split to 13 octaves of 8 buckets by exponent and 3 highest mantissa bits of float
+// each bucket interpolates encoded value (0 .. 255) linearly between its ends, shifted up by half of largest
+// deviation of the (concave) curve from chord (below 2^-13 encoded value rounds to 0)
+struct SrgbBucket_ {
+    float base;
+    float slope;
+};
+
+constexpr uint32_t SRGB_MIN_BITS_ = (127 - 13) << 23;
+constexpr uint32_t SRGB_ONE_BITS_ = 127 << 23;
+
+inline const std::array<SrgbBucket_, 104>& linear_to_srgb_table_() noexcept {
+    static const auto table = []{
+        std::array<SrgbBucket_, 104> table{};
+        for(uint32_t i = 0; i < 104; ++i) {
+            auto low_bits = SRGB_MIN_BITS_ + (i << 20);
+            auto high_bits = low_bits + (1u << 20);
+            float low{}, high{};
+            std::memcpy(&low, &low_bits, 4);
+            std::memcpy(&high, &high_bits, 4);
+            auto base = linear_to_srgb_exact_(low) * 255.0f;
+            auto slope = linear_to_srgb_exact_(high) * 255.0f - base;
+            float deviation = 0.0f;
+            for(uint32_t k = 1; k < 16; ++k) {
+                auto t = k / 16.0f;
+                deviation = std::max(deviation, linear_to_srgb_exact_(low + (high - low) * t) * 255.0f - (base + slope * t));
+            }
+            table[i] = {base + deviation * 0.5f, slope};
+        }
+        return table;
+    }();
+    return table;
+}
+
+inline uint8_t linear_to_srgb8_(float value) noexcept {
+    // also maps NaN to 0
+    if(!(value > 0.0f)) {
+        return 0;
+    }
+    uint32_t bits{};
+    std::memcpy(&bits, &value, 4);
+    if(bits >= SRGB_ONE_BITS_) {
+        return 255;
+    }
+    if(bits < SRGB_MIN_BITS_) {
+        return 0;
+    }
+    const auto& bucket = linear_to_srgb_table_()[(bits - SRGB_MIN_BITS_) >> 20];
+    auto t = static_cast<float>(bits & 0xfffff) * (1.0f / (1 << 20));
+    return static_cast<uint8_t>(bucket.base + bucket.slope * t + 0.5f);
+}
+
+inline uint8_t linear_to_unorm8_(float value) noexcept {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cmath>
+#include <numbers>
+
+#include "../common.hpp"
+
+namespace image {
+
+namespace mip {
+
+enum class Filter {
+    // average of source pixels under destination pixel (2x2 for even sizes)
+    box,
+    // tent of radius 1 destination pixel (4 taps per axis for even sizes), bilinear when magnifying
+    triangle,
+    // Kaiser windowed sinc of radius 3 destination pixels, alpha 4 (12 taps per axis, sharpest, slight ringing)
+    kaiser,
+    // Lanczos windowed sinc of radius 3 (sharp, slight ringing)
+    lanczos3,
+    // Mitchell-Netravali cubic, B = C = 1/3 (radius 2, little blur and ringing)
+    mitchell,
+};
+
+// radius in destination pixels
+inline float filter_support_(Filter filter) noexcept {
+    switch(filter) {
+        case Filter::box: return 0.5f;
+        case Filter::triangle: return 1.0f;
+        case Filter::mitchell: return 2.0f;
+        default: return 3.0f;
+    }
+}
+
+// modified Bessel function of the first kind of order 0 (power series)
+inline double bessel_i0_(double x) noexcept {
+    double sum = 1.0, term = 1.0;
+    for(uint32_t k = 1; k < 32 && term > sum * 1e-12; ++k) {
+        auto factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+    }
+    return sum;
+}
+
+// normalized sinc
+inline double sinc_(double x) noexcept {
+    return x < 1e-6 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+}
+
+// x in destination pixels from center
+inline double filter_value_(Filter filter, double x) noexcept {
+    x = std::abs(x);
+    switch(filter) {
+        case Filter::box:
+            return x < 0.5 ? 1.0 : 0.0;
+        case Filter::triangle:
+            return std::max(0.0, 1.0 - x);
+        case Filter::lanczos3: {
+            if(x >= 3.0) {
+                return 0.0;
+            }
+            return sinc_(x) * sinc_(x / 3.0);
+        }
+        case Filter::mitchell: {
+            constexpr double B = 1.0 / 3.0, C = 1.0 / 3.0;
+            if(x < 1.0) {
+                return ((12.0 - 9.0 * B - 6.0 * C) * x * x * x + (-18.0 + 12.0 * B + 6.0 * C) * x * x + (6.0 - 2.0 * B)) / 6.0;
+            }
+            if(x < 2.0) {
+                return ((-B - 6.0 * C) * x * x * x + (6.0 * B + 30.0 * C) * x * x + (-12.0 * B - 48.0 * C) * x + (8.0 * B + 24.0 * C)) / 6.0;
+            }
+            return 0.0;
+        }
+        default: {
+            constexpr double WIDTH = 3.0, ALPHA = 4.0;
+            if(x >= WIDTH) {
+                return 0.0;
+            }
+            auto t = x / WIDTH;
+            return sinc_(x) * bessel_i0_(ALPHA * std::sqrt(1.0 - t * t)) / bessel_i0_(ALPHA);
+        }
+    }
+}
+
+// weights of source pixels for each destination pixel along one axis (polyphase for any src_size / dst_size)
+// every destination pixel has tap_count taps (unused taps have zero weight), weights sum to 1
+// minifying: weight of source pixel is integral of filter over its extent, so odd sizes get fractional coverage
+// magnifying: filter is sampled at source pixel centers in source pixel units (box is nearest, triangle is bilinear)
+// source indices outside of image are clamped to edge or wrapped around (tiling textures)
+struct Kernel {
+    uint32_t tap_count;
+    // [dst] source position of first tap before clamping or wrapping (taps are consecutive from it)
+    std::vector<int64_t> firsts;
+    // [dst * tap_count + tap]
+    std::vector<uint32_t> indices;
+    std::vector<float> weights;
+
+    static Kernel make(Filter filter, uint32_t src_size, uint32_t dst_size, bool wrap) {
+        auto scale = static_cast<double>(src_size) / dst_size;
+        auto filter_scale = std::max(scale, 1.0);
+        auto radius = filter_support_(filter) * filter_scale;
+        uint32_t sample_count = scale >= 1.0 ? 8 : 1;
+
+        // first source pixel and weights of each destination pixel before padding to common tap count
+        std::vector<int64_t> firsts(dst_size);
+        std::vector<std::vector<double>> taps(dst_size);
+        uint32_t tap_count = 1;
+        for(uint32_t i = 0; i < dst_size; ++i) {
+            auto center = (i + 0.5) * scale;
+            auto first = static_cast<int64_t>(std::floor(center - radius));
+            auto last = static_cast<int64_t>(std::ceil(center + radius));
+            double sum = 0.0;
+            std::vector<double> weights{};
+            for(auto j = first; j < last; ++j) {
+                double weight = 0.0;
+                for(uint32_t s = 0; s < sample_count; ++s) {
+                    weight += filter_value_(filter, (j + (s + 0.5) / sample_count - center) / filter_scale);
+                }
+                weights.push_back(weight);
+                sum += weight;
+            }
+            // magnified box at center exactly between source pixels has no sample inside, nearest one is taken
+            if(sum == 0.0) {
+                auto nearest = static_cast<int64_t>(std::floor(center));
+                for(auto j = first; j < last; ++j) {
+                    weights[j - first] = j == nearest ? 1.0 : 0.0;
+                }
+                sum = 1.0;
+            }
+            // zero weights at both ends are dropped
+            while(!weights.empty() && weights.back() == 0.0) {
+                weights.pop_back();
+            }
+            size_t leading = 0;
+            while(leading < weights.size() && weights[leading] == 0.0) {
+                ++leading;
+            }
+            weights.erase(weights.begin(), weights.begin() + leading);
+            first += static_cast<int64_t>(leading);
+            for(auto& weight : weights) {
+                weight /= sum;
+            }
+
+            firsts[i] = first;
+            tap_count = std::max(tap_count, static_cast<uint32_t>(weights.size()));
+            taps[i] = std::move(weights);
+        }
+
+        Kernel kernel{tap_count, firsts, std::vector<uint32_t>(size_t(dst_size) * tap_count), std::vector<float>(size_t(dst_size) * tap_count)};
+        auto source_size = static_cast<int64_t>(src_size);
+        for(uint32_t i = 0; i < dst_size; ++i) {
+            for(uint32_t k = 0; k < tap_count; ++k) {
+                auto j = firsts[i] + k;
+                j = wrap ? ((j % source_size) + source_size) % source_size : std::clamp<int64_t>(j, 0, source_size - 1);
+                kernel.indices[size_t(i) * tap_count + k] = static_cast<uint32_t>(j);
+                kernel.weights[size_t(i) * tap_count + k] = k < taps[i].size() ? static_cast<float>(taps[i][k]) : 0.0f;
+            }
+        }
+        return kernel;
+    }
+};
+
+}
+
+}
\ No newline at end of file
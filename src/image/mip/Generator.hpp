@@ -0,0 +1,215 @@
+#pragma once
+
+#include "Color.hpp"
+#include "Resample.hpp"
+#include "../dds/Layout.hpp"
+#include "../../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+namespace mip {
+
+struct Options {
+    Filter filter = Filter::box;
+    // 0: full chain down to 1 x 1
+    uint32_t mip_count = 0;
+    // bytes between source rows (0: tightly packed)
+    size_t row_pitch = 0;
+    // color channels of 8 bits source are sRGB encoded (filtered in linear space, alpha is always linear)
+    bool is_srgb = false;
+    // source repeats at edges (tiling texture), otherwise edge pixels are extended
+    bool wrap = false;
+    // > 0: alpha of each level is scaled so that fraction of pixels with alpha >= cutoff stays as in level 0
+    // (alpha-tested cutout textures would otherwise fade out in smaller levels)
+    float alpha_cutoff = 0.0f;
+};
+
+// levels in DDS order (largest first, tightly packed, see dds::Layout), level 0 is copy of source
+struct Chain {
+    dds::Layout layout;
+    std::vector<uint8_t> data;
+};
+
+// mip chain generator of 8 bits (R8, RG8, RGB8, RGBA8, BGRA8) and float (R32F, RG32F, RGB32F, RGBA32F) images
+// each level is filtered from previous one in linear float (so rounding does not accumulate), then stored to format
+// level size is max(1, size >> level), odd sizes are resampled with fractional filter footprint
+// rows of each level are split to tasks on pool, a task keeps ring of horizontally filtered source rows its own rows need
+class Generator {
+    uint32_t channel_count_;
+    Format format_;
+    bool is_srgb_;
+
+    // channel c of pixel is sRGB encoded (alpha is the 4th channel of RGBA8 and BGRA8)
+    bool is_srgb_channel_(uint32_t c) const noexcept {
+        return is_srgb_ && !(channel_count_ == 4 && c == 3);
+    }
+
+    void load_row_(const uint8_t* src, uint32_t width, float* dst) const noexcept {
+        auto count = size_t(width) * channel_count_;
+        if(pixel_size(format_) == channel_count_ * 4) {
+            std::memcpy(dst, src, count * 4);
+            return;
+        }
+        const auto& table = srgb_to_linear_table_();
+        for(size_t i = 0; i < count; i += channel_count_) {
+            for(uint32_t c = 0; c < channel_count_; ++c) {
+                dst[i + c] = is_srgb_channel_(c) ? table[src[i + c]] : src[i + c] * (1.0f / 255.0f);
+            }
+        }
+    }
+
+    void store_row_(const float* src, uint32_t width, float alpha_scale, uint8_t* dst) const noexcept {
+        auto count = size_t(width) * channel_count_;
+        if(pixel_size(format_) == channel_count_ * 4) {
+            std::memcpy(dst, src, count * 4);
+            if(alpha_scale != 1.0f) {
+                auto pixels = reinterpret_cast<float*>(dst);
+                for(size_t i = 3; i < count; i += 4) {
+                    pixels[i] = std::min(pixels[i] * alpha_scale, 1.0f);
+                }
+            }
+            return;
+        }
+        for(size_t i = 0; i < count; i += channel_count_) {
+            for(uint32_t c = 0; c < channel_count_; ++c) {
+                if(is_srgb_channel_(c)) {
+                    dst[i + c] = linear_to_srgb8_(src[i + c]);
+                }
+                else {
+                    dst[i + c] = linear_to_unorm8_(c == 3 ? src[i + c] * alpha_scale : src[i + c]);
+                }
+            }
+        }
+    }
+
+    // alpha scale which keeps target fraction of pixels with alpha >= cutoff
+    // (scaled alpha of k-th largest alpha becomes cutoff, k = target * pixel count)
+    static float coverage_scale_(const float* pixels, size_t pixel_count, float cutoff, double target) {
+        auto k = static_cast<size_t>(std::llround(target * pixel_count));
+        std::vector<float> alphas(pixel_count);
+        for(size_t i = 0; i < pixel_count; ++i) {
+            alphas[i] = pixels[i * 4 + 3];
+        }
+        if(k == 0) {
+            auto largest = *std::max_element(alphas.begin(), alphas.end());
+            return largest >= cutoff ? cutoff / largest * 0.99f : 1.0f;
+        }
+        std::nth_element(alphas.begin(), alphas.begin() + (k - 1), alphas.end(), std::greater<float>{});
+        return cutoff / std::max(alphas[k - 1], 1.0f / 255.0f);
+    }
+
+public:
+    Generator(Format format, bool is_srgb) : channel_count_(component_count(format)), format_(format), is_srgb_(is_srgb) {
+        bool is_8bit = format == Format::R8 || format == Format::RG8 || format == Format::RGB8 || format == Format::RGBA8 || format == Format::BGRA8;
+        bool is_float = format == Format::R32F || format == Format::RG32F || format == Format::RGB32F || format == Format::RGBA32F;
+        if(!is_8bit && !is_float) {
+            throw std::runtime_error(std::format("[image::mip::Generator] ERROR: unsupported format: {}", static_cast<uint32_t>(format)));
+        }
+        // float images are linear
+        is_srgb_ = is_srgb && is_8bit;
+    }
+
+    // do not call from task on the same pool (waits for row tasks)
+    Chain generate(std::span<const uint8_t> data, uint32_t width, uint32_t height, const Options& options = {}, concurrency::ThreadPool* pool = nullptr) const {
+        if(width == 0 || height == 0) {
+            throw std::runtime_error(std::format("[image::mip::Generator] ERROR: invalid image size: {} x {}", width, height));
+        }
+        auto source_info = ImageInfo::make(width, height, format_);
+        auto row_pitch = options.row_pitch ? options.row_pitch : source_info.row_pitch;
+        if(row_pitch < source_info.row_pitch || data.size() < source_info.size(row_pitch)) {
+            throw std::runtime_error(std::format("[image::mip::Generator] ERROR: source is too small (size = {}, pitch = {}, image = {} x {}).", data.size(), row_pitch, width, height));
+        }
+        auto mip_count = options.mip_count ? options.mip_count : static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+
+        Chain chain{dds::Layout::make(format_, width, height, 1, mip_count, 1, false, std::numeric_limits<size_t>::max()), {}};
+        chain.data.resize(chain.layout.size);
+        for(uint32_t y = 0; y < height; ++y) {
+            std::memcpy(chain.data.data() + y * source_info.row_pitch, data.data() + y * row_pitch, source_info.row_pitch);
+        }
+
+        auto resampler = Resampler::select(channel_count_);
+        bool keeps_coverage = options.alpha_cutoff > 0.0f && channel_count_ == 4;
+        double target_coverage = 0.0;
+        if(keeps_coverage) {
+            std::vector<float> row(size_t(width) * 4);
+            size_t covered = 0;
+            for(uint32_t y = 0; y < height; ++y) {
+                load_row_(data.data() + y * row_pitch, width, row.data());
+                for(uint32_t x = 0; x < width; ++x) {
+                    covered += row[x * 4 + 3] >= options.alpha_cutoff;
+                }
+            }
+            target_coverage = static_cast<double>(covered) / (double(width) * height);
+        }
+
+        // previous level in float (empty for level 0, which is read from source)
+        std::vector<float> current{}, next{};
+        for(uint32_t level = 1; level < mip_count; ++level) {
+            const auto& source = chain.layout.subresource(level - 1, 0);
+            const auto& target = chain.layout.subresource(level, 0);
+            auto src_width = source.width, src_height = source.height;
+            auto dst_width = target.width, dst_height = target.height;
+            auto src_floats = size_t(src_width) * channel_count_;
+            auto dst_floats = size_t(dst_width) * channel_count_;
+
+            auto kernel_x = Kernel::make(options.filter, src_width, dst_width, options.wrap);
+            auto kernel_y = Kernel::make(options.filter, src_height, dst_height, options.wrap);
+            auto tap_count = kernel_y.tap_count;
+            next.resize(dst_floats * dst_height);
+
+            auto task_count = pool ? std::min(dst_height, pool->thread_count() * 4) : 1;
+            concurrency::parallel_for(pool, task_count, [&](uint32_t task) {
+                auto first = static_cast<uint32_t>(uint64_t(dst_height) * task / task_count);
+                auto last = static_cast<uint32_t>(uint64_t(dst_height) * (task + 1) / task_count);
+
+                // ring of horizontally filtered source rows, slot is unwrapped source row modulo ring size
+                // (taps of one destination row are consecutive unwrapped rows, so they never share a slot)
+                auto ring_size = tap_count * 2;
+                std::vector<float> filtered(size_t(ring_size) * dst_floats);
+                std::vector<int64_t> tags(ring_size, std::numeric_limits<int64_t>::min());
+                std::vector<float> scratch(current.empty() ? src_floats : 0);
+                std::vector<const float*> rows(tap_count);
+
+                for(uint32_t y = first; y < last; ++y) {
+                    for(uint32_t k = 0; k < tap_count; ++k) {
+                        auto unwrapped = kernel_y.firsts[y] + k;
+                        auto slot = static_cast<size_t>(((unwrapped % ring_size) + ring_size) % ring_size);
+                        auto filtered_row = filtered.data() + slot * dst_floats;
+                        if(tags[slot] != unwrapped) {
+                            tags[slot] = unwrapped;
+                            auto source_y = kernel_y.indices[size_t(y) * tap_count + k];
+                            const float* row{};
+                            if(current.empty()) {
+                                load_row_(data.data() + source_y * row_pitch, src_width, scratch.data());
+                                row = scratch.data();
+                            }
+                            else {
+                                row = current.data() + source_y * src_floats;
+                            }
+                            resampler.row(row, kernel_x, filtered_row, dst_width);
+                        }
+                        rows[k] = filtered_row;
+                    }
+                    resampler.columns(rows.data(), kernel_y.weights.data() + size_t(y) * tap_count, tap_count, next.data() + y * dst_floats, dst_floats);
+                }
+            });
+
+            auto alpha_scale = keeps_coverage ? coverage_scale_(next.data(), size_t(dst_width) * dst_height, options.alpha_cutoff, target_coverage) : 1.0f;
+            concurrency::parallel_for(pool, task_count, [&](uint32_t task) {
+                auto first = static_cast<uint32_t>(uint64_t(dst_height) * task / task_count);
+                auto last = static_cast<uint32_t>(uint64_t(dst_height) * (task + 1) / task_count);
+                for(uint32_t y = first; y < last; ++y) {
+                    store_row_(next.data() + y * dst_floats, dst_width, alpha_scale, chain.data.data() + target.offset + y * target.row_pitch);
+                }
+            });
+
+            std::swap(current, next);
+        }
+
+        return chain;
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "Filter.hpp"
+#include "../simd.hpp"
+
+namespace image {
+
+namespace mip {
+
+// separable resampling of float rows with interleaved channels
+// rows: horizontal pass of each source row, columns: weighted sum of horizontally filtered rows
+
+// dst[x] = sum of weights[k] * rows[k][x] for x in [0, size)
+using FilterColumns = void(*)(const float* const* rows, const float* weights, uint32_t tap_count, float* dst, size_t size);
+// dst pixel x = sum of kernel weights * src pixels at kernel indices for x in [0, dst_width)
+using FilterRow = void(*)(const float* src, const Kernel& kernel, float* dst, uint32_t dst_width);
+
+inline void filter_columns_scalar(const float* const* rows, const float* weights, uint32_t tap_count, float* dst, size_t size) noexcept {
+    for(size_t x = 0; x < size; ++x) {
+        float sum = 0.0f;
+        for(uint32_t k = 0; k < tap_count; ++k) {
+            sum += weights[k] * rows[k][x];
+        }
+        dst[x] = sum;
+    }
+}
+
+template<uint32_t CHANNEL_COUNT>
+inline void filter_row_scalar(const float* src, const Kernel& kernel, float* dst, uint32_t dst_width) noexcept {
+    auto tap_count = kernel.tap_count;
+    for(uint32_t x = 0; x < dst_width; ++x) {
+        const auto* indices = kernel.indices.data() + size_t(x) * tap_count;
+        const auto* weights = kernel.weights.data() + size_t(x) * tap_count;
+        float sum[CHANNEL_COUNT]{};
+        for(uint32_t k = 0; k < tap_count; ++k) {
+            const auto* pixel = src + size_t(indices[k]) * CHANNEL_COUNT;
+            for(uint32_t c = 0; c < CHANNEL_COUNT; ++c) {
+                sum[c] += weights[k] * pixel[c];
+            }
+        }
+        for(uint32_t c = 0; c < CHANNEL_COUNT; ++c) {
+            dst[size_t(x) * CHANNEL_COUNT + c] = sum[c];
+        }
+    }
+}
+
+#if defined(IMAGE_SIMD_X86)
+// columns [x, size)
+IMAGE_TARGET("sse2") inline void filter_columns_sse2_(const float* const* rows, const float* weights, uint32_t tap_count, float* dst, size_t x, size_t size) noexcept {
+    for(; x + 8 <= size; x += 8) {
+        auto sum0 = _mm_setzero_ps();
+        auto sum1 = _mm_setzero_ps();
+        for(uint32_t k = 0; k < tap_count; ++k) {
+            auto weight = _mm_set1_ps(weights[k]);
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(weight, _mm_loadu_ps(rows[k] + x)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(weight, _mm_loadu_ps(rows[k] + x + 4)));
+        }
+        _mm_storeu_ps(dst + x, sum0);
+        _mm_storeu_ps(dst + x + 4, sum1);
+    }
+    for(; x < size; ++x) {
+        float sum = 0.0f;
+        for(uint32_t k = 0; k < tap_count; ++k) {
+            sum += weights[k] * rows[k][x];
+        }
+        dst[x] = sum;
+    }
+}
+
+IMAGE_TARGET("sse2") inline void filter_columns_sse2(const float* const* rows, const float* weights, uint32_t tap_count, float* dst, size_t size) noexcept {
+    filter_columns_sse2_(rows, weights, tap_count, dst, 0, size);
+}
+
+IMAGE_TARGET("avx2") inline void filter_columns_avx2(const float* const* rows, const float* weights, uint32_t tap_count, float* dst, size_t size) noexcept {
+    size_t x = 0;
+    for(; x + 16 <= size; x += 16) {
+        auto sum0 = _mm256_setzero_ps();
+        auto sum1 = _mm256_setzero_ps();
+        for(uint32_t k = 0; k < tap_count; ++k) {
+            auto weight = _mm256_set1_ps(weights[k]);
+            sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(weight, _mm256_loadu_ps(rows[k] + x)));
+            sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(weight, _mm256_loadu_ps(rows[k] + x + 8)));
+        }
+        _mm256_storeu_ps(dst + x, sum0);
+        _mm256_storeu_ps(dst + x + 8, sum1);
+    }
+    filter_columns_sse2_(rows, weights, tap_count, dst, x, size);
+}
+
+// one RGBA pixel per vector
+IMAGE_TARGET("sse2") inline void filter_row_rgba_sse2(const float* src, const Kernel& kernel, float* dst, uint32_t dst_width) noexcept {
+    auto tap_count = kernel.tap_count;
+    for(uint32_t x = 0; x < dst_width; ++x) {
+        const auto* indices = kernel.indices.data() + size_t(x) * tap_count;
+        const auto* weights = kernel.weights.data() + size_t(x) * tap_count;
+        auto sum = _mm_setzero_ps();
+        for(uint32_t k = 0; k < tap_count; ++k) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(src + size_t(indices[k]) * 4)));
+        }
+        _mm_storeu_ps(dst + size_t(x) * 4, sum);
+    }
+}
+
+// two RGBA pixels per vector (pairs of taps of neighbouring destination pixels)
+IMAGE_TARGET("avx2") inline void filter_row_rgba_avx2(const float* src, const Kernel& kernel, float* dst, uint32_t dst_width) noexcept {
+    auto tap_count = kernel.tap_count;
+    uint32_t x = 0;
+    for(; x + 2 <= dst_width; x += 2) {
+        const auto* indices = kernel.indices.data() + size_t(x) * tap_count;
+        const auto* weights = kernel.weights.data() + size_t(x) * tap_count;
+        auto sum = _mm256_setzero_ps();
+        for(uint32_t k = 0; k < tap_count; ++k) {
+            auto pixels = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + size_t(indices[k]) * 4)), _mm_loadu_ps(src + size_t(indices[tap_count + k]) * 4), 1);
+            auto weight = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(weights[k])), _mm_set1_ps(weights[tap_count + k]), 1);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(weight, pixels));
+        }
+        _mm256_storeu_ps(dst + size_t(x) * 4, sum);
+    }
+    if(x < dst_width) {
+        const auto* indices = kernel.indices.data() + size_t(x) * tap_count;
+        const auto* weights = kernel.weights.data() + size_t(x) * tap_count;
+        auto sum = _mm_setzero_ps();
+        for(uint32_t k = 0; k < tap_count; ++k) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(src + size_t(indices[k]) * 4)));
+        }
+        _mm_storeu_ps(dst + size_t(x) * 4, sum);
+    }
+}
+#endif
+
+struct Resampler {
+    FilterColumns columns;
+    FilterRow row;
+
+    static Resampler select(uint32_t channel_count) {
+        Resampler resampler{filter_columns_scalar, nullptr};
+        switch(channel_count) {
+            case 1: resampler.row = filter_row_scalar<1>; break;
+            case 2: resampler.row = filter_row_scalar<2>; break;
+            case 3: resampler.row = filter_row_scalar<3>; break;
+            case 4: resampler.row = filter_row_scalar<4>; break;
+            default:
+                throw std::runtime_error(std::format("[image::mip::Resampler] ERROR: unsupported channel count: {}", channel_count));
+        }
+
+#if defined(IMAGE_SIMD_X86)
+        const auto& features = simd::features();
+        if(features.sse2) {
+            resampler.columns = filter_columns_sse2;
+            if(channel_count == 4) {
+                resampler.row = filter_row_rgba_sse2;
+            }
+        }
+        if(features.avx2) {
+            resampler.columns = filter_columns_avx2;
+            if(channel_count == 4) {
+                resampler.row = filter_row_rgba_avx2;
+            }
+        }
+#endif
+
+        return resampler;
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Generic.hpp"
+
+namespace image {
+
+namespace pixel {
+
+struct Options {
+    // color channels of 8 and 16 bits formats are sRGB encoded
+    // (decoded to linear for float formats and premultiplication, 8 and 16 bits formats are converted without decoding otherwise)
+    bool is_srgb = false;
+    // multiplies color channels by alpha (in linear space if is_srgb)
+    bool premultiply_alpha = false;
+};
+
+// converter of pixel rows from one uncompressed format to another (see Generic.hpp for channel mapping)
+// fast kernel is used for plain copy, RGB8 <-> RGBA8, BGRA8 <-> RGBA8, 16 <-> 8 bits, 8 and 16 bits <-> float, float <-> half
+// and RGBA8 premultiplication, other conversions go through RGBA floats
+struct Converter {
+    // pixels per chunk of generic path
+    static constexpr size_t CHUNK_SIZE = 256;
+
+    Kernel kernel;
+    // count unit of kernel per pixel (channels for per-sample kernels, bytes for copy)
+    uint32_t kernel_scale;
+    LoadPixels load;
+    StorePixels store;
+    uint32_t src_pixel_size;
+    uint32_t dst_pixel_size;
+    bool is_linearized;
+    bool premultiply_alpha;
+
+    // src and dst must not overlap unless formats have same pixel size
+    void convert(const uint8_t* src, uint8_t* dst, size_t count) const {
+        if(kernel) {
+            kernel(src, dst, count * kernel_scale);
+            return;
+        }
+        float rgba[CHUNK_SIZE * 4];
+        for(size_t i = 0; i < count; i += CHUNK_SIZE) {
+            auto chunk = std::min(CHUNK_SIZE, count - i);
+            load(src + i * src_pixel_size, rgba, chunk, is_linearized);
+            if(premultiply_alpha) {
+                premultiply_(rgba, chunk);
+            }
+            store(rgba, dst + i * dst_pixel_size, chunk, is_linearized);
+        }
+    }
+
+    static Converter select(Format src_format, Format dst_format, const Options& options = {}) {
+        Converter converter{nullptr, 1, select_load_(src_format), select_store_(dst_format), pixel_size(src_format), pixel_size(dst_format), false, options.premultiply_alpha};
+        // 8 and 16 bits values are moved as is unless they meet floats or alpha
+        converter.is_linearized = options.is_srgb && (options.premultiply_alpha || is_float(src_format) || is_float(dst_format));
+
+        auto src_sample = sample_of_(src_format);
+        auto dst_sample = sample_of_(dst_format);
+        auto channel_count = component_count(src_format);
+        bool is_same_layout = channel_count == component_count(dst_format) && src_format != Format::BGRA8 && dst_format != Format::BGRA8;
+        auto set_kernel = [&](Kernel kernel, uint32_t scale) {
+            converter.kernel = kernel;
+            converter.kernel_scale = scale;
+        };
+
+        if(options.premultiply_alpha) {
+            if(!options.is_srgb && src_format == dst_format && (src_format == Format::RGBA8 || src_format == Format::BGRA8)) {
+                set_kernel(premultiply_rgba8_scalar, 1);
+#if defined(IMAGE_SIMD_X86)
+                if(simd::features().sse2) {
+                    set_kernel(premultiply_rgba8_sse2, 1);
+                }
+#endif
+            }
+            return converter;
+        }
+
+        if(src_format == dst_format) {
+            set_kernel(copy_bytes, pixel_size(src_format));
+        }
+        else if(src_format == Format::RGB8 && dst_format == Format::RGBA8) {
+            set_kernel(rgb8_to_rgba8_scalar, 1);
+        }
+        else if(src_format == Format::RGBA8 && dst_format == Format::RGB8) {
+            set_kernel(rgba8_to_rgb8_scalar, 1);
+        }
+        else if((src_format == Format::BGRA8 && dst_format == Format::RGBA8) || (src_format == Format::RGBA8 && dst_format == Format::BGRA8)) {
+            set_kernel(swap_rb8_scalar, 1);
+        }
+        else if(is_same_layout && src_sample == Sample_::UNORM16 && dst_sample == Sample_::UNORM8) {
+            set_kernel(unorm16_to_unorm8_scalar, channel_count);
+        }
+        else if(is_same_layout && src_sample == Sample_::UNORM8 && dst_sample == Sample_::UNORM16) {
+            set_kernel(unorm8_to_unorm16_scalar, channel_count);
+        }
+        else if(is_same_layout && src_sample == Sample_::UNORM8 && dst_sample == Sample_::FLOAT32 && !options.is_srgb) {
+            set_kernel(unorm8_to_float_scalar, channel_count);
+        }
+        else if(is_same_layout && src_sample == Sample_::FLOAT32 && dst_sample == Sample_::UNORM8 && !options.is_srgb) {
+            set_kernel(float_to_unorm8_scalar, channel_count);
+        }
+        else if(is_same_layout && src_sample == Sample_::UNORM16 && dst_sample == Sample_::FLOAT32 && !options.is_srgb) {
+            set_kernel(unorm16_to_float_scalar, channel_count);
+        }
+        else if(is_same_layout && src_sample == Sample_::FLOAT32 && dst_sample == Sample_::UNORM16 && !options.is_srgb) {
+            set_kernel(float_to_unorm16_scalar, channel_count);
+        }
+        else if(is_same_layout && src_sample == Sample_::FLOAT32 && dst_sample == Sample_::FLOAT16) {
+            set_kernel(floats_to_halves_scalar, channel_count);
+        }
+        else if(is_same_layout && src_sample == Sample_::FLOAT16 && dst_sample == Sample_::FLOAT32) {
+            set_kernel(halves_to_floats_scalar, channel_count);
+        }
+
+#if defined(IMAGE_SIMD_X86)
+        const auto& features = simd::features();
+        auto upgrade = [&](Kernel scalar, Kernel simd, bool is_supported) {
+            if(converter.kernel == scalar && is_supported) {
+                converter.kernel = simd;
+            }
+        };
+        upgrade(rgb8_to_rgba8_scalar, rgb8_to_rgba8_ssse3, features.ssse3);
+        upgrade(rgba8_to_rgb8_scalar, rgba8_to_rgb8_ssse3, features.ssse3);
+        upgrade(swap_rb8_scalar, swap_rb8_sse2, features.sse2);
+        upgrade(swap_rb8_sse2, swap_rb8_avx2, features.avx2);
+        upgrade(unorm16_to_unorm8_scalar, unorm16_to_unorm8_sse2, features.sse2);
+        upgrade(unorm8_to_unorm16_scalar, unorm8_to_unorm16_sse2, features.sse2);
+        upgrade(unorm8_to_float_scalar, unorm8_to_float_sse2, features.sse2);
+        upgrade(float_to_unorm8_scalar, float_to_unorm8_sse2, features.sse2);
+        upgrade(unorm16_to_float_scalar, unorm16_to_float_sse2, features.sse2);
+        upgrade(float_to_unorm16_scalar, float_to_unorm16_sse2, features.sse2);
+        upgrade(floats_to_halves_scalar, floats_to_halves_f16c, features.f16c);
+        upgrade(halves_to_floats_scalar, halves_to_floats_f16c, features.f16c);
+#endif
+        return converter;
+    }
+};
+
+}
+
+}
\ No newline at end of file
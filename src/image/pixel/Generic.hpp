@@ -0,0 +1,194 @@
+#pragma once
+
+#include "Half.hpp"
+#include "Kernels.hpp"
+#include "../mip/Color.hpp"
+
+namespace image {
+
+namespace pixel {
+
+// any uncompressed format -> RGBA floats -> any uncompressed format
+// missing channels follow decoders: 1 channel is gray (R = G = B), 2 channels are gray and alpha, alpha defaults to 1
+// storing keeps R (gray), R and A, RGB or RGBA
+
+// loads count pixels as RGBA, is_srgb decodes color channels of 8 and 16 bits formats to linear (float formats are linear)
+using LoadPixels = void(*)(const uint8_t* src, float* rgba, size_t count, bool is_srgb);
+// stores count RGBA pixels, is_srgb encodes color channels of 8 and 16 bits formats
+using StorePixels = void(*)(const float* rgba, uint8_t* dst, size_t count, bool is_srgb);
+
+enum class Sample_ {
+    UNORM8,
+    UNORM16,
+    FLOAT32,
+    FLOAT16,
+};
+
+constexpr Sample_ sample_of_(Format format) noexcept {
+    if(is_float(format)) {
+        return format >= Format::R16F ? Sample_::FLOAT16 : Sample_::FLOAT32;
+    }
+    return pixel_size(format) == component_count(format) ? Sample_::UNORM8 : Sample_::UNORM16;
+}
+
+// channel c of CHANNEL_COUNT channels holds color (not alpha)
+constexpr bool is_color_channel_(uint32_t channel_count, uint32_t c) noexcept {
+    return channel_count == 2 ? c == 0 : c < 3;
+}
+
+template<Format FORMAT>
+inline void load_pixels_(const uint8_t* src, float* rgba, size_t count, bool is_srgb) noexcept {
+    constexpr auto SAMPLE = sample_of_(FORMAT);
+    constexpr auto CHANNEL_COUNT = component_count(FORMAT);
+    constexpr auto PIXEL_SIZE = pixel_size(FORMAT);
+    const auto& srgb_table = mip::srgb_to_linear_table_();
+
+    for(size_t i = 0; i < count; ++i) {
+        const auto* pixel = src + i * PIXEL_SIZE;
+        float values[4]{};
+        for(uint32_t c = 0; c < CHANNEL_COUNT; ++c) {
+            bool is_encoded = is_srgb && is_color_channel_(CHANNEL_COUNT, c);
+            if constexpr(SAMPLE == Sample_::UNORM8) {
+                values[c] = is_encoded ? srgb_table[pixel[c]] : pixel[c] * (1.0f / 255.0f);
+            }
+            else if constexpr(SAMPLE == Sample_::UNORM16) {
+                uint16_t value{};
+                std::memcpy(&value, pixel + c * 2, 2);
+                values[c] = value * (1.0f / 65535.0f);
+                if(is_encoded) {
+                    values[c] = mip::srgb_to_linear_exact_(values[c]);
+                }
+            }
+            else if constexpr(SAMPLE == Sample_::FLOAT32) {
+                std::memcpy(&values[c], pixel + c * 4, 4);
+            }
+            else {
+                uint16_t value{};
+                std::memcpy(&value, pixel + c * 2, 2);
+                values[c] = half_to_float(value);
+            }
+        }
+        if constexpr(FORMAT == Format::BGRA8) {
+            std::swap(values[0], values[2]);
+        }
+
+        auto* out = rgba + i * 4;
+        if constexpr(CHANNEL_COUNT == 1) {
+            out[0] = out[1] = out[2] = values[0];
+            out[3] = 1.0f;
+        }
+        else if constexpr(CHANNEL_COUNT == 2) {
+            out[0] = out[1] = out[2] = values[0];
+            out[3] = values[1];
+        }
+        else if constexpr(CHANNEL_COUNT == 3) {
+            out[0] = values[0];
+            out[1] = values[1];
+            out[2] = values[2];
+            out[3] = 1.0f;
+        }
+        else {
+            std::memcpy(out, values, sizeof(values));
+        }
+    }
+}
+
+template<Format FORMAT>
+inline void store_pixels_(const float* rgba, uint8_t* dst, size_t count, bool is_srgb) noexcept {
+    constexpr auto SAMPLE = sample_of_(FORMAT);
+    constexpr auto CHANNEL_COUNT = component_count(FORMAT);
+    constexpr auto PIXEL_SIZE = pixel_size(FORMAT);
+
+    for(size_t i = 0; i < count; ++i) {
+        const auto* in = rgba + i * 4;
+        float values[4]{in[0], in[1], in[2], in[3]};
+        if constexpr(CHANNEL_COUNT == 2) {
+            values[1] = in[3];
+        }
+        if constexpr(FORMAT == Format::BGRA8) {
+            std::swap(values[0], values[2]);
+        }
+
+        auto* pixel = dst + i * PIXEL_SIZE;
+        for(uint32_t c = 0; c < CHANNEL_COUNT; ++c) {
+            bool is_encoded = is_srgb && is_color_channel_(CHANNEL_COUNT, c);
+            if constexpr(SAMPLE == Sample_::UNORM8) {
+                pixel[c] = is_encoded ? mip::linear_to_srgb8_(values[c]) : float_to_unorm8_(values[c]);
+            }
+            else if constexpr(SAMPLE == Sample_::UNORM16) {
+                auto value = values[c];
+                if(is_encoded && value > 0.0f) {
+                    value = mip::linear_to_srgb_exact_(std::min(value, 1.0f));
+                }
+                auto quantized = static_cast<uint16_t>(value > 0.0f ? std::min(value, 1.0f) * 65535.0f + 0.5f : 0.0f);
+                std::memcpy(pixel + c * 2, &quantized, 2);
+            }
+            else if constexpr(SAMPLE == Sample_::FLOAT32) {
+                std::memcpy(pixel + c * 4, &values[c], 4);
+            }
+            else {
+                auto half = float_to_half(values[c]);
+                std::memcpy(pixel + c * 2, &half, 2);
+            }
+        }
+    }
+}
+
+inline void premultiply_(float* rgba, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        auto* pixel = rgba + i * 4;
+        pixel[0] *= pixel[3];
+        pixel[1] *= pixel[3];
+        pixel[2] *= pixel[3];
+    }
+}
+
+inline LoadPixels select_load_(Format format) {
+    switch(format) {
+        case Format::R8: return load_pixels_<Format::R8>;
+        case Format::RG8: return load_pixels_<Format::RG8>;
+        case Format::RGB8: return load_pixels_<Format::RGB8>;
+        case Format::RGBA8: return load_pixels_<Format::RGBA8>;
+        case Format::BGRA8: return load_pixels_<Format::BGRA8>;
+        case Format::R16: return load_pixels_<Format::R16>;
+        case Format::RG16: return load_pixels_<Format::RG16>;
+        case Format::RGB16: return load_pixels_<Format::RGB16>;
+        case Format::RGBA16: return load_pixels_<Format::RGBA16>;
+        case Format::R32F: return load_pixels_<Format::R32F>;
+        case Format::RG32F: return load_pixels_<Format::RG32F>;
+        case Format::RGB32F: return load_pixels_<Format::RGB32F>;
+        case Format::RGBA32F: return load_pixels_<Format::RGBA32F>;
+        case Format::R16F: return load_pixels_<Format::R16F>;
+        case Format::RG16F: return load_pixels_<Format::RG16F>;
+        case Format::RGBA16F: return load_pixels_<Format::RGBA16F>;
+        default:
+            throw std::runtime_error(std::format("[image::pixel] ERROR: unsupported source format: {}", static_cast<uint32_t>(format)));
+    }
+}
+
+inline StorePixels select_store_(Format format) {
+    switch(format) {
+        case Format::R8: return store_pixels_<Format::R8>;
+        case Format::RG8: return store_pixels_<Format::RG8>;
+        case Format::RGB8: return store_pixels_<Format::RGB8>;
+        case Format::RGBA8: return store_pixels_<Format::RGBA8>;
+        case Format::BGRA8: return store_pixels_<Format::BGRA8>;
+        case Format::R16: return store_pixels_<Format::R16>;
+        case Format::RG16: return store_pixels_<Format::RG16>;
+        case Format::RGB16: return store_pixels_<Format::RGB16>;
+        case Format::RGBA16: return store_pixels_<Format::RGBA16>;
+        case Format::R32F: return store_pixels_<Format::R32F>;
+        case Format::RG32F: return store_pixels_<Format::RG32F>;
+        case Format::RGB32F: return store_pixels_<Format::RGB32F>;
+        case Format::RGBA32F: return store_pixels_<Format::RGBA32F>;
+        case Format::R16F: return store_pixels_<Format::R16F>;
+        case Format::RG16F: return store_pixels_<Format::RG16F>;
+        case Format::RGBA16F: return store_pixels_<Format::RGBA16F>;
+        default:
+            throw std::runtime_error(std::format("[image::pixel] ERROR: unsupported destination format: {}", static_cast<uint32_t>(format)));
+    }
+}
+
+}
+
+}
\ No newline at end of file
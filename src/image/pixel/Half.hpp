@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstring>
+
+#include "../common.hpp"
+#include "../simd.hpp"
+
+namespace image {
+
+namespace pixel {
+
+// IEEE half <-> float (round to nearest even, overflow to infinity, NaN is quieted and keeps high payload bits as F16C does)
+
+inline uint16_t float_to_half(float value) noexcept {
+    uint32_t bits{};
+    std::memcpy(&bits, &value, 4);
+    auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    bits &= 0x7fffffff;
+
+    // 2^16 and above: infinity or NaN (values rounding up to 2^16 overflow to infinity below)
+    if(bits >= 0x47800000) {
+        return sign | (bits > 0x7f800000 ? 0x7e00 | ((bits >> 13) & 0x3ff) : 0x7c00);
+    }
+    // below 2^-14: subnormal half, float addition of 0.5 rounds mantissa to 2^-24 steps
+    if(bits < 0x38800000) {
+        float shifted{};
+        std::memcpy(&shifted, &bits, 4);
+        shifted += 0.5f;
+        std::memcpy(&bits, &shifted, 4);
+        return sign | static_cast<uint16_t>(bits - 0x3f000000);
+    }
+    // rebias exponent and round (ties to even by lowest kept bit), carry may round up to infinity
+    auto is_odd = (bits >> 13) & 1;
+    bits += 0xc8000fff + is_odd;
+    return sign | static_cast<uint16_t>(bits >> 13);
+}
+
+inline float half_to_float(uint16_t value) noexcept {
+    auto sign = uint32_t(value & 0x8000) << 16;
+    auto exponent = (value >> 10) & 0x1f;
+    auto mantissa = uint32_t(value & 0x3ff);
+
+    uint32_t bits{};
+    if(exponent == 0x1f) {
+        // infinity, or NaN with quiet bit set
+        bits = sign | 0x7f800000 | (mantissa << 13) | (mantissa != 0 ? 0x00400000 : 0);
+    }
+    else if(exponent == 0) {
+        // zero or subnormal (exact in float)
+        auto magnitude = static_cast<float>(mantissa) * (1.0f / (1 << 24));
+        std::memcpy(&bits, &magnitude, 4);
+        bits |= sign;
+    }
+    else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float result{};
+    std::memcpy(&result, &bits, 4);
+    return result;
+}
+
+// count elements
+
+inline void floats_to_halves_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        float value{};
+        std::memcpy(&value, src + i * 4, 4);
+        auto half = float_to_half(value);
+        std::memcpy(dst + i * 2, &half, 2);
+    }
+}
+
+inline void halves_to_floats_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        uint16_t half{};
+        std::memcpy(&half, src + i * 2, 2);
+        auto value = half_to_float(half);
+        std::memcpy(dst + i * 4, &value, 4);
+    }
+}
+
+#if defined(IMAGE_SIMD_X86)
+IMAGE_TARGET("avx,f16c") inline void floats_to_halves_f16c(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        auto halves = _mm256_cvtps_ph(_mm256_loadu_ps(reinterpret_cast<const float*>(src + i * 4)), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), halves);
+    }
+    floats_to_halves_scalar(src + i * 4, dst + i * 2, count - i);
+}
+
+IMAGE_TARGET("avx,f16c") inline void halves_to_floats_f16c(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        auto floats = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2)));
+        _mm256_storeu_ps(reinterpret_cast<float*>(dst + i * 4), floats);
+    }
+    halves_to_floats_scalar(src + i * 2, dst + i * 4, count - i);
+}
+#endif
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <cstring>
+
+#include "../common.hpp"
+#include "../simd.hpp"
+
+namespace image {
+
+namespace pixel {
+
+// fast paths between formats of same sample layout
+// count is pixels for kernels which move channels and elements (channels of all pixels) for per-sample kernels
+using Kernel = void(*)(const uint8_t* src, uint8_t* dst, size_t count);
+
+inline void copy_bytes(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    std::memcpy(dst, src, count);
+}
+
+// RGB8 -> RGBA8 (alpha 255)
+inline void rgb8_to_rgba8_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        dst[i * 4 + 0] = src[i * 3 + 0];
+        dst[i * 4 + 1] = src[i * 3 + 1];
+        dst[i * 4 + 2] = src[i * 3 + 2];
+        dst[i * 4 + 3] = 255;
+    }
+}
+
+// RGBA8 -> RGB8 (alpha is dropped)
+inline void rgba8_to_rgb8_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        dst[i * 3 + 0] = src[i * 4 + 0];
+        dst[i * 3 + 1] = src[i * 4 + 1];
+        dst[i * 3 + 2] = src[i * 4 + 2];
+    }
+}
+
+// BGRA8 <-> RGBA8
+inline void swap_rb8_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        auto b = src[i * 4 + 0];
+        dst[i * 4 + 0] = src[i * 4 + 2];
+        dst[i * 4 + 1] = src[i * 4 + 1];
+        dst[i * 4 + 2] = b;
+        dst[i * 4 + 3] = src[i * 4 + 3];
+    }
+}
+
+// 16 bits -> 8 bits (rounded, per sample)
+inline void unorm16_to_unorm8_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        uint16_t value{};
+        std::memcpy(&value, src + i * 2, 2);
+        dst[i] = static_cast<uint8_t>((value * 255u + 32767u) / 65535u);
+    }
+}
+
+// 8 bits -> 16 bits (x * 257, per sample)
+inline void unorm8_to_unorm16_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        auto value = static_cast<uint16_t>(src[i] * 257u);
+        std::memcpy(dst + i * 2, &value, 2);
+    }
+}
+
+// 8 bits -> float [0, 1] (per sample, no transfer function)
+inline void unorm8_to_float_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        auto value = src[i] * (1.0f / 255.0f);
+        std::memcpy(dst + i * 4, &value, 4);
+    }
+}
+
+// float -> 8 bits (clamped to [0, 1] and rounded, NaN is 0, per sample, no transfer function)
+inline uint8_t float_to_unorm8_(float value) noexcept {
+    if(!(value > 0.0f)) {
+        return 0;
+    }
+    return value >= 1.0f ? 255 : static_cast<uint8_t>(value * 255.0f + 0.5f);
+}
+
+inline void float_to_unorm8_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        float value{};
+        std::memcpy(&value, src + i * 4, 4);
+        dst[i] = float_to_unorm8_(value);
+    }
+}
+
+// 16 bits -> float [0, 1] (per sample, no transfer function)
+inline void unorm16_to_float_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        uint16_t value{};
+        std::memcpy(&value, src + i * 2, 2);
+        auto result = value * (1.0f / 65535.0f);
+        std::memcpy(dst + i * 4, &result, 4);
+    }
+}
+
+// float -> 16 bits (clamped to [0, 1] and rounded, NaN is 0, per sample, no transfer function)
+inline void float_to_unorm16_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        float value{};
+        std::memcpy(&value, src + i * 4, 4);
+        auto result = static_cast<uint16_t>(value > 0.0f ? std::min(value, 1.0f) * 65535.0f + 0.5f : 0.0f);
+        std::memcpy(dst + i * 2, &result, 2);
+    }
+}
+
+// color channels of RGBA8 or BGRA8 multiplied by alpha (rounded)
+inline uint8_t multiply_unorm8_(uint32_t a, uint32_t b) noexcept {
+    auto t = a * b + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+inline void premultiply_rgba8_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for(size_t i = 0; i < count; ++i) {
+        auto alpha = src[i * 4 + 3];
+        dst[i * 4 + 0] = multiply_unorm8_(src[i * 4 + 0], alpha);
+        dst[i * 4 + 1] = multiply_unorm8_(src[i * 4 + 1], alpha);
+        dst[i * 4 + 2] = multiply_unorm8_(src[i * 4 + 2], alpha);
+        dst[i * 4 + 3] = alpha;
+    }
+}
+
+#if defined(IMAGE_SIMD_X86)
+// 16 pixels (48 bytes) per iteration, pshufb spreads 4 pixels of each 12 bytes to 16 bytes
+IMAGE_TARGET("ssse3") inline void rgb8_to_rgba8_ssse3(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const auto spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const auto alpha = _mm_set1_epi32(static_cast<int32_t>(0xff000000));
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + 16));
+        auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + 32));
+        auto p0 = _mm_shuffle_epi8(a, spread);
+        auto p1 = _mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), spread);
+        auto p2 = _mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), spread);
+        auto p3 = _mm_shuffle_epi8(_mm_srli_si128(c, 4), spread);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(p0, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 16), _mm_or_si128(p1, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 32), _mm_or_si128(p2, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 48), _mm_or_si128(p3, alpha));
+    }
+    rgb8_to_rgba8_scalar(src + i * 3, dst + i * 4, count - i);
+}
+
+// 16 pixels per iteration, pshufb packs each 4 pixels to low 12 bytes which are merged by byte shifts
+IMAGE_TARGET("ssse3") inline void rgba8_to_rgb8_ssse3(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const auto pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        auto p0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4)), pack);
+        auto p1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4 + 16)), pack);
+        auto p2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4 + 32)), pack);
+        auto p3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4 + 48)), pack);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3), _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3 + 16), _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3 + 32), _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+    }
+    rgba8_to_rgb8_scalar(src + i * 4, dst + i * 3, count - i);
+}
+
+// R and B bytes of each 32 bits pixel swapped by shifts (G and A are masked through)
+IMAGE_TARGET("sse2") inline void swap_rb8_sse2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const auto ga_mask = _mm_set1_epi32(static_cast<int32_t>(0xff00ff00));
+    const auto rb_mask = _mm_set1_epi32(0x00ff00ff);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        auto rb = _mm_and_si128(pixels, rb_mask);
+        rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_and_si128(pixels, ga_mask), rb));
+    }
+    swap_rb8_scalar(src + i * 4, dst + i * 4, count - i);
+}
+
+IMAGE_TARGET("avx2") inline void swap_rb8_avx2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const auto swap = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        auto pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(pixels, swap));
+    }
+    swap_rb8_sse2(src + i * 4, dst + i * 4, count - i);
+}
+
+// round(x / 257) = (t - (t >> 8)) >> 8 with t = x + 128 (saturated, exact for all 16 bits values)
+IMAGE_TARGET("sse2") inline __m128i narrow_unorm16_sse2_(const uint8_t* src) noexcept {
+    auto t = _mm_adds_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_sub_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+IMAGE_TARGET("sse2") inline void unorm16_to_unorm8_sse2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        auto low = narrow_unorm16_sse2_(src + i * 2);
+        auto high = narrow_unorm16_sse2_(src + i * 2 + 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+    }
+    unorm16_to_unorm8_scalar(src + i * 2, dst + i, count - i);
+}
+
+IMAGE_TARGET("sse2") inline void unorm8_to_unorm16_sse2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_unpacklo_epi8(bytes, bytes));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2 + 16), _mm_unpackhi_epi8(bytes, bytes));
+    }
+    unorm8_to_unorm16_scalar(src + i, dst + i * 2, count - i);
+}
+
+IMAGE_TARGET("sse2") inline void unorm8_to_float_sse2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const auto zero = _mm_setzero_si128();
+    const auto scale = _mm_set1_ps(1.0f / 255.0f);
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        auto low = _mm_unpacklo_epi8(bytes, zero);
+        auto high = _mm_unpackhi_epi8(bytes, zero);
+        const __m128i words[4] = {
+            _mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero), _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero),
+        };
+        for(uint32_t k = 0; k < 4; ++k) {
+            _mm_storeu_ps(reinterpret_cast<float*>(dst + (i + k * 4) * 4), _mm_mul_ps(_mm_cvtepi32_ps(words[k]), scale));
+        }
+    }
+    unorm8_to_float_scalar(src + i, dst + i * 4, count - i);
+}
+
+// max(x, 0) returns 0 for NaN (second operand), so result matches float_to_unorm8_()
+IMAGE_TARGET("sse2") inline __m128i quantize_unorm8_sse2_(const uint8_t* src) noexcept {
+    auto value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(reinterpret_cast<const float*>(src)), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+IMAGE_TARGET("sse2") inline void float_to_unorm8_sse2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        auto low = _mm_packs_epi32(quantize_unorm8_sse2_(src + i * 4), quantize_unorm8_sse2_(src + i * 4 + 16));
+        auto high = _mm_packs_epi32(quantize_unorm8_sse2_(src + i * 4 + 32), quantize_unorm8_sse2_(src + i * 4 + 48));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+    }
+    float_to_unorm8_scalar(src + i * 4, dst + i, count - i);
+}
+
+IMAGE_TARGET("sse2") inline void unorm16_to_float_sse2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const auto zero = _mm_setzero_si128();
+    const auto scale = _mm_set1_ps(1.0f / 65535.0f);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        auto words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        _mm_storeu_ps(reinterpret_cast<float*>(dst + i * 4), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), scale));
+        _mm_storeu_ps(reinterpret_cast<float*>(dst + i * 4 + 16), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)), scale));
+    }
+    unorm16_to_float_scalar(src + i * 2, dst + i * 4, count - i);
+}
+
+// SSE2 has signed saturating pack only, so values are biased by -32768 before packing and flipped back after it
+IMAGE_TARGET("sse2") inline __m128i quantize_unorm16_sse2_(const uint8_t* src) noexcept {
+    auto value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(reinterpret_cast<const float*>(src)), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    auto quantized = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(65535.0f)), _mm_set1_ps(0.5f)));
+    return _mm_sub_epi32(quantized, _mm_set1_epi32(32768));
+}
+
+IMAGE_TARGET("sse2") inline void float_to_unorm16_sse2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const auto flip = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        auto words = _mm_packs_epi32(quantize_unorm16_sse2_(src + i * 4), quantize_unorm16_sse2_(src + i * 4 + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_xor_si128(words, flip));
+    }
+    float_to_unorm16_scalar(src + i * 4, dst + i * 2, count - i);
+}
+
+// 2 pixels in 16 bits lanes, alpha is broadcast by word shuffles
+IMAGE_TARGET("sse2") inline __m128i premultiply_words_sse2_(__m128i pixels) noexcept {
+    auto alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0xff), 0xff);
+    auto t = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// alpha itself is restored after multiplication
+IMAGE_TARGET("sse2") inline void premultiply_rgba8_sse2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const auto zero = _mm_setzero_si128();
+    const auto alpha_mask = _mm_set1_epi32(static_cast<int32_t>(0xff000000));
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        auto low = premultiply_words_sse2_(_mm_unpacklo_epi8(pixels, zero));
+        auto high = premultiply_words_sse2_(_mm_unpackhi_epi8(pixels, zero));
+        auto result = _mm_or_si128(_mm_andnot_si128(alpha_mask, _mm_packus_epi16(low, high)), _mm_and_si128(pixels, alpha_mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), result);
+    }
+    premultiply_rgba8_scalar(src + i * 4, dst + i * 4, count - i);
+}
+#endif
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstring>
+
+#include "utils.hpp"
+#include "IDAT.hpp"
+
+namespace image {
+
+namespace png {
+
+// LSB-first bit reader for deflate stream
+// keeps up to 64 bits in accumulator and refills 8 bytes at once
+// input is a sequence of segments (IDAT payloads), next one is pulled from stream when current one runs out
+struct BitReader {
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    uint64_t buffer;
+    uint32_t bit_count;
+    // zero bytes fed after end of stream
+    uint32_t padding_count;
+    // source of following segments (nullptr if data is whole stream)
+    IdatStream* stream;
+
+    BitReader(const uint8_t* d, size_t s) noexcept : data(d), size(s), position(0), buffer(0), bit_count(0), padding_count(0), stream(nullptr) {}
+
+    explicit BitReader(IdatStream& s) noexcept : data(nullptr), size(0), position(0), buffer(0), bit_count(0), padding_count(0), stream(&s) {}
+
+    bool next_segment_() {
+        if(stream && stream->next(data, size)) {
+            position = 0;
+            return true;
+        }
+        // no more segments
+        stream = nullptr;
+        return false;
+    }
+
+    // after refill, accumulator has at least 56 bits
+    // (bytes after the end of stream are read as 0, check overrun() to detect truncation)
+    void refill() {
+        if(std::endian::native == std::endian::little && position + 8 <= size) {
+            uint64_t word{};
+            std::memcpy(&word, data + position, sizeof(uint64_t));
+            buffer |= word << bit_count;
+            position += (63 - bit_count) >> 3;
+            bit_count |= 56;
+        }
+        else {
+            // near end of segment
+            while(bit_count <= 56) {
+                uint64_t byte{};
+                if(position < size || next_segment_()) {
+                    byte = data[position++];
+                }
+                else {
+                    ++padding_count;
+                }
+                buffer |= byte << bit_count;
+                bit_count += 8;
+            }
+        }
+    }
+
+    uint32_t peek(uint32_t count) const noexcept {
+        return static_cast<uint32_t>(buffer & ((uint64_t(1) << count) - 1));
+    }
+
+    void consume(uint32_t count) noexcept {
+        buffer >>= count;
+        bit_count -= count;
+    }
+
+    // count <= 32
+    uint32_t read_bits(uint32_t count) {
+        if(bit_count < count) {
+            refill();
+        }
+        auto value = peek(count);
+        consume(count);
+        return value;
+    }
+
+    void align_to_byte() noexcept {
+        consume(bit_count & 7);
+    }
+
+    // copy raw bytes (must be aligned to byte)
+    void read_bytes(uint8_t* dst, size_t count) {
+        while(bit_count >= 8 && count > 0) {
+            *dst++ = static_cast<uint8_t>(buffer & 0xff);
+            consume(8);
+            --count;
+        }
+        if(count == 0) {
+            return;
+        }
+        if(padding_count > 0) {
+            throw std::runtime_error("[image::png::BitReader::read_bytes] ERROR: unexpected end of deflate stream.");
+        }
+        // accumulator is empty, drop bytes preloaded by refill() (they are copied below)
+        buffer = 0;
+
+        while(count > 0) {
+            if(position >= size && !next_segment_()) {
+                throw std::runtime_error("[image::png::BitReader::read_bytes] ERROR: unexpected end of deflate stream.");
+            }
+            auto copy_count = std::min(count, size - position);
+            std::memcpy(dst, data + position, copy_count);
+            dst += copy_count;
+            position += copy_count;
+            count -= copy_count;
+        }
+    }
+
+    // true if more bits than stream has are consumed
+    // (padding bytes are on top of accumulator, so they are consumed only after all real bits)
+    bool overrun() const noexcept {
+        return size_t(padding_count) * 8 > bit_count;
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstring>
+
+#include "utils.hpp"
+
+namespace image {
+
+namespace png {
+
+// LSB-first bit writer for deflate stream (counterpart of BitReader)
+// bits are collected in 64 bits accumulator and flushed 4 bytes at once
+struct BitWriter {
+    std::vector<uint8_t> bytes;
+    uint64_t buffer;
+    uint32_t bit_count;
+
+    BitWriter() noexcept : buffer(0), bit_count(0) {}
+
+    // count <= 32
+    void write_bits(uint32_t value, uint32_t count) {
+        buffer |= uint64_t(value) << bit_count;
+        bit_count += count;
+        if(bit_count >= 32) {
+            auto size = bytes.size();
+            bytes.resize(size + 4);
+            auto word = static_cast<uint32_t>(buffer);
+            if constexpr(std::endian::native == std::endian::big) {
+                word = io::byteswap(word);
+            }
+            std::memcpy(bytes.data() + size, &word, 4);
+            buffer >>= 32;
+            bit_count -= 32;
+        }
+    }
+
+    // pad with zero bits to byte boundary and move all bits to bytes
+    void align_to_byte() {
+        while(bit_count > 0) {
+            bytes.push_back(static_cast<uint8_t>(buffer & 0xff));
+            buffer >>= 8;
+            bit_count = bit_count > 8 ? bit_count - 8 : 0;
+        }
+        buffer = 0;
+    }
+
+    // raw bytes (must be aligned to byte)
+    void write_bytes(const uint8_t* src, size_t count) {
+        bytes.insert(bytes.end(), src, src + count);
+    }
+};
+
+}
+
+}
\ No newline at end of file
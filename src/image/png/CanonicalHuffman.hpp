@@ -1,45 +1,198 @@
 #pragma once
 
+#include <span>
+
 #include "utils.hpp"
-#include "Deflate.hpp"
+#include "BitReader.hpp"
 
 namespace image {
 
 namespace png {
 
 struct CanonicalHuffman {
-    std::vector<std::pair<uint16_t, uint16_t>> code_lengths;
-    std::vector<uint8_t> code_counts;
-
-    uint16_t read_code(const Deflate& bit_stream, size_t& index) {
-        uint16_t code{};
-        uint16_t first_code{};
-        uint16_t first_index{};
-        
-        for(size_t i = 0; i < code_counts.size(); ++i) {
-            code |= bit_stream.read_bits(1, index);
-            if(code - first_code < code_counts[i]) {
-                return code_lengths[code - first_code + first_index].first;
+    // bit width of first level lookup table
+    // codes longer than this are resolved by overflow subtable
+    static constexpr uint32_t ROOT_BITS = 10;
+    static constexpr uint32_t MAX_CODE_LENGTH = 15;
+
+    // table entry: [31:16] symbol (or subtable offset), [15] subtable flag, [7:0] code length (or subtable bits)
+    static constexpr uint32_t SUBTABLE_FLAG = 0x8000;
+    static constexpr uint32_t LENGTH_MASK = 0x00ff;
+
+    static uint32_t reverse_bits_(uint32_t code, uint32_t length) noexcept {
+        uint32_t reversed = 0;
+        for(uint32_t i = 0; i < length; ++i) {
+            reversed = (reversed << 1) | (code & 1);
+            code >>= 1;
+        }
+        return reversed;
+    }
+
+    // hot loops can pass table pointer kept in register
+    static uint16_t decode(BitReader& reader, const uint32_t* table, uint32_t root_bits) {
+        if(reader.bit_count < MAX_CODE_LENGTH) {
+            reader.refill();
+        }
+
+        auto entry = table[reader.peek(root_bits)];
+        if(entry & SUBTABLE_FLAG) {
+            reader.consume(root_bits);
+            entry = table[(entry >> 16) + reader.peek(entry & LENGTH_MASK)];
+        }
+
+        auto length = entry & LENGTH_MASK;
+        if(length == 0) {
+            throw std::runtime_error("[image::png::CanonicalHuffman::decode] ERROR: invalid huffman code.");
+        }
+        reader.consume(length);
+
+        return static_cast<uint16_t>(entry >> 16);
+    }
+};
+
+// lookup table of canonical huffman code with up to MAX_SYMBOLS symbols
+// storage is fixed size, so dynamic blocks rebuild it in place without allocation
+template<uint32_t MAX_SYMBOLS>
+struct CanonicalHuffmanTable : CanonicalHuffman {
+    // upper bound of root table + subtables (same idea as zlib's ENOUGH)
+    // canonical codes have no gap, so every subtable but the last is complete,
+    // and complete subtable of b bits needs at least b + 1 codes (32 entries per 6 codes at most)
+    static constexpr uint32_t MAX_SUBTABLE_BITS = MAX_CODE_LENGTH - ROOT_BITS;
+    static constexpr uint32_t MAX_TABLE_SIZE = (uint32_t(1) << ROOT_BITS) + (uint32_t(1) << MAX_SUBTABLE_BITS)
+        + (uint32_t(1) << MAX_SUBTABLE_BITS) * (MAX_SYMBOLS - 1) / (MAX_SUBTABLE_BITS + 1);
+
+    // (symbol, length) of used symbols, sorted by length, then symbol
+    std::array<std::pair<uint16_t, uint16_t>, MAX_SYMBOLS> code_lengths;
+    uint32_t code_length_count;
+    // index = code length (0 = unused symbols)
+    std::array<uint16_t, MAX_CODE_LENGTH + 1> code_counts;
+    std::array<uint32_t, MAX_TABLE_SIZE> table;
+    uint32_t root_bits;
+
+    // make canonical huffman code from code length of each symbol (0 = unused)
+    void build(std::span<const uint8_t> lengths) {
+        if(lengths.size() > MAX_SYMBOLS) {
+            throw std::runtime_error("[image::png::CanonicalHuffmanTable::build] ERROR: too many symbols.");
+        }
+
+        code_counts.fill(0);
+        for(auto length : lengths) {
+            ++code_counts[length];
+        }
+
+        // counting sort keeps symbol order in the same length
+        std::array<uint32_t, MAX_CODE_LENGTH + 1> offsets;
+        offsets[0] = 0;
+        offsets[1] = 0;
+        for(uint32_t length = 1; length < MAX_CODE_LENGTH; ++length) {
+            offsets[length + 1] = offsets[length] + code_counts[length];
+        }
+        code_length_count = 0;
+        for(size_t i = 0; i < lengths.size(); ++i) {
+            if(lengths[i] != 0) {
+                code_lengths[offsets[lengths[i]]++] = {static_cast<uint16_t>(i), lengths[i]};
+                ++code_length_count;
             }
-            code <<= 1;
-            first_code += code_counts[i];
-            first_code <<= 1;
-            first_index += code_counts[i];
         }
 
-        return code_lengths[code - first_code + first_index].first;
+        build_table();
+    }
+
+    // build lookup table from code_lengths (sorted by length, then symbol)
+    void build_table() {
+        if(code_length_count == 0) {
+            // no code: every lookup hits invalid entry
+            root_bits = 1;
+            table[0] = 0;
+            table[1] = 0;
+            return;
+        }
+
+        root_bits = std::min<uint32_t>(ROOT_BITS, code_lengths[code_length_count - 1].second);
+        auto root_size = uint32_t(1) << root_bits;
+        std::fill_n(table.begin(), root_size, 0);
+
+        auto root_mask = root_size - 1;
+
+        // assign canonical codes (bit reversed, because deflate stores huffman codes from MSB)
+        std::array<uint32_t, MAX_SYMBOLS> codes;
+        uint32_t code = 0;
+        uint32_t prev_length = code_lengths[0].second;
+        for(uint32_t i = 0; i < code_length_count; ++i) {
+            uint32_t length = code_lengths[i].second;
+            code <<= length - prev_length;
+            if(code >= (uint32_t(1) << length)) {
+                throw std::runtime_error("[image::png::CanonicalHuffmanTable::build_table] ERROR: over-subscribed code lengths.");
+            }
+            codes[i] = reverse_bits_(code, length);
+            ++code;
+            prev_length = length;
+        }
+
+        // size of overflow subtables for each root prefix
+        std::array<uint8_t, uint32_t(1) << ROOT_BITS> subtable_bits;
+        std::fill_n(subtable_bits.begin(), root_size, 0);
+        for(uint32_t i = 0; i < code_length_count; ++i) {
+            uint32_t length = code_lengths[i].second;
+            if(length > root_bits) {
+                auto& bits = subtable_bits[codes[i] & root_mask];
+                bits = std::max<uint8_t>(bits, static_cast<uint8_t>(length - root_bits));
+            }
+        }
+
+        auto table_size = root_size;
+        for(uint32_t prefix = 0; prefix < root_size; ++prefix) {
+            if(subtable_bits[prefix] != 0) {
+                auto subtable_size = uint32_t(1) << subtable_bits[prefix];
+                if(table_size + subtable_size > MAX_TABLE_SIZE) {
+                    throw std::runtime_error("[image::png::CanonicalHuffmanTable::build_table] ERROR: huffman table overflow.");
+                }
+                table[prefix] = (table_size << 16) | SUBTABLE_FLAG | subtable_bits[prefix];
+                std::fill_n(table.begin() + table_size, subtable_size, 0);
+                table_size += subtable_size;
+            }
+        }
+
+        // fill every entry whose low bits match the code
+        for(uint32_t i = 0; i < code_length_count; ++i) {
+            uint32_t symbol = code_lengths[i].first;
+            uint32_t length = code_lengths[i].second;
+            if(length <= root_bits) {
+                for(uint32_t j = codes[i]; j < root_size; j += uint32_t(1) << length) {
+                    table[j] = (symbol << 16) | length;
+                }
+            }
+            else {
+                auto link = table[codes[i] & root_mask];
+                auto offset = link >> 16;
+                auto bits = link & LENGTH_MASK;
+                auto sub_length = length - root_bits;
+                for(uint32_t j = codes[i] >> root_bits; j < (uint32_t(1) << bits); j += uint32_t(1) << sub_length) {
+                    table[offset + j] = (symbol << 16) | sub_length;
+                }
+            }
+        }
+    }
+
+    uint16_t decode(BitReader& reader) const {
+        return CanonicalHuffman::decode(reader, table.data(), root_bits);
     }
 
     void print() const noexcept {
-        for(size_t i = 0; i < code_lengths.size(); ++i) {
+        for(uint32_t i = 0; i < code_length_count; ++i) {
             std::cerr << std::format("#{}: value = {}, length = {}", i, code_lengths[i].first, code_lengths[i].second) << std::endl;
         }
-        for(size_t i = 0; i < code_counts.size(); ++i) {
-            std::cerr << std::format("length = {}, count = {}", i + 1, code_counts[i]) << std::endl;
+        for(uint32_t length = 1; length <= MAX_CODE_LENGTH; ++length) {
+            std::cerr << std::format("length = {}, count = {}", length, code_counts[length]) << std::endl;
         }
     }
 };
 
+// deflate alphabets: literal/length (286 + 2 reserved), distance (30 + 2 reserved), code length
+using CharacterHuffman = CanonicalHuffmanTable<288>;
+using DistanceHuffman = CanonicalHuffmanTable<32>;
+using CodeLengthHuffman = CanonicalHuffmanTable<19>;
+
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstring>
+
+#include "utils.hpp"
+#include "../simd.hpp"
+
+namespace image {
+
+namespace png {
+
+// CRC-32 of chunks and Adler-32 of zlib stream
+// crc32(0, ...) and adler32(1, ...) start new checksum, passing previous result continues it (same as zlib)
+
+constexpr uint32_t ADLER_BASE = 65521;
+// max bytes before s2 can overflow 32 bits
+constexpr size_t ADLER_NMAX = 5552;
+
+// slicing-by-8 tables (table[k][b] is CRC of byte b followed by k zero bytes)
+inline const std::array<std::array<uint32_t, 256>, 8>& crc32_tables_() {
+    static const auto tables = []{
+        std::array<std::array<uint32_t, 256>, 8> t{};
+        for(uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for(int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for(uint32_t i = 0; i < 256; ++i) {
+            for(size_t k = 1; k < 8; ++k) {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+            }
+        }
+        return t;
+    }();
+
+    return tables;
+}
+
+// crc is inverted state
+inline uint32_t crc32_scalar_(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+    const auto& t = crc32_tables_();
+    while(size >= 8) {
+        uint32_t lo{}, hi{};
+        std::memcpy(&lo, data, 4);
+        std::memcpy(&hi, data + 4, 4);
+        if constexpr(std::endian::native == std::endian::big) {
+            lo = io::byteswap(lo);
+            hi = io::byteswap(hi);
+        }
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while(size-- > 0) {
+        crc = t[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+inline uint32_t adler32_scalar_(uint32_t adler, const uint8_t* data, size_t size) noexcept {
+    uint32_t s1 = adler & 0xffff;
+    uint32_t s2 = adler >> 16;
+    while(size > 0) {
+        auto count = std::min(size, ADLER_NMAX);
+        size -= count;
+        for(size_t i = 0; i < count; ++i) {
+            s1 += data[i];
+            s2 += s1;
+        }
+        data += count;
+        s1 %= ADLER_BASE;
+        s2 %= ADLER_BASE;
+    }
+
+    return s1 | (s2 << 16);
+}
+
+#if defined(IMAGE_SIMD_X86)
+
+// x * k (both 64 bits halves) + y
+IMAGE_TARGET("pclmul,sse4.1") inline __m128i crc32_fold_(__m128i x, __m128i k, __m128i y) noexcept {
+    auto lo = _mm_clmulepi64_si128(x, k, 0x00);
+    auto hi = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(lo, hi), y);
+}
+
+// carry-less multiplication folding (Intel, "Fast CRC Computation Using PCLMULQDQ Instruction")
+// size >= 64 and multiple of 16, crc is inverted state
+IMAGE_TARGET("pclmul,sse4.1") inline uint32_t crc32_pclmul_(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+    // constants for reflected polynomial 0xedb88320
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    auto x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+    auto x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+    auto x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+    auto x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int32_t>(crc)));
+    data += 64;
+    size -= 64;
+
+    // fold 4 x 128 bits in parallel
+    while(size >= 64) {
+        x1 = crc32_fold_(x1, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+        x2 = crc32_fold_(x2, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+        x3 = crc32_fold_(x3, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+        x4 = crc32_fold_(x4, k1k2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+        data += 64;
+        size -= 64;
+    }
+
+    // fold into 128 bits
+    x1 = crc32_fold_(x1, k3k4, x2);
+    x1 = crc32_fold_(x1, k3k4, x3);
+    x1 = crc32_fold_(x1, k3k4, x4);
+    while(size >= 16) {
+        x1 = crc32_fold_(x1, k3k4, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+        data += 16;
+        size -= 16;
+    }
+
+    // 128 -> 64 bits
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+// 32 bytes per iteration, s2 weights by multiply-add
+IMAGE_TARGET("ssse3") inline uint32_t adler32_ssse3_(uint32_t adler, const uint8_t* data, size_t size) noexcept {
+    constexpr size_t BLOCK_SIZE = 32;
+
+    uint32_t s1 = adler & 0xffff;
+    uint32_t s2 = adler >> 16;
+
+    const auto tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const auto tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const auto zero = _mm_setzero_si128();
+    const auto ones = _mm_set1_epi16(1);
+
+    auto blocks = size / BLOCK_SIZE;
+    size -= blocks * BLOCK_SIZE;
+    while(blocks > 0) {
+        auto count = std::min<size_t>(blocks, ADLER_NMAX / BLOCK_SIZE);
+        blocks -= count;
+
+        // s1 before each block contributes 32 times to s2
+        auto v_ps = _mm_cvtsi32_si128(static_cast<int32_t>(s1 * count));
+        auto v_s2 = _mm_cvtsi32_si128(static_cast<int32_t>(s2));
+        auto v_s1 = _mm_setzero_si128();
+        for(size_t i = 0; i < count; ++i) {
+            auto bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            auto bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+            data += BLOCK_SIZE;
+        }
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        // horizontal sums
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += static_cast<uint32_t>(_mm_cvtsi128_si32(v_s1));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = static_cast<uint32_t>(_mm_cvtsi128_si32(v_s2));
+
+        s1 %= ADLER_BASE;
+        s2 %= ADLER_BASE;
+    }
+
+    return adler32_scalar_(s1 | (s2 << 16), data, size);
+}
+
+#endif
+
+inline uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+    crc = ~crc;
+#if defined(IMAGE_SIMD_X86)
+    const auto& features = simd::features();
+    if(size >= 64 && features.pclmul && features.sse41) {
+        auto count = size & ~size_t(15);
+        crc = crc32_pclmul_(crc, data, count);
+        data += count;
+        size -= count;
+    }
+#endif
+    return ~crc32_scalar_(crc, data, size);
+}
+
+inline uint32_t adler32(uint32_t adler, const uint8_t* data, size_t size) noexcept {
+#if defined(IMAGE_SIMD_X86)
+    if(simd::features().ssse3) {
+        return adler32_ssse3_(adler, data, size);
+    }
+#endif
+    return adler32_scalar_(adler, data, size);
+}
+
+// Adler-32 of concatenation from Adler-32 of parts (size2 is byte count of second part)
+inline uint32_t adler32_combine(uint32_t adler1, uint32_t adler2, size_t size2) noexcept {
+    uint32_t rem = static_cast<uint32_t>(size2 % ADLER_BASE);
+    uint32_t s1 = adler1 & 0xffff;
+    uint32_t s2 = static_cast<uint32_t>((uint64_t(rem) * s1) % ADLER_BASE);
+    s1 += (adler2 & 0xffff) + ADLER_BASE - 1;
+    s2 += (adler1 >> 16) + (adler2 >> 16) + ADLER_BASE - rem;
+    if(s1 >= ADLER_BASE) { s1 -= ADLER_BASE; }
+    if(s1 >= ADLER_BASE) { s1 -= ADLER_BASE; }
+    if(s2 >= ADLER_BASE * 2) { s2 -= ADLER_BASE * 2; }
+    if(s2 >= ADLER_BASE) { s2 -= ADLER_BASE; }
+
+    return s1 | (s2 << 16);
+}
+
+}
+
+}
\ No newline at end of file
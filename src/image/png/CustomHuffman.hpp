@@ -15,149 +15,73 @@ struct CustomHuffman {
     uint16_t hlit;
     uint16_t hdist;
     uint16_t hclen;
-    CanonicalHuffman code_lengths;
-    CanonicalHuffman characters;
-    CanonicalHuffman distances;
+    CodeLengthHuffman code_lengths;
+    CharacterHuffman characters;
+    DistanceHuffman distances;
 
-    void read_header(const Deflate& bit_stream, size_t& index) {
-        hlit = bit_stream.read_bits(5, index);
+    void read_header(BitReader& bit_stream) {
+        hlit = bit_stream.read_bits(5);
         hlit += 257;
 
-        hdist = bit_stream.read_bits(5, index);
+        hdist = bit_stream.read_bits(5);
         hdist += 1;
 
-        hclen = bit_stream.read_bits(4, index);
+        hclen = bit_stream.read_bits(4);
         hclen += 4;
     }
 
-    void read_code_length_codes(const Deflate& bit_stream, size_t& index) {
-        std::vector<std::pair<uint16_t, uint16_t>> code_length_code_lengths{};
-        std::vector<uint8_t> code_length_code_counts(7);
+    void read_code_length_codes(BitReader& bit_stream) {
+        std::array<uint8_t, 19> code_length_code_lengths{};
 
         for(uint16_t i = 0; i < hclen; ++i) {
-            auto length = bit_stream.read_bits(3, index);
-            if(length != 0) {
-                code_length_code_lengths.push_back({CODE_LENGTH_CODE_INDICES[i], length});
-                ++code_length_code_counts[length - 1];
-            }
+            code_length_code_lengths[CODE_LENGTH_CODE_INDICES[i]] = static_cast<uint8_t>(bit_stream.read_bits(3));
         }
 
-        std::sort(code_length_code_lengths.begin(), code_length_code_lengths.end(),
-            [](const auto& a, const auto& b) {
-                if(a.second != b.second) {
-                    return a.second < b.second;
-                }
-                else {
-                    return a.first < b.first;
-                }
-            }
-        );
-
-        code_lengths = {code_length_code_lengths, code_length_code_counts};
+        code_lengths.build(code_length_code_lengths);
     }
 
-    void read_character_length_codes(const Deflate& bit_stream, size_t& index) {
-        std::vector<std::pair<uint16_t, uint16_t>> character_code_lengths{};
-        std::vector<uint8_t> character_code_counts(15);
-        uint16_t prev_length{};
-
-        for(uint16_t i = 0; i < hlit;) {
-            auto result = code_lengths.read_code(bit_stream, index);
-            if(result == 16) {
-                auto count = bit_stream.read_bits(2, index);
-                count += 3;
-                for(uint32_t k = 0; k < count; ++k) {
-                    if(prev_length != 0) {
-                        character_code_lengths.push_back({i, prev_length});
-                        ++character_code_counts[prev_length - 1];
-                    }
-                    ++i;
-                }
-            }
-            else if(result == 17) {
-                auto count = bit_stream.read_bits(3, index);
-                count += 3;
-                i += count;
-            }
-            else if(result == 18) {
-                auto count = bit_stream.read_bits(7, index);
-                count += 11;
-                i += count;
-            }
-            else {
-                if(result != 0) {
-                    character_code_lengths.push_back({i, result});
-                    ++character_code_counts[result - 1];
-                }
-                prev_length = result;
-                ++i;
-            }
+    // character and distance code lengths are one sequence
+    // (repeat codes may cross the boundary)
+    void read_length_codes(BitReader& bit_stream) {
+        std::array<uint8_t, 286 + 32> lengths{};
+        uint32_t total = hlit + hdist;
+        if(total > lengths.size()) {
+            throw std::runtime_error("[image::png::CustomHuffman::read_length_codes] ERROR: too many length codes.");
         }
 
-        std::sort(character_code_lengths.begin(), character_code_lengths.end(),
-            [](const auto& a, const auto& b) {
-                if(a.second != b.second) {
-                    return a.second < b.second;
-                }
-                else {
-                    return a.first < b.first;
-                }
-            }
-        );
-
-        characters = {character_code_lengths, character_code_counts};
-    }
-
-    void read_distance_length_codes(const Deflate& bit_stream, size_t& index) {
-        std::vector<std::pair<uint16_t, uint16_t>> distance_code_lengths{};
-        std::vector<uint8_t> distance_code_counts(15);
-        uint16_t prev_length{};
-
-        for(uint16_t i = 0; i < hdist;) {
-            auto result = code_lengths.read_code(bit_stream, index);
+        uint8_t prev_length{};
+        for(uint32_t i = 0; i < total;) {
+            auto result = code_lengths.decode(bit_stream);
+            uint32_t count{};
+            uint8_t length{};
             if(result == 16) {
-                auto count = bit_stream.read_bits(2, index);
-                count += 3;
-                for(uint32_t k = 0; k < count; ++k) {
-                    if(prev_length != 0) {
-                        distance_code_lengths.push_back({i, prev_length});
-                        ++distance_code_counts[prev_length - 1];
-                    }
-                    ++i;
+                if(i == 0) {
+                    throw std::runtime_error("[image::png::CustomHuffman::read_length_codes] ERROR: repeat code without previous length.");
                 }
+                count = bit_stream.read_bits(2) + 3;
+                length = prev_length;
             }
             else if(result == 17) {
-                auto count = bit_stream.read_bits(3, index);
-                count += 3;
-                i += count;
+                count = bit_stream.read_bits(3) + 3;
             }
             else if(result == 18) {
-                auto count = bit_stream.read_bits(7, index);
-                count += 11;
-                i += count;
+                count = bit_stream.read_bits(7) + 11;
             }
             else {
-                if(result != 0) {
-                    distance_code_lengths.push_back({i, result});
-                    ++distance_code_counts[result - 1];
-                }
-                prev_length = result;
-                ++i;
+                count = 1;
+                length = static_cast<uint8_t>(result);
             }
-        }
 
-        std::sort(distance_code_lengths.begin(), distance_code_lengths.end(),
-            [](const auto& a, const auto& b) {
-                if(a.second != b.second) {
-                    return a.second < b.second;
-                }
-                else {
-                    return a.first < b.first;
-                }
+            if(i + count > total) {
+                throw std::runtime_error("[image::png::CustomHuffman::read_length_codes] ERROR: length codes overflow.");
             }
-        );
+            std::fill_n(lengths.begin() + i, count, length);
+            i += count;
+            prev_length = length;
+        }
 
-        distances = {distance_code_lengths, distance_code_counts};
+        characters.build(std::span<const uint8_t>(lengths.data(), hlit));
+        distances.build(std::span<const uint8_t>(lengths.data() + hlit, hdist));
     }
 };
 
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <optional>
+#include <span>
+
+#include "../../io/MappedFile.hpp"
+
+#include "utils.hpp"
+#include "IHDR.hpp"
+#include "PLTE.hpp"
+#include "tRNS.hpp"
+#include "IDAT.hpp"
+#include "Inflate.hpp"
+#include "Unfilter.hpp"
+#include "Expand.hpp"
+
+namespace image {
+
+namespace png {
+
+// one unfiltered scanline and where its pixels go in output image
+struct Scanline {
+    std::span<const uint8_t> data;
+    // output position of first pixel
+    uint32_t x;
+    uint32_t y;
+    // output column step between pixels (1 if not interlaced)
+    uint32_t dx;
+    // pixel count
+    uint32_t width;
+};
+
+// streaming PNG decoder (pull iterator over scanlines)
+// file is mapped and zlib stream is inflated straight from IDAT payloads
+// each row is unfiltered as soon as inflate has produced it, while it and previous row are still in cache
+// interlaced image is returned pass by pass (Adam7), caller scatters pixels by Scanline::x/y/dx
+class Decoder {
+    // sub image of one Adam7 pass (whole image if not interlaced)
+    struct Pass {
+        uint32_t x;
+        uint32_t y;
+        uint32_t dx;
+        uint32_t dy;
+        uint32_t width;
+        uint32_t height;
+        size_t row_size;
+    };
+
+    io::MappedFile file_;
+    IHDR ihdr_;
+    ColorInfo color_info_;
+    bool has_trns_;
+    // samples per pixel in file
+    uint32_t component_count_;
+    size_t row_size_;
+    IdatStream idat_;
+    std::optional<Inflate> inflate_;
+    Unfilter unfilter_;
+    // current and previous unfiltered rows
+    std::vector<uint8_t> rows_;
+    std::array<Pass, 7> passes_;
+    uint32_t pass_count_;
+    uint32_t pass_index_;
+    // row in current pass
+    uint32_t row_index_;
+
+    void validate_header_() const {
+        if(ihdr_.width == 0 || ihdr_.height == 0 || ihdr_.width > 0x7fffffffu || ihdr_.height > 0x7fffffffu) {
+            throw std::runtime_error(std::format("[image::png::Decoder] ERROR: invalid image size: {} x {}", ihdr_.width, ihdr_.height));
+        }
+
+        auto depth = ihdr_.bit_depth;
+        bool valid_depth = false;
+        switch(ihdr_.color_type) {
+            case 0: valid_depth = depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16; break;
+            case 3: valid_depth = depth == 1 || depth == 2 || depth == 4 || depth == 8; break;
+            case 2: case 4: case 6: valid_depth = depth == 8 || depth == 16; break;
+            default:
+                throw std::runtime_error(std::format("[image::png::Decoder] ERROR: invalid color type: {}", ihdr_.color_type));
+        }
+        if(!valid_depth) {
+            throw std::runtime_error(std::format("[image::png::Decoder] ERROR: invalid bit depth {} for color type {}", depth, ihdr_.color_type));
+        }
+
+        if(ihdr_.compression_method != 0 || ihdr_.filter_method != 0 || ihdr_.interlace_method > 1) {
+            throw std::runtime_error("[image::png::Decoder] ERROR: unknown compression / filter / interlace method.");
+        }
+    }
+
+    size_t row_bytes_(uint32_t width) const noexcept {
+        return (size_t(width) * component_count_ * ihdr_.bit_depth + 7) / 8;
+    }
+
+    void setup_passes_() {
+        pass_count_ = 0;
+        if(ihdr_.interlace_method == 0) {
+            passes_[pass_count_++] = Pass{0, 0, 1, 1, ihdr_.width, ihdr_.height, row_size_};
+            return;
+        }
+
+        // Adam7
+        constexpr uint32_t start_x[7] = {0, 4, 0, 2, 0, 1, 0};
+        constexpr uint32_t start_y[7] = {0, 0, 4, 0, 2, 0, 1};
+        constexpr uint32_t step_x[7] = {8, 8, 4, 4, 2, 2, 1};
+        constexpr uint32_t step_y[7] = {8, 8, 8, 4, 4, 2, 2};
+        for(uint32_t i = 0; i < 7; ++i) {
+            if(ihdr_.width <= start_x[i] || ihdr_.height <= start_y[i]) {
+                // empty pass has no data (not even filter bytes)
+                continue;
+            }
+            auto width = (ihdr_.width - start_x[i] + step_x[i] - 1) / step_x[i];
+            auto height = (ihdr_.height - start_y[i] + step_y[i] - 1) / step_y[i];
+            passes_[pass_count_++] = Pass{start_x[i], start_y[i], step_x[i], step_y[i], width, height, row_bytes_(width)};
+        }
+    }
+
+public:
+    explicit Decoder(const std::filesystem::path& path) : file_(path), has_trns_(false), pass_index_(0), row_index_(0) {
+        constexpr uint8_t expected_signature[8] = {
+            0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a,
+        };
+
+        io::ByteReader reader(file_.bytes());
+        if(reader.size() < 8 || std::memcmp(reader.read_bytes(8).data(), expected_signature, 8) != 0) {
+            throw std::runtime_error(std::format("[image::png::Decoder] ERROR: unexpected file format. expected PNG file."));
+        }
+
+        // walk chunk headers until first IDAT
+        // (chunks after image data are not needed)
+        bool has_ihdr = false;
+        color_info_.plte = default_plte();
+        while(true) {
+            if(reader.remaining() < 12) {
+                throw std::runtime_error(std::format("[image::png::Decoder] ERROR: unexpected end of file: {}", path.string()));
+            }
+            auto chunk_position = reader.position();
+            auto length = reader.read_be<uint32_t>();
+            auto chunk_type = reader.read_bytes(4).data();
+            if(length > reader.remaining() - 4) {
+                throw std::runtime_error(std::format("[image::png::Decoder] ERROR: chunk is truncated: {}", path.string()));
+            }
+            auto chunk_data = reader.sub_reader(reader.position(), length);
+
+            if(std::memcmp(chunk_type, "IHDR", 4) == 0) {
+                if(length < 13) {
+                    throw std::runtime_error("[image::png::Decoder] ERROR: IHDR chunk is too short.");
+                }
+                ihdr_ = read_ihdr(chunk_data);
+                validate_header_();
+                has_ihdr = true;
+            }
+            else if(std::memcmp(chunk_type, "PLTE", 4) == 0) {
+                // suggested palette of true color image is not used
+                if(has_ihdr && ihdr_.color_type == 3) {
+                    read_plte(color_info_.plte, chunk_data);
+                }
+            }
+            else if(std::memcmp(chunk_type, "tRNS", 4) == 0) {
+                if(has_ihdr) {
+                    color_info_.trns = read_trns(ihdr_, color_info_.plte, chunk_data);
+                    has_trns_ = (ihdr_.color_type & 4) == 0;
+                }
+            }
+            else if(std::memcmp(chunk_type, "IDAT", 4) == 0) {
+                // IDAT stream starts from this chunk header
+                reader.seek(chunk_position);
+                break;
+            }
+            else if(std::memcmp(chunk_type, "IEND", 4) == 0) {
+                throw std::runtime_error(std::format("[image::png::Decoder] ERROR: no image data: {}", path.string()));
+            }
+
+            // skip payload and CRC
+            reader.skip(size_t(length) + 4);
+        }
+        if(!has_ihdr) {
+            throw std::runtime_error("[image::png::Decoder] ERROR: IHDR chunk must come before image data.");
+        }
+        if(ihdr_.color_type == 3 && color_info_.plte.size == 0) {
+            throw std::runtime_error("[image::png::Decoder] ERROR: indexed color image has no PLTE chunk.");
+        }
+
+        // index, RGB or gray scale
+        component_count_ = ihdr_.color_type == 3 ? 1 : ihdr_.color_type & 2 ? 3 : 1;
+        // has alpha channel?
+        component_count_ += ihdr_.color_type & 4 ? 1 : 0;
+        row_size_ = row_bytes_(ihdr_.width);
+        setup_passes_();
+
+        // zlib stream is read directly from IDAT payloads in file
+        idat_ = IdatStream{reader};
+        BitReader bit_reader(idat_);
+
+        // zlib header
+        auto cmf = bit_reader.read_bits(8);
+        auto flg = bit_reader.read_bits(8);
+        if(bit_reader.overrun()) {
+            throw std::runtime_error("[image::png::Decoder] ERROR: zlib stream is too short.");
+        }
+        // compression method must be deflate, header check bits must be valid
+        if((cmf & 0x0f) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0) {
+            throw std::runtime_error("[image::png::Decoder] ERROR: invalid zlib header.");
+        }
+        // preset dictionary is not allowed in PNG
+        if(flg & 0x20) {
+            throw std::runtime_error("[image::png::Decoder] ERROR: zlib preset dictionary is not supported.");
+        }
+
+        // one scanline (with filter byte) is requested at once
+        inflate_.emplace(bit_reader, row_size_ + 1);
+        // filter works on bytes of complete pixel (at least 1 byte)
+        unfilter_ = Unfilter::select(std::max<uint32_t>(1, component_count_ * ihdr_.bit_depth / 8));
+        rows_.resize(row_size_ * 2 + UNFILTER_PADDING);
+    }
+
+    Decoder(const Decoder&) = delete;
+    Decoder& operator=(const Decoder&) = delete;
+
+    const auto& header() const noexcept { return ihdr_; }
+    const auto& color_info() const noexcept { return color_info_; }
+    auto width() const noexcept { return ihdr_.width; }
+    auto height() const noexcept { return ihdr_.height; }
+    auto component_count() const noexcept { return component_count_; }
+    // bytes of one unfiltered full width scanline
+    auto row_size() const noexcept { return row_size_; }
+    auto is_interlaced() const noexcept { return ihdr_.interlace_method == 1; }
+    // color key or palette alpha
+    auto has_trns() const noexcept { return has_trns_; }
+
+    // output format which keeps all information of file
+    // (palette and tRNS are expanded, 1/2/4 bits samples are scaled to 8 bits)
+    Format natural_format() const noexcept {
+        bool has_alpha = (ihdr_.color_type & 4) || has_trns_;
+        bool is_gray = (ihdr_.color_type & 2) == 0;
+        bool is_16bit = ihdr_.bit_depth == 16;
+        if(is_gray) {
+            return has_alpha ? (is_16bit ? Format::RG16 : Format::RG8) : (is_16bit ? Format::R16 : Format::R8);
+        }
+        return has_alpha ? (is_16bit ? Format::RGBA16 : Format::RGBA8) : (is_16bit ? Format::RGB16 : Format::RGB8);
+    }
+
+    // returns next unfiltered scanline (data is valid until next call), or scanline with empty data after last row
+    Scanline next_row() {
+        while(pass_index_ < pass_count_ && row_index_ >= passes_[pass_index_].height) {
+            ++pass_index_;
+            row_index_ = 0;
+        }
+        if(pass_index_ >= pass_count_) {
+            return {};
+        }
+
+        const auto& pass = passes_[pass_index_];
+        if(!inflate_->fill(pass.row_size + 1)) {
+            throw std::runtime_error("[image::png::Decoder::next_row] ERROR: image data is truncated.");
+        }
+
+        auto src = inflate_->window.read_data();
+        auto dst = rows_.data() + (row_index_ & 1) * row_size_;
+        // first row of each pass has no previous row
+        auto prev = row_index_ > 0 ? rows_.data() + ((row_index_ - 1) & 1) * row_size_ : nullptr;
+        unfilter_.row(src[0], dst, src + 1, prev, pass.row_size);
+        inflate_->window.consume(pass.row_size + 1);
+
+        Scanline scanline{{dst, pass.row_size}, pass.x, pass.y + row_index_ * pass.dy, pass.dx, pass.width};
+        ++row_index_;
+
+        return scanline;
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -1,42 +1,542 @@
 #pragma once
 
+#include <cstring>
+
 #include "utils.hpp"
-#include "IDAT.hpp"
+#include "LZSS.hpp"
+#include "BitWriter.hpp"
+#include "HuffmanEncoder.hpp"
 
 namespace image {
 
 namespace png {
 
-struct Deflate {
-    std::vector<uint8_t> data;
+// deflate compressor (RFC 1951) for encoder
+// level 0: stored blocks only
+// level 1: run length matches only (distance 1), fast on filtered image rows
+// level 2-3: greedy hash chain matching, level 4-9: lazy matching with longer chains
+class Deflate {
+public:
+    static constexpr uint32_t MAX_LEVEL = 9;
+    static constexpr uint32_t WINDOW_SIZE = 32768;
 
-    auto size() const noexcept { return data.size() * 8; }
+private:
+    static constexpr uint32_t MIN_MATCH = 3;
+    static constexpr uint32_t MAX_MATCH = 258;
+    // chain entries older than this may be overwritten by newer positions
+    static constexpr uint32_t MAX_DISTANCE = WINDOW_SIZE - MAX_MATCH - MIN_MATCH - 1;
+    // 3 bytes match this far is usually more expensive than literals
+    static constexpr uint32_t TOO_FAR = 4096;
+    static constexpr uint32_t HASH_BITS = 15;
+    static constexpr size_t BLOCK_SYMBOLS = 1 << 14;
+    static constexpr size_t MAX_STORED_SIZE = 65535;
 
-    bool operator[](size_t i) const noexcept { return data[i / 8] & (0x01 << (i % 8)); }
+    struct Level {
+        // chain is shortened when previous match is already this long
+        uint16_t good_length;
+        // lazy: no lazy search for previous match this long, greedy: max match length to insert into hash chain
+        uint16_t max_lazy;
+        // stop searching when match is this long
+        uint16_t nice_length;
+        uint16_t max_chain;
+        bool is_lazy;
+    };
 
-    uint32_t read_bits(size_t bit_count, size_t& index) const noexcept {
-        uint32_t value = 0;
-        for(size_t i = 0; i < bit_count; ++i) {
-            value |= int(this->operator[](index++)) << i;
-        }
+    static constexpr std::array<Level, MAX_LEVEL + 1> LEVELS = {
+        Level{0, 0, 0, 0, false},
+        Level{0, 0, 0, 0, false},
+        Level{4, 5, 16, 8, false},
+        Level{4, 6, 32, 32, false},
+        Level{4, 4, 16, 16, true},
+        Level{8, 16, 32, 32, true},
+        Level{8, 16, 128, 128, true},
+        Level{8, 32, 128, 256, true},
+        Level{32, 128, 258, 1024, true},
+        Level{32, 258, 258, 4096, true},
+    };
+
+    // literal (distance = 0) or match
+    struct Symbol {
+        uint16_t value;
+        uint16_t distance;
+    };
+
+    struct Tables {
+        // match length -> index of LZSS::MATCH_TABLE
+        std::array<uint8_t, MAX_MATCH + 1> length_codes;
+        // distance - 1 (< 256) or 256 + ((distance - 1) >> 7) -> index of LZSS::DISTANCE_TABLE
+        std::array<uint8_t, 512> distance_codes;
+        HuffmanEncoder fixed_characters;
+        HuffmanEncoder fixed_distances;
+    };
+
+    static const Tables& tables_() {
+        static const Tables tables = []{
+            Tables t{};
+            for(uint8_t code = 0; code < LZSS::MATCH_TABLE.size(); ++code) {
+                auto [base, extra] = LZSS::MATCH_TABLE[code];
+                for(uint32_t length = base; length < base + (1u << extra) && length <= MAX_MATCH; ++length) {
+                    t.length_codes[length] = code;
+                }
+            }
+            // 258 has own code (not 227 + 31)
+            t.length_codes[MAX_MATCH] = static_cast<uint8_t>(LZSS::MATCH_TABLE.size() - 1);
+
+            for(uint8_t code = 0; code < LZSS::DISTANCE_TABLE.size(); ++code) {
+                auto [base, extra] = LZSS::DISTANCE_TABLE[code];
+                for(uint32_t distance = base; distance < base + (1u << extra); ++distance) {
+                    auto index = distance - 1 < 256 ? distance - 1 : 256 + ((distance - 1) >> 7);
+                    t.distance_codes[index] = code;
+                }
+            }
+
+            std::array<uint8_t, 288> character_lengths{};
+            for(size_t i = 0; i < character_lengths.size(); ++i) {
+                character_lengths[i] = i <= 143 ? 8 : i <= 255 ? 9 : i <= 279 ? 7 : 8;
+            }
+            t.fixed_characters = HuffmanEncoder::from_lengths(character_lengths);
+            std::array<uint8_t, 30> distance_lengths{};
+            distance_lengths.fill(5);
+            t.fixed_distances = HuffmanEncoder::from_lengths(distance_lengths);
+
+            return t;
+        }();
+
+        return tables;
+    }
+
+    static uint32_t distance_code_(uint32_t distance) noexcept {
+        const auto& codes = tables_().distance_codes;
+        return distance - 1 < 256 ? codes[distance - 1] : codes[256 + ((distance - 1) >> 7)];
+    }
+
+    const uint8_t* data_;
+    // first byte of dictionary, range to compress
+    size_t base_;
+    size_t start_;
+    size_t end_;
+    Level level_;
+
+    BitWriter writer_;
+    std::vector<Symbol> symbols_;
+    // raw bytes of current block are [block_start_, covered_)
+    size_t block_start_;
+    size_t covered_;
+
+    // hash chains, positions are stored as (position - base_ + 1), 0 is empty
+    std::vector<uint32_t> head_;
+    std::vector<uint32_t> prev_;
+
+    Deflate(std::span<const uint8_t> data, size_t start, size_t end, uint32_t level) :
+        data_(data.data()), base_(start - std::min<size_t>(start, WINDOW_SIZE)), start_(start), end_(end), level_(LEVELS[level]),
+        block_start_(start), covered_(start)
+    {
+        symbols_.reserve(BLOCK_SYMBOLS);
+        writer_.bytes.reserve((end - start) / 2 + 64);
+    }
+
+    uint32_t hash_(size_t position) const noexcept {
+        uint32_t value = data_[position] | (data_[position + 1] << 8) | (data_[position + 2] << 16);
+        return (value * 0x9e3779b1u) >> (32 - HASH_BITS);
+    }
+
+    // returns previous head of same hash
+    uint32_t insert_(size_t position) noexcept {
+        auto hash = hash_(position);
+        auto previous = head_[hash];
+        prev_[position & (WINDOW_SIZE - 1)] = previous;
+        head_[hash] = static_cast<uint32_t>(position - base_ + 1);
+        return previous;
+    }
 
+    uint16_t load_u16_(size_t position) const noexcept {
+        uint16_t value{};
+        std::memcpy(&value, data_ + position, 2);
         return value;
     }
-};
 
-inline Deflate concat_idat(std::vector<IDAT>&& data_chunks, size_t total_length) {
-    Deflate deflate{};
-    deflate.data.resize(total_length);
+    uint32_t match_length_(size_t a, size_t b, uint32_t max_length) const noexcept {
+        uint32_t length = 0;
+        while(length + 8 <= max_length) {
+            uint64_t x{}, y{};
+            std::memcpy(&x, data_ + a + length, 8);
+            std::memcpy(&y, data_ + b + length, 8);
+            if(auto diff = x ^ y; diff != 0) {
+                auto bits = std::endian::native == std::endian::little ? std::countr_zero(diff) : std::countl_zero(diff);
+                return length + static_cast<uint32_t>(bits / 8);
+            }
+            length += 8;
+        }
+        while(length < max_length && data_[a + length] == data_[b + length]) {
+            ++length;
+        }
+        return length;
+    }
 
-    size_t current_index = 0;
-    for(size_t i = 0; i < data_chunks.size(); ++i) {
-        for(size_t j = 0; j < data_chunks[i].data.size(); ++j) {
-            deflate.data[current_index++] = data_chunks[i].data[j];
+    // longest match longer than best_length, 0 if not found
+    uint32_t longest_match_(size_t position, uint32_t chain_head, uint32_t best_length, uint32_t& distance) const noexcept {
+        auto max_length = static_cast<uint32_t>(std::min<size_t>(MAX_MATCH, end_ - position));
+        if(best_length >= max_length) {
+            return 0;
+        }
+        uint32_t chain = level_.max_chain;
+        if(best_length >= level_.good_length) {
+            chain >>= 2;
         }
+        auto nice_length = std::min<uint32_t>(level_.nice_length, max_length);
+
+        uint32_t found = 0;
+        auto scan_start = load_u16_(position);
+        auto scan_end = load_u16_(position + best_length - 1);
+        auto candidate = chain_head;
+        while(candidate != 0 && chain-- > 0) {
+            auto c = base_ + candidate - 1;
+            if(position - c > MAX_DISTANCE) {
+                break;
+            }
+            // last 2 bytes of best match first (most candidates fail there)
+            if(load_u16_(c + best_length - 1) == scan_end && load_u16_(c) == scan_start) {
+                auto length = match_length_(c, position, max_length);
+                if(length > best_length) {
+                    best_length = length;
+                    found = length;
+                    distance = static_cast<uint32_t>(position - c);
+                    if(length >= nice_length) {
+                        break;
+                    }
+                    scan_end = load_u16_(position + best_length - 1);
+                }
+            }
+            // chain must go back in position (entry may be overwritten by newer one)
+            auto next = prev_[c & (WINDOW_SIZE - 1)];
+            if(next >= candidate) {
+                break;
+            }
+            candidate = next;
+        }
+
+        if(found == MIN_MATCH && distance > TOO_FAR) {
+            return 0;
+        }
+        return found;
     }
 
-    return deflate;
-}
+    void emit_literal_(uint8_t value) {
+        symbols_.push_back(Symbol{value, 0});
+        ++covered_;
+        if(symbols_.size() >= BLOCK_SYMBOLS) {
+            flush_block_(false);
+        }
+    }
+
+    void emit_match_(uint32_t length, uint32_t distance) {
+        symbols_.push_back(Symbol{static_cast<uint16_t>(length), static_cast<uint16_t>(distance)});
+        covered_ += length;
+        if(symbols_.size() >= BLOCK_SYMBOLS) {
+            flush_block_(false);
+        }
+    }
+
+    void write_stored_(size_t begin, size_t end, bool is_final) {
+        do {
+            auto size = std::min(end - begin, MAX_STORED_SIZE);
+            auto is_final_chunk = is_final && begin + size == end;
+            writer_.write_bits(is_final_chunk ? 1 : 0, 1);
+            writer_.write_bits(0, 2);
+            writer_.align_to_byte();
+            const uint8_t header[4] = {
+                static_cast<uint8_t>(size & 0xff), static_cast<uint8_t>(size >> 8),
+                static_cast<uint8_t>(~size & 0xff), static_cast<uint8_t>((~size >> 8) & 0xff),
+            };
+            writer_.write_bytes(header, 4);
+            writer_.write_bytes(data_ + begin, size);
+            begin += size;
+        } while(begin < end);
+    }
+
+    void write_symbols_(const HuffmanEncoder& characters, const HuffmanEncoder& distances) {
+        const auto& length_codes = tables_().length_codes;
+        for(auto symbol : symbols_) {
+            if(symbol.distance == 0) {
+                characters.write(writer_, symbol.value);
+                continue;
+            }
+            auto length_code = length_codes[symbol.value];
+            characters.write(writer_, 257 + length_code);
+            auto [length_base, length_extra] = LZSS::MATCH_TABLE[length_code];
+            if(length_extra > 0) {
+                writer_.write_bits(symbol.value - length_base, length_extra);
+            }
+            auto distance_code = distance_code_(symbol.distance);
+            distances.write(writer_, distance_code);
+            auto [distance_base, distance_extra] = LZSS::DISTANCE_TABLE[distance_code];
+            if(distance_extra > 0) {
+                writer_.write_bits(symbol.distance - distance_base, distance_extra);
+            }
+        }
+        // end of block
+        characters.write(writer_, 256);
+    }
+
+    // pick cheapest of stored, fixed and dynamic Huffman block
+    void flush_block_(bool is_final) {
+        std::array<uint32_t, 286> character_frequencies{};
+        std::array<uint32_t, 30> distance_frequencies{};
+        uint64_t extra_bits = 0;
+        const auto& length_codes = tables_().length_codes;
+        for(auto symbol : symbols_) {
+            if(symbol.distance == 0) {
+                ++character_frequencies[symbol.value];
+                continue;
+            }
+            auto length_code = length_codes[symbol.value];
+            auto distance_code = distance_code_(symbol.distance);
+            ++character_frequencies[257 + length_code];
+            ++distance_frequencies[distance_code];
+            extra_bits += LZSS::MATCH_TABLE[length_code].second + LZSS::DISTANCE_TABLE[distance_code].second;
+        }
+        character_frequencies[256] = 1;
+
+        auto characters = HuffmanEncoder::from_frequencies(character_frequencies, 15);
+        auto distances = HuffmanEncoder::from_frequencies(distance_frequencies, 15);
+
+        // code length sequence (RFC 1951 3.2.7)
+        uint32_t hlit = 286;
+        while(hlit > 257 && characters.lengths[hlit - 1] == 0) {
+            --hlit;
+        }
+        uint32_t hdist = 30;
+        while(hdist > 1 && distances.lengths[hdist - 1] == 0) {
+            --hdist;
+        }
+        std::vector<uint8_t> lengths(characters.lengths.begin(), characters.lengths.begin() + hlit);
+        lengths.insert(lengths.end(), distances.lengths.begin(), distances.lengths.begin() + hdist);
+
+        // (symbol, extra bits value)
+        std::vector<std::pair<uint8_t, uint8_t>> length_codes_rle{};
+        std::array<uint32_t, 19> code_length_frequencies{};
+        for(size_t i = 0; i < lengths.size();) {
+            auto length = lengths[i];
+            size_t run = 1;
+            while(i + run < lengths.size() && lengths[i + run] == length) {
+                ++run;
+            }
+            i += run;
+            if(length == 0) {
+                while(run >= 11) {
+                    auto count = std::min<size_t>(run, 138);
+                    length_codes_rle.push_back({18, static_cast<uint8_t>(count - 11)});
+                    run -= count;
+                }
+                if(run >= 3) {
+                    length_codes_rle.push_back({17, static_cast<uint8_t>(run - 3)});
+                    run = 0;
+                }
+            }
+            else {
+                length_codes_rle.push_back({length, 0});
+                --run;
+                while(run >= 3) {
+                    auto count = std::min<size_t>(run, 6);
+                    length_codes_rle.push_back({16, static_cast<uint8_t>(count - 3)});
+                    run -= count;
+                }
+            }
+            while(run-- > 0) {
+                length_codes_rle.push_back({length, 0});
+            }
+        }
+        for(auto [symbol, extra] : length_codes_rle) {
+            ++code_length_frequencies[symbol];
+        }
+        auto code_lengths = HuffmanEncoder::from_frequencies(code_length_frequencies, 7);
+
+        constexpr uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        uint32_t hclen = 19;
+        while(hclen > 4 && code_lengths.lengths[CODE_LENGTH_ORDER[hclen - 1]] == 0) {
+            --hclen;
+        }
+
+        uint64_t dynamic_bits = 3 + 5 + 5 + 4 + 3 * hclen + code_lengths.cost(code_length_frequencies)
+            + code_length_frequencies[16] * 2 + code_length_frequencies[17] * 3 + code_length_frequencies[18] * 7
+            + characters.cost(character_frequencies) + distances.cost(distance_frequencies) + extra_bits;
+        uint64_t fixed_bits = 3 + tables_().fixed_characters.cost(character_frequencies) + tables_().fixed_distances.cost(distance_frequencies) + extra_bits;
+        auto raw_size = covered_ - block_start_;
+        uint64_t stored_bits = (raw_size + 5 * std::max<size_t>(1, (raw_size + MAX_STORED_SIZE - 1) / MAX_STORED_SIZE)) * 8 + 7;
+
+        if(stored_bits < std::min(dynamic_bits, fixed_bits)) {
+            write_stored_(block_start_, covered_, is_final);
+        }
+        else if(fixed_bits <= dynamic_bits) {
+            writer_.write_bits(is_final ? 1 : 0, 1);
+            writer_.write_bits(1, 2);
+            write_symbols_(tables_().fixed_characters, tables_().fixed_distances);
+        }
+        else {
+            writer_.write_bits(is_final ? 1 : 0, 1);
+            writer_.write_bits(2, 2);
+            writer_.write_bits(hlit - 257, 5);
+            writer_.write_bits(hdist - 1, 5);
+            writer_.write_bits(hclen - 4, 4);
+            for(uint32_t i = 0; i < hclen; ++i) {
+                writer_.write_bits(code_lengths.lengths[CODE_LENGTH_ORDER[i]], 3);
+            }
+            for(auto [symbol, extra] : length_codes_rle) {
+                code_lengths.write(writer_, symbol);
+                if(symbol == 16) {
+                    writer_.write_bits(extra, 2);
+                }
+                else if(symbol == 17) {
+                    writer_.write_bits(extra, 3);
+                }
+                else if(symbol == 18) {
+                    writer_.write_bits(extra, 7);
+                }
+            }
+            write_symbols_(characters, distances);
+        }
+
+        symbols_.clear();
+        block_start_ = covered_;
+    }
+
+    void compress_rle_() {
+        for(auto position = start_; position < end_;) {
+            if(position > 0 && data_[position] == data_[position - 1]) {
+                auto max_length = std::min<size_t>(MAX_MATCH, end_ - position);
+                size_t length = 1;
+                while(length < max_length && data_[position + length] == data_[position - 1]) {
+                    ++length;
+                }
+                if(length >= MIN_MATCH) {
+                    emit_match_(static_cast<uint32_t>(length), 1);
+                    position += length;
+                    continue;
+                }
+            }
+            emit_literal_(data_[position++]);
+        }
+    }
+
+    void prepare_chains_() {
+        head_.assign(size_t(1) << HASH_BITS, 0);
+        prev_.assign(WINDOW_SIZE, 0);
+        // preset dictionary
+        for(auto position = base_; position < start_ && position + MIN_MATCH <= end_; ++position) {
+            insert_(position);
+        }
+    }
+
+    void compress_greedy_() {
+        prepare_chains_();
+        for(auto position = start_; position < end_;) {
+            uint32_t length = 0;
+            uint32_t distance = 0;
+            if(position + MIN_MATCH <= end_) {
+                auto chain_head = insert_(position);
+                length = longest_match_(position, chain_head, MIN_MATCH - 1, distance);
+            }
+            if(length >= MIN_MATCH) {
+                emit_match_(length, distance);
+                // long matches are not inserted (faster)
+                if(length <= level_.max_lazy) {
+                    for(auto p = position + 1; p < position + length && p + MIN_MATCH <= end_; ++p) {
+                        insert_(p);
+                    }
+                }
+                position += length;
+            }
+            else {
+                emit_literal_(data_[position++]);
+            }
+        }
+    }
+
+    // match at position is emitted only if match at next position is not longer
+    void compress_lazy_() {
+        prepare_chains_();
+        uint32_t prev_length = 0;
+        uint32_t prev_distance = 0;
+        bool has_pending_literal = false;
+        for(auto position = start_; position < end_;) {
+            uint32_t length = 0;
+            uint32_t distance = 0;
+            if(position + MIN_MATCH <= end_) {
+                auto chain_head = insert_(position);
+                if(prev_length < level_.max_lazy) {
+                    length = longest_match_(position, chain_head, std::max(prev_length, MIN_MATCH - 1), distance);
+                }
+            }
+
+            if(prev_length >= MIN_MATCH && length <= prev_length) {
+                // previous match starts at position - 1
+                auto match_end = position - 1 + prev_length;
+                emit_match_(prev_length, prev_distance);
+                for(auto p = position + 1; p < match_end && p + MIN_MATCH <= end_; ++p) {
+                    insert_(p);
+                }
+                position = match_end;
+                prev_length = 0;
+                has_pending_literal = false;
+            }
+            else {
+                if(has_pending_literal) {
+                    emit_literal_(data_[position - 1]);
+                }
+                has_pending_literal = true;
+                prev_length = length;
+                prev_distance = distance;
+                ++position;
+            }
+        }
+        if(has_pending_literal) {
+            emit_literal_(data_[end_ - 1]);
+        }
+    }
+
+public:
+    // compress data[start, end)
+    // up to WINDOW_SIZE bytes before start are used as preset dictionary (matches may refer to them),
+    // so independently compressed ranges can be concatenated into one stream
+    // is_last: last block is final, otherwise output ends with sync flush (empty stored block) on byte boundary
+    static std::vector<uint8_t> compress(std::span<const uint8_t> data, size_t start, size_t end, uint32_t level, bool is_last) {
+        if(level > MAX_LEVEL) {
+            throw std::runtime_error(std::format("[image::png::Deflate::compress] ERROR: invalid compression level: {}", level));
+        }
+
+        Deflate deflate(data, start, end, level);
+        if(level == 0) {
+            if(start < end || is_last) {
+                deflate.write_stored_(start, end, is_last);
+            }
+        }
+        else {
+            if(level == 1) {
+                deflate.compress_rle_();
+            }
+            else if(deflate.level_.is_lazy) {
+                deflate.compress_lazy_();
+            }
+            else {
+                deflate.compress_greedy_();
+            }
+            if(!deflate.symbols_.empty() || is_last) {
+                deflate.flush_block_(is_last);
+            }
+        }
+
+        if(!is_last) {
+            // sync flush
+            deflate.writer_.write_bits(0, 3);
+            deflate.writer_.align_to_byte();
+            const uint8_t marker[4] = {0x00, 0x00, 0xff, 0xff};
+            deflate.writer_.write_bytes(marker, 4);
+        }
+        deflate.writer_.align_to_byte();
+
+        return std::move(deflate.writer_.bytes);
+    }
+};
 
 }
 
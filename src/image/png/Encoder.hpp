@@ -0,0 +1,202 @@
+#pragma once
+
+#include <future>
+
+#include "utils.hpp"
+#include "Checksum.hpp"
+#include "Filter.hpp"
+#include "Deflate.hpp"
+#include "../../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+namespace png {
+
+struct EncodeOptions {
+    // deflate level (0: stored, 1: run length only, 2-9: hash chain, see Deflate)
+    uint32_t level = 6;
+    // number of independently compressed parts of image (0: thread count of pool, 1 without pool)
+    uint32_t segment_count = 0;
+    // bytes between source rows (0: tightly packed)
+    size_t row_pitch = 0;
+};
+
+// PNG writer (non-interlaced, 8 or 16 bits gray, gray alpha, RGB and RGBA)
+// image is split into horizontal segments which are filtered and deflated in parallel,
+// each segment uses end of previous one as preset dictionary and ends with sync flush, so they are joined into one zlib stream
+// (each segment is written as own IDAT chunk)
+class Encoder {
+    static constexpr uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    // smaller segments lose too much ratio
+    static constexpr size_t MIN_SEGMENT_SIZE = 64 * 1024;
+    // positions in hash chains are 32 bits
+    static constexpr size_t MAX_SEGMENT_SIZE = size_t(1) << 30;
+
+    struct Segment {
+        uint32_t first_row;
+        uint32_t row_count;
+        uint32_t adler;
+        std::vector<uint8_t> chunk;
+    };
+
+    static void write_u32_(std::vector<uint8_t>& out, uint32_t value) {
+        const uint8_t bytes[4] = {
+            static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value),
+        };
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+
+    // length, type, payload and CRC of type + payload
+    static void write_chunk_(std::vector<uint8_t>& out, const char* type, std::span<const uint8_t> payload) {
+        write_u32_(out, static_cast<uint32_t>(payload.size()));
+        auto type_offset = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), payload.begin(), payload.end());
+        write_u32_(out, crc32(0, out.data() + type_offset, out.size() - type_offset));
+    }
+
+public:
+    // data: 16 bits samples are native endian (same as decoder output)
+    // do not call from task on the same pool (waits for segment tasks)
+    static std::vector<uint8_t> encode(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format format, const EncodeOptions& options = {}, concurrency::ThreadPool* pool = nullptr) {
+        if(format == Format::BGRA8 || is_float(format)) {
+            throw std::runtime_error(std::format("[image::png::Encoder::encode] ERROR: format cannot be written to PNG (see image::convert()): {}", static_cast<uint32_t>(format)));
+        }
+        uint8_t color_type{};
+        switch(component_count(format)) {
+            case 1: color_type = 0; break;
+            case 2: color_type = 4; break;
+            case 3: color_type = 2; break;
+            case 4: color_type = 6; break;
+            default:
+                throw std::runtime_error("[image::png::Encoder::encode] ERROR: block compressed format cannot be written to PNG.");
+        }
+        if(width == 0 || height == 0 || width > 0x7fffffffu || height > 0x7fffffffu) {
+            throw std::runtime_error(std::format("[image::png::Encoder::encode] ERROR: invalid image size: {} x {}", width, height));
+        }
+        if(options.level > Deflate::MAX_LEVEL) {
+            throw std::runtime_error(std::format("[image::png::Encoder::encode] ERROR: invalid compression level: {}", options.level));
+        }
+        auto bit_depth = static_cast<uint8_t>(pixel_size(format) / component_count(format) * 8);
+        auto bpp = pixel_size(format);
+        auto row_size = size_t(width) * bpp;
+        auto src_pitch = options.row_pitch == 0 ? row_size : options.row_pitch;
+        if(src_pitch < row_size || data.size() < src_pitch * (height - 1) + row_size) {
+            throw std::runtime_error(std::format("[image::png::Encoder::encode] ERROR: source is too small (size = {}, pitch = {}).", data.size(), src_pitch));
+        }
+        auto needs_swap = bit_depth == 16 && std::endian::native == std::endian::little;
+
+        // filtered rows (filter type byte + row) of all segments
+        auto filtered_row_size = row_size + 1;
+        std::vector<uint8_t> filtered(filtered_row_size * height);
+
+        size_t segment_count = options.segment_count != 0 ? options.segment_count : pool ? pool->thread_count() : 1;
+        segment_count = std::min(segment_count, std::max<size_t>(1, filtered.size() / MIN_SEGMENT_SIZE));
+        segment_count = std::max(segment_count, (filtered.size() + MAX_SEGMENT_SIZE - 1) / MAX_SEGMENT_SIZE);
+        segment_count = std::min<size_t>(segment_count, height);
+
+        std::vector<Segment> segments(segment_count);
+        for(size_t i = 0; i < segment_count; ++i) {
+            segments[i].first_row = static_cast<uint32_t>(height * i / segment_count);
+            segments[i].row_count = static_cast<uint32_t>(height * (i + 1) / segment_count) - segments[i].first_row;
+        }
+
+        // filter and Adler-32 of each segment
+        concurrency::parallel_for(pool, static_cast<uint32_t>(segment_count), [&](uint32_t index) {
+            auto& segment = segments[index];
+            // rows converted to big endian
+            std::vector<uint8_t> swapped(needs_swap ? row_size * 2 : 0);
+            std::vector<uint8_t> scratch(row_size);
+            auto source_row = [&](uint32_t y, size_t slot) -> const uint8_t* {
+                auto row = data.data() + y * src_pitch;
+                if(!needs_swap) {
+                    return row;
+                }
+                auto dst = swapped.data() + slot * row_size;
+                for(size_t i = 0; i < row_size; i += 2) {
+                    dst[i] = row[i + 1];
+                    dst[i + 1] = row[i];
+                }
+                return dst;
+            };
+
+            size_t slot = 0;
+            const uint8_t* prev = segment.first_row > 0 ? source_row(segment.first_row - 1, slot) : nullptr;
+            for(uint32_t y = segment.first_row; y < segment.first_row + segment.row_count; ++y) {
+                slot ^= 1;
+                auto raw = source_row(y, slot);
+                auto dst = filtered.data() + y * filtered_row_size;
+                if(options.level == 0) {
+                    dst[0] = Filter::NONE;
+                    std::memcpy(dst + 1, raw, row_size);
+                }
+                else {
+                    Filter::adaptive(dst, scratch.data(), raw, prev, row_size, bpp);
+                }
+                prev = raw;
+            }
+
+            segment.adler = adler32(1, filtered.data() + segment.first_row * filtered_row_size, segment.row_count * filtered_row_size);
+        });
+
+        auto adler = segments[0].adler;
+        for(size_t i = 1; i < segment_count; ++i) {
+            adler = adler32_combine(adler, segments[i].adler, segments[i].row_count * filtered_row_size);
+        }
+
+        // deflate each segment into IDAT chunk
+        concurrency::parallel_for(pool, static_cast<uint32_t>(segment_count), [&](uint32_t index) {
+            auto& segment = segments[index];
+            auto is_first = index == 0;
+            auto is_last = index + 1 == segment_count;
+            auto start = segment.first_row * filtered_row_size;
+            auto end = start + segment.row_count * filtered_row_size;
+            auto compressed = Deflate::compress(filtered, start, end, options.level, is_last);
+
+            std::vector<uint8_t> payload{};
+            payload.reserve(compressed.size() + 6);
+            if(is_first) {
+                // CMF: deflate, 32K window, FLG: level hint and check bits
+                uint8_t cmf = 0x78;
+                uint8_t flevel = options.level <= 1 ? 0 : options.level <= 5 ? 1 : options.level == 6 ? 2 : 3;
+                auto flg = static_cast<uint8_t>(flevel << 6);
+                flg = static_cast<uint8_t>(flg + 31 - (cmf * 256 + flg) % 31);
+                payload.push_back(cmf);
+                payload.push_back(flg);
+            }
+            payload.insert(payload.end(), compressed.begin(), compressed.end());
+            if(is_last) {
+                write_u32_(payload, adler);
+            }
+
+            segment.chunk.reserve(payload.size() + 12);
+            write_chunk_(segment.chunk, "IDAT", payload);
+        });
+
+        std::vector<uint8_t> out(SIGNATURE, SIGNATURE + 8);
+
+        std::vector<uint8_t> ihdr{};
+        write_u32_(ihdr, width);
+        write_u32_(ihdr, height);
+        // bit depth, color type, compression, filter, interlace
+        const uint8_t fields[5] = {bit_depth, color_type, 0, 0, 0};
+        ihdr.insert(ihdr.end(), fields, fields + 5);
+        write_chunk_(out, "IHDR", ihdr);
+
+        size_t total_size = out.size() + 12;
+        for(const auto& segment : segments) {
+            total_size += segment.chunk.size();
+        }
+        out.reserve(total_size);
+        for(const auto& segment : segments) {
+            out.insert(out.end(), segment.chunk.begin(), segment.chunk.end());
+        }
+        write_chunk_(out, "IEND", {});
+
+        return out;
+    }
+};
+
+}
+
+}
\ No newline at end of file
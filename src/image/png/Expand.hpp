@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cstring>
+
+#include "utils.hpp"
+#include "IHDR.hpp"
+#include "PLTE.hpp"
+#include "tRNS.hpp"
+
+namespace image {
+
+namespace png {
+
+// per-image data needed to interpret samples
+struct ColorInfo {
+    PLTE plte;
+    tRNS trns;
+};
+
+template<typename T>
+struct Pixel {
+    T r, g, b, a;
+};
+
+template<uint32_t DEPTH>
+inline uint32_t load_sample_(const uint8_t* src, size_t index) noexcept {
+    if constexpr(DEPTH == 16) {
+        return (uint32_t(src[index * 2]) << 8) | src[index * 2 + 1];
+    }
+    else if constexpr(DEPTH == 8) {
+        return src[index];
+    }
+    // packed samples, MSB first
+    else {
+        auto bit = index * DEPTH;
+        return (src[bit >> 3] >> (8 - DEPTH - (bit & 7))) & ((1u << DEPTH) - 1);
+    }
+}
+
+// scale sample of DEPTH bits to full range of T
+// (low depths are replicated: 0b01 -> 0x55, 16 bits -> 8 bits keeps high byte)
+template<uint32_t DEPTH, typename T>
+constexpr T scale_sample_(uint32_t value) noexcept {
+    if constexpr(sizeof(T) == 1) {
+        if constexpr(DEPTH == 16) {
+            return static_cast<T>(value >> 8);
+        }
+        else {
+            return static_cast<T>(value * (255 / ((1u << DEPTH) - 1)));
+        }
+    }
+    else {
+        if constexpr(DEPTH == 16) {
+            return static_cast<T>(value);
+        }
+        else {
+            return static_cast<T>(value * (65535 / ((1u << DEPTH) - 1)));
+        }
+    }
+}
+
+// sources (one per color type) read pixel i of unfiltered scanline
+// GRAY: gray scale source, two channel output is (gray, alpha) instead of (red, green)
+template<uint32_t DEPTH>
+struct GraySource {
+    static constexpr bool GRAY = true;
+
+    template<typename T>
+    static Pixel<T> load(const ColorInfo& info, const uint8_t* src, size_t i) noexcept {
+        auto value = load_sample_<DEPTH>(src, i);
+        auto gray = scale_sample_<DEPTH, T>(value);
+        T alpha = info.trns.has_key && value == info.trns.key[0] ? T(0) : T(~T(0));
+        return {gray, gray, gray, alpha};
+    }
+};
+
+template<uint32_t DEPTH>
+struct GrayAlphaSource {
+    static constexpr bool GRAY = true;
+
+    template<typename T>
+    static Pixel<T> load(const ColorInfo&, const uint8_t* src, size_t i) noexcept {
+        auto gray = scale_sample_<DEPTH, T>(load_sample_<DEPTH>(src, i * 2 + 0));
+        auto alpha = scale_sample_<DEPTH, T>(load_sample_<DEPTH>(src, i * 2 + 1));
+        return {gray, gray, gray, alpha};
+    }
+};
+
+template<uint32_t DEPTH>
+struct RGBSource {
+    static constexpr bool GRAY = false;
+
+    template<typename T>
+    static Pixel<T> load(const ColorInfo& info, const uint8_t* src, size_t i) noexcept {
+        auto r = load_sample_<DEPTH>(src, i * 3 + 0);
+        auto g = load_sample_<DEPTH>(src, i * 3 + 1);
+        auto b = load_sample_<DEPTH>(src, i * 3 + 2);
+        bool transparent = info.trns.has_key && r == info.trns.key[0] && g == info.trns.key[1] && b == info.trns.key[2];
+        return {scale_sample_<DEPTH, T>(r), scale_sample_<DEPTH, T>(g), scale_sample_<DEPTH, T>(b), transparent ? T(0) : T(~T(0))};
+    }
+};
+
+template<uint32_t DEPTH>
+struct RGBASource {
+    static constexpr bool GRAY = false;
+
+    template<typename T>
+    static Pixel<T> load(const ColorInfo&, const uint8_t* src, size_t i) noexcept {
+        return {
+            scale_sample_<DEPTH, T>(load_sample_<DEPTH>(src, i * 4 + 0)),
+            scale_sample_<DEPTH, T>(load_sample_<DEPTH>(src, i * 4 + 1)),
+            scale_sample_<DEPTH, T>(load_sample_<DEPTH>(src, i * 4 + 2)),
+            scale_sample_<DEPTH, T>(load_sample_<DEPTH>(src, i * 4 + 3)),
+        };
+    }
+};
+
+template<uint32_t DEPTH>
+struct PaletteSource {
+    static constexpr bool GRAY = false;
+
+    template<typename T>
+    static Pixel<T> load(const ColorInfo& info, const uint8_t* src, size_t i) noexcept {
+        const auto& entry = info.plte.entries[load_sample_<DEPTH>(src, i)];
+        return {scale_sample_<8, T>(entry[0]), scale_sample_<8, T>(entry[1]), scale_sample_<8, T>(entry[2]), scale_sample_<8, T>(entry[3])};
+    }
+};
+
+// write count pixels of scanline to dst (dst_step: bytes between output pixels)
+// 16 bits output is native endian
+using ExpandRow = void(*)(const ColorInfo& info, const uint8_t* src, uint8_t* dst, uint32_t count, size_t dst_step);
+
+template<typename Source, typename T, uint32_t N>
+void expand_row_(const ColorInfo& info, const uint8_t* src, uint8_t* dst, uint32_t count, size_t dst_step) {
+    for(uint32_t i = 0; i < count; ++i) {
+        auto pixel = Source::template load<T>(info, src, i);
+        T values[4]{};
+        if constexpr(N == 2) {
+            values[0] = pixel.r;
+            values[1] = Source::GRAY ? pixel.a : pixel.g;
+        }
+        else {
+            values[0] = pixel.r;
+            values[1] = pixel.g;
+            values[2] = pixel.b;
+            values[3] = pixel.a;
+        }
+        std::memcpy(dst, values, sizeof(T) * N);
+        dst += dst_step;
+    }
+}
+
+template<typename Source>
+ExpandRow select_target_(Format format) {
+    switch(format) {
+        case Format::R8: return expand_row_<Source, uint8_t, 1>;
+        case Format::RG8: return expand_row_<Source, uint8_t, 2>;
+        case Format::RGB8: return expand_row_<Source, uint8_t, 3>;
+        case Format::RGBA8: return expand_row_<Source, uint8_t, 4>;
+        case Format::R16: return expand_row_<Source, uint16_t, 1>;
+        case Format::RG16: return expand_row_<Source, uint16_t, 2>;
+        case Format::RGB16: return expand_row_<Source, uint16_t, 3>;
+        case Format::RGBA16: return expand_row_<Source, uint16_t, 4>;
+        default:
+            throw std::runtime_error("[image::png::Expand] ERROR: unsupported output format.");
+    }
+}
+
+// converts unfiltered scanlines to output format
+// (palette expansion, tRNS, bit depth scaling and channel mapping are done while writing output)
+struct Expand {
+    ExpandRow expand;
+    // scanline is same as output pixels -> plain copy
+    bool is_copy;
+    uint32_t pixel_size;
+
+    static Expand select(const IHDR& ihdr, bool has_key, Format format) {
+        Expand result{};
+        result.pixel_size = image::pixel_size(format);
+
+        auto depth = ihdr.bit_depth;
+        switch(ihdr.color_type) {
+            case 0:
+                switch(depth) {
+                    case 1: result.expand = select_target_<GraySource<1>>(format); break;
+                    case 2: result.expand = select_target_<GraySource<2>>(format); break;
+                    case 4: result.expand = select_target_<GraySource<4>>(format); break;
+                    case 8: result.expand = select_target_<GraySource<8>>(format); break;
+                    case 16: result.expand = select_target_<GraySource<16>>(format); break;
+                }
+                result.is_copy = depth == 8 && !has_key && format == Format::R8;
+                break;
+            case 2:
+                result.expand = depth == 8 ? select_target_<RGBSource<8>>(format) : select_target_<RGBSource<16>>(format);
+                result.is_copy = depth == 8 && !has_key && format == Format::RGB8;
+                break;
+            case 3:
+                switch(depth) {
+                    case 1: result.expand = select_target_<PaletteSource<1>>(format); break;
+                    case 2: result.expand = select_target_<PaletteSource<2>>(format); break;
+                    case 4: result.expand = select_target_<PaletteSource<4>>(format); break;
+                    case 8: result.expand = select_target_<PaletteSource<8>>(format); break;
+                }
+                result.is_copy = false;
+                break;
+            case 4:
+                result.expand = depth == 8 ? select_target_<GrayAlphaSource<8>>(format) : select_target_<GrayAlphaSource<16>>(format);
+                result.is_copy = depth == 8 && format == Format::RG8;
+                break;
+            case 6:
+                result.expand = depth == 8 ? select_target_<RGBASource<8>>(format) : select_target_<RGBASource<16>>(format);
+                result.is_copy = depth == 8 && format == Format::RGBA8;
+                break;
+        }
+        if(!result.expand) {
+            throw std::runtime_error(std::format("[image::png::Expand::select] ERROR: unsupported color type / bit depth: {} / {}", ihdr.color_type, ihdr.bit_depth));
+        }
+
+        return result;
+    }
+
+    // dst_step: bytes between output pixels (pixel_size for non-interlaced rows)
+    void row(const ColorInfo& info, const uint8_t* src, uint8_t* dst, uint32_t count, size_t dst_step) const {
+        if(is_copy && dst_step == pixel_size) {
+            std::memcpy(dst, src, size_t(count) * pixel_size);
+        }
+        else {
+            expand(info, src, dst, count, dst_step);
+        }
+    }
+};
+
+}
+
+}
\ No newline at end of file
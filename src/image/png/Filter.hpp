@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstring>
+
+#include "utils.hpp"
+
+namespace image {
+
+namespace png {
+
+// forward filters for encoder (inverse of Unfilter)
+// raw and prev are unfiltered rows (prev is nullptr for first row), dst receives filtered bytes (without filter type byte)
+struct Filter {
+    static constexpr uint8_t NONE = 0;
+    static constexpr uint8_t SUB = 1;
+    static constexpr uint8_t UP = 2;
+    static constexpr uint8_t AVERAGE = 3;
+    static constexpr uint8_t PAETH = 4;
+
+    // "minimum sum of absolute differences" heuristic: filtered bytes are treated as signed,
+    // row with smallest magnitude usually compresses best
+    static uint32_t cost_(const uint8_t* row, size_t row_size) noexcept {
+        uint32_t sum = 0;
+        for(size_t i = 0; i < row_size; ++i) {
+            sum += row[i] < 128 ? row[i] : 256 - row[i];
+        }
+        return sum;
+    }
+
+    static void sub_(uint8_t* dst, const uint8_t* raw, size_t row_size, uint32_t bpp) noexcept {
+        std::memcpy(dst, raw, std::min<size_t>(bpp, row_size));
+        for(size_t i = bpp; i < row_size; ++i) {
+            dst[i] = raw[i] - raw[i - bpp];
+        }
+    }
+
+    static void up_(uint8_t* dst, const uint8_t* raw, const uint8_t* prev, size_t row_size) noexcept {
+        for(size_t i = 0; i < row_size; ++i) {
+            dst[i] = raw[i] - prev[i];
+        }
+    }
+
+    static void average_(uint8_t* dst, const uint8_t* raw, const uint8_t* prev, size_t row_size, uint32_t bpp) noexcept {
+        for(size_t i = 0; i < bpp && i < row_size; ++i) {
+            dst[i] = raw[i] - (prev[i] >> 1);
+        }
+        for(size_t i = bpp; i < row_size; ++i) {
+            dst[i] = raw[i] - static_cast<uint8_t>((raw[i - bpp] + prev[i]) >> 1);
+        }
+    }
+
+    static void paeth_(uint8_t* dst, const uint8_t* raw, const uint8_t* prev, size_t row_size, uint32_t bpp) noexcept {
+        for(size_t i = 0; i < bpp && i < row_size; ++i) {
+            dst[i] = raw[i] - prev[i];
+        }
+        for(size_t i = bpp; i < row_size; ++i) {
+            int32_t a = raw[i - bpp];
+            int32_t b = prev[i];
+            int32_t c = prev[i - bpp];
+            int32_t pa = std::abs(b - c);
+            int32_t pb = std::abs(a - c);
+            int32_t pc = std::abs(a + b - 2 * c);
+            auto predictor = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+            dst[i] = raw[i] - static_cast<uint8_t>(predictor);
+        }
+    }
+
+    static void apply(uint8_t filter, uint8_t* dst, const uint8_t* raw, const uint8_t* prev, size_t row_size, uint32_t bpp) noexcept {
+        // up/average/paeth with zero previous row
+        if(!prev) {
+            if(filter == UP) {
+                filter = NONE;
+            }
+            else if(filter == PAETH) {
+                filter = SUB;
+            }
+            else if(filter == AVERAGE) {
+                for(size_t i = 0; i < bpp && i < row_size; ++i) {
+                    dst[i] = raw[i];
+                }
+                for(size_t i = bpp; i < row_size; ++i) {
+                    dst[i] = raw[i] - (raw[i - bpp] >> 1);
+                }
+                return;
+            }
+        }
+
+        switch(filter) {
+            case SUB: sub_(dst, raw, row_size, bpp); break;
+            case UP: up_(dst, raw, prev, row_size); break;
+            case AVERAGE: average_(dst, raw, prev, row_size, bpp); break;
+            case PAETH: paeth_(dst, raw, prev, row_size, bpp); break;
+            default: std::memcpy(dst, raw, row_size); break;
+        }
+    }
+
+    // try all filters and keep cheapest one
+    // dst is row_size + 1 bytes (filter type byte first), scratch is row_size bytes
+    static void adaptive(uint8_t* dst, uint8_t* scratch, const uint8_t* raw, const uint8_t* prev, size_t row_size, uint32_t bpp) noexcept {
+        dst[0] = NONE;
+        std::memcpy(dst + 1, raw, row_size);
+        auto best_cost = cost_(dst + 1, row_size);
+
+        // first row: up and paeth are same as none and sub
+        const uint8_t candidates[] = {SUB, UP, AVERAGE, PAETH};
+        for(auto filter : candidates) {
+            if(best_cost == 0) {
+                break;
+            }
+            if(!prev && (filter == UP || filter == PAETH)) {
+                continue;
+            }
+            apply(filter, scratch, raw, prev, row_size, bpp);
+            auto cost = cost_(scratch, row_size);
+            if(cost < best_cost) {
+                best_cost = cost;
+                dst[0] = filter;
+                std::memcpy(dst + 1, scratch, row_size);
+            }
+        }
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -8,48 +8,41 @@ namespace image {
 namespace png {
 
 struct FixedHuffman {
-    CanonicalHuffman characters;
-    CanonicalHuffman distances;
+    CharacterHuffman characters;
+    DistanceHuffman distances;
 
     void init() {
-        characters.code_lengths.resize(288);
-        characters.code_counts.resize(15);
-        for(uint16_t i = 0; i < 287; ++i) {
+        std::array<uint8_t, 288> character_lengths{};
+        for(size_t i = 0; i < character_lengths.size(); ++i) {
             if(i <= 143) {
-                characters.code_lengths[i] = std::make_pair(i, 8);
-                ++characters.code_counts[7];
+                character_lengths[i] = 8;
             }
             else if(i <= 255) {
-                characters.code_lengths[i] = std::make_pair(i, 9);
-                ++characters.code_counts[8];
+                character_lengths[i] = 9;
             }
             else if(i <= 279) {
-                characters.code_lengths[i] = std::make_pair(i, 7);
-                ++characters.code_counts[6];    
+                character_lengths[i] = 7;
             }
             else {
-                characters.code_lengths[i] = std::make_pair(i, 8);
-                ++characters.code_counts[7];
+                character_lengths[i] = 8;
             }
         }
+        characters.build(character_lengths);
 
-        std::sort(characters.code_lengths.begin(), characters.code_lengths.end(),
-            [](const auto& a, const auto& b) {
-                if(a.second != b.second) {
-                    return a.second < b.second;
-                }
-                else {
-                    return a.first < b.first;
-                }
-            }
-        );
+        std::array<uint8_t, 32> distance_lengths{};
+        distance_lengths.fill(5);
+        distances.build(distance_lengths);
+    }
 
-        distances.code_lengths.resize(32);
-        distances.code_counts.resize(15);
-        for(uint16_t i = 0; i < 31; ++i) {
-            distances.code_lengths[i] = std::make_pair(i, 5);
-            ++distances.code_counts[4];
-        }
+    // tables are same for all blocks -> build only once per process
+    static const FixedHuffman& get() {
+        static const FixedHuffman fixed_huffman = []{
+            FixedHuffman table{};
+            table.init();
+            return table;
+        }();
+
+        return fixed_huffman;
     }
 };
 
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <queue>
+
+#include "utils.hpp"
+#include "BitWriter.hpp"
+
+namespace image {
+
+namespace png {
+
+// length-limited canonical Huffman code for encoder (counterpart of CanonicalHuffman)
+// codes are stored bit-reversed, so they can be written LSB-first as is
+struct HuffmanEncoder {
+    static constexpr size_t MAX_SYMBOLS = 288;
+
+    std::array<uint16_t, MAX_SYMBOLS> codes;
+    std::array<uint8_t, MAX_SYMBOLS> lengths;
+    uint32_t count;
+
+    void write(BitWriter& writer, uint32_t symbol) const {
+        writer.write_bits(codes[symbol], lengths[symbol]);
+    }
+
+    // bits needed to write all symbols (without extra bits)
+    uint64_t cost(std::span<const uint32_t> frequencies) const noexcept {
+        uint64_t bits = 0;
+        for(size_t i = 0; i < frequencies.size(); ++i) {
+            bits += uint64_t(frequencies[i]) * lengths[i];
+        }
+        return bits;
+    }
+
+    static uint16_t reverse_(uint16_t code, uint32_t length) noexcept {
+        uint16_t result = 0;
+        for(uint32_t i = 0; i < length; ++i) {
+            result = static_cast<uint16_t>((result << 1) | (code & 1));
+            code >>= 1;
+        }
+        return result;
+    }
+
+    // canonical codes from lengths (RFC 1951 3.2.2)
+    static HuffmanEncoder from_lengths(std::span<const uint8_t> lengths) {
+        HuffmanEncoder encoder{};
+        encoder.count = static_cast<uint32_t>(lengths.size());
+
+        std::array<uint16_t, 16> length_counts{};
+        for(auto length : lengths) {
+            ++length_counts[length];
+        }
+        length_counts[0] = 0;
+
+        std::array<uint16_t, 16> next_code{};
+        uint16_t code = 0;
+        for(size_t bits = 1; bits < 16; ++bits) {
+            code = static_cast<uint16_t>((code + length_counts[bits - 1]) << 1);
+            next_code[bits] = code;
+        }
+
+        for(size_t i = 0; i < lengths.size(); ++i) {
+            encoder.lengths[i] = lengths[i];
+            if(lengths[i] != 0) {
+                encoder.codes[i] = reverse_(next_code[lengths[i]]++, lengths[i]);
+            }
+        }
+
+        return encoder;
+    }
+
+    // optimal lengths for frequencies, limited to max_length bits
+    // (unused symbols get length 0, at least two symbols get a code so that code is complete)
+    // number of used symbols must be <= 2^max_length
+    static HuffmanEncoder from_frequencies(std::span<const uint32_t> frequencies, uint32_t max_length) {
+        auto count = frequencies.size();
+
+        std::vector<uint32_t> symbols{};
+        for(uint32_t i = 0; i < count; ++i) {
+            if(frequencies[i] > 0) {
+                symbols.push_back(i);
+            }
+        }
+        // deflate decoders reject single code trees -> add dummy symbol
+        for(uint32_t i = 0; symbols.size() < 2 && i < count; ++i) {
+            if(frequencies[i] == 0) {
+                symbols.push_back(i);
+            }
+        }
+
+        std::array<uint8_t, MAX_SYMBOLS> lengths{};
+
+        // Huffman tree (nodes [0, n) are leaves, parents follow)
+        auto n = symbols.size();
+        std::vector<uint64_t> weights(n);
+        std::vector<uint32_t> parents(2 * n - 1, 0);
+        using Node = std::pair<uint64_t, uint32_t>;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue{};
+        for(uint32_t i = 0; i < n; ++i) {
+            weights[i] = std::max<uint64_t>(frequencies[symbols[i]], 1);
+            queue.push({weights[i], i});
+        }
+        auto next = static_cast<uint32_t>(n);
+        while(queue.size() > 1) {
+            auto [w0, a] = queue.top();
+            queue.pop();
+            auto [w1, b] = queue.top();
+            queue.pop();
+            parents[a] = next;
+            parents[b] = next;
+            queue.push({w0 + w1, next++});
+        }
+        // depth of node = depth of parent + 1 (parents have larger index)
+        std::vector<uint32_t> depths(2 * n - 1, 0);
+        for(auto i = static_cast<int64_t>(2 * n - 3); i >= 0; --i) {
+            depths[i] = depths[parents[i]] + 1;
+        }
+
+        // limit lengths keeping Kraft sum (longer codes are shortened, then shorter ones are split)
+        std::array<uint32_t, 64> length_counts{};
+        for(uint32_t i = 0; i < n; ++i) {
+            ++length_counts[std::min(depths[i], max_length)];
+        }
+        uint64_t kraft = 0;
+        for(uint32_t bits = 1; bits <= max_length; ++bits) {
+            kraft += uint64_t(length_counts[bits]) << (max_length - bits);
+        }
+        while(kraft > (uint64_t(1) << max_length)) {
+            --length_counts[max_length];
+            for(auto bits = max_length - 1; bits > 0; --bits) {
+                if(length_counts[bits] > 0) {
+                    --length_counts[bits];
+                    length_counts[bits + 1] += 2;
+                    break;
+                }
+            }
+            --kraft;
+        }
+
+        // most frequent symbols get shortest codes
+        std::vector<uint32_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return weights[a] > weights[b]; });
+        size_t index = 0;
+        for(uint32_t bits = 1; bits <= max_length; ++bits) {
+            for(uint32_t i = 0; i < length_counts[bits]; ++i) {
+                lengths[symbols[order[index++]]] = static_cast<uint8_t>(bits);
+            }
+        }
+
+        return from_lengths(std::span<const uint8_t>(lengths.data(), count));
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -6,18 +6,42 @@ namespace image {
 
 namespace png {
 
-struct IDAT {
-    std::vector<uint8_t> data;
+// zlib stream split over consecutive IDAT chunks
+// payloads are handed out in place (file bytes are never copied)
+struct IdatStream {
+    // positioned at header of next chunk
+    io::ByteReader reader;
+
+    // next non-empty IDAT payload
+    // returns false if next chunk is not IDAT (end of image data)
+    bool next(const uint8_t*& data, size_t& size) {
+        while(reader.remaining() >= 12) {
+            auto chunk_position = reader.position();
+            auto length = reader.read_be<uint32_t>();
+            auto chunk_type = reader.read_bytes(4);
+            if(std::memcmp(chunk_type.data(), "IDAT", 4) != 0) {
+                reader.seek(chunk_position);
+                return false;
+            }
+
+            if(length > reader.remaining() - 4) {
+                throw std::runtime_error("[image::png::IdatStream] ERROR: IDAT chunk is truncated.");
+            }
+            auto payload = reader.read_bytes(length);
+            // CRC
+            reader.skip(4);
+
+            if(!payload.empty()) {
+                data = payload.data();
+                size = payload.size();
+                return true;
+            }
+        }
+
+        return false;
+    }
 };
 
-inline IDAT read_idat(std::ifstream& ifs, uint32_t length) {
-    IDAT idat{};
-    idat.data.resize(length);
-    ifs.read(reinterpret_cast<char*>(idat.data.data()), sizeof(uint8_t) * length);
-
-    return idat;
-}
-
 }
 
 }
\ No newline at end of file
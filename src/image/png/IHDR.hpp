@@ -16,16 +16,17 @@ struct IHDR {
     uint8_t interlace_method;
 };
 
-inline IHDR read_ihdr(std::ifstream& ifs) {
+// reader: IHDR chunk payload (13 bytes)
+inline IHDR read_ihdr(io::ByteReader& reader) {
     IHDR ihdr{};
 
-    read_be(ifs, ihdr.width);
-    read_be(ifs, ihdr.height);
-    read_be(ifs, ihdr.bit_depth);
-    read_be(ifs, ihdr.color_type);
-    read_be(ifs, ihdr.compression_method);
-    read_be(ifs, ihdr.filter_method);
-    read_be(ifs, ihdr.interlace_method);
+    reader.read_be(ihdr.width);
+    reader.read_be(ihdr.height);
+    reader.read_be(ihdr.bit_depth);
+    reader.read_be(ihdr.color_type);
+    reader.read_be(ihdr.compression_method);
+    reader.read_be(ihdr.filter_method);
+    reader.read_be(ihdr.interlace_method);
 
     return ihdr;
 }
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "utils.hpp"
+#include "BitReader.hpp"
+#include "LZSS.hpp"
+#include "FixedHuffman.hpp"
+#include "CustomHuffman.hpp"
+#include "Window.hpp"
+
+namespace image {
+
+namespace png {
+
+// resumable deflate decoder
+// fill() decodes only as much as requested, so caller can consume output row by row
+struct Inflate {
+    enum class State {
+        HEADER,
+        NOT_COMPRESSED,
+        HUFFMAN,
+        END,
+    };
+
+    BitReader reader;
+    Window window;
+    State state;
+    bool is_final_block;
+    uint32_t stored_remaining;
+    CustomHuffman custom_huffman;
+    const CharacterHuffman* characters;
+    const DistanceHuffman* distances;
+
+    Inflate(const BitReader& r, size_t max_request) :
+        reader(r), window(max_request), state(State::HEADER), is_final_block(false), stored_remaining(0),
+        custom_huffman{}, characters(nullptr), distances(nullptr) {}
+
+    bool finished() const noexcept { return state == State::END; }
+
+    void read_block_header_() {
+        if(is_final_block) {
+            state = State::END;
+            return;
+        }
+
+        is_final_block = bool(reader.read_bits(1));
+        auto btype = reader.read_bits(2);
+
+        // BTYPE = 0b00 -> not compressed data
+        if(btype == 0) {
+            reader.align_to_byte();
+
+            // data length 16 bits
+            uint16_t len = static_cast<uint16_t>(reader.read_bits(16));
+            // length complement
+            uint16_t nlen = static_cast<uint16_t>(reader.read_bits(16));
+            if(len != static_cast<uint16_t>(~nlen)) {
+                throw std::runtime_error("[image::png::Inflate] ERROR: corrupted non-compressed block length.");
+            }
+
+            stored_remaining = len;
+            state = State::NOT_COMPRESSED;
+        }
+        // BTYPE = 0b01 -> fixed huffman code
+        else if(btype == 1) {
+            const auto& fixed_huffman = FixedHuffman::get();
+            characters = &fixed_huffman.characters;
+            distances = &fixed_huffman.distances;
+            state = State::HUFFMAN;
+        }
+        // BTYPE = 0b10 -> custom huffman code (tables are rebuilt in place once per block)
+        else if(btype == 2) {
+            custom_huffman.read_header(reader);
+            custom_huffman.read_code_length_codes(reader);
+            custom_huffman.read_length_codes(reader);
+            characters = &custom_huffman.characters;
+            distances = &custom_huffman.distances;
+            state = State::HUFFMAN;
+        }
+        // BTYPE = 0b11 -> invalid
+        else {
+            throw std::runtime_error("[image::png::Inflate] ERROR: unknown compression type found.");
+        }
+    }
+
+    // bits past end of stream are read as 0, so output decoded from them must never reach caller
+    static void check_overrun_(const BitReader& r) {
+        if(r.overrun()) {
+            throw std::runtime_error("[image::png::Inflate] ERROR: unexpected end of deflate stream.");
+        }
+    }
+
+    void end_block_() {
+        check_overrun_(reader);
+        state = State::HEADER;
+    }
+
+    // decode symbols until window reaches target position or end of block
+    // hot state is kept in locals (byte stores through output pointer would force reloading members)
+    void decode_huffman_(size_t target) {
+        auto local_reader = reader;
+        auto out_begin = window.data.data();
+        auto out = out_begin + window.position;
+        auto out_end = out_begin + target;
+        auto literal_table = characters->table.data();
+        auto literal_root_bits = characters->root_bits;
+        auto distance_table = distances->table.data();
+        auto distance_root_bits = distances->root_bits;
+
+        bool end_of_block = false;
+        while(out < out_end) {
+            // one refill covers length code + extra bits + distance code + extra bits (<= 48 bits)
+            local_reader.refill();
+
+            auto character_code = CanonicalHuffman::decode(local_reader, literal_table, literal_root_bits);
+            // raw data
+            if(character_code < 256) {
+                *out++ = static_cast<uint8_t>(character_code);
+            }
+            // end of block
+            else if(character_code == 256) {
+                end_of_block = true;
+                break;
+            }
+            // LZSS code
+            else {
+                if(character_code > 285) {
+                    throw std::runtime_error("[image::png::Inflate] ERROR: invalid length code.");
+                }
+                auto match = LZSS::MATCH_TABLE[character_code - 257];
+                auto match_extend = local_reader.read_bits(match.second);
+
+                auto distance_code = CanonicalHuffman::decode(local_reader, distance_table, distance_root_bits);
+                if(distance_code > 29) {
+                    throw std::runtime_error("[image::png::Inflate] ERROR: invalid distance code.");
+                }
+                auto distance = LZSS::DISTANCE_TABLE[distance_code];
+                auto distance_extend = local_reader.read_bits(distance.second);
+
+                auto match_length = match.first + match_extend;
+                auto match_distance = distance.first + distance_extend;
+                if(match_distance > static_cast<size_t>(out - out_begin)) {
+                    throw std::runtime_error("[image::png::Inflate] ERROR: distance is too far back.");
+                }
+                Window::copy_match(out, match_length, match_distance);
+                out += match_length;
+            }
+        }
+
+        check_overrun_(local_reader);
+        reader = local_reader;
+        window.position = static_cast<size_t>(out - out_begin);
+        if(end_of_block) {
+            end_block_();
+        }
+    }
+
+    // decode until count bytes are available in window
+    // returns false if stream ends before that
+    bool fill(size_t count) {
+        if(window.available() >= count) {
+            return true;
+        }
+
+        window.prepare(count);
+        auto target = window.read_position + count;
+        while(window.position < target) {
+            if(state == State::HEADER) {
+                read_block_header_();
+            }
+            else if(state == State::NOT_COMPRESSED) {
+                auto copy_count = std::min<size_t>(stored_remaining, target - window.position);
+                reader.read_bytes(window.append(copy_count), copy_count);
+                check_overrun_(reader);
+                stored_remaining -= static_cast<uint32_t>(copy_count);
+                if(stored_remaining == 0) {
+                    end_block_();
+                }
+            }
+            else if(state == State::HUFFMAN) {
+                decode_huffman_(target);
+            }
+            else {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "utils.hpp"
+
+namespace image {
+
+namespace png {
+
+// palette entries are kept as RGBA (alpha is filled by tRNS chunk)
+// indices without entry decode to opaque black
+struct PLTE {
+    std::array<std::array<uint8_t, 4>, 256> entries;
+    uint32_t size;
+};
+
+inline PLTE default_plte() noexcept {
+    PLTE plte{};
+    for(auto& entry : plte.entries) {
+        entry = {0, 0, 0, 255};
+    }
+
+    return plte;
+}
+
+// reader: PLTE chunk payload
+inline void read_plte(PLTE& plte, io::ByteReader& reader) {
+    auto length = reader.size();
+    if(length == 0 || length % 3 != 0 || length > 256 * 3) {
+        throw std::runtime_error(std::format("[image::png::read_plte] ERROR: invalid palette length: {}", length));
+    }
+
+    plte.size = static_cast<uint32_t>(length / 3);
+    for(uint32_t i = 0; i < plte.size; ++i) {
+        auto rgb = reader.read_bytes(3);
+        plte.entries[i] = {rgb[0], rgb[1], rgb[2], 255};
+    }
+}
+
+}
+
+}
\ No newline at end of file
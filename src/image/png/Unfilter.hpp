@@ -0,0 +1,335 @@
+#pragma once
+
+#include <cstring>
+
+#include "utils.hpp"
+#include "../simd.hpp"
+
+namespace image {
+
+namespace png {
+
+// unfilter one scanline
+// dst may alias src at lower address, kernels read src before writing same position
+// prev is previous unfiltered row (never nullptr, first row is handled by Unfilter::row)
+// src and prev must be readable up to UNFILTER_PADDING bytes after the end of row
+using UnfilterRow = void(*)(uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size);
+
+constexpr size_t UNFILTER_PADDING = 8;
+
+// scalar kernels
+
+template<uint32_t BPP>
+inline void unfilter_sub_scalar(uint8_t* dst, const uint8_t* src, const uint8_t*, size_t row_size) {
+    for(size_t i = 0; i < BPP && i < row_size; ++i) {
+        dst[i] = src[i];
+    }
+    for(size_t i = BPP; i < row_size; ++i) {
+        dst[i] = src[i] + dst[i - BPP];
+    }
+}
+
+inline void unfilter_up_scalar(uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size) {
+    for(size_t i = 0; i < row_size; ++i) {
+        dst[i] = src[i] + prev[i];
+    }
+}
+
+template<uint32_t BPP>
+inline void unfilter_average_scalar(uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size) {
+    for(size_t i = 0; i < BPP && i < row_size; ++i) {
+        dst[i] = src[i] + (prev[i] >> 1);
+    }
+    for(size_t i = BPP; i < row_size; ++i) {
+        dst[i] = src[i] + ((dst[i - BPP] + prev[i]) >> 1);
+    }
+}
+
+// average on first row (up = 0)
+template<uint32_t BPP>
+inline void unfilter_average_first_row(uint8_t* dst, const uint8_t* src, const uint8_t*, size_t row_size) {
+    for(size_t i = 0; i < BPP && i < row_size; ++i) {
+        dst[i] = src[i];
+    }
+    for(size_t i = BPP; i < row_size; ++i) {
+        dst[i] = src[i] + (dst[i - BPP] >> 1);
+    }
+}
+
+template<uint32_t BPP>
+inline void unfilter_paeth_scalar(uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size) {
+    // first pixel: left = up_left = 0 -> predictor is up
+    for(size_t i = 0; i < BPP && i < row_size; ++i) {
+        dst[i] = src[i] + prev[i];
+    }
+    for(size_t i = BPP; i < row_size; ++i) {
+        int32_t a = dst[i - BPP];
+        int32_t b = prev[i];
+        int32_t c = prev[i - BPP];
+        // |p - a|, |p - b|, |p - c| where p = a + b - c
+        auto pa = std::abs(b - c);
+        auto pb = std::abs(a - c);
+        auto pc = std::abs(a + b - 2 * c);
+        auto predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+        dst[i] = static_cast<uint8_t>(src[i] + predictor);
+    }
+}
+
+#if defined(IMAGE_SIMD_X86)
+
+// load one pixel with single 4 or 8 bytes load (reads up to 2 bytes after the pixel, extra lanes are ignored)
+template<uint32_t BPP>
+IMAGE_TARGET("sse2") inline __m128i load_pixel_(const uint8_t* p) {
+    if constexpr(BPP <= 4) {
+        uint32_t value{};
+        std::memcpy(&value, p, sizeof(uint32_t));
+        return _mm_cvtsi32_si128(static_cast<int32_t>(value));
+    }
+    else {
+        return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    }
+}
+
+// store exactly one pixel
+template<uint32_t BPP>
+IMAGE_TARGET("sse2") inline void store_pixel_(uint8_t* p, __m128i v) {
+    if constexpr(BPP <= 4) {
+        auto value = static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+        std::memcpy(p, &value, BPP);
+    }
+    else {
+        uint64_t value{};
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&value), v);
+        std::memcpy(p, &value, BPP);
+    }
+}
+
+IMAGE_TARGET("sse2") inline void unfilter_up_sse2(uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size) {
+    size_t i = 0;
+    for(; i + 16 <= row_size; i += 16) {
+        auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi8(x, b));
+    }
+    for(; i < row_size; ++i) {
+        dst[i] = src[i] + prev[i];
+    }
+}
+
+IMAGE_TARGET("avx2") inline void unfilter_up_avx2(uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size) {
+    size_t i = 0;
+    for(; i + 32 <= row_size; i += 32) {
+        auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi8(x, b));
+    }
+    for(; i < row_size; ++i) {
+        dst[i] = src[i] + prev[i];
+    }
+}
+
+// prefix sum of pixels in 16 bytes block (log steps), carry = last pixel of previous block
+template<uint32_t BPP>
+IMAGE_TARGET("sse2") inline void unfilter_sub_sse2(uint8_t* dst, const uint8_t* src, const uint8_t*, size_t row_size) {
+    constexpr uint32_t BLOCK = (16 / BPP) * BPP;
+
+    auto carry = _mm_setzero_si128();
+    size_t i = 0;
+    for(; i + 16 <= row_size; i += BLOCK) {
+        auto x = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), carry);
+        x = _mm_add_epi8(x, _mm_slli_si128(x, BPP));
+        if constexpr(BPP * 2 < 16) { x = _mm_add_epi8(x, _mm_slli_si128(x, BPP * 2)); }
+        if constexpr(BPP * 4 < 16) { x = _mm_add_epi8(x, _mm_slli_si128(x, BPP * 4)); }
+        if constexpr(BPP * 8 < 16) { x = _mm_add_epi8(x, _mm_slli_si128(x, BPP * 8)); }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), x);
+        carry = _mm_srli_si128(_mm_slli_si128(x, 16 - BLOCK), 16 - BPP);
+    }
+    for(; i < row_size; ++i) {
+        auto left = i >= BPP ? dst[i - BPP] : 0;
+        dst[i] = src[i] + left;
+    }
+}
+
+// one pixel per step, left pixel stays in register (first column starts with zero)
+template<uint32_t BPP>
+IMAGE_TARGET("sse2") inline void unfilter_average_sse2(uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size) {
+    const auto one = _mm_set1_epi8(1);
+    auto a = _mm_setzero_si128();
+    for(size_t i = 0; i + BPP <= row_size; i += BPP) {
+        auto b = load_pixel_<BPP>(prev + i);
+        auto x = load_pixel_<BPP>(src + i);
+        // avg_epu8 rounds up -> subtract carried bit
+        auto average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+        a = _mm_add_epi8(x, average);
+        store_pixel_<BPP>(dst + i, a);
+    }
+}
+
+// paeth in 16-bit lanes, takes pa = |b - c|, pb = |a - c|, pc = |a + b - 2c|
+IMAGE_TARGET("sse2") inline __m128i paeth_predictor_sse2_(__m128i a, __m128i b, __m128i c, __m128i pa, __m128i pb, __m128i pc) {
+    // b if pb <= pc else c
+    auto mask = _mm_cmplt_epi16(pc, pb);
+    auto t = _mm_or_si128(_mm_and_si128(mask, c), _mm_andnot_si128(mask, b));
+    // a if pa <= min(pb, pc) else t
+    mask = _mm_cmplt_epi16(_mm_min_epi16(pb, pc), pa);
+    return _mm_or_si128(_mm_and_si128(mask, t), _mm_andnot_si128(mask, a));
+}
+
+// one pixel per step, left and up-left pixels stay in register (first column starts with zero)
+template<uint32_t BPP>
+IMAGE_TARGET("sse2") inline void unfilter_paeth_sse2(uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size) {
+    const auto zero = _mm_setzero_si128();
+    auto a = zero;
+    auto c = zero;
+    for(size_t i = 0; i + BPP <= row_size; i += BPP) {
+        auto b = _mm_unpacklo_epi8(load_pixel_<BPP>(prev + i), zero);
+        auto x = load_pixel_<BPP>(src + i);
+
+        auto pa = _mm_sub_epi16(b, c);
+        auto pb = _mm_sub_epi16(a, c);
+        auto pc = _mm_add_epi16(pa, pb);
+        // no abs instruction in SSE2
+        pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+        pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+        pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+        auto predictor = paeth_predictor_sse2_(a, b, c, pa, pb, pc);
+        auto result = _mm_add_epi8(x, _mm_packus_epi16(predictor, predictor));
+        store_pixel_<BPP>(dst + i, result);
+
+        a = _mm_unpacklo_epi8(result, zero);
+        c = b;
+    }
+}
+
+template<uint32_t BPP>
+IMAGE_TARGET("ssse3") inline void unfilter_paeth_ssse3(uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size) {
+    const auto zero = _mm_setzero_si128();
+    auto a = zero;
+    auto c = zero;
+    for(size_t i = 0; i + BPP <= row_size; i += BPP) {
+        auto b = _mm_unpacklo_epi8(load_pixel_<BPP>(prev + i), zero);
+        auto x = load_pixel_<BPP>(src + i);
+
+        auto pa = _mm_sub_epi16(b, c);
+        auto pb = _mm_sub_epi16(a, c);
+        auto pc = _mm_add_epi16(pa, pb);
+        pa = _mm_abs_epi16(pa);
+        pb = _mm_abs_epi16(pb);
+        pc = _mm_abs_epi16(pc);
+
+        auto predictor = paeth_predictor_sse2_(a, b, c, pa, pb, pc);
+        auto result = _mm_add_epi8(x, _mm_packus_epi16(predictor, predictor));
+        store_pixel_<BPP>(dst + i, result);
+
+        a = _mm_unpacklo_epi8(result, zero);
+        c = b;
+    }
+}
+
+#endif
+
+// kernel set for one pixel size
+struct Unfilter {
+    uint32_t bpp;
+    UnfilterRow sub;
+    UnfilterRow up;
+    UnfilterRow average;
+    UnfilterRow average_first_row;
+    UnfilterRow paeth;
+
+    template<uint32_t BPP>
+    static Unfilter select_() {
+        Unfilter unfilter{
+            .bpp = BPP,
+            .sub = unfilter_sub_scalar<BPP>,
+            .up = unfilter_up_scalar,
+            .average = unfilter_average_scalar<BPP>,
+            .average_first_row = unfilter_average_first_row<BPP>,
+            .paeth = unfilter_paeth_scalar<BPP>,
+        };
+
+#if defined(IMAGE_SIMD_X86)
+        const auto& features = simd::features();
+        if(features.sse2) {
+            unfilter.sub = unfilter_sub_sse2<BPP>;
+            unfilter.up = unfilter_up_sse2;
+            // one byte per step is not worth to vectorize
+            if constexpr(BPP >= 3) {
+                unfilter.average = unfilter_average_sse2<BPP>;
+                unfilter.paeth = unfilter_paeth_sse2<BPP>;
+            }
+        }
+        if(features.ssse3) {
+            if constexpr(BPP >= 3) {
+                unfilter.paeth = unfilter_paeth_ssse3<BPP>;
+            }
+        }
+        if(features.avx2) {
+            unfilter.up = unfilter_up_avx2;
+        }
+#endif
+
+        return unfilter;
+    }
+
+    // bpp: bytes per complete pixel (rounded up to 1 for bit depth < 8)
+    static Unfilter select(uint32_t bpp) {
+        switch(bpp) {
+            case 1: return select_<1>();
+            case 2: return select_<2>();
+            case 3: return select_<3>();
+            case 4: return select_<4>();
+            case 6: return select_<6>();
+            case 8: return select_<8>();
+            default:
+                throw std::runtime_error(std::format("[image::png::Unfilter::select] ERROR: unsupported bytes per pixel: {}", bpp));
+        }
+    }
+
+    // prev = nullptr for first row
+    void row(uint8_t filter, uint8_t* dst, const uint8_t* src, const uint8_t* prev, size_t row_size) const {
+        // none
+        if(filter == 0) {
+            std::memmove(dst, src, row_size);
+        }
+        // sub
+        else if(filter == 1) {
+            sub(dst, src, prev, row_size);
+        }
+        // up
+        else if(filter == 2) {
+            if(prev) {
+                up(dst, src, prev, row_size);
+            }
+            else {
+                std::memmove(dst, src, row_size);
+            }
+        }
+        // average
+        else if(filter == 3) {
+            if(prev) {
+                average(dst, src, prev, row_size);
+            }
+            else {
+                average_first_row(dst, src, prev, row_size);
+            }
+        }
+        // paeth (on first row, predictor is always left)
+        else if(filter == 4) {
+            if(prev) {
+                paeth(dst, src, prev, row_size);
+            }
+            else {
+                sub(dst, src, prev, row_size);
+            }
+        }
+        else {
+            throw std::runtime_error(std::format("[image::png::Unfilter::row] ERROR: unknown filter type: {}", filter));
+        }
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstring>
+
+#include "utils.hpp"
+
+namespace image {
+
+namespace png {
+
+// sliding output window of inflate
+// scanlines are stored as is (filter byte + filtered row) until consumed by unfilter,
+// and last 32KB are kept for back references
+struct Window {
+    // max distance of back reference
+    static constexpr size_t HISTORY = 32768;
+    static constexpr size_t MAX_MATCH = 258;
+    // wide copy may write up to this many bytes after the end of match
+    static constexpr size_t SLACK = 16;
+
+    std::vector<uint8_t> data;
+    size_t position;
+    size_t read_position;
+    size_t max_request;
+
+    // max_request: max bytes requested at once by prepare()
+    // extra history makes sliding rare (moves at most 32KB per 96KB output)
+    explicit Window(size_t max_request) :
+        data(4 * HISTORY + 2 * (max_request + MAX_MATCH) + SLACK), position(0), read_position(0), max_request(max_request) {}
+
+    auto available() const noexcept { return position - read_position; }
+    const uint8_t* read_data() const noexcept { return data.data() + read_position; }
+    void consume(size_t count) noexcept { read_position += count; }
+
+    // make room to produce count bytes after read_position (+ one match overshoot)
+    void prepare(size_t count) {
+        if(count > max_request) {
+            throw std::runtime_error("[image::png::Window::prepare] ERROR: request exceeds window size.");
+        }
+        if(read_position + count + MAX_MATCH + SLACK > data.size()) {
+            // keep unconsumed bytes and history
+            auto keep_from = std::min(read_position, position > HISTORY ? position - HISTORY : 0);
+            std::memmove(data.data(), data.data() + keep_from, position - keep_from);
+            position -= keep_from;
+            read_position -= keep_from;
+        }
+    }
+
+    // caller guarantees space by prepare()
+    void put(uint8_t value) noexcept {
+        data[position++] = value;
+    }
+
+    // returns pointer to write count bytes directly
+    uint8_t* append(size_t count) noexcept {
+        auto dst = data.data() + position;
+        position += count;
+        return dst;
+    }
+
+    void copy_match(uint32_t length, uint32_t distance) {
+        if(distance > position) {
+            throw std::runtime_error("[image::png::Window::copy_match] ERROR: distance is too far back.");
+        }
+        copy_match(data.data() + position, length, distance);
+        position += length;
+    }
+
+    // LZ77 copy to dst from dst - distance
+    static void copy_match(uint8_t* dst, uint32_t length, uint32_t distance) noexcept {
+        auto src = dst - distance;
+
+        // run of one byte
+        if(distance == 1) {
+            std::memset(dst, *src, length);
+        }
+        // chunks never overlap within one copy, later chunks read bytes written by earlier ones
+        else if(distance >= 16) {
+            for(uint32_t i = 0; i < length; i += 16) {
+                std::memcpy(dst + i, src + i, 16);
+            }
+        }
+        else if(distance >= 8) {
+            for(uint32_t i = 0; i < length; i += 8) {
+                std::memcpy(dst + i, src + i, 8);
+            }
+        }
+        // short period: copy one period, then double copied pattern
+        else {
+            uint32_t copied = std::min(length, distance);
+            std::memcpy(dst, src, copied);
+            while(copied < length) {
+                auto count = std::min(copied, length - copied);
+                std::memcpy(dst + copied, dst, count);
+                copied += count;
+            }
+        }
+    }
+};
+
+}
+
+}
\ No newline at end of file
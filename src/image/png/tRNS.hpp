@@ -0,0 +1,58 @@
+#pragma once
+
+#include "utils.hpp"
+#include "IHDR.hpp"
+#include "PLTE.hpp"
+
+namespace image {
+
+namespace png {
+
+// transparent color key for gray scale / RGB images
+// (key is compared with raw samples before scaling)
+struct tRNS {
+    bool has_key;
+    std::array<uint16_t, 3> key;
+};
+
+// reader: tRNS chunk payload
+// for indexed color, alpha values are written to palette entries
+inline tRNS read_trns(const IHDR& ihdr, PLTE& plte, io::ByteReader& reader) {
+    tRNS trns{};
+    auto length = reader.size();
+
+    // gray scale
+    if(ihdr.color_type == 0) {
+        if(length != 2) {
+            throw std::runtime_error("[image::png::read_trns] ERROR: invalid tRNS length for gray scale image.");
+        }
+        trns.has_key = true;
+        reader.read_be(trns.key[0]);
+    }
+    // RGB
+    else if(ihdr.color_type == 2) {
+        if(length != 6) {
+            throw std::runtime_error("[image::png::read_trns] ERROR: invalid tRNS length for RGB image.");
+        }
+        trns.has_key = true;
+        for(uint32_t i = 0; i < 3; ++i) {
+            reader.read_be(trns.key[i]);
+        }
+    }
+    // indexed color
+    else if(ihdr.color_type == 3) {
+        if(plte.size == 0 || length > plte.size) {
+            throw std::runtime_error("[image::png::read_trns] ERROR: invalid tRNS length for indexed color image.");
+        }
+        for(size_t i = 0; i < length; ++i) {
+            reader.read_be(plte.entries[i][3]);
+        }
+    }
+    // images with alpha channel must not have tRNS (ignored)
+
+    return trns;
+}
+
+}
+
+}
\ No newline at end of file
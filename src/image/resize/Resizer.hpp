@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../mip/Resample.hpp"
+#include "../pixel/Converter.hpp"
+#include "../../concurrency/ThreadPool.hpp"
+
+namespace image {
+
+namespace resize {
+
+struct Options {
+    mip::Filter filter = mip::Filter::mitchell;
+    // bytes between source rows (0: tightly packed)
+    size_t row_pitch = 0;
+    // color channels of 8 and 16 bits images are sRGB encoded (filtered in linear space, alpha is always linear)
+    bool is_srgb = false;
+    // source repeats at edges (tiling texture), otherwise edge pixels are extended
+    bool wrap = false;
+};
+
+// size which fits in max_dimension x max_dimension with aspect ratio kept (as is if it already fits or max_dimension is 0)
+inline std::pair<uint32_t, uint32_t> fit(uint32_t width, uint32_t height, uint32_t max_dimension) noexcept {
+    if(max_dimension == 0 || (width <= max_dimension && height <= max_dimension)) {
+        return {width, height};
+    }
+    auto scale = static_cast<double>(max_dimension) / std::max(width, height);
+    auto fitted_width = static_cast<uint32_t>(std::clamp(std::lround(width * scale), 1l, static_cast<long>(max_dimension)));
+    auto fitted_height = static_cast<uint32_t>(std::clamp(std::lround(height * scale), 1l, static_cast<long>(max_dimension)));
+    return {fitted_width, fitted_height};
+}
+
+// separable resampler of uncompressed images to any size (minifying and magnifying, see mip::Kernel)
+// rows are converted to linear RGBA floats (SIMD kernels for 8 bits, 16 bits and float without sRGB),
+// filtered horizontally then vertically by SIMD RGBA passes, and converted back to format
+// destination rows are split to bands on pool, a band keeps ring of horizontally filtered source rows its own rows need
+class Resizer {
+    Format format_;
+    pixel::Converter load_;
+    pixel::Converter store_;
+
+public:
+    Resizer(Format format, bool is_srgb) :
+        format_(format),
+        load_(pixel::Converter::select(format, Format::RGBA32F, pixel::Options{is_srgb, false})),
+        store_(pixel::Converter::select(Format::RGBA32F, format, pixel::Options{is_srgb, false})) {}
+
+    // do not call from task on the same pool (waits for band tasks)
+    void resize(std::span<const uint8_t> src, uint32_t src_width, uint32_t src_height, std::span<uint8_t> dst, size_t dst_pitch, uint32_t dst_width, uint32_t dst_height, const Options& options = {}, concurrency::ThreadPool* pool = nullptr) const {
+        if(src_width == 0 || src_height == 0 || dst_width == 0 || dst_height == 0) {
+            throw std::runtime_error(std::format("[image::resize::Resizer] ERROR: invalid image size: {} x {} -> {} x {}", src_width, src_height, dst_width, dst_height));
+        }
+        auto source_info = ImageInfo::make(src_width, src_height, format_);
+        auto src_pitch = options.row_pitch ? options.row_pitch : source_info.row_pitch;
+        if(src_pitch < source_info.row_pitch || src.size() < source_info.size(src_pitch)) {
+            throw std::runtime_error(std::format("[image::resize::Resizer] ERROR: source is too small (size = {}, pitch = {}, image = {} x {}).", src.size(), src_pitch, src_width, src_height));
+        }
+        ImageInfo::make(dst_width, dst_height, format_).check_destination(dst, dst_pitch);
+
+        auto resampler = mip::Resampler::select(4);
+        auto kernel_x = mip::Kernel::make(options.filter, src_width, dst_width, options.wrap);
+        auto kernel_y = mip::Kernel::make(options.filter, src_height, dst_height, options.wrap);
+        auto tap_count = kernel_y.tap_count;
+        auto src_floats = size_t(src_width) * 4;
+        auto dst_floats = size_t(dst_width) * 4;
+
+        auto task_count = pool ? std::min(dst_height, pool->thread_count() * 4) : 1;
+        concurrency::parallel_for(pool, task_count, [&](uint32_t task) {
+            auto first = static_cast<uint32_t>(uint64_t(dst_height) * task / task_count);
+            auto last = static_cast<uint32_t>(uint64_t(dst_height) * (task + 1) / task_count);
+
+            // ring of horizontally filtered source rows, slot is unwrapped source row modulo ring size (as in mip::Generator)
+            auto ring_size = tap_count * 2;
+            std::vector<float> filtered(size_t(ring_size) * dst_floats);
+            std::vector<int64_t> tags(ring_size, std::numeric_limits<int64_t>::min());
+            std::vector<float> source_row(src_floats);
+            std::vector<float> row(dst_floats);
+            std::vector<const float*> rows(tap_count);
+
+            for(uint32_t y = first; y < last; ++y) {
+                for(uint32_t k = 0; k < tap_count; ++k) {
+                    auto unwrapped = kernel_y.firsts[y] + k;
+                    auto slot = static_cast<size_t>(((unwrapped % ring_size) + ring_size) % ring_size);
+                    auto filtered_row = filtered.data() + slot * dst_floats;
+                    if(tags[slot] != unwrapped) {
+                        tags[slot] = unwrapped;
+                        auto source_y = kernel_y.indices[size_t(y) * tap_count + k];
+                        load_.convert(src.data() + source_y * src_pitch, reinterpret_cast<uint8_t*>(source_row.data()), src_width);
+                        resampler.row(source_row.data(), kernel_x, filtered_row, dst_width);
+                    }
+                    rows[k] = filtered_row;
+                }
+                resampler.columns(rows.data(), kernel_y.weights.data() + size_t(y) * tap_count, tap_count, row.data(), dst_floats);
+                store_.convert(reinterpret_cast<const uint8_t*>(row.data()), dst.data() + y * dst_pitch, dst_width);
+            }
+        });
+    }
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+
+// x86 SIMD support
+// kernels are compiled with target attribute and selected at runtime by features()
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IMAGE_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define IMAGE_TARGET(features)
+#else
+#include <cpuid.h>
+#define IMAGE_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+namespace image {
+
+namespace simd {
+
+struct Features {
+    bool sse2;
+    bool ssse3;
+    bool sse41;
+    bool pclmul;
+    bool avx2;
+    bool f16c;
+};
+
+inline Features detect_features_() noexcept {
+    Features features{};
+#if defined(IMAGE_SIMD_X86)
+    uint32_t leaf1[4]{};
+    uint32_t leaf7[4]{};
+    uint32_t max_leaf{};
+#if defined(_MSC_VER) && !defined(__clang__)
+    int32_t regs[4]{};
+    __cpuid(regs, 0);
+    max_leaf = regs[0];
+    __cpuid(regs, 1);
+    for(int i = 0; i < 4; ++i) { leaf1[i] = regs[i]; }
+    if(max_leaf >= 7) {
+        __cpuidex(regs, 7, 0);
+        for(int i = 0; i < 4; ++i) { leaf7[i] = regs[i]; }
+    }
+#else
+    uint32_t unused{};
+    __cpuid(0, max_leaf, unused, unused, unused);
+    __cpuid(1, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+    if(max_leaf >= 7) {
+        __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+    }
+#endif
+    // leaf 1: EDX[26] SSE2, ECX[9] SSSE3, ECX[19] SSE4.1, ECX[1] PCLMULQDQ, ECX[27] OSXSAVE, ECX[28] AVX, ECX[29] F16C
+    features.sse2 = leaf1[3] & (1u << 26);
+    features.ssse3 = leaf1[2] & (1u << 9);
+    features.sse41 = leaf1[2] & (1u << 19);
+    features.pclmul = leaf1[2] & (1u << 1);
+
+    // AVX state must be enabled by OS (XCR0[2:1])
+    bool os_avx = false;
+    if((leaf1[2] & (1u << 27)) && (leaf1[2] & (1u << 28))) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        uint64_t xcr0 = _xgetbv(0);
+#else
+        uint32_t eax{}, edx{};
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        uint64_t xcr0 = (uint64_t(edx) << 32) | eax;
+#endif
+        os_avx = (xcr0 & 0x6) == 0x6;
+    }
+    // leaf 7: EBX[5] AVX2
+    features.avx2 = os_avx && (leaf7[1] & (1u << 5));
+    features.f16c = os_avx && (leaf1[2] & (1u << 29));
+#endif
+    return features;
+}
+
+// detected once per process
+inline const Features& features() noexcept {
+    static const Features detected = detect_features_();
+    return detected;
+}
+
+}
+
+}
\ No newline at end of file
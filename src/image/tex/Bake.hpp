@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../BC.hpp"
+#include "../Mip.hpp"
+#include "../Convert.hpp"
+#include "../Resize.hpp"
+
+namespace image {
+
+namespace tex {
+
+struct BakeOptions {
+    // stored format: R8, RG8, RGB8, RGBA8, BGRA8, float or half formats, BC1-BC5 or BC7
+    Format format = Format::RGBA8;
+    // color channels are sRGB encoded (mips are filtered in linear space, *_SRGB format is stored unless format is float)
+    bool is_srgb = false;
+    // false: top level only
+    bool generate_mips = true;
+    // 0: no limit, otherwise larger side of source is scaled down to it before mips are generated (aspect ratio kept)
+    uint32_t max_dimension = 0;
+    // filter, wrap and alpha_cutoff of mip generation (mip_count, row_pitch and is_srgb are set by baking)
+    mip::Options mip{};
+    bc::Quality quality = bc::Quality::normal;
+    // deflate level of payload (0: stored as is, subresources are views of mapped file)
+    uint32_t compression_level = 0;
+};
+
+// baked subresources (one layer) in dds::Layout order
+struct Baked {
+    dds::Layout layout;
+    std::vector<uint8_t> payload;
+    bool is_srgb;
+};
+
+// format of mip generation (block compressed formats are encoded from RGBA8, half formats are filtered as floats)
+constexpr Format working_format_(Format format) noexcept {
+    switch(format) {
+        case Format::R16F: return Format::R32F;
+        case Format::RG16F: return Format::RG32F;
+        case Format::RGBA16F: return Format::RGBA32F;
+        default: return is_block_compressed(format) ? Format::RGBA8 : format;
+    }
+}
+
+// decoded source -> working format (see convert()) -> size budget -> mips (filtered in linear space if sRGB) -> stored format of each level
+// do not call from task on the same pool
+inline Baked bake(std::span<const uint8_t> data, uint32_t width, uint32_t height, Format source_format, const BakeOptions& options, concurrency::ThreadPool* pool = nullptr) {
+    auto format = options.format;
+    auto working_format = working_format_(format);
+    // float formats are linear (8 and 16 bits sRGB sources are decoded when converted to them)
+    bool is_srgb = options.is_srgb && !is_float(format);
+    std::vector<uint8_t> converted{};
+    std::span<const uint8_t> pixels = data;
+    if(source_format != working_format) {
+        converted.resize(ImageInfo::make(width, height, working_format).size());
+        convert(source_format, working_format, data, row_pitch(source_format, width), converted, row_pitch(working_format, width), width, height, pixel::Options{options.is_srgb, false});
+        pixels = converted;
+    }
+    // size budget is applied in working format (filtered in linear space if sRGB, as mips are)
+    auto [fitted_width, fitted_height] = resize::fit(width, height, options.max_dimension);
+    if(fitted_width != width || fitted_height != height) {
+        resize::Options resize_options{};
+        resize_options.is_srgb = is_srgb;
+        resize_options.wrap = options.mip.wrap;
+        converted = Resize::resize(pixels, width, height, working_format, fitted_width, fitted_height, resize_options, pool);
+        pixels = converted;
+        width = fitted_width;
+        height = fitted_height;
+    }
+
+    auto mip_options = options.mip;
+    mip_options.mip_count = options.generate_mips ? 0 : 1;
+    mip_options.row_pitch = 0;
+    mip_options.is_srgb = is_srgb;
+    auto chain = Mip::generate(pixels, width, height, working_format, mip_options, pool);
+    if(format == working_format) {
+        return Baked{std::move(chain.layout), std::move(chain.data), is_srgb};
+    }
+
+    Baked baked{dds::Layout::make(format, width, height, 1, chain.layout.mip_count, 1, false, std::numeric_limits<size_t>::max()), {}, is_srgb};
+    baked.payload.resize(baked.layout.size);
+    bc::EncodeOptions encode_options{};
+    encode_options.quality = options.quality;
+    encode_options.is_srgb = is_srgb;
+    for(uint32_t mip = 0; mip < chain.layout.mip_count; ++mip) {
+        const auto& level = chain.layout.subresource(mip, 0);
+        const auto& target = baked.layout.subresource(mip, 0);
+        auto source = std::span<const uint8_t>(chain.data).subspan(level.offset, level.size);
+        auto destination = std::span<uint8_t>(baked.payload).subspan(target.offset, target.size);
+        if(is_block_compressed(format)) {
+            auto result = BC::encode(source, level.width, level.height, working_format, format, encode_options, pool);
+            std::memcpy(destination.data(), result.blocks.data(), target.size);
+        }
+        else {
+            convert(working_format, format, source, destination);
+        }
+    }
+    return baked;
+}
+
+}
+
+}
\ No newline at end of file
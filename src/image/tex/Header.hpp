@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../common.hpp"
+#include "../../io/ByteReader.hpp"
+
+namespace image {
+
+namespace tex {
+
+// baked texture file (little endian)
+//   Header (64 bytes)
+//   subresource table: mip_count * layer_count entries of {uint64 offset, uint64 size} in dds::Layout order
+//   chunk table (compressed payload only): chunk_count entries of uint64 end of chunk (from payload_offset)
+//   padding to payload_offset (multiple of PAYLOAD_ALIGNMENT)
+//   payload: subresources as in dds::Layout, stored as is or as raw deflate streams of chunk_size bytes each
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t dxgi_format;
+    uint32_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t mip_count;
+    // 6 per cube
+    uint32_t layer_count;
+    // uncompressed bytes per chunk (0: payload is not compressed)
+    uint32_t chunk_size;
+    uint32_t chunk_count;
+    // size budget of baking (BakeOptions::max_dimension, 0: none)
+    uint32_t max_dimension;
+    uint64_t payload_offset;
+    // uncompressed
+    uint64_t payload_size;
+};
+
+constexpr uint32_t MAGIC = 'C' | ('T' << 8) | ('E' << 16) | ('X' << 24);
+// 2: max_dimension (reserved in 1, so caches of version 1 are baked again)
+constexpr uint32_t VERSION = 2;
+constexpr uint32_t FLAG_CUBE = 0x1;
+constexpr uint32_t FLAG_SRGB = 0x2;
+constexpr size_t HEADER_SIZE = 64;
+// payload starts at multiple of this (block and copy alignment of GPU upload)
+constexpr size_t PAYLOAD_ALIGNMENT = 256;
+
+inline Header read_header(io::ByteReader& reader) {
+    Header header{};
+
+    reader.read_le(header.magic);
+    reader.read_le(header.version);
+    reader.read_le(header.dxgi_format);
+    reader.read_le(header.flags);
+    reader.read_le(header.width);
+    reader.read_le(header.height);
+    reader.read_le(header.depth);
+    reader.read_le(header.mip_count);
+    reader.read_le(header.layer_count);
+    reader.read_le(header.chunk_size);
+    reader.read_le(header.chunk_count);
+    reader.read_le(header.max_dimension);
+    reader.read_le(header.payload_offset);
+    reader.read_le(header.payload_size);
+
+    return header;
+}
+
+inline void write_header(std::vector<uint8_t>& out, const Header& header) {
+    const uint32_t fields[] = {
+        header.magic, header.version, header.dxgi_format, header.flags, header.width, header.height, header.depth, header.mip_count,
+        header.layer_count, header.chunk_size, header.chunk_count, header.max_dimension,
+    };
+    for(auto field : fields) {
+        uint8_t bytes[4];
+        io::store_le(bytes, field);
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+    for(auto field : {header.payload_offset, header.payload_size}) {
+        uint8_t bytes[8];
+        io::store_le(bytes, field);
+        out.insert(out.end(), bytes, bytes + 8);
+    }
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "common.hpp"
+
+namespace io {
+
+template<typename T>
+constexpr T byteswap(T value) noexcept {
+    static_assert(std::is_integral_v<T>, "[io::byteswap] ERROR: integral type is expected.");
+
+    if constexpr(sizeof(T) == 1) {
+        return value;
+    }
+    else {
+        auto bytes = std::bit_cast<std::array<uint8_t, sizeof(T)>>(value);
+        std::reverse(bytes.begin(), bytes.end());
+        return std::bit_cast<T>(bytes);
+    }
+}
+
+// unsigned integer type which has same size as T
+template<typename T>
+using Bits = std::conditional_t<sizeof(T) == 1, uint8_t,
+             std::conditional_t<sizeof(T) == 2, uint16_t,
+             std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+// read arithmetic (or enum) value stored in given byte order from unaligned pointer
+template<typename T, std::endian ORDER>
+T load(const uint8_t* src) noexcept {
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "[io::load] ERROR: arithmetic type is expected.");
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "[io::load] ERROR: unexpected byte size.");
+
+    Bits<T> bits{};
+    std::memcpy(&bits, src, sizeof(T));
+    if constexpr(ORDER != std::endian::native) {
+        bits = byteswap(bits);
+    }
+
+    return std::bit_cast<T>(bits);
+}
+
+template<typename T>
+T load_be(const uint8_t* src) noexcept { return load<T, std::endian::big>(src); }
+
+template<typename T>
+T load_le(const uint8_t* src) noexcept { return load<T, std::endian::little>(src); }
+
+// write arithmetic (or enum) value in given byte order to unaligned pointer
+template<typename T, std::endian ORDER>
+void store(uint8_t* dst, T value) noexcept {
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "[io::store] ERROR: arithmetic type is expected.");
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "[io::store] ERROR: unexpected byte size.");
+
+    auto bits = std::bit_cast<Bits<T>>(value);
+    if constexpr(ORDER != std::endian::native) {
+        bits = byteswap(bits);
+    }
+    std::memcpy(dst, &bits, sizeof(T));
+}
+
+template<typename T>
+void store_be(uint8_t* dst, T value) noexcept { store<T, std::endian::big>(dst, value); }
+
+template<typename T>
+void store_le(uint8_t* dst, T value) noexcept { store<T, std::endian::little>(dst, value); }
+
+// bounds-checked cursor over bytes (e.g. MappedFile::bytes(), does not own them)
+// every read throws std::runtime_error instead of reading past the end
+class ByteReader {
+    const uint8_t* data_;
+    size_t size_;
+    size_t position_;
+
+    void check_(size_t count) const {
+        if(count > size_ - position_) {
+            throw std::runtime_error(std::format("[io::ByteReader] ERROR: unexpected end of data (position = {}, count = {}, size = {}).", position_, count, size_));
+        }
+    }
+
+    template<typename T, std::endian ORDER>
+    T read_() {
+        check_(sizeof(T));
+        auto value = load<T, ORDER>(data_ + position_);
+        position_ += sizeof(T);
+        return value;
+    }
+
+    template<typename T, std::endian ORDER>
+    void read_array_(std::span<T> dst) {
+        static_assert(std::is_arithmetic_v<T>, "[io::ByteReader] ERROR: arithmetic type is expected.");
+
+        check_(dst.size_bytes());
+        std::memcpy(dst.data(), data_ + position_, dst.size_bytes());
+        position_ += dst.size_bytes();
+        if constexpr(sizeof(T) > 1 && ORDER != std::endian::native) {
+            for(auto& value : dst) {
+                value = std::bit_cast<T>(byteswap(std::bit_cast<Bits<T>>(value)));
+            }
+        }
+    }
+
+public:
+    ByteReader() noexcept : data_(nullptr), size_(0), position_(0) {}
+    explicit ByteReader(std::span<const uint8_t> bytes) noexcept : data_(bytes.data()), size_(bytes.size()), position_(0) {}
+
+    size_t size() const noexcept { return size_; }
+    size_t position() const noexcept { return position_; }
+    size_t remaining() const noexcept { return size_ - position_; }
+    bool at_end() const noexcept { return position_ == size_; }
+    // pointer to current position
+    const uint8_t* data() const noexcept { return data_ + position_; }
+    std::span<const uint8_t> bytes() const noexcept { return {data_, size_}; }
+
+    void seek(size_t position) {
+        if(position > size_) {
+            throw std::runtime_error(std::format("[io::ByteReader] ERROR: seek out of range (position = {}, size = {}).", position, size_));
+        }
+        position_ = position;
+    }
+
+    void skip(size_t count) {
+        check_(count);
+        position_ += count;
+    }
+
+    // reader over [offset, offset + count) of whole bytes
+    ByteReader sub_reader(size_t offset, size_t count) const {
+        if(offset > size_ || count > size_ - offset) {
+            throw std::runtime_error(std::format("[io::ByteReader] ERROR: range out of data (offset = {}, count = {}, size = {}).", offset, count, size_));
+        }
+        return ByteReader({data_ + offset, count});
+    }
+
+    uint8_t peek() const {
+        check_(1);
+        return data_[position_];
+    }
+
+    // view of next count bytes (no copy)
+    std::span<const uint8_t> read_bytes(size_t count) {
+        check_(count);
+        auto bytes = std::span<const uint8_t>(data_ + position_, count);
+        position_ += count;
+        return bytes;
+    }
+
+    void copy_bytes(void* dst, size_t count) {
+        check_(count);
+        std::memcpy(dst, data_ + position_, count);
+        position_ += count;
+    }
+
+    template<typename T>
+    T read_be() { return read_<T, std::endian::big>(); }
+
+    template<typename T>
+    T read_le() { return read_<T, std::endian::little>(); }
+
+    template<typename T>
+    void read_be(T& dst) { dst = read_be<T>(); }
+
+    template<typename T>
+    void read_le(T& dst) { dst = read_le<T>(); }
+
+    // bulk read of arrays
+    template<typename T, size_t N>
+    void read_be(std::span<T, N> dst) { read_array_<T, std::endian::big>(dst); }
+
+    template<typename T, size_t N>
+    void read_le(std::span<T, N> dst) { read_array_<T, std::endian::little>(dst); }
+
+    // raw copy of trivially copyable data stored in host order (e.g. little endian float vectors)
+    template<typename T>
+    void read(T& dst) {
+        static_assert(std::is_trivially_copyable_v<T>, "[io::ByteReader::read] ERROR: trivially copyable type is expected.");
+        copy_bytes(&dst, sizeof(T));
+    }
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "MappedFile.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace io {
+
+MappedFile::MappedFile(const std::filesystem::path& path) : data_(nullptr), size_(0), mapping_(nullptr) {
+#if defined(_WIN32)
+    auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER file_size{};
+        if(GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+            auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(mapping) {
+                auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                // view keeps mapping alive
+                CloseHandle(mapping);
+                if(view) {
+                    data_ = static_cast<const uint8_t*>(view);
+                    size_ = static_cast<size_t>(file_size.QuadPart);
+                    mapping_ = view;
+                }
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if(fd >= 0) {
+        struct stat st{};
+        if(::fstat(fd, &st) == 0 && st.st_size > 0) {
+            auto view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if(view != MAP_FAILED) {
+                data_ = static_cast<const uint8_t*>(view);
+                size_ = static_cast<size_t>(st.st_size);
+                mapping_ = view;
+            }
+        }
+        // mapping stays valid after close
+        ::close(fd);
+    }
+#endif
+
+    if(mapping_) {
+        return;
+    }
+
+    // fallback: read whole file
+    std::ifstream ifs(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if(ifs.fail()) {
+        throw std::runtime_error(std::format("[io::MappedFile] ERROR: failed to open file: {}", path.string()));
+    }
+    auto file_size = static_cast<size_t>(ifs.tellg());
+    ifs.seekg(0, std::ios::beg);
+    fallback_.resize(file_size);
+    ifs.read(reinterpret_cast<char*>(fallback_.data()), static_cast<std::streamsize>(file_size));
+    if(ifs.fail()) {
+        throw std::runtime_error(std::format("[io::MappedFile] ERROR: failed to read file: {}", path.string()));
+    }
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+}
+
+void MappedFile::release_() noexcept {
+    if(mapping_) {
+#if defined(_WIN32)
+        UnmapViewOfFile(mapping_);
+#else
+        ::munmap(mapping_, size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    mapping_ = nullptr;
+    fallback_.clear();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common.hpp"
+
+namespace io {
+
+// read-only view of whole file
+// memory-mapped if possible, otherwise read into memory
+class MappedFile {
+    const uint8_t* data_;
+    size_t size_;
+    // platform mapping handle (nullptr if not mapped)
+    void* mapping_;
+    std::vector<uint8_t> fallback_;
+
+    void release_() noexcept;
+
+public:
+    MappedFile() noexcept : data_(nullptr), size_(0), mapping_(nullptr) {}
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile() noexcept { release_(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& rhs) noexcept :
+        data_(std::exchange(rhs.data_, nullptr)), size_(std::exchange(rhs.size_, 0)), mapping_(std::exchange(rhs.mapping_, nullptr)), fallback_(std::move(rhs.fallback_)) {}
+
+    MappedFile& operator=(MappedFile&& rhs) noexcept {
+        if(this != &rhs) {
+            release_();
+            data_ = std::exchange(rhs.data_, nullptr);
+            size_ = std::exchange(rhs.size_, 0);
+            mapping_ = std::exchange(rhs.mapping_, nullptr);
+            fallback_ = std::move(rhs.fallback_);
+        }
+        return *this;
+    }
+
+    const uint8_t* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+    std::span<const uint8_t> bytes() const noexcept { return {data_, size_}; }
+    bool is_mapped() const noexcept { return mapping_ != nullptr; }
+};
+
+}
\ No newline at end of file
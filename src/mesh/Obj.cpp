@@ -1,120 +1,48 @@
 #include "Obj.hpp"
+#include "../io/MappedFile.hpp"
 
 namespace mesh {
 
-Obj Obj::load(const char* path) {
-    std::FILE* fp = std::fopen(path, "r");
-    if(!fp) {
-        throw std::runtime_error(std::format("[mesh::Obj::load] ERROR: failed to open {}.", path));
+Obj Obj::load(const std::filesystem::path& path, concurrency::ThreadPool* pool) {
+    io::MappedFile file(path);
+    std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+
+    auto ranges = obj::split_lines(text, CHUNK_SIZE);
+    std::vector<obj::Chunk> chunks(ranges.size());
+    concurrency::parallel_for(pool, static_cast<uint32_t>(chunks.size()), [&](uint32_t i) {
+        auto [begin, end] = ranges[i];
+        obj::parse_chunk(text.substr(begin, end - begin), begin, chunks[i]);
+    });
+
+    // attribute and corner counts of preceding chunks
+    std::vector<std::array<size_t, 3>> bases(chunks.size());
+    std::vector<size_t> corner_bases(chunks.size());
+    std::array<size_t, 3> counts{};
+    size_t corner_count = 0;
+    for(size_t i = 0; i < chunks.size(); ++i) {
+        bases[i] = counts;
+        corner_bases[i] = corner_count;
+        counts[0] += chunks[i].positions.size();
+        counts[1] += chunks[i].tex_coords.size();
+        counts[2] += chunks[i].normals.size();
+        corner_count += chunks[i].corners.size();
     }
 
-    std::vector<glm::vec3> vertices{};
-    std::vector<glm::vec2> texcoords{};
-    std::vector<glm::vec3> normals{};
-    std::vector<IndexLayout_> attribute_indices{};
-
-    constexpr size_t BUF_SIZE = 256;
-
-    std::array<char, BUF_SIZE> buf{};
-    size_t line{};
-
-    while(!std::feof(fp)) {
-        // reset buffer
-        buf.fill('\0');
-        // get line
-        std::fgets(buf.data(), static_cast<int>(buf.size()), fp);
-        line++;
-        // failed to read whole line -> error
-        if(buf[BUF_SIZE-2] != '\0') {
-            throw std::runtime_error(std::format("[mesh::Obj::load_fast] ERROR: buffer overflow. parser expects up to {} bytes for each line.", BUF_SIZE-1));
-        }
-
-        std::string_view str_view(buf.data());
-
-        // line is not EOF -> remove line feed
-        if(str_view.find('\n') != std::string_view::npos) {
-            str_view.remove_suffix(1);
-        }
-
-        // remove spaces at the end
-        auto last_pos = str_view.find_last_not_of(' ');
-        if(last_pos != std::string_view::npos && last_pos + 1 < str_view.length()) {
-            last_pos += 1;
-            str_view.remove_suffix(str_view.length() - last_pos);
-        }
-
-        // empty line -> skip
-        if(str_view.empty() || str_view.find_first_not_of(' ') == std::string_view::npos) {
-            continue;
+    std::vector<glm::vec3> vertices(counts[0]);
+    std::vector<glm::vec2> texcoords(counts[1]);
+    std::vector<glm::vec3> normals(counts[2]);
+    std::vector<IndexLayout_> attribute_indices(corner_count);
+    concurrency::parallel_for(pool, static_cast<uint32_t>(chunks.size()), [&](uint32_t i) {
+        auto& chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), vertices.begin() + bases[i][0]);
+        std::copy(chunk.tex_coords.begin(), chunk.tex_coords.end(), texcoords.begin() + bases[i][1]);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + bases[i][2]);
+        for(size_t j = 0; j < chunk.corners.size(); ++j) {
+            auto [v, t, n] = obj::resolve(chunk.corners[j], bases[i], counts);
+            attribute_indices[corner_bases[i] + j] = IndexLayout_{v, t, n};
         }
-
-        // remove front spaces
-        str_view.remove_prefix(str_view.find_first_not_of(' '));
-        // comment line -> skip
-        if(str_view[0] == '#') {
-            continue;
-        }
-
-        // extract first token
-        auto header = read_(str_view);
-
-        // vertex
-        if(header == "v") {
-            seek_(str_view);
-
-            auto x_str = read_(str_view); seek_(str_view);
-            auto y_str = read_(str_view); seek_(str_view);
-            auto z_str = read_(str_view);
-            float x{}, y{}, z{};
-            std::from_chars(x_str.data(), x_str.data() + x_str.length(), x); std::from_chars(y_str.data(), y_str.data() + y_str.length(), y); std::from_chars(z_str.data(), z_str.data() + z_str.length(), z);
-            vertices.emplace_back(glm::vec3(x, y, z));
-        }
-        // texcoord
-        else if(header == "vt") {
-            seek_(str_view);
-
-            auto u_str = read_(str_view); seek_(str_view);
-            auto v_str = read_(str_view);
-            float u{}, v{};
-            std::from_chars(u_str.data(), u_str.data() + u_str.length(), u); std::from_chars(v_str.data(), v_str.data() + v_str.length(), v);
-            texcoords.emplace_back(glm::vec2(u, v));
-        }
-        // normal
-        else if(header == "vn") {
-            seek_(str_view);
-
-            auto x_str = read_(str_view); seek_(str_view);
-            auto y_str = read_(str_view); seek_(str_view);
-            auto z_str = read_(str_view);
-            float x{}, y{}, z{};
-            std::from_chars(x_str.data(), x_str.data() + x_str.length(), x); std::from_chars(y_str.data(), y_str.data() + y_str.length(), y); std::from_chars(z_str.data(), z_str.data() + z_str.length(), z);
-            normals.emplace_back(glm::vec3(x, y, z));
-        }
-        // face
-        else if(header == "f") {
-            seek_(str_view);
-
-            auto i0_str = read_(str_view); seek_(str_view);
-            auto i1_str = read_(str_view); seek_(str_view);
-            auto i2_str = read_(str_view);
-            auto i0 = read_index_(i0_str, vertices.size(), texcoords.size(), normals.size());
-            auto i1 = read_index_(i1_str, vertices.size(), texcoords.size(), normals.size());
-            auto i2 = read_index_(i2_str, vertices.size(), texcoords.size(), normals.size());
-            attribute_indices.emplace_back(i0);
-            attribute_indices.emplace_back(i1);
-            attribute_indices.emplace_back(i2);
-
-            // face has 4 indices
-            if(seek_(str_view)) {
-                auto i3_str = read_(str_view);
-                auto i3 = read_index_(i3_str, vertices.size(), texcoords.size(), normals.size());
-                attribute_indices.emplace_back(i3);
-                attribute_indices.emplace_back(i0);
-                attribute_indices.emplace_back(i2);
-            }
-        }
-    }
-    std::fclose(fp);
+        chunk = obj::Chunk{};
+    });
 
     auto [interleaved, indices] = make_interleaved_(vertices, texcoords, normals, attribute_indices);
 
@@ -122,33 +50,45 @@ Obj Obj::load(const char* path) {
 }
 
 std::pair<std::vector<VertexAttribute>, std::vector<uint32_t>> Obj::make_interleaved_(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec2>& texcoords, const std::vector<glm::vec3>& normals, const std::vector<IndexLayout_>& attribute_indices) {
-    auto max_attribute_count = (std::max)({vertices.size(), texcoords.size(), normals.size()});
-
     std::vector<VertexAttribute> interleaved{};
-    std::map<std::tuple<int32_t, int32_t, int32_t>, uint32_t> index_table{};
     std::vector<uint32_t> indices(attribute_indices.size());
 
-    uint32_t idx = 0;
+    // vertices sharing position are chained: first[position] -> next[vertex] -> ... (UINT32_MAX: end of chain)
+    // chains are short (one vertex per uv seam or hard edge), so no hashing is needed
+    std::vector<uint32_t> first(vertices.size(), UINT32_MAX);
+    std::vector<uint32_t> next{};
+    std::vector<IndexLayout_> layouts{};
+    interleaved.reserve(vertices.size());
+    next.reserve(vertices.size());
+    layouts.reserve(vertices.size());
+
     for(size_t i = 0; i < attribute_indices.size(); ++i) {
-        if(index_table.contains({attribute_indices[i].vertex, attribute_indices[i].tex_coord, attribute_indices[i].normal})) {
-            indices[i] = index_table.at({attribute_indices[i].vertex, attribute_indices[i].tex_coord, attribute_indices[i].normal});
+        const auto& layout = attribute_indices[i];
+        auto* link = &first[layout.vertex];
+        while(*link != UINT32_MAX && layouts[*link] != layout) {
+            link = &next[*link];
         }
-        else {
-            index_table[{attribute_indices[i].vertex, attribute_indices[i].tex_coord, attribute_indices[i].normal}] = idx;
+        auto vertex = *link;
+        if(vertex == UINT32_MAX) {
+            // link is updated before next grows (it may point into next)
+            vertex = static_cast<uint32_t>(interleaved.size());
+            *link = vertex;
+            next.push_back(UINT32_MAX);
+            layouts.push_back(layout);
+            // missing attributes are zero
             interleaved.emplace_back(
                 VertexAttribute {
-                    .position = vertices[attribute_indices[i].vertex],
-                    .normal = normals[attribute_indices[i].normal],
-                    .tex_coord = texcoords[attribute_indices[i].tex_coord],
+                    .position = vertices[layout.vertex],
+                    .normal = layout.normal < 0 ? glm::vec3(0.0f) : normals[layout.normal],
+                    .tex_coord = layout.tex_coord < 0 ? glm::vec2(0.0f) : texcoords[layout.tex_coord],
                     .color = glm::vec4(1.0f),
                 }
             );
-            indices[i] = idx;
-            idx += 1;
         }
+        indices[i] = vertex;
     }
 
-    return { interleaved, indices };
+    return { std::move(interleaved), std::move(indices) };
 }
 
 void Obj::print_statistics() const {
@@ -1,17 +1,16 @@
 #include "PMX.hpp"
 
+#include "../io/MappedFile.hpp"
+
 namespace mesh {
 
 PMX PMX::load(const std::filesystem::path& path) {
-    std::ifstream ifs(path, std::ios::in | std::ios::binary);
-    if(ifs.fail()) {
-        throw std::runtime_error(std::format("[mesh::PMX::load] ERROR: failed to open file: {}", path.string().c_str()));
-    }
+    io::MappedFile file(path);
+    io::ByteReader reader(file.bytes());
 
     // magic number "PMX "
-    uint8_t magic[4];
-    ifs.read(reinterpret_cast<char*>(magic), sizeof(uint8_t) * 4);
-    auto magic_str = std::string_view((const char*)magic, 4);
+    auto magic = reader.read_bytes(4);
+    auto magic_str = std::string_view(reinterpret_cast<const char*>(magic.data()), magic.size());
     if(!(magic_str == "PMX ")) {
         throw std::runtime_error(std::format("[mesh::PMX::load] ERROR: input file is not PMX format: {}", path.string().c_str()));
     }
@@ -19,70 +18,83 @@ PMX PMX::load(const std::filesystem::path& path) {
     PMX pmx{};
 
     // format version
-    ifs.read(reinterpret_cast<char*>(&pmx.version_), sizeof(float));
+    reader.read(pmx.version_);
 
     // header size: must be 8
     uint8_t byte_size{};
-    ifs.read(reinterpret_cast<char*>(&byte_size), sizeof(uint8_t));
+    reader.read(byte_size);
     if(byte_size != 8) {
         throw std::runtime_error(std::format("[mesh::PMX::load] ERROR: wrong header byte size: {}", path.string().c_str()));
     }
 
     // header
-    ifs.read(reinterpret_cast<char*>(&pmx.header_), sizeof(uint8_t) * 8);
+    reader.read(pmx.header_);
 
     // model information
-    pmx.name_ = pmx::read_text(ifs, pmx.header_.encode);
-    pmx.name_en_ = pmx::read_text(ifs, pmx.header_.encode);
-    pmx.comment_ = pmx::read_text(ifs, pmx.header_.encode);
-    pmx.comment_en_ = pmx::read_text(ifs, pmx.header_.encode);
+    pmx.name_ = pmx::read_text(reader, pmx.header_.encode);
+    pmx.name_en_ = pmx::read_text(reader, pmx.header_.encode);
+    pmx.comment_ = pmx::read_text(reader, pmx.header_.encode);
+    pmx.comment_en_ = pmx::read_text(reader, pmx.header_.encode);
 
     // vertices
     uint32_t vertex_count{};
-    ifs.read(reinterpret_cast<char*>(&vertex_count), sizeof(uint32_t));
+    reader.read(vertex_count);
     pmx.vertices_.resize(vertex_count);
     for(size_t i = 0; i < pmx.vertices_.size(); ++i) {
-        pmx.vertices_[i] = std::move(pmx::read_vertex(ifs, pmx.header_.additional_uv, pmx.header_.bone_index_size));
+        pmx.vertices_[i] = std::move(pmx::read_vertex(reader, pmx.header_.additional_uv, pmx.header_.bone_index_size));
     }
 
     // index
     uint32_t index_count{};
-    ifs.read(reinterpret_cast<char*>(&index_count), sizeof(uint32_t));
+    reader.read(index_count);
     pmx.indices_.resize(index_count);
-    for(size_t i = 0; i < pmx.indices_.size(); ++i) {
-        pmx.indices_[i] = pmx::read_index(ifs, pmx.header_.vertex_index_size);
+    // vertex indices are unsigned (unlike other indices)
+    if(pmx.header_.vertex_index_size == 1) {
+        auto bytes = reader.read_bytes(index_count);
+        std::copy(bytes.begin(), bytes.end(), pmx.indices_.begin());
+    }
+    else if(pmx.header_.vertex_index_size == 2) {
+        std::vector<uint16_t> indices(index_count);
+        reader.read_le(std::span(indices));
+        std::copy(indices.begin(), indices.end(), pmx.indices_.begin());
+    }
+    else if(pmx.header_.vertex_index_size == 4) {
+        reader.read_le(std::span(pmx.indices_));
+    }
+    else {
+        throw std::runtime_error(std::format("[mesh::PMX::load] ERROR: invalid vertex index size: {}", pmx.header_.vertex_index_size));
     }
 
     // textures
     uint32_t texture_count{};
-    ifs.read(reinterpret_cast<char*>(&texture_count), sizeof(uint32_t));
+    reader.read(texture_count);
     pmx.textures_.resize(texture_count);
     for(size_t i = 0; i < pmx.textures_.size(); ++i) {
-        pmx.textures_[i] = std::move(pmx::read_text(ifs, pmx.header_.encode));
+        pmx.textures_[i] = std::move(pmx::read_text(reader, pmx.header_.encode));
     }
 
     // materials
     uint32_t material_count{};
-    ifs.read(reinterpret_cast<char*>(&material_count), sizeof(uint32_t));
+    reader.read(material_count);
     pmx.materials_.resize(material_count);
     for(size_t i = 0; i < pmx.materials_.size(); ++i) {
-        pmx.materials_[i] = std::move(pmx::read_material(ifs, pmx.header_.texuture_index_size, pmx.header_.encode));
+        pmx.materials_[i] = std::move(pmx::read_material(reader, pmx.header_.texuture_index_size, pmx.header_.encode));
     }
 
     // bones
     uint32_t bone_count{};
-    ifs.read(reinterpret_cast<char*>(&bone_count), sizeof(uint32_t));
+    reader.read(bone_count);
     pmx.bones_.resize(bone_count);
     for(size_t i = 0; i < pmx.bones_.size(); ++i) {
-        pmx.bones_[i] = std::move(pmx::read_bone(ifs, pmx.header_.bone_index_size, pmx.header_.encode));
+        pmx.bones_[i] = std::move(pmx::read_bone(reader, pmx.header_.bone_index_size, pmx.header_.encode));
     }
 
     // morphs
     uint32_t morph_count{};
-    ifs.read(reinterpret_cast<char*>(&morph_count), sizeof(uint32_t));
+    reader.read(morph_count);
     pmx.morphs_.resize(morph_count);
     for(size_t i = 0; i < pmx.morphs_.size(); ++i) {
-        pmx.morphs_[i] = std::move(pmx::read_morph(ifs,
+        pmx.morphs_[i] = std::move(pmx::read_morph(reader,
             pmx.header_.vertex_index_size, pmx.header_.bone_index_size,
             pmx.header_.material_index_size, pmx.header_.morph_index_size,
             pmx.header_.encode
@@ -91,26 +103,26 @@ PMX PMX::load(const std::filesystem::path& path) {
 
     // frames
     uint32_t frame_count{};
-    ifs.read(reinterpret_cast<char*>(&frame_count), sizeof(uint32_t));
+    reader.read(frame_count);
     pmx.frames_.resize(frame_count);
     for(size_t i = 0; i < pmx.frames_.size(); ++i) {
-        pmx.frames_[i] = std::move(pmx::read_frame(ifs, pmx.header_.bone_index_size, pmx.header_.morph_index_size, pmx.header_.encode));
+        pmx.frames_[i] = std::move(pmx::read_frame(reader, pmx.header_.bone_index_size, pmx.header_.morph_index_size, pmx.header_.encode));
     }
 
     // rigids
     uint32_t rigid_count{};
-    ifs.read(reinterpret_cast<char*>(&rigid_count), sizeof(uint32_t));
+    reader.read(rigid_count);
     pmx.rigids_.resize(rigid_count);
     for(size_t i = 0; i < pmx.rigids_.size(); ++i) {
-        pmx.rigids_[i] = std::move(pmx::read_rigid(ifs, pmx.header_.bone_index_size, pmx.header_.encode));
+        pmx.rigids_[i] = std::move(pmx::read_rigid(reader, pmx.header_.bone_index_size, pmx.header_.encode));
     }
 
     // joints
     uint32_t joint_count{};
-    ifs.read(reinterpret_cast<char*>(&joint_count), sizeof(uint32_t));
+    reader.read(joint_count);
     pmx.joints_.resize(joint_count);
     for(size_t i = 0; i < pmx.joints_.size(); ++i) {
-        pmx.joints_[i] = std::move(pmx::read_joint(ifs, pmx.header_.rigid_index_size, pmx.header_.encode));
+        pmx.joints_[i] = std::move(pmx::read_joint(reader, pmx.header_.rigid_index_size, pmx.header_.encode));
     }
 
     return pmx;
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+#include "../common.hpp"
+
+namespace mesh {
+
+namespace obj {
+
+// one corner of triangle as read from file (indices are 0-based)
+// negative (relative) indices of file are counted back from attributes read so far in chunk, so they stay relative to
+// first attribute of chunk until attribute counts of preceding chunks are known (see resolve())
+struct Corner {
+    static constexpr int32_t ABSENT = INT32_MIN;
+
+    // position, tex_coord, normal (ABSENT if not given)
+    std::array<int32_t, 3> indices;
+    // bit k: indices[k] is relative to first attribute of chunk
+    uint8_t relative_mask;
+};
+
+// attributes and triangles of whole lines of file
+struct Chunk {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> tex_coords;
+    std::vector<glm::vec3> normals;
+    // 3 corners per triangle, polygons are fan triangulated
+    std::vector<Corner> corners;
+};
+
+inline bool is_space_(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline const char* skip_spaces_(const char* p, const char* end) noexcept {
+    while(p < end && is_space_(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// number must end at space or end of line (nullptr if not)
+inline const char* parse_float_(const char* p, const char* end, float& value) noexcept {
+    p = skip_spaces_(p, end);
+    if(p < end && *p == '+') {
+        ++p;
+    }
+    auto result = std::from_chars(p, end, value);
+    if(result.ec == std::errc::result_out_of_range) {
+        // denormal or huge value, rounded through double (0 or inf)
+        double wide{};
+        result = std::from_chars(p, end, wide);
+        value = static_cast<float>(wide);
+    }
+    if(result.ec != std::errc{} || (result.ptr < end && !is_space_(*result.ptr))) {
+        return nullptr;
+    }
+    return result.ptr;
+}
+
+// v, v/t, v//n or v/t/n (nullptr if malformed or index is 0)
+inline const char* parse_corner_(const char* p, const char* end, const Chunk& chunk, Corner& corner) noexcept {
+    const size_t counts[3] = {chunk.positions.size(), chunk.tex_coords.size(), chunk.normals.size()};
+    corner = Corner{{Corner::ABSENT, Corner::ABSENT, Corner::ABSENT}, 0};
+    for(uint32_t k = 0; k < 3; ++k) {
+        if(k > 0) {
+            if(p == end || *p != '/') {
+                break;
+            }
+            ++p;
+            // v//n
+            if(p < end && (*p == '/' || is_space_(*p))) {
+                continue;
+            }
+        }
+        int32_t index{};
+        auto [next, error] = std::from_chars(p, end, index);
+        if(error != std::errc{} || index == 0) {
+            return nullptr;
+        }
+        p = next;
+        if(index > 0) {
+            corner.indices[k] = index - 1;
+        }
+        else {
+            corner.indices[k] = static_cast<int32_t>(counts[k]) + index;
+            corner.relative_mask |= 1 << k;
+        }
+    }
+    if(p < end && !is_space_(*p)) {
+        return nullptr;
+    }
+    return p;
+}
+
+// false if line is malformed
+inline bool parse_line_(const char* p, const char* end, Chunk& chunk, std::vector<Corner>& polygon) {
+    p = skip_spaces_(p, end);
+    if(p == end || *p == '#') {
+        return true;
+    }
+    auto keyword_begin = p;
+    while(p < end && !is_space_(*p)) {
+        ++p;
+    }
+    std::string_view keyword(keyword_begin, static_cast<size_t>(p - keyword_begin));
+
+    if(keyword == "v" || keyword == "vn") {
+        // extra values (w or vertex color) are ignored
+        glm::vec3 value{};
+        if(!(p = parse_float_(p, end, value.x)) || !(p = parse_float_(p, end, value.y)) || !(p = parse_float_(p, end, value.z))) {
+            return false;
+        }
+        (keyword == "v" ? chunk.positions : chunk.normals).push_back(value);
+    }
+    else if(keyword == "vt") {
+        // v is optional (1D texture)
+        glm::vec2 value{0.0f, 0.0f};
+        if(!(p = parse_float_(p, end, value.x))) {
+            return false;
+        }
+        if(skip_spaces_(p, end) < end && !parse_float_(p, end, value.y)) {
+            return false;
+        }
+        chunk.tex_coords.push_back(value);
+    }
+    else if(keyword == "f") {
+        polygon.clear();
+        for(p = skip_spaces_(p, end); p < end; p = skip_spaces_(p, end)) {
+            Corner corner{};
+            if(!(p = parse_corner_(p, end, chunk, corner))) {
+                return false;
+            }
+            polygon.push_back(corner);
+        }
+        if(polygon.size() < 3) {
+            return false;
+        }
+        for(size_t k = 1; k + 1 < polygon.size(); ++k) {
+            chunk.corners.push_back(polygon[0]);
+            chunk.corners.push_back(polygon[k]);
+            chunk.corners.push_back(polygon[k + 1]);
+        }
+    }
+    // other statements (o, g, s, usemtl, mtllib, l, p, ...) are skipped
+    return true;
+}
+
+// [begin, end) byte ranges of about chunk_size bytes, each range ends after line feed (or at end of text)
+// line longer than chunk_size just makes its range longer
+inline std::vector<std::pair<size_t, size_t>> split_lines(std::string_view text, size_t chunk_size) {
+    std::vector<std::pair<size_t, size_t>> ranges{};
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    for(size_t begin = 0; begin < text.size();) {
+        auto end = std::min(begin + chunk_size, text.size());
+        if(end < text.size()) {
+            auto line_feed = text.find('\n', end - 1);
+            end = line_feed == std::string_view::npos ? text.size() : line_feed + 1;
+        }
+        ranges.emplace_back(begin, end);
+        begin = end;
+    }
+    return ranges;
+}
+
+// text: whole lines starting at byte offset of file (for error messages)
+// lines may be of any length, line feeds are LF or CRLF
+inline void parse_chunk(std::string_view text, size_t offset, Chunk& chunk) {
+    std::vector<Corner> polygon{};
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    for(auto p = begin; p < end;) {
+        auto line_end = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if(!line_end) {
+            line_end = end;
+        }
+        if(!parse_line_(p, line_end, chunk, polygon)) {
+            auto line = std::string_view(p, static_cast<size_t>(std::min<ptrdiff_t>(line_end - p, 64)));
+            throw std::runtime_error(std::format("[mesh::obj] ERROR: invalid statement at offset {}: {}", offset + static_cast<size_t>(p - begin), line));
+        }
+        p = line_end + 1;
+    }
+}
+
+// chunk relative indices to file indices
+// bases: attribute counts (position, tex_coord, normal) of all preceding chunks, counts: of whole file
+// result uses -1 for absent attributes
+inline std::array<int32_t, 3> resolve(const Corner& corner, const std::array<size_t, 3>& bases, const std::array<size_t, 3>& counts) {
+    std::array<int32_t, 3> indices{-1, -1, -1};
+    for(uint32_t k = 0; k < 3; ++k) {
+        if(corner.indices[k] == Corner::ABSENT) {
+            continue;
+        }
+        auto index = static_cast<int64_t>(corner.indices[k]) + ((corner.relative_mask >> k) & 1 ? static_cast<int64_t>(bases[k]) : 0);
+        if(index < 0 || index >= static_cast<int64_t>(counts[k])) {
+            throw std::runtime_error(std::format("[mesh::obj] ERROR: index out of range (index = {}, count = {}).", index + 1, counts[k]));
+        }
+        indices[k] = static_cast<int32_t>(index);
+    }
+    return indices;
+}
+
+}
+
+}
\ No newline at end of file
@@ -13,17 +13,17 @@ struct IKLink {
     glm::vec3 upper_bound;
 };
 
-inline IKLink read_ik_link(std::ifstream& ifs, uint8_t bone_index_size) {
+inline IKLink read_ik_link(io::ByteReader& reader, uint8_t bone_index_size) {
     IKLink link{};
 
     // bone index
-    link.index = read_index(ifs, bone_index_size);
+    link.index = read_index(reader, bone_index_size);
     // angle constraint
-    ifs.read(reinterpret_cast<char*>(&link.is_limited), sizeof(uint8_t));
+    link.is_limited = reader.read_le<uint8_t>() != 0;
     if(link.is_limited) {
         // lower bound
-        ifs.read(reinterpret_cast<char*>(&link.lower_bound), sizeof(glm::vec3));
-        ifs.read(reinterpret_cast<char*>(&link.upper_bound), sizeof(glm::vec3));
+        reader.read(link.lower_bound);
+        reader.read(link.upper_bound);
     }
 
     return link;
@@ -36,22 +36,22 @@ struct IK {
     std::vector<IKLink> links;
 };
 
-inline IK read_ik(std::ifstream& ifs, uint8_t bone_index_size) {
+inline IK read_ik(io::ByteReader& reader, uint8_t bone_index_size) {
     IK ik{};
 
     // target bone index
-    ik.index = read_index(ifs, bone_index_size);
+    ik.index = read_index(reader, bone_index_size);
     // loop count
-    ifs.read(reinterpret_cast<char*>(&ik.loop_count), sizeof(uint32_t));
+    reader.read(ik.loop_count);
     // constraint
-    ifs.read(reinterpret_cast<char*>(&ik.constraint_rad), sizeof(float));
+    reader.read(ik.constraint_rad);
     // link count
     uint32_t link_count{};
-    ifs.read(reinterpret_cast<char*>(&link_count), sizeof(uint32_t));
+    reader.read(link_count);
     ik.links.resize(link_count);
     // links
     for(size_t i = 0; i < ik.links.size(); ++i) {
-        ik.links[i] = std::move(read_ik_link(ifs, bone_index_size));
+        ik.links[i] = std::move(read_ik_link(reader, bone_index_size));
     }
 
     return ik;
@@ -81,50 +81,50 @@ struct Bone {
     std::filesystem::path name_en;
 };
 
-inline Bone read_bone(std::ifstream& ifs, uint8_t bone_index_size, bool is_utf8) {
+inline Bone read_bone(io::ByteReader& reader, uint8_t bone_index_size, bool is_utf8) {
     Bone bone{};
 
     // name
-    bone.name = std::move(read_text(ifs, is_utf8));
-    bone.name_en = std::move(read_text(ifs, is_utf8));
+    bone.name = std::move(read_text(reader, is_utf8));
+    bone.name_en = std::move(read_text(reader, is_utf8));
 
     // position
-    ifs.read(reinterpret_cast<char*>(&bone.position), sizeof(glm::vec3));
+    reader.read(bone.position);
     // parent index
-    bone.parent_index = read_index(ifs, bone_index_size);
+    bone.parent_index = read_index(reader, bone_index_size);
     // hierarchy
-    ifs.read(reinterpret_cast<char*>(&bone.hierarchy), sizeof(uint32_t));
+    reader.read(bone.hierarchy);
     // flags
-    ifs.read(reinterpret_cast<char*>(&bone.flags), sizeof(uint16_t));
+    reader.read(bone.flags);
     // connectivity = 0 -> offset
     if(!(bone.flags & 0x0001)) {
-        ifs.read(reinterpret_cast<char*>(&bone.connect.offset), sizeof(glm::vec3));
+        reader.read(bone.connect.offset);
     }
     // connectivity = 1 -> bone index
     else {
-        bone.connect.dst_index = read_index(ifs, bone_index_size);
+        bone.connect.dst_index = read_index(reader, bone_index_size);
     }
     // rotate | translate giving -> index and giving rate
     if((bone.flags & 0x0100) || (bone.flags & 0x0200)) {
-        bone.giving_index = read_index(ifs, bone_index_size);
-        ifs.read(reinterpret_cast<char*>(&bone.giving_rate), sizeof(float));
+        bone.giving_index = read_index(reader, bone_index_size);
+        reader.read(bone.giving_rate);
     }
     // axis fixed -> axis direction
     if(bone.flags & 0x0400) {
-        ifs.read(reinterpret_cast<char*>(&bone.axis_dir), sizeof(glm::vec3));
+        reader.read(bone.axis_dir);
     }
     // local axis -> x-axis and z-axis direction
     if(bone.flags & 0x0800) {
-        ifs.read(reinterpret_cast<char*>(&bone.local_x_axis), sizeof(glm::vec3));
-        ifs.read(reinterpret_cast<char*>(&bone.local_z_axis), sizeof(glm::vec3));
+        reader.read(bone.local_x_axis);
+        reader.read(bone.local_z_axis);
     }
     // external transform -> key value
     if(bone.flags & 0x2000) {
-        ifs.read(reinterpret_cast<char*>(&bone.key), sizeof(uint32_t));
+        reader.read(bone.key);
     }
     // IK -> IK information
     if(bone.flags & 0x0020) {
-        bone.ik = std::move(read_ik(ifs, bone_index_size));
+        bone.ik = std::move(read_ik(reader, bone_index_size));
     }
 
     return bone;
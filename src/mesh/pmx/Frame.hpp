@@ -11,18 +11,18 @@ struct FrameElement {
     int32_t index;
 };
 
-inline FrameElement read_frame_element(std::ifstream& ifs, uint8_t bone_index_size, uint8_t morph_index_size) {
+inline FrameElement read_frame_element(io::ByteReader& reader, uint8_t bone_index_size, uint8_t morph_index_size) {
     FrameElement element{};
 
     // target
-    ifs.read(reinterpret_cast<char*>(&element.target), sizeof(uint8_t));
+    reader.read(element.target);
     if(!element.target) {
         // bone index
-        element.index = read_index(ifs, bone_index_size);
+        element.index = read_index(reader, bone_index_size);
     }
     else {
         // morph index
-        element.index = read_index(ifs, morph_index_size);
+        element.index = read_index(reader, morph_index_size);
     }
 
     return element;
@@ -37,20 +37,20 @@ struct Frame {
     std::filesystem::path name_en;
 };
 
-inline Frame read_frame(std::ifstream& ifs, uint8_t bone_index_size, uint8_t morph_index_size, bool is_utf8) {
+inline Frame read_frame(io::ByteReader& reader, uint8_t bone_index_size, uint8_t morph_index_size, bool is_utf8) {
     Frame frame{};
 
     // name
-    frame.name = std::move(read_text(ifs, is_utf8));
-    frame.name_en = std::move(read_text(ifs, is_utf8));
+    frame.name = std::move(read_text(reader, is_utf8));
+    frame.name_en = std::move(read_text(reader, is_utf8));
     // flag
-    ifs.read(reinterpret_cast<char*>(&frame.is_special), sizeof(uint8_t));
+    reader.read(frame.is_special);
     // number of elements
     uint32_t element_count{};
-    ifs.read(reinterpret_cast<char*>(&element_count), sizeof(uint32_t));
+    reader.read(element_count);
     frame.elements.resize(element_count);
     for(size_t i = 0; i < frame.elements.size(); ++i) {
-        frame.elements[i] = std::move(read_frame_element(ifs, bone_index_size, morph_index_size));
+        frame.elements[i] = std::move(read_frame_element(reader, bone_index_size, morph_index_size));
     }
 
     return frame;
@@ -35,34 +35,34 @@ struct Joint {
     std::filesystem::path name_en;
 };
 
-inline Joint read_joint(std::ifstream& ifs, uint8_t rigid_index_size, bool is_utf8) {
+inline Joint read_joint(io::ByteReader& reader, uint8_t rigid_index_size, bool is_utf8) {
     Joint joint{};
 
     // name
-    joint.name = std::move(read_text(ifs, is_utf8));
-    joint.name_en = std::move(read_text(ifs, is_utf8));
+    joint.name = std::move(read_text(reader, is_utf8));
+    joint.name_en = std::move(read_text(reader, is_utf8));
     // type (must be 0 in ver2.0)
-    ifs.read(reinterpret_cast<char*>(&joint.type), sizeof(uint8_t));
+    reader.read(joint.type);
     // rigid A
-    joint.index_a = read_index(ifs, rigid_index_size);
+    joint.index_a = read_index(reader, rigid_index_size);
     // rigid B
-    joint.index_b = read_index(ifs, rigid_index_size);
+    joint.index_b = read_index(reader, rigid_index_size);
     // position
-    ifs.read(reinterpret_cast<char*>(&joint.position), sizeof(glm::vec3));
+    reader.read(joint.position);
     // rotation
-    ifs.read(reinterpret_cast<char*>(&joint.rotate_rad), sizeof(glm::vec3));
+    reader.read(joint.rotate_rad);
     // translation lower bound
-    ifs.read(reinterpret_cast<char*>(&joint.trans_lower), sizeof(glm::vec3));
+    reader.read(joint.trans_lower);
     // translation upper bound
-    ifs.read(reinterpret_cast<char*>(&joint.trans_upper), sizeof(glm::vec3));
+    reader.read(joint.trans_upper);
     // rotation lower bound
-    ifs.read(reinterpret_cast<char*>(&joint.rot_lower_rad), sizeof(glm::vec3));
+    reader.read(joint.rot_lower_rad);
     // rotation upper bound
-    ifs.read(reinterpret_cast<char*>(&joint.rot_upper_rad), sizeof(glm::vec3));
+    reader.read(joint.rot_upper_rad);
     // spring constant translation
-    ifs.read(reinterpret_cast<char*>(&joint.k_trans), sizeof(glm::vec3));
+    reader.read(joint.k_trans);
     // spring constant rotation
-    ifs.read(reinterpret_cast<char*>(&joint.k_rot), sizeof(glm::vec3));
+    reader.read(joint.k_rot);
 
     return joint;
 }
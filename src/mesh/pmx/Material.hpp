@@ -36,48 +36,48 @@ struct Material {
     std::filesystem::path memo;
 };
 
-inline Material read_material(std::ifstream& ifs, uint8_t tex_index_size, bool is_utf8 = false) {
+inline Material read_material(io::ByteReader& reader, uint8_t tex_index_size, bool is_utf8 = false) {
     Material material{};
     material.texture_indices = glm::ivec3(-1);
     // name
-    material.name = std::move(read_text(ifs, is_utf8));
-    material.name_en = std::move(read_text(ifs, is_utf8));
+    material.name = std::move(read_text(reader, is_utf8));
+    material.name_en = std::move(read_text(reader, is_utf8));
     // diffuse
-    ifs.read(reinterpret_cast<char*>(&material.diffuse), sizeof(glm::vec4));
+    reader.read(material.diffuse);
     // specular
-    ifs.read(reinterpret_cast<char*>(&material.specular), sizeof(glm::vec3));
+    reader.read(material.specular);
     // specular intensity
-    ifs.read(reinterpret_cast<char*>(&material.specular_intensity), sizeof(float));
+    reader.read(material.specular_intensity);
     // ambient
-    ifs.read(reinterpret_cast<char*>(&material.ambient), sizeof(glm::vec3));
+    reader.read(material.ambient);
     // flags
-    ifs.read(reinterpret_cast<char*>(&material.flags), sizeof(uint8_t));
+    reader.read(material.flags);
     // edge color
-    ifs.read(reinterpret_cast<char*>(&material.edge_color), sizeof(glm::vec4));
+    reader.read(material.edge_color);
     // edge size
-    ifs.read(reinterpret_cast<char*>(&material.edge_size), sizeof(float));
+    reader.read(material.edge_size);
     // normal texture index
-    material.texture_indices.x = read_index(ifs, tex_index_size);
+    material.texture_indices.x = read_index(reader, tex_index_size);
     // sphere texture index
-    material.texture_indices.y = read_index(ifs, tex_index_size);
+    material.texture_indices.y = read_index(reader, tex_index_size);
     // sphere mode
-    ifs.read(reinterpret_cast<char*>(&material.sphere_mode), sizeof(uint8_t));
+    reader.read(material.sphere_mode);
     // toon flag
     uint8_t toon_flag{};
-    ifs.read(reinterpret_cast<char*>(&toon_flag), sizeof(uint8_t));
+    reader.read(toon_flag);
     if(!toon_flag) {
         // toon texture index
-        material.texture_indices.z = read_index(ifs, tex_index_size);
+        material.texture_indices.z = read_index(reader, tex_index_size);
     }
     else {
         // shared toon index (ignore)
-        ifs.seekg(sizeof(uint8_t), std::ios::cur);
-        // ifs.read(reinterpret_cast<char*>(&material.toon_tex_index), sizeof(uint8_t));
+        reader.skip(sizeof(uint8_t));
+        // reader.read(material.toon_tex_index);
     }
     // memo
-    material.memo = std::move(read_text(ifs, is_utf8));
+    material.memo = std::move(read_text(reader, is_utf8));
     // vertex count
-    ifs.read(reinterpret_cast<char*>(&material.vertex_count), sizeof(uint32_t));
+    reader.read(material.vertex_count);
 
     return material;
 }
@@ -11,13 +11,13 @@ struct VertexMorph {
     int32_t index;
 };
 
-inline VertexMorph read_vertex_morph(std::ifstream& ifs, uint8_t vertex_index_size) {
+inline VertexMorph read_vertex_morph(io::ByteReader& reader, uint8_t vertex_index_size) {
     VertexMorph morph{};
 
     // index
-    morph.index = read_index(ifs, vertex_index_size);
+    morph.index = read_index(reader, vertex_index_size);
     // position offset
-    ifs.read(reinterpret_cast<char*>(&morph.offset), sizeof(glm::vec3));
+    reader.read(morph.offset);
 
     return morph;
 }
@@ -27,13 +27,13 @@ struct UVMorph {
     int32_t index;
 };
 
-inline UVMorph read_uv_morph(std::ifstream& ifs, uint8_t vertex_index_size) {
+inline UVMorph read_uv_morph(io::ByteReader& reader, uint8_t vertex_index_size) {
     UVMorph morph{};
     
     // index
-    morph.index = read_index(ifs, vertex_index_size);
+    morph.index = read_index(reader, vertex_index_size);
     // uv offset
-    ifs.read(reinterpret_cast<char*>(&morph.offset), sizeof(glm::vec4));
+    reader.read(morph.offset);
 
     return morph;
 }
@@ -44,15 +44,15 @@ struct BoneMorph {
     glm::vec4 rotate_quat;
 };
 
-inline BoneMorph read_bone_morph(std::ifstream& ifs, uint8_t bone_index_size) {
+inline BoneMorph read_bone_morph(io::ByteReader& reader, uint8_t bone_index_size) {
     BoneMorph morph{};
     
     // index
-    morph.index = read_index(ifs, bone_index_size);
+    morph.index = read_index(reader, bone_index_size);
     // translate offset
-    ifs.read(reinterpret_cast<char*>(&morph.translate), sizeof(glm::vec3));
+    reader.read(morph.translate);
     // rotate offset
-    ifs.read(reinterpret_cast<char*>(&morph.rotate_quat), sizeof(glm::vec4));
+    reader.read(morph.rotate_quat);
 
     return morph;
 }
@@ -71,31 +71,31 @@ struct MaterialMorph {
     uint8_t calc_mode;
 };
 
-inline MaterialMorph read_material_morph(std::ifstream& ifs, uint8_t material_index_size) {
+inline MaterialMorph read_material_morph(io::ByteReader& reader, uint8_t material_index_size) {
     MaterialMorph morph{};
 
     // index
-    morph.index = read_index(ifs, material_index_size);
+    morph.index = read_index(reader, material_index_size);
     // calculation mode
-    ifs.read(reinterpret_cast<char*>(&morph.calc_mode), sizeof(uint8_t));
+    reader.read(morph.calc_mode);
     // diffuse
-    ifs.read(reinterpret_cast<char*>(&morph.diffuse), sizeof(glm::vec4));
+    reader.read(morph.diffuse);
     // specular
-    ifs.read(reinterpret_cast<char*>(&morph.specular), sizeof(glm::vec3));
+    reader.read(morph.specular);
     // specular intensity
-    ifs.read(reinterpret_cast<char*>(&morph.specular_intensity), sizeof(float));
+    reader.read(morph.specular_intensity);
     // ambient
-    ifs.read(reinterpret_cast<char*>(&morph.ambient), sizeof(glm::vec3));
+    reader.read(morph.ambient);
     // edge color
-    ifs.read(reinterpret_cast<char*>(&morph.edge_color), sizeof(glm::vec4));
+    reader.read(morph.edge_color);
     // edge size
-    ifs.read(reinterpret_cast<char*>(&morph.edge_size), sizeof(float));
+    reader.read(morph.edge_size);
     // texture coefficient
-    ifs.read(reinterpret_cast<char*>(&morph.tex_coef), sizeof(glm::vec4));
+    reader.read(morph.tex_coef);
     // sphere texture coefficient
-    ifs.read(reinterpret_cast<char*>(&morph.sphere_tex_coef), sizeof(glm::vec4));
+    reader.read(morph.sphere_tex_coef);
     // toon texture coefficient
-    ifs.read(reinterpret_cast<char*>(&morph.toon_tex_coef), sizeof(glm::vec4));
+    reader.read(morph.toon_tex_coef);
 
     return morph;
 }
@@ -105,13 +105,13 @@ struct GroupMorph {
     float rate;
 };
 
-inline GroupMorph read_group_morph(std::ifstream& ifs, uint8_t morph_index_size) {
+inline GroupMorph read_group_morph(io::ByteReader& reader, uint8_t morph_index_size) {
     GroupMorph morph{};
 
     // index
-    morph.index = read_index(ifs, morph_index_size);
+    morph.index = read_index(reader, morph_index_size);
     // rate
-    ifs.read(reinterpret_cast<char*>(&morph.rate), sizeof(float));
+    reader.read(morph.rate);
 
     return morph;
 }
@@ -132,7 +132,7 @@ struct Morph {
     std::vector<Offset> offsets;
 };
 
-inline Morph read_morph(std::ifstream& ifs,
+inline Morph read_morph(io::ByteReader& reader,
     uint8_t vertex_index_size, uint8_t bone_index_size,
     uint8_t material_index_size, uint8_t morph_index_size,
     bool is_utf8)
@@ -140,33 +140,33 @@ inline Morph read_morph(std::ifstream& ifs,
     Morph morph{};
 
     // name
-    morph.name = std::move(read_text(ifs, is_utf8));
-    morph.name_en = std::move(read_text(ifs, is_utf8));
+    morph.name = std::move(read_text(reader, is_utf8));
+    morph.name_en = std::move(read_text(reader, is_utf8));
     // panel
-    ifs.read(reinterpret_cast<char*>(&morph.panel), sizeof(uint8_t));
+    reader.read(morph.panel);
     // type
-    ifs.read(reinterpret_cast<char*>(&morph.type), sizeof(uint8_t));
+    reader.read(morph.type);
     // number of morphs
-    ifs.read(reinterpret_cast<char*>(&morph.offset_count), sizeof(uint32_t));
+    reader.read(morph.offset_count);
     morph.offsets.resize(morph.offset_count);
 
     switch(morph.type) {
         // group
         case 0:
             for(size_t i = 0; i < morph.offsets.size(); ++i) {
-                morph.offsets[i].group = std::move(read_group_morph(ifs, morph_index_size));
+                morph.offsets[i].group = std::move(read_group_morph(reader, morph_index_size));
             }
             break;
         // vertex
         case 1:
             for(size_t i = 0; i < morph.offsets.size(); ++i) {
-                morph.offsets[i].vertex = std::move(read_vertex_morph(ifs, vertex_index_size));
+                morph.offsets[i].vertex = std::move(read_vertex_morph(reader, vertex_index_size));
             }
             break;
         // bone
         case 2:
             for(size_t i = 0; i < morph.offsets.size(); ++i) {
-                morph.offsets[i].bone = std::move(read_bone_morph(ifs, bone_index_size));
+                morph.offsets[i].bone = std::move(read_bone_morph(reader, bone_index_size));
             }
             break;
         // uv
@@ -180,13 +180,13 @@ inline Morph read_morph(std::ifstream& ifs,
         // additonal uv4
         case 7:
             for(size_t i = 0; i < morph.offsets.size(); ++i) {
-                morph.offsets[i].uv = std::move(read_uv_morph(ifs, vertex_index_size));
+                morph.offsets[i].uv = std::move(read_uv_morph(reader, vertex_index_size));
             }
             break;
         // material
         case 8:
             for(size_t i = 0; i < morph.offsets.size(); ++i) {
-                morph.offsets[i].material = std::move(read_material_morph(ifs, material_index_size));
+                morph.offsets[i].material = std::move(read_material_morph(reader, material_index_size));
             }
             break;
         default:
@@ -26,38 +26,38 @@ struct Rigid {
     std::filesystem::path name_en;
 };
 
-inline Rigid read_rigid(std::ifstream& ifs, uint8_t bone_index_size, bool is_utf8) {
+inline Rigid read_rigid(io::ByteReader& reader, uint8_t bone_index_size, bool is_utf8) {
     Rigid rigid{};
 
     // name
-    rigid.name = std::move(read_text(ifs, is_utf8));
-    rigid.name_en = std::move(read_text(ifs, is_utf8));
+    rigid.name = std::move(read_text(reader, is_utf8));
+    rigid.name_en = std::move(read_text(reader, is_utf8));
     // bone index
-    rigid.index = read_index(ifs, bone_index_size);
+    rigid.index = read_index(reader, bone_index_size);
     // group
-    ifs.read(reinterpret_cast<char*>(&rigid.group), sizeof(uint8_t));
+    reader.read(rigid.group);
     // group flag
-    ifs.read(reinterpret_cast<char*>(&rigid.group_flag), sizeof(uint16_t));
+    reader.read(rigid.group_flag);
     // topology
-    ifs.read(reinterpret_cast<char*>(&rigid.topology), sizeof(uint8_t));
+    reader.read(rigid.topology);
     // size
-    ifs.read(reinterpret_cast<char*>(&rigid.size), sizeof(glm::vec3));
+    reader.read(rigid.size);
     // position
-    ifs.read(reinterpret_cast<char*>(&rigid.position), sizeof(glm::vec3));
+    reader.read(rigid.position);
     // rotation
-    ifs.read(reinterpret_cast<char*>(&rigid.rotate_rad), sizeof(glm::vec3));
+    reader.read(rigid.rotate_rad);
     // mass
-    ifs.read(reinterpret_cast<char*>(&rigid.mass), sizeof(float));
+    reader.read(rigid.mass);
     // translation attenuation
-    ifs.read(reinterpret_cast<char*>(&rigid.trans_atten), sizeof(float));
+    reader.read(rigid.trans_atten);
     // rotation attenuation
-    ifs.read(reinterpret_cast<char*>(&rigid.rot_atten), sizeof(float));
+    reader.read(rigid.rot_atten);
     // repulsion
-    ifs.read(reinterpret_cast<char*>(&rigid.repulsion), sizeof(float));
+    reader.read(rigid.repulsion);
     // friction
-    ifs.read(reinterpret_cast<char*>(&rigid.friction), sizeof(float));
+    reader.read(rigid.friction);
     // calculation type
-    ifs.read(reinterpret_cast<char*>(&rigid.calc_type), sizeof(uint8_t));
+    reader.read(rigid.calc_type);
 
     return rigid;
 }
@@ -51,63 +51,63 @@ struct Vertex {
     float edge_mult;
 };
 
-inline Vertex read_vertex(std::ifstream& ifs, uint8_t add_uv_count, uint8_t bone_index_size) {
+inline Vertex read_vertex(io::ByteReader& reader, uint8_t add_uv_count, uint8_t bone_index_size) {
     Vertex vertex{};
     // position
-    ifs.read(reinterpret_cast<char*>(&vertex.position), sizeof(glm::vec3));
+    reader.read(vertex.position);
     // normal
-    ifs.read(reinterpret_cast<char*>(&vertex.normal), sizeof(glm::vec3));
+    reader.read(vertex.normal);
     // uv
-    ifs.read(reinterpret_cast<char*>(&vertex.uv), sizeof(glm::vec2));
+    reader.read(vertex.uv);
     // addtional uvs (ignore)
     for(uint8_t i = 0; i < add_uv_count; ++i) {
-        ifs.seekg(sizeof(glm::vec4), std::ios::cur);
+        reader.skip(sizeof(glm::vec4));
     }
     // weight type
     uint8_t weight_type{};
-    ifs.read(reinterpret_cast<char*>(&weight_type), sizeof(uint8_t));
+    reader.read(weight_type);
     // bone indices/weights
     vertex.bone_indices = glm::ivec4(-1);
     switch(weight_type) {
         // BDEF1
         case 0:
-            vertex.bone_indices.x = read_index(ifs, bone_index_size);
+            vertex.bone_indices.x = read_index(reader, bone_index_size);
             vertex.bone_weights.x = 1.0f;
             break;
         // BDEF2
         case 1:
-            vertex.bone_indices.x = read_index(ifs, bone_index_size);
-            vertex.bone_indices.y = read_index(ifs, bone_index_size);
-            ifs.read(reinterpret_cast<char*>(&vertex.bone_weights.x), sizeof(float));
+            vertex.bone_indices.x = read_index(reader, bone_index_size);
+            vertex.bone_indices.y = read_index(reader, bone_index_size);
+            reader.read(vertex.bone_weights.x);
             vertex.bone_weights.y = 1.0f - vertex.bone_weights.x;
             break;
         // BDEF4
         case 2:
-            vertex.bone_indices.x = read_index(ifs, bone_index_size);
-            vertex.bone_indices.y = read_index(ifs, bone_index_size);
-            vertex.bone_indices.z = read_index(ifs, bone_index_size);
-            vertex.bone_indices.w = read_index(ifs, bone_index_size);
-            ifs.read(reinterpret_cast<char*>(&vertex.bone_weights.x), sizeof(float));
-            ifs.read(reinterpret_cast<char*>(&vertex.bone_weights.y), sizeof(float));
-            ifs.read(reinterpret_cast<char*>(&vertex.bone_weights.z), sizeof(float));
-            ifs.read(reinterpret_cast<char*>(&vertex.bone_weights.w), sizeof(float));
+            vertex.bone_indices.x = read_index(reader, bone_index_size);
+            vertex.bone_indices.y = read_index(reader, bone_index_size);
+            vertex.bone_indices.z = read_index(reader, bone_index_size);
+            vertex.bone_indices.w = read_index(reader, bone_index_size);
+            reader.read(vertex.bone_weights.x);
+            reader.read(vertex.bone_weights.y);
+            reader.read(vertex.bone_weights.z);
+            reader.read(vertex.bone_weights.w);
             // maybe sum of weights is not 1 -> normalize
             vertex.bone_weights = glm::normalize(vertex.bone_weights);
             break;
         // SDEF
         case 3:
-            vertex.bone_indices.x = read_index(ifs, bone_index_size);
-            vertex.bone_indices.y = read_index(ifs, bone_index_size);
-            ifs.read(reinterpret_cast<char*>(&vertex.bone_weights.x), sizeof(float));
+            vertex.bone_indices.x = read_index(reader, bone_index_size);
+            vertex.bone_indices.y = read_index(reader, bone_index_size);
+            reader.read(vertex.bone_weights.x);
             vertex.bone_weights.y = 1.0f - vertex.bone_weights.x;
             // ignore SDEF parameters
-            ifs.seekg(sizeof(glm::vec3) * 3, std::ios::cur);
+            reader.skip(sizeof(glm::vec3) * 3);
             break;
         default:
             break;
     }
     // edge mult
-    ifs.read(reinterpret_cast<char*>(&vertex.edge_mult), sizeof(float));
+    reader.read(vertex.edge_mult);
 
     return vertex;
 }
@@ -1,39 +1,35 @@
 #pragma once
 
 #include "../common.hpp"
+#include "../../io/ByteReader.hpp"
 
 namespace mesh {
 
 namespace pmx {
 
-inline std::filesystem::path read_text(std::ifstream& ifs, bool is_utf8 = false) {
-    uint32_t byte_size{};
-    ifs.read(reinterpret_cast<char*>(&byte_size), sizeof(uint32_t));
-    std::vector<uint8_t> bytes(byte_size);
-    ifs.read(reinterpret_cast<char*>(bytes.data()), sizeof(uint8_t) * bytes.size());
+inline std::filesystem::path read_text(io::ByteReader& reader, bool is_utf8 = false) {
+    auto byte_size = reader.read_le<uint32_t>();
+    auto bytes = reader.read_bytes(byte_size);
     if(is_utf8) {
-        return std::filesystem::path(reinterpret_cast<char8_t*>(bytes.data()), reinterpret_cast<char8_t*>(bytes.data()) + byte_size);
+        return std::filesystem::path(reinterpret_cast<const char8_t*>(bytes.data()), reinterpret_cast<const char8_t*>(bytes.data()) + byte_size);
     }
     else {
-        return std::filesystem::path(reinterpret_cast<char16_t*>(bytes.data()), reinterpret_cast<char16_t*>(bytes.data()) + byte_size / 2);
+        // text is not aligned in file -> copy to aligned buffer
+        std::u16string text(byte_size / 2, u'\0');
+        std::memcpy(text.data(), bytes.data(), text.size() * sizeof(char16_t));
+        return std::filesystem::path(text);
     }
 }
 
-inline int32_t read_index(std::ifstream& ifs, uint8_t index_size) {
+inline int32_t read_index(io::ByteReader& reader, uint8_t index_size) {
     if(index_size == 1) {
-        int8_t index{};
-        ifs.read(reinterpret_cast<char*>(&index), index_size);
-        return index;
+        return reader.read_le<int8_t>();
     }
     else if(index_size == 2) {
-        int16_t index{};
-        ifs.read(reinterpret_cast<char*>(&index), index_size);
-        return index;
+        return reader.read_le<int16_t>();
     }
     else if(index_size == 4) {
-        int32_t index{};
-        ifs.read(reinterpret_cast<char*>(&index), index_size);
-        return index;
+        return reader.read_le<int32_t>();
     }
     else {
         return -1;